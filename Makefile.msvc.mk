@@ -1,24 +1,63 @@
 CFLAGS  = /W3 /O2 /I..\include
 LIB_EXE = lib.exe
 
-SRCS = convert.c \
+SRCS = analyzeLinkGraph.c \
+	callTrace.c \
+	convert.c \
 	createLink.c \
+	deadline.c \
+	dedupTree.c \
+	diskUsage.c \
 	getCanonicalPath.c \
+	getFileIdentity.c \
+	getHardLinkNames.c \
 	getLinkTarget.c \
 	isSymlink.c \
+	linkFilter.c \
+	linkIndex.c \
 	lstat.c \
-	posix.c
+	lstat_columns.c \
+	lstatx.c \
+	lx_path.c \
+	mapVolumePath.c \
+	mirrorTree.c \
+	ntapi.c \
+	ntname.c \
+	ntNative.c \
+	openat.c \
+	posix.c \
+	readLinkChanges.c \
+	reparse_decode.c \
+	resolver.c \
+	resolver_core.c \
+	resolver_os_win32.c \
+	retarget.c \
+	retargetLinks.c \
+	slice.c \
+	strpool.c \
+	symlinkReplace.c \
+	trace.c \
+	translateLxTarget.c \
+	usn_feed.c \
+	volhealth.c \
+	walk.c \
+	workers.c
 
 ARCHIVE = symlink.lib
-TEST_FILES = test\test1.exe test\test2.exe test\test3.exe
+TEST_FILES = test\test1.exe test\test2.exe test\test3.exe test\test4.exe test\test5.exe test\test7.exe test\test8.exe test\test9.exe test\test10.exe test\test11.exe test\test13.exe
+
+TOOLS = tools\findlinks.exe tools\ln.exe tools\lstat.exe tools\readlink.exe tools\realpath.exe tools\resolverd.exe tools\tracereplay.exe
+TOOL_SRCS = tool.c toolio.c
 
 
 all: $(ARCHIVE)
 
 tests: $(TEST_FILES)
 
+tools: $(TOOLS)
+
 clean:
-	-del /Q *.lib test\*.exe test\*.obj source\*.obj
+	-del /Q *.lib test\*.exe test\*.obj source\*.obj tools\*.exe tools\*.obj
 
 $(ARCHIVE):
 	cd source && $(CC) /nologo /MP $(CFLAGS) /c $(SRCS) && $(LIB_EXE) *.obj /out:..\$(ARCHIVE)
@@ -32,3 +71,47 @@ test/test2.exe: $(ARCHIVE)
 test/test3.exe: $(ARCHIVE)
 	cd test && $(CC) /nologo /MP $(CFLAGS) test3.c /Fe:test3.exe /link ..\$(ARCHIVE) $(LFLAGS)
 
+test/test4.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test4.c ..\source\reparse_decode.c ..\source\usn_feed.c /Fe:test4.exe
+
+test/test5.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test5.c ..\source\lx_path.c /Fe:test5.exe
+
+test/test7.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test7.c ..\source\trace.c ..\source\reparse_decode.c /Fe:test7.exe
+
+test/test8.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test8.c ..\source\retarget.c ..\source\reparse_decode.c /Fe:test8.exe
+
+test/test9.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test9.c ..\source\volhealth.c /Fe:test9.exe
+
+test/test10.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\tools test10.c ..\tools\toolio.c /Fe:test10.exe
+
+test/test11.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test11.c ..\source\resolver_core.c /Fe:test11.exe
+
+test/test13.exe:
+	cd test && $(CC) /nologo /MP $(CFLAGS) /I..\source test13.c ..\source\ntname.c /Fe:test13.exe
+
+tools/findlinks.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) /I..\source findlinks.c $(TOOL_SRCS) /Fe:findlinks.exe /link ..\$(ARCHIVE) shell32.lib $(LFLAGS)
+
+tools/ln.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) /I..\source ln.c $(TOOL_SRCS) /Fe:ln.exe /link ..\$(ARCHIVE) shell32.lib $(LFLAGS)
+
+tools/lstat.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) /I..\source lstat.c $(TOOL_SRCS) /Fe:lstat.exe /link ..\$(ARCHIVE) shell32.lib $(LFLAGS)
+
+tools/readlink.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) /I..\source readlink.c $(TOOL_SRCS) /Fe:readlink.exe /link ..\$(ARCHIVE) shell32.lib $(LFLAGS)
+
+tools/realpath.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) /I..\source realpath.c $(TOOL_SRCS) /Fe:realpath.exe /link ..\$(ARCHIVE) shell32.lib $(LFLAGS)
+
+tools/resolverd.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) resolverd.c /Fe:resolverd.exe /link ..\$(ARCHIVE) $(LFLAGS)
+
+tools/tracereplay.exe: $(ARCHIVE)
+	cd tools && $(CC) /nologo /MP $(CFLAGS) /I..\source tracereplay.c /Fe:tracereplay.exe /link ..\$(ARCHIVE) $(LFLAGS)
@@ -24,9 +24,13 @@
 #ifndef W32_SYMLINK_H_INCLUDED
 #define W32_SYMLINK_H_INCLUDED
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <wchar.h>
 #include <limits.h>
+#include <stdio.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -45,6 +49,8 @@ extern "C" {
 #endif
 
 
+#ifdef _WIN32
+
 /* typedef for ssize_t */
 #ifndef _SSIZE_T_DEFINED
 #define _SSIZE_T_DEFINED
@@ -65,6 +71,26 @@ typedef int ssize_t;
 #endif
 #endif
 
+#else
+
+/* Outside of Windows only the narrow character core of the API is
+ * available: createLink(), getCanonicalPath(), getLinkTarget(),
+ * getLinkTargetView(), isSymlink(), readlink_s(), realpath_s(), their
+ * length-delimited *N() variants and the resolver service. They map onto
+ * the native system calls and report errors in errno. */
+typedef int      BOOL;
+typedef uint32_t DWORD;
+typedef uint32_t ULONG;
+
+#ifndef TRUE
+#define TRUE   1
+#endif
+#ifndef FALSE
+#define FALSE  0
+#endif
+
+#endif /* _WIN32 */
+
 
 /* https://learn.microsoft.com/en-us/windows/win32/fileio/maximum-file-path-limitation */
 #define MODERN_MAX_PATH 32767
@@ -113,7 +139,38 @@ typedef int ssize_t;
 #endif
 
 BOOL createLinkA(const char *lpLinkName, const char *lpTargetName, char mode);
+#ifdef _WIN32
 BOOL createLinkW(const wchar_t *lpLinkName, const wchar_t *lpTargetName, char mode);
+#endif
+
+
+
+#ifdef _WIN32
+
+/**
+ * Returns what the current process is able to do when creating symbolic
+ * links. The system is probed once per process and the result is cached;
+ * createLink() uses it to pick the right flags on the first attempt.
+ *
+ * SYMLINK_CAP_UNPRIVILEGED_FLAG  the OS accepts the flag
+ *                                SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE
+ *                                (Windows 10 build 14972 or later)
+ * SYMLINK_CAP_DEVELOPER_MODE     Developer Mode is enabled
+ * SYMLINK_CAP_PRIVILEGE          the process token holds
+ *                                SeCreateSymbolicLinkPrivilege
+ * SYMLINK_CAP_CREATE             symbolic links can be created
+ *
+ * Hard links and junctions are not affected by any of these.
+ */
+
+#define SYMLINK_CAP_UNPRIVILEGED_FLAG  0x1
+#define SYMLINK_CAP_DEVELOPER_MODE     0x2
+#define SYMLINK_CAP_PRIVILEGE          0x4
+#define SYMLINK_CAP_CREATE             0x8
+
+DWORD getSymlinkCapabilities(void);
+
+#endif /* _WIN32 */
 
 
 
@@ -136,7 +193,108 @@ BOOL createLinkW(const wchar_t *lpLinkName, const wchar_t *lpTargetName, char mo
 #endif
 
 char    *getCanonicalPathA(const char *lpFileName);
+#ifdef _WIN32
 wchar_t *getCanonicalPathW(const wchar_t *lpFileName);
+#endif
+
+
+
+#ifdef _WIN32
+
+/**
+ * getCanonicalPathEx() works like getCanonicalPath(), but 'flags' selects
+ * how the volume is named in the result:
+ *
+ * CANONICAL_PATH_DOS   drive letter, "\\?\C:\..." (like getCanonicalPath())
+ * CANONICAL_PATH_GUID  volume GUID path, "\\?\Volume{...}\..."
+ * CANONICAL_PATH_NT    NT device path, "\Device\HarddiskVolume1\..."
+ *
+ * CANONICAL_PATH_NT skips the drive letter lookup and is the cheapest
+ * mode if the result is only compared or hashed.
+ */
+
+#define CANONICAL_PATH_DOS   0x0
+#define CANONICAL_PATH_GUID  0x1
+#define CANONICAL_PATH_NT    0x2
+
+#ifdef _UNICODE
+#define getCanonicalPathEx getCanonicalPathExW
+#else
+#define getCanonicalPathEx getCanonicalPathExA
+#endif
+
+char    *getCanonicalPathExA(const char *lpFileName, DWORD flags);
+wchar_t *getCanonicalPathExW(const wchar_t *lpFileName, DWORD flags);
+
+
+
+/**
+ * translateLxTarget() turns the target of a WSL symbolic link
+ * (IO_REPARSE_TAG_LX_SYMLINK) into the Windows path it refers to,
+ * without starting WSL. lpLinkName is the path of the link and lpTarget
+ * its target as returned by getLinkTarget().
+ *
+ * "/mnt/c/..." becomes "C:\...". Other absolute targets are located in
+ * the distribution the link lives in ("\\wsl$\<name>\..." or
+ * "\\wsl.localhost\<name>\...") or, for links on a Windows drive, in the
+ * default distribution. Relative targets are resolved from the link's
+ * directory the way Linux sees it, so "../../d" from "C:\x\link" is "D:\".
+ * Characters that WSL escapes in Windows file names are escaped.
+ *
+ * The registered distributions are read from the registry once and
+ * cached, together with the automount root ("root" in the [automount]
+ * section of /etc/wsl.conf) and the drvfs mounts of /etc/fstab of each;
+ * call refreshLxMountTable() after changing them. Those files are only
+ * readable for WSL 1 distributions, for others drives are expected below
+ * the default automount root "/mnt/". Nothing is checked for existence.
+ *
+ * getCanonicalPath() uses this to follow WSL symbolic links.
+ * If the target has no Windows counterpart, NULL is returned with
+ * ERROR_NOT_SUPPORTED. The result must be deallocated with free().
+ */
+
+#ifdef _UNICODE
+#define translateLxTarget translateLxTargetW
+#else
+#define translateLxTarget translateLxTargetA
+#endif
+
+char    *translateLxTargetA(const char *lpLinkName, const char *lpTarget);
+wchar_t *translateLxTargetW(const wchar_t *lpLinkName, const wchar_t *lpTarget);
+
+void refreshLxMountTable(void);
+
+
+
+/**
+ * mapVolumePath() replaces the volume part of a volume GUID path
+ * ("\\?\Volume{...}\..." or "\??\Volume{...}\...", i.e. the target of a
+ * mount point) or of an NT device path ("\Device\HarddiskVolume1\...")
+ * with the path the volume is mounted at, usually its drive letter.
+ * "\Device\Mup\server\share" becomes "\\server\share".
+ *
+ * Volumes are enumerated once into a process-wide cache, which is
+ * reloaded when a drive letter appears or disappears. getCanonicalPath()
+ * and the other functions returning drive letter paths use this cache
+ * instead of querying the mount manager on every call.
+ * Call flushVolumeMountCache() after mounting a volume into a folder.
+ *
+ * If the volume is not mounted anywhere, NULL is returned with
+ * ERROR_PATH_NOT_FOUND. The result must be deallocated with free().
+ */
+
+#ifdef _UNICODE
+#define mapVolumePath mapVolumePathW
+#else
+#define mapVolumePath mapVolumePathA
+#endif
+
+char    *mapVolumePathA(const char *lpPath);
+wchar_t *mapVolumePathW(const wchar_t *lpPath);
+
+void flushVolumeMountCache(void);
+
+#endif /* _WIN32 */
 
 
 
@@ -156,7 +314,92 @@ wchar_t *getCanonicalPathW(const wchar_t *lpFileName);
 #endif
 
 char    *getLinkTargetA(const char *lpFileName, ULONG *pReparseTag);
+#ifdef _WIN32
 wchar_t *getLinkTargetW(const wchar_t *lpFileName, ULONG *pReparseTag);
+#endif
+
+
+
+/**
+ * getLinkTargetView() reads the raw reparse data of lpFileName into the
+ * caller-owned 'buffer' and fills pView with the positions of the link's
+ * names inside of it. Nothing is allocated or copied, so this is the
+ * cheapest way to hash or compare link targets.
+ *
+ * Offsets are in bytes from the start of 'buffer', lengths are in
+ * characters and the strings are not NUL-terminated. They are UTF-16
+ * (also for the A variant) unless 'utf8' is set, which is the case
+ * for WSL symbolic links. Use LINK_VIEW_STRING() to get a pointer.
+ *
+ * subst   substitute name, the path the system actually follows
+ * print   print name; 0 length if the link type has none
+ * target  what getLinkTarget() returns
+ * norm    target without a leading "\??\"
+ *
+ * A buffer of MAXIMUM_REPARSE_DATA_BUFFER_SIZE bytes is always large
+ * enough. If lpFileName exists but is not a link, FALSE is returned with
+ * ERROR_NOT_SUPPORTED.
+ */
+
+typedef struct {
+    ULONG  tag;          /* reparse tag */
+    ULONG  flags;        /* symbolic link flags, 0x1 = relative target */
+    BOOL   utf8;         /* strings are UTF-8 encoded */
+    size_t subst_off;
+    size_t subst_len;
+    size_t print_off;
+    size_t print_len;
+    size_t target_off;
+    size_t target_len;
+    size_t norm_off;
+    size_t norm_len;
+} LINK_TARGET_VIEW;
+
+#define LINK_VIEW_STRING(buffer, off)  ((const void *)((const char *)(buffer) + (off)))
+
+#ifdef _UNICODE
+#define getLinkTargetView getLinkTargetViewW
+#else
+#define getLinkTargetView getLinkTargetViewA
+#endif
+
+BOOL getLinkTargetViewA(const char *lpFileName, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView);
+#ifdef _WIN32
+BOOL getLinkTargetViewW(const wchar_t *lpFileName, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView);
+#endif
+
+
+
+#ifdef _WIN32
+
+/**
+ * NT-native functions.
+ *
+ * These take NT paths ("\??\C:\..." or "\Device\HarddiskVolume1\...")
+ * and call ntdll directly, skipping the DOS to NT path conversion that
+ * every Win32 file function does. Convert a path once with getNtPath()
+ * and reuse the result for any number of calls.
+ *
+ * ntIsSymlink(), ntGetLinkTarget(), ntGetLinkTargetView() and
+ * ntGetCanonicalPath() behave like isSymlink(), getLinkTarget(),
+ * getLinkTargetView() and getCanonicalPathEx().
+ *
+ * getNtPath() returns an allocated string that must be deallocated
+ * with free(). If ntdll is not available, ERROR_CALL_NOT_IMPLEMENTED
+ * is set.
+ */
+
+wchar_t *getNtPathW(const wchar_t *lpFileName);
+
+int ntIsSymlinkW(const wchar_t *lpNtPath, ULONG *pReparseTag);
+
+wchar_t *ntGetLinkTargetW(const wchar_t *lpNtPath, ULONG *pReparseTag);
+
+BOOL ntGetLinkTargetViewW(const wchar_t *lpNtPath, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView);
+
+wchar_t *ntGetCanonicalPathW(const wchar_t *lpNtPath, DWORD flags);
+
+#endif /* _WIN32 */
 
 
 
@@ -180,7 +423,583 @@ wchar_t *getLinkTargetW(const wchar_t *lpFileName, ULONG *pReparseTag);
 #endif
 
 int isSymlinkA(const char *lpFileName, ULONG *pReparseTag);
+#ifdef _WIN32
 int isSymlinkW(const wchar_t *lpFileName, ULONG *pReparseTag);
+#endif
+
+
+
+#ifdef _WIN32
+
+
+/**
+ * Variants of isSymlink(), getLinkTarget() and getCanonicalPathEx() for
+ * network volumes, where a single open can hang for tens of seconds.
+ * If the query is not done after dwMilliseconds (INFINITE = no limit),
+ * the synchronous I/O of the calling thread is cancelled and the query
+ * fails with ERROR_TIMEOUT.
+ *
+ * A volume ("C:", "\\server\share") that timed out is remembered:
+ * further queries on it fail with ERROR_TIMEOUT at once, for 2 seconds
+ * after the first timeout and up to a minute after repeated ones. Then
+ * a single query is let through to probe it. Any answer from the volume,
+ * even an error, ends this. flushVolumeHealth() forgets all volumes.
+ */
+
+#ifdef _UNICODE
+#define isSymlinkTimeout        isSymlinkTimeoutW
+#define getLinkTargetTimeout    getLinkTargetTimeoutW
+#define getCanonicalPathTimeout getCanonicalPathTimeoutW
+#else
+#define isSymlinkTimeout        isSymlinkTimeoutA
+#define getLinkTargetTimeout    getLinkTargetTimeoutA
+#define getCanonicalPathTimeout getCanonicalPathTimeoutA
+#endif
+
+int isSymlinkTimeoutA(const char *lpFileName, ULONG *pReparseTag, DWORD dwMilliseconds);
+int isSymlinkTimeoutW(const wchar_t *lpFileName, ULONG *pReparseTag, DWORD dwMilliseconds);
+
+char    *getLinkTargetTimeoutA(const char *lpFileName, ULONG *pReparseTag, DWORD dwMilliseconds);
+wchar_t *getLinkTargetTimeoutW(const wchar_t *lpFileName, ULONG *pReparseTag, DWORD dwMilliseconds);
+
+char    *getCanonicalPathTimeoutA(const char *lpFileName, DWORD flags, DWORD dwMilliseconds);
+wchar_t *getCanonicalPathTimeoutW(const wchar_t *lpFileName, DWORD flags, DWORD dwMilliseconds);
+
+void flushVolumeHealth(void);
+
+
+
+
+/**
+ * analyzeLinkGraph() collects every link below lpRootDir (without
+ * following any of them), reads their targets like getLinkTarget() does
+ * and checks the resulting graph for dangling links, cycles and long
+ * chains of links pointing to links.
+ *
+ * Every distinct path is stored only once and the existence of each
+ * distinct final target is checked only once. A target below another
+ * link of the tree is attributed to that link. Links outside of
+ * lpRootDir are not followed.
+ *
+ * If report is not NULL a line is written into it for each dangling,
+ * cyclic or unresolvable link and for each chain longer than depthLimit
+ * (0 = don't report chains). Paths are written UTF-8 encoded.
+ *
+ * pStats can be set NULL.
+ * Returns FALSE if lpRootDir could not be enumerated or on memory errors.
+ */
+
+typedef struct {
+    size_t links;        /* number of links found */
+    size_t targets;      /* number of distinct link targets */
+    size_t dangling;     /* links whose final target does not exist */
+    size_t cycles;       /* number of distinct cycles */
+    size_t in_cycle;     /* links that are part of or lead into a cycle */
+    size_t long_chains;  /* links with a chain longer than depthLimit */
+    size_t unresolved;   /* targets that cannot be mapped to a Windows path */
+    size_t max_depth;    /* longest chain of links outside of cycles */
+} LINK_GRAPH_STATS;
+
+#ifdef _UNICODE
+#define analyzeLinkGraph analyzeLinkGraphW
+#else
+#define analyzeLinkGraph analyzeLinkGraphA
+#endif
+
+BOOL analyzeLinkGraphA(const char *lpRootDir, unsigned int depthLimit,
+                       FILE *report, LINK_GRAPH_STATS *pStats);
+BOOL analyzeLinkGraphW(const wchar_t *lpRootDir, unsigned int depthLimit,
+                       FILE *report, LINK_GRAPH_STATS *pStats);
+
+
+
+
+/**
+ * mirrorTree() recreates the directories below lpSourceDir inside of
+ * lpTargetDir and fills them with symbolic links to the source's files
+ * (a "symlink farm", like `cp -rs`). lpSourceDir is enumerated only once
+ * and the links are then created on up to 'threads' threads
+ * (0 = number of processors). The type of each link is taken from the
+ * enumeration, so no link target is probed.
+ *
+ * MIRROR_LINK_DIRS   link the subdirectories of lpSourceDir as a whole
+ *                    instead of recreating them
+ * MIRROR_RELATIVE    use relative link targets if source and target are
+ *                    on the same drive, so both can be moved together
+ *
+ * Links and junctions inside of lpSourceDir are linked, not followed.
+ * Existing directories in lpTargetDir are reused; existing files are not
+ * replaced and count as failures. If lpTargetDir is inside of
+ * lpSourceDir it is left out.
+ *
+ * pStats can be set NULL.
+ * Returns FALSE if lpSourceDir could not be enumerated, on memory errors
+ * or if any directory or link could not be created. GetLastError() then
+ * returns the first error that occurred.
+ */
+
+#define MIRROR_LINK_DIRS  0x1
+#define MIRROR_RELATIVE   0x2
+
+typedef struct {
+    size_t dirs;    /* directories created */
+    size_t links;   /* links created */
+    size_t failed;  /* directories or links that could not be created */
+} MIRROR_STATS;
+
+#ifdef _UNICODE
+#define mirrorTree mirrorTreeW
+#else
+#define mirrorTree mirrorTreeA
+#endif
+
+BOOL mirrorTreeA(const char *lpSourceDir, const char *lpTargetDir,
+                 DWORD flags, unsigned int threads, MIRROR_STATS *pStats);
+BOOL mirrorTreeW(const wchar_t *lpSourceDir, const wchar_t *lpTargetDir,
+                 DWORD flags, unsigned int threads, MIRROR_STATS *pStats);
+
+
+
+
+/**
+ * dedupTree() finds files with identical content below lpRootDir and
+ * replaces the duplicates by hard links to a single copy.
+ *
+ * Files are grouped by size, then by a hash of their first 4 KiB and
+ * finally by a hash of their whole content, which is computed from
+ * memory-mapped views on up to 'threads' threads (0 = number of
+ * processors). Files that already are hard links of each other are
+ * recognized by their file ID and read only once. The content is
+ * compared byte by byte before a file is replaced.
+ *
+ * Each name is replaced in a single step by renaming a new hard link
+ * over it, so it never disappears. The copy that already has the most
+ * names is kept; if it reaches the limit of 1023 links, a new copy is
+ * used for the remaining duplicates.
+ *
+ * Links, junctions and empty files are skipped. Hard links can only be
+ * created on the same volume.
+ *
+ * DEDUP_DRY_RUN   only report what would be linked
+ *
+ * If report is not NULL a line is written into it for each (possible)
+ * link and for each file that could not be read or replaced. Paths are
+ * written UTF-8 encoded.
+ *
+ * pStats can be set NULL.
+ * Returns FALSE if lpRootDir could not be enumerated or on memory errors.
+ */
+
+#define DEDUP_DRY_RUN  0x1
+
+typedef struct {
+    size_t   files;        /* non-empty files found */
+    size_t   linked;       /* names replaced (or to be replaced) by links */
+    size_t   failed;       /* files that could not be read or replaced */
+    uint64_t bytes_saved;  /* size of the copies that were freed */
+} DEDUP_STATS;
+
+#ifdef _UNICODE
+#define dedupTree dedupTreeW
+#else
+#define dedupTree dedupTreeA
+#endif
+
+BOOL dedupTreeA(const char *lpRootDir, DWORD flags, unsigned int threads,
+                FILE *report, DEDUP_STATS *pStats);
+BOOL dedupTreeW(const wchar_t *lpRootDir, DWORD flags, unsigned int threads,
+                FILE *report, DEDUP_STATS *pStats);
+
+
+
+
+/**
+ * getHardLinkNames() calls func() with the full path of every name of
+ * lpFileName's file, including lpFileName itself, without searching the
+ * volume. func() must return TRUE to continue or FALSE to stop.
+ * Returns FALSE on error.
+ *
+ * getHardLinkNamesBatch() collects the names of 'count' files on up to
+ * 'threads' threads (0 = number of processors). The names of file i are
+ * names[first[i]] to names[first[i+1]-1]. Each distinct name is stored
+ * only once, so names of siblings in the batch compare equal by pointer.
+ * error[i] is 0 or the error that occurred for file i.
+ * The result must be released with freeHardLinkNames().
+ * Returns NULL on memory errors.
+ */
+
+typedef BOOL (*HARD_LINK_FUNC)(void *ctx, const wchar_t *name);
+
+typedef struct {
+    size_t                count;  /* number of files */
+    const size_t         *first;  /* count + 1 indices into 'names' */
+    const wchar_t *const *names;
+    const DWORD          *error;
+} HARD_LINK_NAMES;
+
+#ifdef _UNICODE
+#define getHardLinkNames      getHardLinkNamesW
+#define getHardLinkNamesBatch getHardLinkNamesBatchW
+#else
+#define getHardLinkNames      getHardLinkNamesA
+#define getHardLinkNamesBatch getHardLinkNamesBatchA
+#endif
+
+BOOL getHardLinkNamesA(const char *lpFileName, HARD_LINK_FUNC func, void *ctx);
+BOOL getHardLinkNamesW(const wchar_t *lpFileName, HARD_LINK_FUNC func, void *ctx);
+
+HARD_LINK_NAMES *getHardLinkNamesBatchA(const char * const *paths, size_t count,
+                                        unsigned int threads);
+HARD_LINK_NAMES *getHardLinkNamesBatchW(const wchar_t * const *paths, size_t count,
+                                        unsigned int threads);
+
+void freeHardLinkNames(HARD_LINK_NAMES *names);
+
+
+
+
+/**
+ * diskUsage() sums up the file sizes below lpRootDir like `du`.
+ * Links and junctions (name surrogates) are not followed; other reparse
+ * points such as compressed or cloud files are counted. Every file is
+ * counted only once even if it has several names (hard links) in the tree; it is
+ * attributed to the directory nearest to lpRootDir that contains one of
+ * them. Files are identified by volume serial number and file ID, which
+ * are read together with the sizes when listing a directory.
+ *
+ * The directories of each level are listed on up to 'threads' threads
+ * (0 = number of processors).
+ *
+ * dirs[0] is lpRootDir; a parent always comes before its subdirectories.
+ * The numbers of each directory include all of its subdirectories.
+ * The result must be released with freeDiskUsage().
+ * Returns NULL if lpRootDir could not be listed or on memory errors.
+ */
+
+#define DISK_USAGE_NONE  ((size_t)-1)
+
+typedef struct {
+    const wchar_t *path;
+    size_t         parent;     /* index of the parent, DISK_USAGE_NONE for the root */
+    uint64_t       files;      /* distinct files */
+    uint64_t       apparent;   /* sum of the file sizes */
+    uint64_t       allocated;  /* sum of the space allocated on disk */
+} DISK_USAGE_DIR;
+
+typedef struct {
+    size_t                count;      /* number of directories */
+    const DISK_USAGE_DIR *dirs;
+    uint64_t              hardlinks;  /* names of files that were already counted */
+    size_t                failed;     /* directories that could not be listed */
+} DISK_USAGE;
+
+#ifdef _UNICODE
+#define diskUsage diskUsageW
+#else
+#define diskUsage diskUsageA
+#endif
+
+DISK_USAGE *diskUsageA(const char *lpRootDir, unsigned int threads);
+DISK_USAGE *diskUsageW(const wchar_t *lpRootDir, unsigned int threads);
+
+void freeDiskUsage(DISK_USAGE *du);
+
+
+
+
+/**
+ * retargetLinks() rewrites every symbolic link and junction below
+ * lpRootDir whose target lies below lpOldPrefix so that it points below
+ * lpNewPrefix instead, i.e. after a tools drive was moved from "T:\tools"
+ * to "\\server\tools". retargetLinkList() does the same for the given
+ * paths.
+ *
+ * The reparse data of each link is changed in memory and written back
+ * through the same handle (FSCTL_SET_REPARSE_POINT), so the links keep
+ * their file IDs, times and security. The links are processed on up to
+ * 'threads' threads (0 = number of processors).
+ *
+ * The prefixes must be absolute ("X:\..." or "\\server\share...") and
+ * match whole path components; ASCII characters are compared
+ * case-insensitively. Relative symlinks are never changed. Junctions
+ * cannot point to remote paths: with a UNC lpNewPrefix, matching
+ * junctions are left alone and counted as errors (ERROR_NOT_SUPPORTED).
+ * Rewriting symbolic links (but not junctions) requires the privilege to
+ * create them, even in developer mode.
+ *
+ * RETARGET_DRY_RUN   only report the links that would be changed
+ *
+ * If report is not NULL a line is written into it for each (matching)
+ * link and for each error. Paths are written UTF-8 encoded.
+ *
+ * pStats can be set NULL.
+ * Returns FALSE if lpRootDir could not be enumerated, on invalid prefixes
+ * or on memory errors.
+ */
+
+#define RETARGET_DRY_RUN  0x1
+
+typedef struct {
+    size_t links;      /* symbolic links and junctions examined */
+    size_t matched;    /* links pointing below the old prefix */
+    size_t rewritten;  /* links that were changed */
+    size_t failed;     /* links that could not be read or changed */
+} RETARGET_STATS;
+
+#ifdef _UNICODE
+#define retargetLinks    retargetLinksW
+#define retargetLinkList retargetLinkListW
+#else
+#define retargetLinks    retargetLinksA
+#define retargetLinkList retargetLinkListA
+#endif
+
+BOOL retargetLinksA(const char *lpRootDir, const char *lpOldPrefix,
+                    const char *lpNewPrefix, DWORD flags, unsigned int threads,
+                    FILE *report, RETARGET_STATS *pStats);
+BOOL retargetLinksW(const wchar_t *lpRootDir, const wchar_t *lpOldPrefix,
+                    const wchar_t *lpNewPrefix, DWORD flags, unsigned int threads,
+                    FILE *report, RETARGET_STATS *pStats);
+
+BOOL retargetLinkListA(const char * const *paths, size_t count,
+                       const char *lpOldPrefix, const char *lpNewPrefix,
+                       DWORD flags, unsigned int threads,
+                       FILE *report, RETARGET_STATS *pStats);
+BOOL retargetLinkListW(const wchar_t * const *paths, size_t count,
+                       const wchar_t *lpOldPrefix, const wchar_t *lpNewPrefix,
+                       DWORD flags, unsigned int threads,
+                       FILE *report, RETARGET_STATS *pStats);
+
+
+
+
+/**
+ * Persistent link index.
+ *
+ * linkIndexBuild() enumerates lpRootDir once and writes every link found
+ * (path, file ID, reparse tag, target, last write time) into lpIndexFile.
+ * The entries are sorted and front-coded, so the file can be memory-mapped
+ * read-only by linkIndexOpen() and searched in O(log n) without parsing it.
+ * The root and all paths passed to the other functions are made absolute
+ * first (see GetFullPathNameW()), so they may be spelled differently.
+ *
+ * linkIndexUpdate() re-reads the given paths from the file system and
+ * writes a new index in which these entries are added, replaced or removed.
+ * The index file is replaced atomically; this fails if another process
+ * still has the old index mapped.
+ *
+ * linkIndexLookup() returns the indexed data of a path. The target in
+ * 'pEntry' points into the mapped file, is not NUL-terminated and stays
+ * valid until linkIndexClose() is called; it is a wide string in both
+ * variants.
+ *
+ * linkIndexIsSymlink() and linkIndexGetLinkTarget() behave like isSymlink()
+ * and getLinkTarget(), but answer from the index if possible. With
+ * LINK_INDEX_VERIFY the last write time of each path is compared with the
+ * index first (a single GetFileAttributesExW() call); stale entries and
+ * paths outside of the indexed tree fall back to the live functions.
+ * Without it, paths inside of the indexed tree are answered from the
+ * index alone.
+ */
+
+#define LINK_INDEX_VERIFY  0x1
+
+typedef struct LINK_INDEX LINK_INDEX;
+
+typedef struct {
+    ULONG          tag;         /* reparse tag */
+    int64_t        mtime;       /* last write time as FILETIME value */
+    FILE_ID_128    file_id;
+    const wchar_t *target;      /* not NUL-terminated! */
+    size_t         target_len;  /* length of 'target' in characters */
+} LINK_INDEX_ENTRY;
+
+#ifdef _UNICODE
+#define linkIndexBuild          linkIndexBuildW
+#define linkIndexUpdate         linkIndexUpdateW
+#define linkIndexOpen           linkIndexOpenW
+#define linkIndexLookup         linkIndexLookupW
+#define linkIndexIsSymlink      linkIndexIsSymlinkW
+#define linkIndexGetLinkTarget  linkIndexGetLinkTargetW
+#else
+#define linkIndexBuild          linkIndexBuildA
+#define linkIndexUpdate         linkIndexUpdateA
+#define linkIndexOpen           linkIndexOpenA
+#define linkIndexLookup         linkIndexLookupA
+#define linkIndexIsSymlink      linkIndexIsSymlinkA
+#define linkIndexGetLinkTarget  linkIndexGetLinkTargetA
+#endif
+
+BOOL linkIndexBuildA(const char *lpRootDir, const char *lpIndexFile);
+BOOL linkIndexBuildW(const wchar_t *lpRootDir, const wchar_t *lpIndexFile);
+
+BOOL linkIndexUpdateA(const char *lpIndexFile, const char * const *paths, size_t count);
+BOOL linkIndexUpdateW(const wchar_t *lpIndexFile, const wchar_t * const *paths, size_t count);
+
+LINK_INDEX *linkIndexOpenA(const char *lpIndexFile);
+LINK_INDEX *linkIndexOpenW(const wchar_t *lpIndexFile);
+
+void linkIndexClose(LINK_INDEX *index);
+
+BOOL linkIndexLookupA(const LINK_INDEX *index, const char *lpFileName, LINK_INDEX_ENTRY *pEntry);
+BOOL linkIndexLookupW(const LINK_INDEX *index, const wchar_t *lpFileName, LINK_INDEX_ENTRY *pEntry);
+
+int linkIndexIsSymlinkA(const LINK_INDEX *index, const char *lpFileName,
+                        ULONG *pReparseTag, DWORD flags);
+int linkIndexIsSymlinkW(const LINK_INDEX *index, const wchar_t *lpFileName,
+                        ULONG *pReparseTag, DWORD flags);
+
+char *linkIndexGetLinkTargetA(const LINK_INDEX *index, const char *lpFileName,
+                              ULONG *pReparseTag, DWORD flags);
+wchar_t *linkIndexGetLinkTargetW(const LINK_INDEX *index, const wchar_t *lpFileName,
+                                 ULONG *pReparseTag, DWORD flags);
+
+
+
+
+/**
+ * readLinkChanges() reads the USN change journal of lpVolume ("C:",
+ * "C:\" or "\\.\C:") starting at *pUsn (0 = oldest entry) and calls func()
+ * for every link that was added, changed or removed. The decoded target
+ * of added and changed links is included. A renamed or moved link is
+ * reported as removed under its old name and added under the new one.
+ * The journal doesn't record the reparse tag of a deleted file, so the
+ * removal of another kind of reparse point (WOF, cloud files) is only
+ * left out if its tag was seen in the same call or the file is a cloud
+ * placeholder by its attributes. Afterwards *pUsn is set to
+ * the position to continue from, so a rescan only costs as much as
+ * what has changed since the last call.
+ *
+ * If 'record' is not NULL, the raw journal data is written into it so
+ * the run can be replayed later (i.e. in tests on other platforms).
+ *
+ * func() must return TRUE to continue or FALSE to stop.
+ * Reading the journal requires administrator rights. If older entries
+ * were already purged from the journal, FALSE is returned with
+ * ERROR_JOURNAL_ENTRY_DELETED and a full rescan is needed.
+ */
+
+#define LINK_CHANGE_ADDED    1
+#define LINK_CHANGE_CHANGED  2
+#define LINK_CHANGE_REMOVED  3
+
+typedef struct {
+    int            type;        /* LINK_CHANGE_* */
+    ULONGLONG      usn;
+    FILE_ID_128    file_id;
+    FILE_ID_128    parent_id;   /* file ID of the parent directory */
+    DWORD          reason;      /* USN_REASON_* flags */
+    const wchar_t *name;        /* file name, not NUL-terminated! */
+    size_t         name_len;
+    ULONG          tag;         /* 0 for removed links */
+    const wchar_t *target;      /* like getLinkTarget(), NULL if unknown */
+} LINK_CHANGE;
+
+typedef BOOL (*LINK_CHANGE_FUNC)(void *ctx, const LINK_CHANGE *change);
+
+#ifdef _UNICODE
+#define readLinkChanges readLinkChangesW
+#else
+#define readLinkChanges readLinkChangesA
+#endif
+
+BOOL readLinkChangesA(const char *lpVolume, ULONGLONG *pUsn,
+                      LINK_CHANGE_FUNC func, void *ctx, FILE *record);
+BOOL readLinkChangesW(const wchar_t *lpVolume, ULONGLONG *pUsn,
+                      LINK_CHANGE_FUNC func, void *ctx, FILE *record);
+
+
+
+
+/**
+ * Negative lookup filter for mass "is this a link?" checks.
+ *
+ * linkFilterBuild() enumerates lpRootDir once and keeps an in-memory
+ * summary of it: a Bloom filter of every reparse point found and, for
+ * each directory, its last write time and whether it contains any
+ * reparse points at all.
+ *
+ * linkFilterIsSymlink() and linkFilterLstat64() behave like isSymlink()
+ * and _lstat64(). Paths inside of the tree that are known not to be
+ * reparse points are answered without asking the file system:
+ * linkFilterIsSymlink() returns FALSE without any system call (the path
+ * is NOT checked for existence!) and linkFilterLstat64() skips the link
+ * check and calls _wstat64() directly. Everything else falls back to the live functions.
+ *
+ * A directory's last write time changes whenever an entry is created,
+ * deleted or renamed in it. linkFilterRefresh() compares it for every
+ * directory and enumerates the changed ones again; call it whenever the
+ * tree may have been modified. A directory turned into a junction in
+ * place does not change the time of its parent and is not detected.
+ *
+ * Queries may run concurrently, but not during linkFilterRefresh().
+ */
+
+typedef struct LINK_FILTER LINK_FILTER;
+
+#ifdef _UNICODE
+#define linkFilterBuild      linkFilterBuildW
+#define linkFilterIsSymlink  linkFilterIsSymlinkW
+#define linkFilterLstat64    linkFilterLstat64W
+#else
+#define linkFilterBuild      linkFilterBuildA
+#define linkFilterIsSymlink  linkFilterIsSymlinkA
+#define linkFilterLstat64    linkFilterLstat64A
+#endif
+
+LINK_FILTER *linkFilterBuildA(const char *lpRootDir);
+LINK_FILTER *linkFilterBuildW(const wchar_t *lpRootDir);
+
+BOOL linkFilterRefresh(LINK_FILTER *filter);
+
+void linkFilterFree(LINK_FILTER *filter);
+
+int linkFilterIsSymlinkA(const LINK_FILTER *filter, const char *lpFileName, ULONG *pReparseTag);
+int linkFilterIsSymlinkW(const LINK_FILTER *filter, const wchar_t *lpFileName, ULONG *pReparseTag);
+
+int linkFilterLstat64A(const LINK_FILTER *filter, const char *path, struct _stat64 *statbuf);
+int linkFilterLstat64W(const LINK_FILTER *filter, const wchar_t *path, struct _stat64 *statbuf);
+
+
+
+/**
+ * Call tracing for offline performance analysis.
+ *
+ * While a trace is active, the system calls that isSymlink(),
+ * getLinkTarget(), getLinkTargetView(), getCanonicalPath(), their nt*()
+ * and *at() counterparts, _lstat64() and lstatx() make are written into
+ * lpFileName: CreateFileW, NtCreateFile, GetFileAttributesW,
+ * NtQueryAttributesFile, GetFileInformationByHandleEx and
+ * FSCTL_GET_REPARSE_POINT (with their results) and
+ * GetFinalPathNameByHandleW (with its result), each with the path,
+ * the error code, the thread and the time it took. Calls of isSymlink(),
+ * getLinkTarget(), getLinkTargetView(), getCanonicalPath(), their nt*()
+ * counterparts and _lstat64() are marked with their arguments.
+ *
+ * The format is described in source/trace.h; trace_replay() reads it
+ * on any platform and reruns the reparse data decoding, so call counts
+ * and decoding cost of a customer volume can be measured without it.
+ * tools/tracereplay feeds the marked calls back into the library, with
+ * the recorded results standing in for the file system, and reports
+ * the calls whose system calls differ from the recorded ones.
+ * Without an active trace the overhead is one flag check per call.
+ *
+ * startCallTrace() fails with ERROR_ALREADY_EXISTS if a trace is
+ * already running. stopCallTrace() closes the file.
+ */
+
+#ifdef _UNICODE
+#define startCallTrace startCallTraceW
+#else
+#define startCallTrace startCallTraceA
+#endif
+
+BOOL startCallTraceA(const char *lpFileName);
+BOOL startCallTraceW(const wchar_t *lpFileName);
+
+void stopCallTrace(void);
+
+#endif /* _WIN32 */
 
 
 
@@ -193,6 +1012,8 @@ int isSymlinkW(const wchar_t *lpFileName, ULONG *pReparseTag);
 
 
 
+#ifdef _WIN32
+
 
 /**
  * Creates a symbolic link named 'linkpath' pointing to the target named 'target'.
@@ -212,6 +1033,35 @@ int _wsymlink(const wchar_t *target, const wchar_t *linkpath);
 
 
 
+
+/**
+ * Replaces the link 'linkpath' by a symbolic link to 'target' in a single
+ * step, so other processes see either the old or the new link but never
+ * a missing file. If 'linkpath' does not exist, it is created like with
+ * symlink().
+ *
+ * A new link is created next to the old one and renamed over it with
+ * POSIX semantics where available. Directories cannot be replaced by
+ * renaming, so the target of directory links and junctions is rewritten
+ * in place instead, which requires the right to create symbolic links
+ * (not needed for junctions). Junctions stay junctions; their target is
+ * resolved relative to the link's directory.
+ *
+ * On success, zero is returned.
+ * On error, -1 is returned, and errno is set to indicate the error.
+ */
+
+#ifdef _UNICODE
+#define _tsymlink_replace _wsymlink_replace
+#else
+#define _tsymlink_replace symlink_replace
+#endif
+
+int   symlink_replace(const char *target, const char *linkpath);
+int _wsymlink_replace(const wchar_t *target, const wchar_t *linkpath);
+
+
+
 /**
  * Creates a new link (also known as a hard link) named 'newpath' to an existing
  * file named 'oldpath'.
@@ -253,6 +1103,8 @@ __DEPRECATED /* use readlink_s instead! */ ssize_t readlink(
 __DEPRECATED /* use _wreadlink_s instead! */ ssize_t _wreadlink(
     const wchar_t *path, wchar_t *buf, size_t numwcs);
 
+#endif /* _WIN32 */
+
 
 
 /**
@@ -273,10 +1125,14 @@ __DEPRECATED /* use _wreadlink_s instead! */ ssize_t _wreadlink(
 #endif
 
 char      *readlink_s(const char *path, char *buf, size_t bufsize);
+#ifdef _WIN32
 wchar_t *_wreadlink_s(const wchar_t *path, wchar_t *buf, size_t numwcs);
+#endif
 
 
 
+#ifdef _WIN32
+
 /**
  * Get the canonicalized absolute pathname of 'path' and save it in the buffer
  * pointed to by 'resolved_path' up to a maximum of PATH_MAX bytes.
@@ -302,6 +1158,8 @@ __DEPRECATED /* use realpath_s instead! */ char *realpath(
 __DEPRECATED /* use _wrealpath_s instead! */ wchar_t *_wrealpath(
     const wchar_t *path, wchar_t *resolved_path);
 
+#endif /* _WIN32 */
+
 
 
 /**
@@ -324,10 +1182,61 @@ __DEPRECATED /* use _wrealpath_s instead! */ wchar_t *_wrealpath(
 #endif
 
 char      *realpath_s(const char *path, char *buf, size_t bufsize);
+#ifdef _WIN32
 wchar_t *_wrealpath_s(const wchar_t *path, wchar_t *buf, size_t numwcs);
+#endif
 
 
 
+/**
+ * Length-delimited variants for paths held as slices of larger buffers:
+ * 'path' points to 'len' characters that need not be NUL-terminated.
+ * They behave like the functions they are named after. A slice that
+ * contains a NUL character is invalid.
+ *
+ * On Windows the NT name of a fully qualified path ("C:\...",
+ * "\\server\share\...", "\\?\..." or "\??\...") is built straight from
+ * the slice and opened through ntdll, like the nt*() functions do. Other
+ * paths, and paths the Win32 rules would change (i.e. with "." or ".."
+ * components or trailing dots), are copied and take the usual route.
+ * Outside of Windows the slice is copied to the stack.
+ */
+
+#ifdef _UNICODE
+#define isSymlinkN           isSymlinkNW
+#define getLinkTargetN       getLinkTargetNW
+#define getCanonicalPathN    getCanonicalPathNW
+#define getCanonicalPathExN  getCanonicalPathExNW
+#define _treadlinkn_s        _wreadlinkn_s
+#define _trealpathn_s        _wrealpathn_s
+#else
+#define isSymlinkN           isSymlinkNA
+#define getLinkTargetN       getLinkTargetNA
+#define getCanonicalPathN    getCanonicalPathNA
+#define getCanonicalPathExN  getCanonicalPathExNA
+#define _treadlinkn_s        readlinkn_s
+#define _trealpathn_s        realpathn_s
+#endif
+
+int      isSymlinkNA(const char *lpFileName, size_t len, ULONG *pReparseTag);
+char    *getLinkTargetNA(const char *lpFileName, size_t len, ULONG *pReparseTag);
+char    *getCanonicalPathNA(const char *lpFileName, size_t len);
+char    *readlinkn_s(const char *path, size_t len, char *buf, size_t bufsize);
+char    *realpathn_s(const char *path, size_t len, char *buf, size_t bufsize);
+#ifdef _WIN32
+int      isSymlinkNW(const wchar_t *lpFileName, size_t len, ULONG *pReparseTag);
+wchar_t *getLinkTargetNW(const wchar_t *lpFileName, size_t len, ULONG *pReparseTag);
+wchar_t *getCanonicalPathNW(const wchar_t *lpFileName, size_t len);
+char    *getCanonicalPathExNA(const char *lpFileName, size_t len, DWORD flags);
+wchar_t *getCanonicalPathExNW(const wchar_t *lpFileName, size_t len, DWORD flags);
+wchar_t *_wreadlinkn_s(const wchar_t *path, size_t len, wchar_t *buf, size_t numwcs);
+wchar_t *_wrealpathn_s(const wchar_t *path, size_t len, wchar_t *buf, size_t numwcs);
+#endif
+
+
+
+#ifdef _WIN32
+
 /**
  * Get the canonicalized absolute pathname of 'path'. This string must later
  * be deallocated with 'free()'.
@@ -352,10 +1261,79 @@ inline wchar_t *_wcanonicalize_file_name(const wchar_t *path) {
 
 
 
+/**
+ * The *at() functions work like their counterparts above, except that a
+ * relative 'path' is interpreted relative to the open directory handle
+ * 'dirfd' instead of the current working directory. The file is opened
+ * through the NT RootDirectory mechanism, so only the components of
+ * 'path' are walked and not the whole absolute path again.
+ *
+ * If 'dirfd' is AT_FDCWD or 'path' is absolute, the file is opened
+ * relative to a cached handle of its parent directory. Up to 16 recently
+ * used directories are kept open. A cached handle is checked before each
+ * use and reopened if its directory was renamed, deleted or replaced.
+ * Call flushDirectoryHandleCache() to close them, i.e. before removing
+ * a parent of a cached directory.
+ *
+ * fstatat64() follows a final symbolic link unless AT_SYMLINK_NOFOLLOW is
+ * set in 'flags'. linkat() links to the target of a symbolic link
+ * 'oldpath' if AT_SYMLINK_FOLLOW is set.
+ * realpathat() behaves like realpath_s().
+ *
+ * On error, -1 (or NULL) is returned and errno is set to indicate the error.
+ */
+
+#ifndef AT_FDCWD
+#define AT_FDCWD             ((HANDLE)NULL)
+#endif
+#ifndef AT_SYMLINK_NOFOLLOW
+#define AT_SYMLINK_NOFOLLOW  0x100
+#endif
+#ifndef AT_SYMLINK_FOLLOW
+#define AT_SYMLINK_FOLLOW    0x400
+#endif
+
+#ifdef _UNICODE
+#define _tfstatat64   _wfstatat64
+#define _treadlinkat  _wreadlinkat
+#define _tsymlinkat   _wsymlinkat
+#define _tlinkat      _wlinkat
+#define _trealpathat  _wrealpathat
+#else
+#define _tfstatat64   fstatat64
+#define _treadlinkat  readlinkat
+#define _tsymlinkat   symlinkat
+#define _tlinkat      linkat
+#define _trealpathat  realpathat
+#endif
+
+int  fstatat64(HANDLE dirfd, const char *path, struct _stat64 *statbuf, int flags);
+int _wfstatat64(HANDLE dirfd, const wchar_t *path, struct _stat64 *statbuf, int flags);
+
+ssize_t  readlinkat(HANDLE dirfd, const char *path, char *buf, size_t bufsize);
+ssize_t _wreadlinkat(HANDLE dirfd, const wchar_t *path, wchar_t *buf, size_t numwcs);
+
+int  symlinkat(const char *target, HANDLE newdirfd, const char *linkpath);
+int _wsymlinkat(const wchar_t *target, HANDLE newdirfd, const wchar_t *linkpath);
+
+int  linkat(HANDLE olddirfd, const char *oldpath, HANDLE newdirfd, const char *newpath, int flags);
+int _wlinkat(HANDLE olddirfd, const wchar_t *oldpath, HANDLE newdirfd, const wchar_t *newpath, int flags);
+
+char      *realpathat(HANDLE dirfd, const char *path, char *buf, size_t bufsize);
+wchar_t *_wrealpathat(HANDLE dirfd, const wchar_t *path, wchar_t *buf, size_t numwcs);
+
+void flushDirectoryHandleCache(void);
+
+
+
 /**
  * _lstat is identical to _stat, except that if path is a symbolic link it
  * will provide information about the link itself instead of the target
  * that the link points to.
+ *
+ * st_dev is set to the volume serial number and st_ino to the file ID
+ * folded to 16 bits (the size of _ino_t). Use getFileIdentity() or
+ * equivalent() to tell files apart reliably.
  */
 
 #ifdef _UNICODE
@@ -408,6 +1386,304 @@ inline int lwstat64(const wchar_t *path, struct stat64 *buffer) {
 }
 
 
+
+
+/**
+ * readlink_s(), realpath_s() and _lstat64() with a time limit in
+ * milliseconds, see isSymlinkTimeout(). When the limit is reached or
+ * the volume is known to hang, errno is set to ETIMEDOUT.
+ */
+
+#ifdef _UNICODE
+#define _treadlink_timeout _wreadlink_timeout
+#define _trealpath_timeout _wrealpath_timeout
+#define _tlstat64_timeout  _lwstat64_timeout
+#else
+#define _treadlink_timeout readlink_timeout
+#define _trealpath_timeout realpath_timeout
+#define _tlstat64_timeout  _lstat64_timeout
+#endif
+
+char      *readlink_timeout(const char *path, char *buf, size_t bufsize, DWORD ms);
+wchar_t *_wreadlink_timeout(const wchar_t *path, wchar_t *buf, size_t numwcs, DWORD ms);
+
+char      *realpath_timeout(const char *path, char *buf, size_t bufsize, DWORD ms);
+wchar_t *_wrealpath_timeout(const wchar_t *path, wchar_t *buf, size_t numwcs, DWORD ms);
+
+int _lstat64_timeout(const char *path, struct _stat64 *buffer, DWORD ms);
+int _lwstat64_timeout(const wchar_t *path, struct _stat64 *buffer, DWORD ms);
+
+
+
+
+/**
+ * getFileIdentity() returns the volume serial number and the 128 bit
+ * file ID of a file with a single open and without requiring any access
+ * rights to it. Two paths refer to the same file (i.e. hard links) if
+ * both values are equal. If 'follow' is FALSE, the identity of a link
+ * itself is returned. Returns FALSE on error.
+ *
+ * equivalent() returns 1 if both paths (after following links) refer to
+ * the same file, 0 if they don't. Neither path is canonicalized.
+ * On error, -1 is returned, and errno is set to indicate the error.
+ */
+
+typedef struct {
+    uint64_t    volume;   /* volume serial number */
+    FILE_ID_128 file_id;
+} FILE_IDENTITY;
+
+#ifdef _UNICODE
+#define getFileIdentity getFileIdentityW
+#define _tequivalent    _wequivalent
+#else
+#define getFileIdentity getFileIdentityA
+#define _tequivalent    equivalent
+#endif
+
+BOOL getFileIdentityA(const char *lpFileName, BOOL follow, FILE_IDENTITY *pIdentity);
+BOOL getFileIdentityW(const wchar_t *lpFileName, BOOL follow, FILE_IDENTITY *pIdentity);
+
+int equivalent(const char *path1, const char *path2);
+int _wequivalent(const wchar_t *path1, const wchar_t *path2);
+
+
+
+/**
+ * lstatx() is a statx(2) like variant of _lstat64 that only retrieves
+ * the fields requested in 'mask'. Depending on the mask the cheapest query
+ * is used, i.e. type, size and most timestamps are read without opening
+ * the file at all. Timestamps are returned with 100 ns precision.
+ *
+ * Symbolic links are reported as _S_IFLNK in 'stx_mode'.
+ * 'stx_mask' is set to the fields that were actually filled in, which
+ * may include more than the requested ones.
+ *
+ * On success, zero is returned.
+ * On error, -1 is returned, and errno is set to indicate the error.
+ */
+
+#ifndef _S_IFLNK
+#define _S_IFLNK  0xA000
+#endif
+#ifndef S_IFLNK
+#define S_IFLNK   _S_IFLNK
+#endif
+
+#define LSTATX_TYPE    0x0001U  /* stx_mode */
+#define LSTATX_SIZE    0x0002U  /* stx_size */
+#define LSTATX_ATIME   0x0004U  /* stx_atime */
+#define LSTATX_MTIME   0x0008U  /* stx_mtime */
+#define LSTATX_BTIME   0x0010U  /* stx_btime (creation time) */
+#define LSTATX_CTIME   0x0020U  /* stx_ctime (last status change) */
+#define LSTATX_INO     0x0040U  /* stx_dev and stx_ino */
+#define LSTATX_NLINK   0x0080U  /* stx_nlink */
+#define LSTATX_TAG     0x0100U  /* stx_reparse_tag */
+#define LSTATX_ALL     0x01FFU
+
+struct lstatx_timestamp {
+    int64_t  tv_sec;   /* seconds since the Unix epoch */
+    uint32_t tv_nsec;  /* nanoseconds, always a multiple of 100 */
+};
+
+struct lstatx {
+    unsigned int stx_mask;        /* fields that were filled in */
+    DWORD        stx_attributes;  /* FILE_ATTRIBUTE_* flags (always filled in) */
+    ULONG        stx_reparse_tag; /* 0 if not a reparse point */
+    uint16_t     stx_mode;
+    uint32_t     stx_nlink;
+    uint64_t     stx_size;
+    uint64_t     stx_dev;         /* volume serial number */
+    FILE_ID_128  stx_ino;         /* file ID */
+    struct lstatx_timestamp stx_atime;
+    struct lstatx_timestamp stx_mtime;
+    struct lstatx_timestamp stx_btime;
+    struct lstatx_timestamp stx_ctime;
+};
+
+#ifdef _UNICODE
+#define ltstatx lwstatx
+#else
+#define ltstatx lstatx
+#endif
+
+int lstatx(const char *path, unsigned int mask, struct lstatx *stx);
+int lwstatx(const wchar_t *path, unsigned int mask, struct lstatx *stx);
+
+
+
+/**
+ * Bulk variant of lstatx() for large scans that writes the results into
+ * caller provided column arrays instead of one struct per path.
+ * Every non-NULL array in 'columns' must hold 'count' elements and
+ * selects the corresponding field; only the fields needed for the selected
+ * columns are queried. The paths are processed on up to 'threads' threads
+ * (0 = number of processors).
+ *
+ * 'mtime' is given in 100 ns intervals since the Unix epoch.
+ * 'error' receives 0 or the errno value of each entry. The other columns
+ * of a failed entry are set to 0.
+ *
+ * On success the number of failed entries is returned.
+ * On error, -1 is returned, and errno is set to indicate the error.
+ */
+
+typedef struct {
+    uint16_t    *mode;     /* stx_mode */
+    uint64_t    *size;     /* stx_size */
+    int64_t     *mtime;    /* stx_mtime */
+    ULONG       *tag;      /* stx_reparse_tag */
+    FILE_ID_128 *file_id;  /* stx_ino */
+    int         *error;    /* errno value, 0 on success */
+} LSTAT_COLUMNS;
+
+#ifdef _UNICODE
+#define ltstat_columns lwstat_columns
+#else
+#define ltstat_columns lstat_columns
+#endif
+
+ssize_t lstat_columns(const char * const *paths, size_t count,
+                      const LSTAT_COLUMNS *columns, unsigned int threads);
+ssize_t lwstat_columns(const wchar_t * const *paths, size_t count,
+                       const LSTAT_COLUMNS *columns, unsigned int threads);
+
+#endif /* _WIN32 */
+
+
+/**
+ * The resolver service answers isSymlink(), getLinkTarget(),
+ * getCanonicalPath() and lstat queries for other processes over a named
+ * pipe (Windows) or a Unix domain socket, so that many short-lived
+ * processes share one warm cache instead of each resolving the same
+ * paths again.
+ *
+ * resolverStart() runs the service inside the calling process until
+ * resolverStop() is called. 'name' is the pipe name or the socket path;
+ * NULL selects "\\.\pipe\w32-symlink-resolver-<user SID>", or
+ * "w32-symlink-resolver.sock" in $XDG_RUNTIME_DIR and otherwise
+ * "/tmp/w32-symlink-resolver-<uid>.sock". The pipe or socket is only
+ * accessible to the user running the service. Queries are answered by
+ * 'backend' (NULL = this library) on 'threads' worker threads (0 = number
+ * of processors); results are cached for 'cacheTtlMs' milliseconds (0 = no
+ * cache), resolverFlush() drops the cache. Requests of clients that
+ * connected with RESOLVER_BULK are queued behind interactive ones.
+ * On error, NULL is returned and GetLastError() or errno is set; it fails
+ * if a service is already running on 'name'.
+ *
+ * resolverConnect() connects the calling process to the service. The
+ * resolver*() functions then behave like the functions they are named
+ * after, except that the query runs in the service. Without a connection,
+ * or once it breaks, they run locally, so they can always be used in
+ * their place. The connection is refused if the service runs as another
+ * user. Relative paths are made absolute by the client first.
+ * Defining W32_SYMLINK_USE_RESOLVER before including this header maps
+ * isSymlink(), getLinkTarget(), getCanonicalPath(), readlink_s() and
+ * realpath_s() onto them.
+ *
+ * resolverQuery() sends a batch of queries at once and collects the
+ * responses as they arrive, which avoids a round trip per path. Paths are
+ * UTF-8. Every query receives its result, error code (GetLastError() or
+ * errno), reparse tag and, for RESOLVER_READLINK and RESOLVER_REALPATH, an
+ * allocated UTF-8 'value' that must be deallocated with free(). FALSE is
+ * only returned if memory runs out.
+ */
+
+#define RESOLVER_BULK       0x1  /* resolverConnect(): background client */
+
+#define RESOLVER_ISSYMLINK  1
+#define RESOLVER_READLINK   2
+#define RESOLVER_REALPATH   3
+#define RESOLVER_LSTAT      4
+
+typedef struct {
+    uint64_t size;
+    int64_t  mtime;  /* seconds since the Unix epoch */
+    uint64_t ino;
+    uint64_t dev;
+    uint32_t mode;
+    uint32_t nlink;
+} RESOLVER_STAT;
+
+/* Paths and returned strings are UTF-8; errors are reported like the
+ * functions of this library do. */
+typedef struct {
+    int   (*isSymlink)(void *ctx, const char *path, ULONG *pReparseTag);
+    char *(*getLinkTarget)(void *ctx, const char *path, ULONG *pReparseTag);
+    char *(*getCanonicalPath)(void *ctx, const char *path);
+    int   (*lstat)(void *ctx, const char *path, RESOLVER_STAT *st);
+    void   *ctx;
+} RESOLVER_BACKEND;
+
+typedef struct {
+    int            op;      /* RESOLVER_ISSYMLINK ... RESOLVER_LSTAT */
+    const char    *path;
+    int            result;  /* return value: 1, 0 or -1 for isSymlink, else 0 or -1 */
+    DWORD          error;
+    ULONG          tag;
+    char          *value;
+    RESOLVER_STAT  st;
+} RESOLVER_QUERY;
+
+typedef struct RESOLVER_SERVER RESOLVER_SERVER;
+
+RESOLVER_SERVER *resolverStart(const char *name, const RESOLVER_BACKEND *backend,
+                               unsigned int threads, unsigned int cacheTtlMs);
+void resolverFlush(RESOLVER_SERVER *server);
+void resolverStop(RESOLVER_SERVER *server);
+
+BOOL resolverConnect(const char *name, DWORD flags);
+void resolverDisconnect(void);
+
+BOOL resolverQuery(RESOLVER_QUERY *queries, size_t count);
+
+#ifdef _UNICODE
+#define resolverIsSymlink         resolverIsSymlinkW
+#define resolverGetLinkTarget     resolverGetLinkTargetW
+#define resolverGetCanonicalPath  resolverGetCanonicalPathW
+#define resolverLstat             resolverLstatW
+#define _tresolver_readlink_s     _wresolver_readlink_s
+#define _tresolver_realpath_s     _wresolver_realpath_s
+#else
+#define resolverIsSymlink         resolverIsSymlinkA
+#define resolverGetLinkTarget     resolverGetLinkTargetA
+#define resolverGetCanonicalPath  resolverGetCanonicalPathA
+#define resolverLstat             resolverLstatA
+#define _tresolver_readlink_s     resolver_readlink_s
+#define _tresolver_realpath_s     resolver_realpath_s
+#endif
+
+int   resolverIsSymlinkA(const char *lpFileName, ULONG *pReparseTag);
+char *resolverGetLinkTargetA(const char *lpFileName, ULONG *pReparseTag);
+char *resolverGetCanonicalPathA(const char *lpFileName);
+int   resolverLstatA(const char *lpFileName, RESOLVER_STAT *st);
+char *resolver_readlink_s(const char *path, char *buf, size_t bufsize);
+char *resolver_realpath_s(const char *path, char *buf, size_t bufsize);
+#ifdef _WIN32
+int      resolverIsSymlinkW(const wchar_t *lpFileName, ULONG *pReparseTag);
+wchar_t *resolverGetLinkTargetW(const wchar_t *lpFileName, ULONG *pReparseTag);
+wchar_t *resolverGetCanonicalPathW(const wchar_t *lpFileName);
+int      resolverLstatW(const wchar_t *lpFileName, RESOLVER_STAT *st);
+wchar_t *_wresolver_readlink_s(const wchar_t *path, wchar_t *buf, size_t numwcs);
+wchar_t *_wresolver_realpath_s(const wchar_t *path, wchar_t *buf, size_t numwcs);
+#endif
+
+#ifdef W32_SYMLINK_USE_RESOLVER
+#define isSymlinkA         resolverIsSymlinkA
+#define getLinkTargetA     resolverGetLinkTargetA
+#define getCanonicalPathA  resolverGetCanonicalPathA
+#define readlink_s         resolver_readlink_s
+#define realpath_s         resolver_realpath_s
+#ifdef _WIN32
+#define isSymlinkW         resolverIsSymlinkW
+#define getLinkTargetW     resolverGetLinkTargetW
+#define getCanonicalPathW  resolverGetCanonicalPathW
+#define _wreadlink_s       _wresolver_readlink_s
+#define _wrealpath_s       _wresolver_realpath_s
+#endif
+#endif /* W32_SYMLINK_USE_RESOLVER */
+
+
 #undef __DEPRECATED
 
 
@@ -0,0 +1,653 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "strpool.h"
+#include "walk.h"
+#include "w32-symlink.h"
+
+#define NODE_NONE      STRPOOL_NONE
+#define DEPTH_CYCLE    (-1)
+
+/* node states while computing the chain depth */
+#define STATE_NEW      0
+#define STATE_ACTIVE   1
+#define STATE_DONE     2
+
+/* existence of a final target */
+#define EXISTS_UNKNOWN 0
+#define EXISTS_YES     1
+#define EXISTS_NO      2
+
+
+typedef struct {
+    uint32_t target;    /* node the link points to, NODE_NONE if not a link */
+    uint32_t resolved;  /* the full target; differs from 'target' below a link */
+    uint32_t terminal;  /* final node of the chain */
+    int32_t  depth;     /* number of links in the chain or DEPTH_CYCLE */
+    uint8_t  state;
+    uint8_t  exists;
+    uint8_t  is_target;
+    uint8_t  unresolved;
+} NODE;
+
+typedef struct {
+    STRPOOL pool;
+    NODE *nodes;
+    size_t nodes_count;
+    size_t nodes_capacity;
+    uint32_t *links;    /* node IDs of all links */
+    size_t links_count;
+    size_t links_capacity;
+    BOOL failed;
+} LINK_GRAPH;
+
+
+static uint32_t add_node(LINK_GRAPH *g, const wchar_t *path, size_t len)
+{
+    NODE *p;
+    uint32_t id;
+    size_t n;
+
+    if ((id = strpool_intern(&g->pool, path, len)) == STRPOOL_NONE) {
+        return NODE_NONE;
+    }
+
+    if (id < g->nodes_count) {
+        return id;
+    }
+
+    /* IDs are handed out in ascending order, so this is a new node */
+    if (id >= g->nodes_capacity) {
+        n = g->nodes_capacity ? g->nodes_capacity * 2 : 1024;
+        if ((p = realloc(g->nodes, n * sizeof(NODE))) == NULL) return NODE_NONE;
+
+        g->nodes = p;
+        g->nodes_capacity = n;
+    }
+
+    memset(&g->nodes[id], 0, sizeof(NODE));
+    g->nodes[id].target = NODE_NONE;
+    g->nodes[id].resolved = NODE_NONE;
+    g->nodes[id].terminal = NODE_NONE;
+    g->nodes_count = id + 1;
+
+    return id;
+}
+
+static BOOL add_link(LINK_GRAPH *g, uint32_t id)
+{
+    uint32_t *p;
+    size_t n;
+
+    if (g->links_count == g->links_capacity) {
+        n = g->links_capacity ? g->links_capacity * 2 : 1024;
+        if ((p = realloc(g->links, n * sizeof(uint32_t))) == NULL) return FALSE;
+
+        g->links = p;
+        g->links_capacity = n;
+    }
+
+    g->links[g->links_count++] = id;
+
+    return TRUE;
+}
+
+static BOOL is_sep(wchar_t c)
+{
+    return (c == L'\\' || c == L'/') ? TRUE : FALSE;
+}
+
+/* "X:\", "\\server" or "\\?\" */
+static BOOL is_absolute(const wchar_t *p)
+{
+    if (iswalpha(p[0]) && p[1] == L':' && is_sep(p[2])) {
+        return TRUE;
+    }
+
+    return (is_sep(p[0]) && is_sep(p[1])) ? TRUE : FALSE;
+}
+
+/**
+ * Turn a link target into a normalized absolute path.
+ * Returns NULL if the target has no Windows counterpart (LXSS paths outside
+ * of any distribution). The result must be deallocated with free().
+ */
+static wchar_t *resolve_target(const wchar_t *linkpath, size_t linklen,
+                               const wchar_t *target, ULONG tag)
+{
+    wchar_t *joined, *buf;
+    const wchar_t *p;
+    size_t dirlen, tlen;
+    DWORD len;
+
+    if (tag == IO_REPARSE_TAG_LX_SYMLINK) {
+        /* already absolute and without "." and ".." */
+        return translateLxTargetW(linkpath, target);
+    }
+
+    if (wcsncmp(target, L"\\??\\Volume{", 11) == 0) {
+        /* mount point: volume GUID -> drive letter or mount folder */
+        return mapVolumePathW(target);
+    }
+
+    tlen = wcslen(target);
+
+    if ((joined = malloc((linklen + tlen + 2) * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    if (wcsncmp(target, L"\\??\\UNC\\", 8) == 0) {
+        /* "\??\UNC\server\share" -> "\\server\share" */
+        joined[0] = joined[1] = L'\\';
+        wmemcpy(joined + 2, target + 8, tlen - 7);
+    } else if (wcsncmp(target, L"\\??\\", 4) == 0) {
+        /* strip the NT namespace prefix */
+        wmemcpy(joined, target + 4, tlen - 3);
+    } else if (is_absolute(target)) {
+        wmemcpy(joined, target, tlen + 1);
+    } else if (is_sep(target[0])) {
+        /* relative to the root of the link's drive */
+        p = linkpath;
+        if (wcsncmp(p, L"\\\\?\\", 4) == 0) p += 4;
+
+        dirlen = (iswalpha(p[0]) && p[1] == L':') ? (size_t)((p + 2) - linkpath) : 0;
+        wmemcpy(joined, linkpath, dirlen);
+        wmemcpy(joined + dirlen, target, tlen + 1);
+    } else {
+        /* relative to the directory containing the link */
+        for (dirlen = linklen; dirlen > 0 && !is_sep(linkpath[dirlen-1]); dirlen--)
+            ;
+        wmemcpy(joined, linkpath, dirlen);
+        wmemcpy(joined + dirlen, target, tlen + 1);
+    }
+
+    /* resolve "." and ".." and unify the separators */
+    len = GetFullPathNameW(joined, 0, NULL, NULL);
+
+    if (len == 0 || (buf = malloc(len * sizeof(wchar_t))) == NULL) {
+        free(joined);
+        return NULL;
+    }
+
+    if (GetFullPathNameW(joined, len, buf, NULL) == 0) {
+        free(buf);
+        buf = NULL;
+    }
+
+    free(joined);
+
+    return buf;
+}
+
+/**
+ * Spell 'root' the way resolve_target() spells link targets, or else the
+ * same file would end up as two different nodes: absolute, with
+ * backslashes and without "." and "..". A "\\?\" prefix is dropped too
+ * since link targets lose their "\??\" prefix; long_path() adds it again
+ * for the walk. The result must be deallocated with free().
+ */
+static wchar_t *full_root(const wchar_t *root)
+{
+    wchar_t *tmp = NULL, *buf;
+    const wchar_t *p = root;
+    DWORD len;
+
+    if (wcsncmp(root, L"\\\\?\\UNC\\", 8) == 0) {
+        /* "\\?\UNC\server\share" -> "\\server\share" */
+        if ((tmp = _wcsdup(root + 6)) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return NULL;
+        }
+        tmp[0] = L'\\';
+        p = tmp;
+    } else if (wcsncmp(root, L"\\\\?\\", 4) == 0 &&
+               iswalpha(root[4]) && root[5] == L':')
+    {
+        p = root + 4;
+    }
+
+    len = GetFullPathNameW(p, 0, NULL, NULL);
+
+    if (len == 0 || (buf = malloc(len * sizeof(wchar_t))) == NULL) {
+        if (len != 0) SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        free(tmp);
+        return NULL;
+    }
+
+    if (GetFullPathNameW(p, len, buf, NULL) == 0) {
+        free(buf);
+        buf = NULL;
+    }
+
+    free(tmp);
+
+    return buf;
+}
+
+/**
+ * The "\\?\" form of an absolute path, so that paths longer than MAX_PATH
+ * can be opened: "C:\x" -> "\\?\C:\x", "\\server\x" -> "\\?\UNC\server\x".
+ * The result must be deallocated with free().
+ */
+static wchar_t *long_path(const wchar_t *path)
+{
+    size_t len = wcslen(path);
+    wchar_t *buf;
+
+    if ((buf = malloc((len + 8) * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if (wcsncmp(path, L"\\\\?\\", 4) == 0 || wcsncmp(path, L"\\\\.\\", 4) == 0) {
+        wmemcpy(buf, path, len + 1);
+    } else if (is_sep(path[0]) && is_sep(path[1])) {
+        wmemcpy(buf, L"\\\\?\\UNC", 7);
+        wmemcpy(buf + 7, path + 1, len);
+    } else {
+        wmemcpy(buf, L"\\\\?\\", 4);
+        wmemcpy(buf + 4, path, len + 1);
+    }
+
+    return buf;
+}
+
+/* the walk reports long paths; nodes are named without the prefix */
+static uint32_t add_path_node(LINK_GRAPH *g, const wchar_t *path, size_t len)
+{
+    wchar_t *buf;
+    uint32_t id;
+
+    if (len >= 8 && wcsncmp(path, L"\\\\?\\UNC\\", 8) == 0) {
+        /* "\\?\UNC\server" -> "\\server" */
+        if ((buf = malloc((len - 5) * sizeof(wchar_t))) == NULL) {
+            return NODE_NONE;
+        }
+
+        buf[0] = L'\\';
+        wmemcpy(buf + 1, path + 7, len - 7);
+        id = add_node(g, buf, len - 6);
+        free(buf);
+
+        return id;
+    }
+
+    if (len >= 4 && wcsncmp(path, L"\\\\?\\", 4) == 0) {
+        return add_node(g, path + 4, len - 4);
+    }
+
+    return add_node(g, path, len);
+}
+
+/* GetFileAttributesW() without the MAX_PATH limit */
+static DWORD path_attributes(const wchar_t *path)
+{
+    wchar_t *buf;
+    DWORD dwAttr;
+
+    if ((buf = long_path(path)) == NULL) {
+        return INVALID_FILE_ATTRIBUTES;
+    }
+
+    dwAttr = GetFileAttributesW(buf);
+    free(buf);
+
+    return dwAttr;
+}
+
+static int collect_link(void *ctx, const WALK_ENTRY *entry)
+{
+    LINK_GRAPH *g = (LINK_GRAPH *)ctx;
+    wchar_t *target, *resolved;
+    uint32_t link, dest;
+    ULONG tag = 0;
+
+    switch (entry->reparse_tag)
+    {
+    case IO_REPARSE_TAG_SYMLINK:
+    case IO_REPARSE_TAG_MOUNT_POINT:
+    case IO_REPARSE_TAG_APPEXECLINK:
+    case IO_REPARSE_TAG_LX_SYMLINK:
+    case IO_REPARSE_TAG_NFS:
+        break;
+    default:
+        return WALK_CONTINUE;
+    }
+
+    if ((target = getLinkTargetW(entry->path, &tag)) == NULL) {
+        /* i.e. NFS entries that are not links */
+        return WALK_CONTINUE;
+    }
+
+    if ((link = add_path_node(g, entry->path, entry->path_len)) == NODE_NONE) {
+        free(target);
+        g->failed = TRUE;
+        return WALK_STOP;
+    }
+
+    /* relative targets are joined with the node name, so that they are
+     * spelled without the prefix as well */
+    resolved = resolve_target(strpool_get(&g->pool, link), strpool_length(&g->pool, link),
+                              target, tag);
+    free(target);
+
+    if (resolved) {
+        dest = add_node(g, resolved, wcslen(resolved));
+        free(resolved);
+    } else {
+        /* unresolvable target: point to ourself, flagged as unresolved */
+        dest = link;
+        g->nodes[link].unresolved = 1;
+    }
+
+    if (dest == NODE_NONE || !add_link(g, link)) {
+        g->failed = TRUE;
+        return WALK_STOP;
+    }
+
+    g->nodes[link].target = dest;
+    g->nodes[link].resolved = dest;
+
+    return WALK_CONTINUE;
+}
+
+/**
+ * Attribute targets below another link to that link, for the cycle
+ * detection; 'resolved' keeps the full path for the existence check.
+ */
+static void redirect_to_ancestors(LINK_GRAPH *g)
+{
+    const wchar_t *path;
+    uint32_t link, dest, up;
+    size_t i, len;
+
+    for (i = 0; i < g->links_count; i++) {
+        link = g->links[i];
+        dest = g->nodes[link].target;
+
+        if (g->nodes[link].unresolved || g->nodes[dest].target != NODE_NONE) {
+            continue;
+        }
+
+        path = strpool_get(&g->pool, dest);
+        len = strpool_length(&g->pool, dest);
+
+        while (len > 0) {
+            while (len > 0 && !is_sep(path[len-1])) len--;
+            if (len <= 1) break;
+
+            up = strpool_find(&g->pool, path, len - 1);
+
+            if (up != STRPOOL_NONE && g->nodes[up].target != NODE_NONE) {
+                g->nodes[link].target = up;
+                break;
+            }
+            len--;
+        }
+    }
+}
+
+/**
+ * Every link has exactly one outgoing edge, so the strongly connected
+ * components with more than one node (or a self loop) are exactly the
+ * cycles found by following the chain of each link once.
+ */
+static void compute_depths(LINK_GRAPH *g, size_t *cycles)
+{
+    uint32_t *stack, x;
+    size_t i, sp;
+    int32_t base;
+    uint32_t terminal;
+
+    *cycles = 0;
+
+    if ((stack = malloc((g->links_count + 1) * sizeof(uint32_t))) == NULL) {
+        g->failed = TRUE;
+        return;
+    }
+
+    for (i = 0; i < g->links_count; i++) {
+        x = g->links[i];
+        sp = 0;
+
+        /* follow the chain until we reach a known node */
+        while (g->nodes[x].target != NODE_NONE && g->nodes[x].state == STATE_NEW &&
+               !g->nodes[x].unresolved)
+        {
+            g->nodes[x].state = STATE_ACTIVE;
+            stack[sp++] = x;
+            x = g->nodes[x].target;
+        }
+
+        if (g->nodes[x].unresolved && g->nodes[x].state == STATE_NEW) {
+            /* chain ends in a link without a Windows counterpart */
+            g->nodes[x].state = STATE_DONE;
+            g->nodes[x].depth = 1;
+            g->nodes[x].terminal = x;
+            base = 1;
+            terminal = x;
+        } else if (g->nodes[x].target == NODE_NONE) {
+            /* reached a real file or directory */
+            base = 0;
+            terminal = x;
+        } else if (g->nodes[x].state == STATE_ACTIVE) {
+            /* found a new cycle */
+            (*cycles)++;
+
+            while (sp > 0) {
+                uint32_t y = stack[--sp];
+                g->nodes[y].state = STATE_DONE;
+                g->nodes[y].depth = DEPTH_CYCLE;
+                g->nodes[y].terminal = NODE_NONE;
+                if (y == x) break;
+            }
+
+            base = DEPTH_CYCLE;
+            terminal = NODE_NONE;
+        } else {
+            /* already computed */
+            base = g->nodes[x].depth;
+            terminal = g->nodes[x].terminal;
+        }
+
+        /* unwind the chain */
+        while (sp > 0) {
+            x = stack[--sp];
+            if (base != DEPTH_CYCLE) base++;
+
+            g->nodes[x].state = STATE_DONE;
+            g->nodes[x].depth = base;
+            g->nodes[x].terminal = terminal;
+        }
+    }
+
+    free(stack);
+}
+
+static void write_line(FILE *fp, const char *what, int depth,
+                       const wchar_t *link, const wchar_t *target)
+{
+    char *s_link = convert_wcs_to_utf8(link);
+    char *s_target = target ? convert_wcs_to_utf8(target) : NULL;
+
+    if (depth > 0) {
+        fprintf(fp, "%s %d: %s\n", what, depth, s_link ? s_link : "?");
+    } else {
+        fprintf(fp, "%s: %s -> %s\n", what, s_link ? s_link : "?", s_target ? s_target : "?");
+    }
+
+    free(s_link);
+    free(s_target);
+}
+
+BOOL analyzeLinkGraphW(const wchar_t *root, unsigned int depthLimit,
+                       FILE *report, LINK_GRAPH_STATS *pStats)
+{
+    LINK_GRAPH g;
+    LINK_GRAPH_STATS st;
+    NODE *n, *t;
+    wchar_t *full, *tmp;
+    uint32_t link, check;
+    size_t i;
+    DWORD dwAttr;
+
+    memset(&g, 0, sizeof(g));
+    memset(&st, 0, sizeof(st));
+
+    if (!root || !*root) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((full = full_root(root)) == NULL) {
+        return FALSE;
+    }
+
+    if (!strpool_init(&g.pool, TRUE)) {
+        free(full);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    /* walk with the prefix, or deep directories are silently skipped */
+    tmp = long_path(full);
+    free(full);
+
+    if (!tmp) {
+        goto error;
+    }
+
+    if (!walk_tree(tmp, collect_link, &g) || g.failed) {
+        /* walk_tree() reports its own memory errors */
+        if (g.failed) SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        free(tmp);
+        goto error;
+    }
+
+    free(tmp);
+
+    redirect_to_ancestors(&g);
+    compute_depths(&g, &st.cycles);
+    if (g.failed) goto error;
+
+    st.links = g.links_count;
+
+    for (i = 0; i < g.links_count; i++) {
+        link = g.links[i];
+        n = &g.nodes[link];
+
+        if (!n->unresolved && !g.nodes[n->target].is_target) {
+            g.nodes[n->target].is_target = 1;
+            st.targets++;
+        }
+
+        if (n->depth == DEPTH_CYCLE) {
+            st.in_cycle++;
+            if (report) write_line(report, "cycle", 0, strpool_get(&g.pool, link),
+                                   strpool_get(&g.pool, n->target));
+            continue;
+        }
+
+        if ((size_t)n->depth > st.max_depth) {
+            st.max_depth = (size_t)n->depth;
+        }
+
+        if (depthLimit > 0 && (unsigned int)n->depth > depthLimit) {
+            st.long_chains++;
+            if (report) write_line(report, "depth", n->depth, strpool_get(&g.pool, link), NULL);
+        }
+
+        t = &g.nodes[n->terminal];
+
+        if (t->unresolved) {
+            st.unresolved++;
+            if (report) write_line(report, "unresolved", 0, strpool_get(&g.pool, link),
+                                   strpool_get(&g.pool, n->terminal));
+            continue;
+        }
+
+        /* A target below another link is checked with its full path; the
+         * existing terminal of that link says nothing about the rest. */
+        check = (n->resolved != n->target) ? n->resolved : n->terminal;
+        t = &g.nodes[check];
+
+        /* check each distinct final target only once */
+        if (t->exists == EXISTS_UNKNOWN) {
+            dwAttr = path_attributes(strpool_get(&g.pool, check));
+            t->exists = (dwAttr == INVALID_FILE_ATTRIBUTES) ? EXISTS_NO : EXISTS_YES;
+        }
+
+        if (t->exists == EXISTS_NO) {
+            st.dangling++;
+            if (report) write_line(report, "dangling", 0, strpool_get(&g.pool, link),
+                                   strpool_get(&g.pool, n->resolved));
+        }
+    }
+
+    if (report) {
+        fprintf(report, "links: %zu, targets: %zu, dangling: %zu, cycles: %zu (%zu links), "
+                        "max depth: %zu, unresolved: %zu\n",
+                st.links, st.targets, st.dangling, st.cycles, st.in_cycle,
+                st.max_depth, st.unresolved);
+    }
+
+    if (pStats) *pStats = st;
+
+    strpool_free(&g.pool);
+    free(g.nodes);
+    free(g.links);
+
+    return TRUE;
+
+error:
+    strpool_free(&g.pool);
+    free(g.nodes);
+    free(g.links);
+
+    return FALSE;
+}
+
+BOOL analyzeLinkGraphA(const char *root, unsigned int depthLimit,
+                       FILE *report, LINK_GRAPH_STATS *pStats)
+{
+    wchar_t *wstr;
+    BOOL ret;
+
+    if ((wstr = convert_str_to_wcs(root)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = analyzeLinkGraphW(wstr, depthLimit, report, pStats);
+    free(wstr);
+
+    return ret;
+}
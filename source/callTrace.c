@@ -0,0 +1,569 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calltrace.h"
+#include "convert.h"
+#include "ntapi.h"
+#include "trace.h"
+#include "w32-symlink.h"
+
+#ifndef GetFinalPathNameByHandle
+extern DWORD GetFinalPathNameByHandleW(HANDLE hFile, LPWSTR lpszFilePath, DWORD cchFilePath, DWORD dwFlags);
+#endif
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL  __declspec(thread)
+#else
+#define THREAD_LOCAL  __thread
+#endif
+
+/* values of trace_active */
+#define TRACE_RECORDING  1
+#define TRACE_REPLAYING  2
+
+/* handles returned while replaying, remembered with their path */
+#define REPLAY_HANDLES  64
+
+
+typedef struct {
+    HANDLE         handle;
+    const uint8_t *path;         /* points into the trace */
+    size_t         path_len;
+} REPLAY_HANDLE;
+
+
+static SRWLOCK trace_lock = SRWLOCK_INIT;
+static FILE *trace_file = NULL;
+static volatile LONG trace_active = 0;
+static LONGLONG qpc_frequency = 0;
+
+/* set while the thread is inside a marked entry point */
+static THREAD_LOCAL int in_call = 0;
+
+static const TRACE_INDEX *replay_index = NULL;
+static size_t replay_call = TRACE_NO_CALL;
+static uint64_t replay_calls[TRACE_OP_COUNT];
+static uint64_t replay_missing = 0;
+static REPLAY_HANDLE replay_handles[REPLAY_HANDLES];
+static size_t replay_next = 0;
+
+
+static LONGLONG now(void)
+{
+    LARGE_INTEGER t;
+
+    QueryPerformanceCounter(&t);
+
+    return t.QuadPart;
+}
+
+/* 'handle' is the handle the call opened or used, 'parent' the directory
+ * a relative name was opened in */
+static void record(uint32_t op, DWORD error, uint32_t arg, LONGLONG start, HANDLE handle,
+                   HANDLE parent, const wchar_t *path, size_t path_len, const void *data, size_t len)
+{
+    TRACE_RECORD rec;
+    LONGLONG ticks = now() - start;
+
+    rec.op = op;
+    rec.error = error;
+    rec.arg = arg;
+    rec.thread = GetCurrentThreadId();
+    rec.handle = (handle == INVALID_HANDLE_VALUE) ? 0 : (uint64_t)(uintptr_t)handle;
+    rec.parent = (uint64_t)(uintptr_t)parent;
+    rec.path = (const uint8_t *)path;
+    rec.path_len = path ? path_len * sizeof(wchar_t) : 0;
+    rec.data = (const uint8_t *)data;
+    rec.data_len = data ? len : 0;
+
+    AcquireSRWLockExclusive(&trace_lock);
+
+    if (trace_file) {
+        rec.elapsed_ns = (uint64_t)(ticks / qpc_frequency * 1000000000 +
+                                    ticks % qpc_frequency * 1000000000 / qpc_frequency);
+        trace_write(trace_file, &rec);
+    }
+
+    ReleaseSRWLockExclusive(&trace_lock);
+}
+
+
+/* the recorded result of a call on a path; counted like the real call */
+static const TRACE_RECORD *replay_find(uint32_t op, uint32_t arg, const uint8_t *path, size_t path_len)
+{
+    const TRACE_RECORD *rec;
+
+    replay_calls[op]++;
+    rec = trace_lookup(replay_index, replay_call, op, arg, path, path_len);
+
+    if (!rec) {
+        replay_missing++;
+        SetLastError(ERROR_FILE_NOT_FOUND);
+    } else if (rec->error != 0) {
+        SetLastError(rec->error);
+    }
+
+    return (rec && rec->error == 0) ? rec : NULL;
+}
+
+static const REPLAY_HANDLE *replay_handle(HANDLE handle)
+{
+    size_t i;
+
+    for (i = 0; i < REPLAY_HANDLES; i++) {
+        if (replay_handles[i].handle == handle) return &replay_handles[i];
+    }
+
+    return NULL;
+}
+
+/* the same for a call on a handle that was returned by replay_open() */
+static const TRACE_RECORD *replay_find_handle(uint32_t op, uint32_t arg, HANDLE handle)
+{
+    const REPLAY_HANDLE *h = replay_handle(handle);
+
+    return h ? replay_find(op, arg, h->path, h->path_len) : replay_find(op, arg, NULL, 0);
+}
+
+/* 'root' is the directory handle a relative NT name is opened in */
+static HANDLE replay_open(uint32_t op, uint32_t arg, HANDLE root, const wchar_t *path, size_t len)
+{
+    const REPLAY_HANDLE *dir;
+    const TRACE_RECORD *rec;
+    REPLAY_HANDLE *slot = NULL;
+    HANDLE handle;
+    uint8_t *joined;
+    size_t i, joined_len;
+
+    if (root && (dir = replay_handle(root)) != NULL) {
+        /* the index joined the name with the directory's path too */
+        if ((joined = trace_join_path(dir->path, dir->path_len, (const uint8_t *)path,
+                                      len * sizeof(wchar_t), &joined_len)) == NULL)
+        {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return INVALID_HANDLE_VALUE;
+        }
+
+        rec = replay_find(op, arg, joined, joined_len);
+        free(joined);
+    } else {
+        rec = replay_find(op, arg, (const uint8_t *)path, len * sizeof(wchar_t));
+    }
+
+    if (!rec) {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    /* a real handle, so CloseHandle() and the CRT accept it */
+    handle = CreateFileW(L"NUL", 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                         OPEN_EXISTING, 0, NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    /* handle values are reused after CloseHandle() */
+    for (i = 0; i < REPLAY_HANDLES && !slot; i++) {
+        if (replay_handles[i].handle == handle) slot = &replay_handles[i];
+    }
+
+    if (!slot) {
+        slot = &replay_handles[replay_next++ % REPLAY_HANDLES];
+    }
+
+    slot->handle = handle;
+    slot->path = rec->path;
+    slot->path_len = rec->path_len;
+
+    return handle;
+}
+
+
+HANDLE traced_CreateFileW(const wchar_t *path, DWORD access, DWORD share,
+                          DWORD disposition, DWORD flags)
+{
+    HANDLE handle;
+    LONGLONG start;
+    DWORD error;
+
+    if (!trace_active) {
+        return CreateFileW(path, access, share, NULL, disposition, flags, NULL);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        return replay_open(TRACE_CREATE_FILE, flags, NULL, path, wcslen(path));
+    }
+
+    start = now();
+    handle = CreateFileW(path, access, share, NULL, disposition, flags, NULL);
+    error = (handle == INVALID_HANDLE_VALUE) ? GetLastError() : 0;
+
+    record(TRACE_CREATE_FILE, error, flags, start, handle, NULL, path, wcslen(path), NULL, 0);
+    SetLastError(error);
+
+    return handle;
+}
+
+DWORD traced_GetFileAttributesW(const wchar_t *path)
+{
+    const TRACE_RECORD *rec;
+    LONGLONG start;
+    DWORD attr, error;
+
+    if (!trace_active) {
+        return GetFileAttributesW(path);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        rec = replay_find(TRACE_GET_ATTRIBUTES, 0, (const uint8_t *)path,
+                          wcslen(path) * sizeof(wchar_t));
+        return rec ? rec->arg : INVALID_FILE_ATTRIBUTES;
+    }
+
+    start = now();
+    attr = GetFileAttributesW(path);
+    error = (attr == INVALID_FILE_ATTRIBUTES) ? GetLastError() : 0;
+
+    record(TRACE_GET_ATTRIBUTES, error, attr, start, NULL, NULL, path, wcslen(path), NULL, 0);
+    SetLastError(error);
+
+    return attr;
+}
+
+BOOL traced_get_reparse_point(HANDLE handle, void *buf, DWORD size, DWORD *pReturned)
+{
+    const TRACE_RECORD *rec;
+    LONGLONG start;
+    DWORD error, returned = 0;
+    BOOL ok;
+
+    if (!trace_active) {
+        return DeviceIoControl(handle, FSCTL_GET_REPARSE_POINT, NULL, 0,
+                               buf, size, pReturned ? pReturned : &returned, NULL);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        if ((rec = replay_find_handle(TRACE_GET_REPARSE, 0, handle)) == NULL) {
+            return FALSE;
+        }
+
+        if (rec->data_len > size) {
+            SetLastError(ERROR_MORE_DATA);
+            return FALSE;
+        }
+
+        memcpy(buf, rec->data, rec->data_len);
+        if (pReturned) *pReturned = (DWORD)rec->data_len;
+
+        return TRUE;
+    }
+
+    start = now();
+    ok = DeviceIoControl(handle, FSCTL_GET_REPARSE_POINT, NULL, 0, buf, size, &returned, NULL);
+    error = ok ? 0 : GetLastError();
+
+    record(TRACE_GET_REPARSE, error, 0, start, handle, NULL, NULL, 0, ok ? buf : NULL, returned);
+    if (pReturned) *pReturned = returned;
+    SetLastError(error);
+
+    return ok;
+}
+
+DWORD traced_GetFinalPathNameByHandleW(HANDLE handle, wchar_t *buf, DWORD len, DWORD flags)
+{
+    const TRACE_RECORD *rec;
+    LONGLONG start;
+    DWORD rv, error;
+
+    if (!trace_active) {
+        return GetFinalPathNameByHandleW(handle, buf, len, flags);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        if ((rec = replay_find_handle(TRACE_FINAL_PATH, flags, handle)) == NULL) {
+            return 0;
+        }
+
+        rv = (DWORD)(rec->data_len / sizeof(wchar_t));
+
+        /* like the real function: the size including the NUL if 'buf' is too small */
+        if (rv >= len) {
+            return rv + 1;
+        }
+
+        memcpy(buf, rec->data, rec->data_len);
+        buf[rv] = 0;
+
+        return rv;
+    }
+
+    start = now();
+    rv = GetFinalPathNameByHandleW(handle, buf, len, flags);
+    error = (rv == 0) ? GetLastError() : 0;
+
+    /* only a call that filled 'buf' has a result */
+    record(TRACE_FINAL_PATH, error, flags, start, handle, NULL, NULL, 0,
+           (rv > 0 && rv < len) ? buf : NULL, rv * sizeof(wchar_t));
+    SetLastError(error);
+
+    return rv;
+}
+
+HANDLE traced_nt_open(HANDLE root, const wchar_t *name, size_t len,
+                      ACCESS_MASK access, ULONG share, ULONG options)
+{
+    HANDLE handle;
+    LONGLONG start;
+    DWORD error;
+
+    if (!trace_active) {
+        return nt_open(root, name, len, access, share, options);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        return replay_open(TRACE_NT_OPEN, options, root, name, len);
+    }
+
+    start = now();
+    handle = nt_open(root, name, len, access, share, options);
+    error = (handle == INVALID_HANDLE_VALUE) ? GetLastError() : 0;
+
+    record(TRACE_NT_OPEN, error, options, start, handle, root, name, len, NULL, 0);
+    SetLastError(error);
+
+    return handle;
+}
+
+BOOL traced_nt_query_attributes(const wchar_t *name, size_t len, DWORD *attr)
+{
+    const TRACE_RECORD *rec;
+    LONGLONG start;
+    DWORD error;
+    BOOL ok;
+
+    if (!trace_active) {
+        return nt_query_attributes(name, len, attr);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        rec = replay_find(TRACE_NT_ATTRIBUTES, 0, (const uint8_t *)name, len * sizeof(wchar_t));
+        if (rec) *attr = rec->arg;
+        return rec ? TRUE : FALSE;
+    }
+
+    start = now();
+    ok = nt_query_attributes(name, len, attr);
+    error = ok ? 0 : GetLastError();
+
+    record(TRACE_NT_ATTRIBUTES, error, ok ? *attr : 0, start, NULL, NULL, name, len, NULL, 0);
+    SetLastError(error);
+
+    return ok;
+}
+
+BOOL traced_GetFileInformationByHandleEx(HANDLE handle, FILE_INFO_BY_HANDLE_CLASS cls,
+                                         void *buf, DWORD size)
+{
+    const TRACE_RECORD *rec;
+    LONGLONG start;
+    DWORD error, len = size;
+    BOOL ok;
+
+    if (!trace_active) {
+        return GetFileInformationByHandleEx(handle, cls, buf, size);
+    }
+
+    if (trace_active == TRACE_REPLAYING) {
+        if ((rec = replay_find_handle(TRACE_FILE_INFO, (uint32_t)cls, handle)) == NULL) {
+            return FALSE;
+        }
+
+        if (rec->data_len > size) {
+            SetLastError(ERROR_MORE_DATA);
+            return FALSE;
+        }
+
+        memset(buf, 0, size);
+        memcpy(buf, rec->data, rec->data_len);
+
+        return TRUE;
+    }
+
+    start = now();
+    ok = GetFileInformationByHandleEx(handle, cls, buf, size);
+    error = ok ? 0 : GetLastError();
+
+    /* only the part of a name buffer that was filled */
+    if (ok && cls == FileNameInfo &&
+        offsetof(FILE_NAME_INFO, FileName) + ((FILE_NAME_INFO *)buf)->FileNameLength < size)
+    {
+        len = (DWORD)offsetof(FILE_NAME_INFO, FileName) + ((FILE_NAME_INFO *)buf)->FileNameLength;
+    }
+
+    record(TRACE_FILE_INFO, error, (uint32_t)cls, start, handle, NULL, NULL, 0, ok ? buf : NULL, len);
+    SetLastError(error);
+
+    return ok;
+}
+
+LONGLONG traced_enter(uint32_t api, uint32_t flags, const wchar_t *path, size_t len)
+{
+    LONGLONG start;
+
+    if (trace_active != TRACE_RECORDING || in_call) {
+        return 0;
+    }
+
+    in_call = 1;
+    start = now();
+    record(TRACE_CALL, 0, TRACE_CALL_ARG(api, flags), start, NULL, NULL, path, path ? len : 0, NULL, 0);
+
+    return start;
+}
+
+void traced_leave(LONGLONG start, BOOL failed)
+{
+    DWORD error;
+
+    if (start == 0) {
+        return;
+    }
+
+    error = GetLastError();
+    in_call = 0;
+    record(TRACE_RETURN, failed ? error : 0, 0, start, NULL, NULL, NULL, 0, NULL, 0);
+    SetLastError(error);
+}
+
+BOOL traced_replay_begin(const TRACE_INDEX *index, size_t call)
+{
+    AcquireSRWLockExclusive(&trace_lock);
+
+    if (trace_active) {
+        ReleaseSRWLockExclusive(&trace_lock);
+        SetLastError(ERROR_BUSY);
+        return FALSE;
+    }
+
+    replay_index = index;
+    replay_call = call;
+    replay_missing = 0;
+    memset(replay_calls, 0, sizeof(replay_calls));
+    memset(replay_handles, 0, sizeof(replay_handles));
+    InterlockedExchange(&trace_active, TRACE_REPLAYING);
+
+    ReleaseSRWLockExclusive(&trace_lock);
+
+    return TRUE;
+}
+
+void traced_replay_end(uint64_t calls[TRACE_OP_COUNT], uint64_t *missing)
+{
+    AcquireSRWLockExclusive(&trace_lock);
+
+    if (trace_active == TRACE_REPLAYING) {
+        InterlockedExchange(&trace_active, 0);
+        memcpy(calls, replay_calls, sizeof(replay_calls));
+        *missing = replay_missing;
+        replay_index = NULL;
+    }
+
+    ReleaseSRWLockExclusive(&trace_lock);
+}
+
+BOOL startCallTraceA(const char *lpFileName)
+{
+    wchar_t *wcs;
+    BOOL ret;
+
+    if (!lpFileName) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((wcs = convert_str_to_wcs(lpFileName)) == NULL) {
+        return FALSE;
+    }
+
+    ret = startCallTraceW(wcs);
+    free(wcs);
+
+    return ret;
+}
+
+BOOL startCallTraceW(const wchar_t *lpFileName)
+{
+    LARGE_INTEGER freq;
+    FILE *fp;
+
+    if (!lpFileName) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    AcquireSRWLockExclusive(&trace_lock);
+
+    if (trace_file || trace_active) {
+        ReleaseSRWLockExclusive(&trace_lock);
+        SetLastError(ERROR_ALREADY_EXISTS);
+        return FALSE;
+    }
+
+    if ((fp = _wfopen(lpFileName, L"wb")) == NULL || trace_write_header(fp) != 0) {
+        if (fp) fclose(fp);
+        ReleaseSRWLockExclusive(&trace_lock);
+        SetLastError(ERROR_CANNOT_MAKE);
+        return FALSE;
+    }
+
+    QueryPerformanceFrequency(&freq);
+    qpc_frequency = freq.QuadPart;
+    trace_file = fp;
+    InterlockedExchange(&trace_active, TRACE_RECORDING);
+
+    ReleaseSRWLockExclusive(&trace_lock);
+
+    return TRUE;
+}
+
+void stopCallTrace(void)
+{
+    AcquireSRWLockExclusive(&trace_lock);
+
+    if (trace_active == TRACE_RECORDING) {
+        InterlockedExchange(&trace_active, 0);
+    }
+
+    if (trace_file) {
+        fclose(trace_file);
+        trace_file = NULL;
+    }
+
+    ReleaseSRWLockExclusive(&trace_lock);
+}
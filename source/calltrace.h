@@ -0,0 +1,82 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_CALLTRACE_H_INCLUDED
+#define W32_SYMLINK_CALLTRACE_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include "trace.h"
+
+
+/**
+ * Backend calls that are recorded while startCallTrace() is active.
+ * Without an active trace they cost one extra flag check.
+ * GetLastError() is preserved.
+ */
+HANDLE traced_CreateFileW(const wchar_t *path, DWORD access, DWORD share,
+                          DWORD disposition, DWORD flags);
+
+DWORD traced_GetFileAttributesW(const wchar_t *path);
+
+/* FSCTL_GET_REPARSE_POINT */
+BOOL traced_get_reparse_point(HANDLE handle, void *buf, DWORD size, DWORD *pReturned);
+
+DWORD traced_GetFinalPathNameByHandleW(HANDLE handle, wchar_t *buf, DWORD len, DWORD flags);
+
+BOOL traced_GetFileInformationByHandleEx(HANDLE handle, FILE_INFO_BY_HANDLE_CLASS cls,
+                                         void *buf, DWORD size);
+
+/* nt_open() and nt_query_attributes() */
+HANDLE traced_nt_open(HANDLE root, const wchar_t *name, size_t len,
+                      ACCESS_MASK access, ULONG share, ULONG options);
+
+BOOL traced_nt_query_attributes(const wchar_t *name, size_t len, DWORD *attr);
+
+
+/**
+ * Mark a call of the entry point 'api' (TRACE_API_*) on the 'len'
+ * characters of 'path', so the backend calls in between can be replayed
+ * and compared call by call. Entry points called from inside another one
+ * are not marked. Pass the result of traced_enter() to traced_leave()
+ * together with whether the call failed; the error code is taken from
+ * GetLastError(), which is preserved.
+ */
+LONGLONG traced_enter(uint32_t api, uint32_t flags, const wchar_t *path, size_t len);
+void traced_leave(LONGLONG start, BOOL failed);
+
+
+/**
+ * Replay mode: instead of the file system, the traced_*() functions
+ * answer from the records in 'index', preferring those of entry point
+ * call 'call'. The handles they return are opened on NUL, so they can be
+ * closed as usual. Only the thread that started the replay may use the
+ * library until traced_replay_end(), which returns to normal operation
+ * and fills in how often each backend call was made and how many of them
+ * had no matching record.
+ * traced_replay_begin() fails with ERROR_BUSY while a trace is recorded.
+ */
+BOOL traced_replay_begin(const TRACE_INDEX *index, size_t call);
+void traced_replay_end(uint64_t calls[TRACE_OP_COUNT], uint64_t *missing);
+
+#endif /* W32_SYMLINK_CALLTRACE_H_INCLUDED */
@@ -98,3 +98,27 @@ wchar_t *convert_str_to_wcs(const char *str)
 
     return buf;
 }
+
+
+char *convert_wcs_to_utf8(const wchar_t *lpWstr)
+{
+    int len, wlen;
+    char *buf;
+
+    if (!lpWstr) return NULL;
+
+    wlen = (int)wcslen(lpWstr);
+    len = WideCharToMultiByte(CP_UTF8, 0, lpWstr, wlen, NULL, 0, NULL, NULL);
+    if (len < 1) return NULL;
+
+    buf = malloc(len + 1);
+    if (!buf) return NULL;
+
+    if (WideCharToMultiByte(CP_UTF8, 0, lpWstr, wlen, buf, len, NULL, NULL) < 1) {
+        free(buf);
+        return NULL;
+    }
+
+    buf[len] = 0;
+    return buf;
+}
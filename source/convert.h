@@ -11,5 +11,6 @@
 char    *convert_wcs_to_str(const wchar_t *wcs);
 wchar_t *convert_str_to_wcs(const char *str);
 wchar_t *convert_utf8_to_wcs(const char *str);
+char    *convert_wcs_to_utf8(const wchar_t *wcs);
 
 #endif /* W32_SYMLINK_CONVERT_H_INCLUDED */
@@ -24,6 +24,7 @@
 #include <windows.h>
 #include <wchar.h>
 #include <stdlib.h>
+#include <string.h>
 #include "convert.h"
 #include "w32-symlink.h"
 
@@ -40,6 +41,153 @@
 extern BOOLEAN CreateSymbolicLinkW(LPCWSTR lpSymlinkFileName, LPCWSTR lpTargetFileName, DWORD dwFlags);
 #endif
 
+#ifdef _MSC_VER
+#pragma comment(lib, "advapi32.lib")
+#endif
+
+/* first build that accepts SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE */
+#define UNPRIVILEGED_CREATE_MIN_BUILD  14972
+
+typedef LONG (WINAPI *RtlGetVersion_t)(RTL_OSVERSIONINFOW *);
+
+
+static INIT_ONCE probe_once = INIT_ONCE_STATIC_INIT;
+static volatile LONG capabilities = 0;
+
+
+/* GetVersionEx() lies about the version, so ask ntdll directly */
+static DWORD get_build_number(void)
+{
+    RTL_OSVERSIONINFOW vi;
+    RtlGetVersion_t pRtlGetVersion;
+    HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+
+    if (!ntdll) return 0;
+
+    pRtlGetVersion = (RtlGetVersion_t)(void *)GetProcAddress(ntdll, "RtlGetVersion");
+    if (!pRtlGetVersion) return 0;
+
+    memset(&vi, 0, sizeof(vi));
+    vi.dwOSVersionInfoSize = sizeof(vi);
+
+    if (pRtlGetVersion(&vi) != 0 || vi.dwMajorVersion < 10) {
+        return 0;
+    }
+
+    return vi.dwBuildNumber;
+}
+
+static BOOL developer_mode_enabled(void)
+{
+    DWORD value = 0;
+    DWORD size = sizeof(value);
+
+    if (RegGetValueW(HKEY_LOCAL_MACHINE,
+                     L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\AppModelUnlock",
+                     L"AllowDevelopmentWithoutDevLicense",
+                     RRF_RT_REG_DWORD,
+                     NULL,
+                     &value,
+                     &size) != ERROR_SUCCESS)
+    {
+        return FALSE;
+    }
+
+    return (value != 0) ? TRUE : FALSE;
+}
+
+static BOOL has_symlink_privilege(void)
+{
+    TOKEN_PRIVILEGES *tp;
+    HANDLE token;
+    LUID luid;
+    DWORD i, len = 0;
+    BOOL found = FALSE;
+
+    if (!LookupPrivilegeValueW(NULL, L"SeCreateSymbolicLinkPrivilege", &luid)) {
+        return FALSE;
+    }
+
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token)) {
+        return FALSE;
+    }
+
+    GetTokenInformation(token, TokenPrivileges, NULL, 0, &len);
+
+    if (len > 0 && (tp = malloc(len)) != NULL) {
+        if (GetTokenInformation(token, TokenPrivileges, tp, len, &len)) {
+            for (i = 0; i < tp->PrivilegeCount; i++) {
+                if (tp->Privileges[i].Luid.LowPart == luid.LowPart &&
+                    tp->Privileges[i].Luid.HighPart == luid.HighPart)
+                {
+                    found = TRUE;
+                    break;
+                }
+            }
+        }
+        free(tp);
+    }
+
+    CloseHandle(token);
+
+    return found;
+}
+
+/* derive SYMLINK_CAP_CREATE from the other bits */
+static LONG with_create_cap(LONG caps)
+{
+    if ((caps & SYMLINK_CAP_PRIVILEGE) ||
+        ((caps & SYMLINK_CAP_DEVELOPER_MODE) && (caps & SYMLINK_CAP_UNPRIVILEGED_FLAG)))
+    {
+        return caps | SYMLINK_CAP_CREATE;
+    }
+
+    return caps & ~(LONG)SYMLINK_CAP_CREATE;
+}
+
+/* the OS rejects SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE after all */
+static void drop_unprivileged_cap(void)
+{
+    LONG caps, update;
+
+    do {
+        caps = capabilities;
+        update = with_create_cap(caps & ~(LONG)SYMLINK_CAP_UNPRIVILEGED_FLAG);
+    }
+    while (InterlockedCompareExchange(&capabilities, update, caps) != caps);
+}
+
+static BOOL CALLBACK probe_capabilities(PINIT_ONCE once, PVOID param, PVOID *ctx)
+{
+    LONG caps = 0;
+
+    (void)once;
+    (void)param;
+    (void)ctx;
+
+    if (get_build_number() >= UNPRIVILEGED_CREATE_MIN_BUILD) {
+        caps |= SYMLINK_CAP_UNPRIVILEGED_FLAG;
+    }
+
+    if (developer_mode_enabled()) {
+        caps |= SYMLINK_CAP_DEVELOPER_MODE;
+    }
+
+    if (has_symlink_privilege()) {
+        caps |= SYMLINK_CAP_PRIVILEGE;
+    }
+
+    InterlockedExchange(&capabilities, with_create_cap(caps));
+
+    return TRUE;
+}
+
+DWORD getSymlinkCapabilities(void)
+{
+    InitOnceExecuteOnce(&probe_once, probe_capabilities, NULL, NULL);
+
+    return (DWORD)capabilities;
+}
 
 BOOL createLinkA(const char *link, const char *target, char mode)
 {
@@ -68,7 +216,7 @@ BOOL createLinkA(const char *link, const char *target, char mode)
 
 BOOL createLinkW(const wchar_t *link, const wchar_t *target, char mode)
 {
-    DWORD flags = SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE;
+    DWORD flags = 0;
 
     switch (mode) {
         case 'h':
@@ -84,14 +232,32 @@ BOOL createLinkW(const wchar_t *link, const wchar_t *target, char mode)
             break;
     }
 
+    /* only pass this flag if the OS knows it */
+    if (getSymlinkCapabilities() & SYMLINK_CAP_UNPRIVILEGED_FLAG) {
+        flags |= SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE;
+    }
+
     /* create symbolic link */
     if (CreateSymbolicLinkW(link, target, flags)) {
         return TRUE;
     }
 
-    /* failure: remove this flag and try again */
-    flags &= ~SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE;
+    /* The flag may have been rejected after all (i.e. the build number was
+     * wrong), or the path is bad. Try again without it and only remember
+     * the flag as unsupported if that helped. */
+    if ((flags & SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE) &&
+        GetLastError() == ERROR_INVALID_PARAMETER)
+    {
+        flags &= ~SYMBOLIC_LINK_FLAG_ALLOW_UNPRIVILEGED_CREATE;
 
-    return CreateSymbolicLinkW(link, target, flags);
-}
+        if (!CreateSymbolicLinkW(link, target, flags)) {
+            return FALSE;
+        }
+
+        drop_unprivileged_cap();
 
+        return TRUE;
+    }
+
+    return FALSE;
+}
@@ -0,0 +1,284 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include "convert.h"
+#include "deadline.h"
+#include "volhealth.h"
+#include "w32-symlink.h"
+
+/* after expiry the I/O is cancelled again in this interval (ms), in
+ * case the query was between two calls the first time */
+#define CANCEL_PERIOD  100
+
+
+static VOLHEALTH health;
+static SRWLOCK health_lock = SRWLOCK_INIT;
+
+
+static void CALLBACK expire(PTP_CALLBACK_INSTANCE instance, PVOID ctx, PTP_TIMER timer)
+{
+    DEADLINE *dl = (DEADLINE *)ctx;
+
+    (void)instance;
+    (void)timer;
+
+    /* the lock keeps us from cancelling I/O the thread does after
+     * deadline_end() */
+    AcquireSRWLockExclusive(&dl->lock);
+
+    if (dl->active) {
+        dl->expired = TRUE;
+        CancelSynchronousIo(dl->thread);
+    }
+
+    ReleaseSRWLockExclusive(&dl->lock);
+}
+
+/* relative paths need GetFullPathNameW(), which does no I/O */
+static size_t path_volume_key(const wchar_t *path, uint16_t *key)
+{
+    wchar_t *full;
+    size_t len;
+    DWORD n;
+
+    len = volume_key((const uint16_t *)path, wcslen(path), key, VOLHEALTH_KEY_MAX);
+
+    if (len > 0 || (n = GetFullPathNameW(path, 0, NULL, NULL)) == 0) {
+        return len;
+    }
+
+    if ((full = malloc(n * sizeof(wchar_t))) == NULL) {
+        return 0;
+    }
+
+    if (GetFullPathNameW(path, n, full, NULL) < n) {
+        len = volume_key((const uint16_t *)full, wcslen(full), key, VOLHEALTH_KEY_MAX);
+    }
+
+    free(full);
+
+    return len;
+}
+
+BOOL deadline_begin(DEADLINE *dl, const wchar_t *path, DWORD ms)
+{
+    LONGLONG due100ns;
+    FILETIME due;
+    uint64_t wait;
+
+    dl->timer = NULL;
+    dl->thread = NULL;
+    dl->active = FALSE;
+    dl->expired = FALSE;
+    InitializeSRWLock(&dl->lock);
+
+    /* fail fast while the volume is known to hang */
+    dl->keylen = path_volume_key(path, dl->key);
+
+    if (dl->keylen > 0) {
+        AcquireSRWLockExclusive(&health_lock);
+        wait = volhealth_admit(&health, dl->key, dl->keylen, GetTickCount64());
+        ReleaseSRWLockExclusive(&health_lock);
+
+        if (wait > 0) {
+            SetLastError(ERROR_TIMEOUT);
+            return FALSE;
+        }
+    }
+
+    if (ms == INFINITE) {
+        return TRUE;
+    }
+
+    /* CancelSynchronousIo() needs a real handle, not the pseudo handle */
+    if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(),
+                         &dl->thread, 0, FALSE, DUPLICATE_SAME_ACCESS))
+    {
+        return FALSE;
+    }
+
+    dl->timer = CreateThreadpoolTimer(expire, dl, NULL);
+
+    if (!dl->timer) {
+        CloseHandle(dl->thread);
+        return FALSE;
+    }
+
+    /* negative = relative time */
+    due100ns = -(LONGLONG)ms * 10000;
+    due.dwLowDateTime = (DWORD)due100ns;
+    due.dwHighDateTime = (DWORD)((ULONGLONG)due100ns >> 32);
+
+    dl->active = TRUE;
+    SetThreadpoolTimer(dl->timer, &due, CANCEL_PERIOD, 0);
+
+    return TRUE;
+}
+
+BOOL deadline_end(DEADLINE *dl, BOOL failed)
+{
+    DWORD err = GetLastError();
+    BOOL timed_out;
+
+    if (dl->timer) {
+        AcquireSRWLockExclusive(&dl->lock);
+        dl->active = FALSE;
+        ReleaseSRWLockExclusive(&dl->lock);
+
+        SetThreadpoolTimer(dl->timer, NULL, 0, 0);
+        WaitForThreadpoolTimerCallbacks(dl->timer, TRUE);
+        CloseThreadpoolTimer(dl->timer);
+        CloseHandle(dl->thread);
+    }
+
+    /* an SMB timeout counts as well, any other answer means the
+     * volume is alive */
+    timed_out = dl->expired || (failed && err == ERROR_SEM_TIMEOUT);
+
+    if (dl->keylen > 0) {
+        AcquireSRWLockExclusive(&health_lock);
+        volhealth_report(&health, dl->key, dl->keylen, GetTickCount64(), timed_out);
+        ReleaseSRWLockExclusive(&health_lock);
+    }
+
+    SetLastError((failed && timed_out) ? ERROR_TIMEOUT : err);
+
+    return dl->expired;
+}
+
+
+void flushVolumeHealth(void)
+{
+    AcquireSRWLockExclusive(&health_lock);
+    volhealth_clear(&health);
+    ReleaseSRWLockExclusive(&health_lock);
+}
+
+
+int isSymlinkTimeoutA(const char *path, ULONG *tag, DWORD ms)
+{
+    DEADLINE dl;
+    wchar_t *wpath;
+    int rv = -1;
+
+    if (!path || (wpath = convert_str_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    if (deadline_begin(&dl, wpath, ms)) {
+        rv = isSymlinkA(path, tag);
+        deadline_end(&dl, rv == -1);
+    }
+
+    free(wpath);
+
+    return rv;
+}
+
+int isSymlinkTimeoutW(const wchar_t *path, ULONG *tag, DWORD ms)
+{
+    DEADLINE dl;
+    int rv;
+
+    if (!path || !deadline_begin(&dl, path, ms)) {
+        return -1;
+    }
+
+    rv = isSymlinkW(path, tag);
+    deadline_end(&dl, rv == -1);
+
+    return rv;
+}
+
+char *getLinkTargetTimeoutA(const char *path, ULONG *tag, DWORD ms)
+{
+    DEADLINE dl;
+    wchar_t *wpath;
+    char *res = NULL;
+
+    if (!path || (wpath = convert_str_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    if (deadline_begin(&dl, wpath, ms)) {
+        res = getLinkTargetA(path, tag);
+        deadline_end(&dl, res == NULL);
+    }
+
+    free(wpath);
+
+    return res;
+}
+
+wchar_t *getLinkTargetTimeoutW(const wchar_t *path, ULONG *tag, DWORD ms)
+{
+    DEADLINE dl;
+    wchar_t *res;
+
+    if (!path || !deadline_begin(&dl, path, ms)) {
+        return NULL;
+    }
+
+    res = getLinkTargetW(path, tag);
+    deadline_end(&dl, res == NULL);
+
+    return res;
+}
+
+char *getCanonicalPathTimeoutA(const char *path, DWORD flags, DWORD ms)
+{
+    DEADLINE dl;
+    wchar_t *wpath;
+    char *res = NULL;
+
+    if (!path || (wpath = convert_str_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    if (deadline_begin(&dl, wpath, ms)) {
+        res = getCanonicalPathExA(path, flags);
+        deadline_end(&dl, res == NULL);
+    }
+
+    free(wpath);
+
+    return res;
+}
+
+wchar_t *getCanonicalPathTimeoutW(const wchar_t *path, DWORD flags, DWORD ms)
+{
+    DEADLINE dl;
+    wchar_t *res;
+
+    if (!path || !deadline_begin(&dl, path, ms)) {
+        return NULL;
+    }
+
+    res = getCanonicalPathExW(path, flags);
+    deadline_end(&dl, res == NULL);
+
+    return res;
+}
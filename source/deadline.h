@@ -0,0 +1,64 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_DEADLINE_H_INCLUDED
+#define W32_SYMLINK_DEADLINE_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include "volhealth.h"
+
+
+/* one query running on the calling thread */
+typedef struct {
+    PTP_TIMER timer;
+    HANDLE    thread;
+    SRWLOCK   lock;
+    BOOL      active;
+    BOOL      expired;
+    uint16_t  key[VOLHEALTH_KEY_MAX];
+    size_t    keylen;
+} DEADLINE;
+
+
+/**
+ * Start a deadline of 'ms' milliseconds (INFINITE = none) for queries
+ * on 'path' made by the calling thread. When it expires, the synchronous
+ * I/O the thread is waiting for is cancelled.
+ *
+ * Returns FALSE with ERROR_TIMEOUT if the volume of 'path' recently
+ * timed out and is still blocked, or with another error if the timer
+ * could not be set up. deadline_end() must not be called then.
+ */
+BOOL deadline_begin(DEADLINE *dl, const wchar_t *path, DWORD ms);
+
+/**
+ * Stop the deadline after the queries are done. 'failed' tells whether
+ * they failed; in that case the last error is replaced with ERROR_TIMEOUT
+ * if the deadline had expired. Otherwise the last error is kept.
+ *
+ * Returns TRUE if the deadline had expired.
+ */
+BOOL deadline_end(DEADLINE *dl, BOOL failed);
+
+#endif /* W32_SYMLINK_DEADLINE_H_INCLUDED */
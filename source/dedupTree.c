@@ -0,0 +1,670 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "strpool.h"
+#include "walk.h"
+#include "workers.h"
+#include "w32-symlink.h"
+
+/* bytes read for the partial hash */
+#define PARTIAL_SIZE   4096
+
+/* size of the mapped views; a multiple of the allocation granularity */
+#define VIEW_SIZE      (64u * 1024 * 1024)
+
+/* NTFS allows up to 1024 names per file */
+#define MAX_LINKS      1023
+
+#define HASH_SEED      UINT64_C(0x9e3779b97f4a7c15)
+
+/* how many temporary names are tried before giving up */
+#define TEMP_TRIES     16
+
+
+typedef struct {
+    uint32_t    path;
+    uint32_t    nlinks;
+    uint64_t    size;
+    uint64_t    volume;
+    FILE_ID_128 id;
+    uint64_t    partial;  /* hash of the first PARTIAL_SIZE bytes */
+    uint64_t    full;     /* hash of the whole file, 0 if not needed */
+    DWORD       error;
+} ITEM;
+
+typedef struct {
+    DWORD        flags;
+    FILE        *report;
+    STRPOOL      pool;
+    ITEM        *items;
+    size_t       count;
+    size_t       capacity;
+    size_t      *work;    /* indices of the items to hash completely */
+    BOOL         nomem;
+    DEDUP_STATS  st;
+} DEDUP;
+
+typedef struct {
+    HANDLE      file;
+    HANDLE      mapping;
+    void       *view;
+} MAPPED;
+
+
+static uint64_t hash_update(uint64_t h, const unsigned char *p, size_t len)
+{
+    uint64_t w;
+
+    while (len >= 8) {
+        memcpy(&w, p, 8);
+        h ^= w * UINT64_C(0xff51afd7ed558ccd);
+        h = ((h << 27) | (h >> 37)) * UINT64_C(0xc4ceb9fe1a85ec53);
+        p += 8;
+        len -= 8;
+    }
+
+    while (len > 0) {
+        h = (h ^ *p++) * UINT64_C(0x100000001b3);
+        len--;
+    }
+
+    return h;
+}
+
+static uint64_t hash_final(uint64_t h, uint64_t size)
+{
+    h ^= size;
+    h = (h ^ (h >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    h = (h ^ (h >> 27)) * UINT64_C(0x94d049bb133111eb);
+    h ^= h >> 31;
+
+    /* 0 means "not computed" */
+    return h ? h : 1;
+}
+
+static BOOL map_open(MAPPED *m, const wchar_t *path)
+{
+    m->view = NULL;
+    m->mapping = NULL;
+    m->file = CreateFileW(path,
+                          GENERIC_READ,
+                          FILE_SHARE_READ | FILE_SHARE_DELETE,
+                          NULL,
+                          OPEN_EXISTING,
+                          FILE_FLAG_SEQUENTIAL_SCAN,
+                          NULL);
+
+    if (m->file == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    m->mapping = CreateFileMappingW(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (m->mapping == NULL) {
+        CloseHandle(m->file);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* map 'len' bytes at 'offset'; the previous view is unmapped */
+static const unsigned char *map_view(MAPPED *m, uint64_t offset, size_t len)
+{
+    if (m->view) UnmapViewOfFile(m->view);
+
+    m->view = MapViewOfFile(m->mapping, FILE_MAP_READ,
+                            (DWORD)(offset >> 32), (DWORD)offset, len);
+
+    return (const unsigned char *)m->view;
+}
+
+static void map_close(MAPPED *m)
+{
+    if (m->view) UnmapViewOfFile(m->view);
+    CloseHandle(m->mapping);
+    CloseHandle(m->file);
+}
+
+static int compare_item(const void *p1, const void *p2)
+{
+    const ITEM *a = (const ITEM *)p1;
+    const ITEM *b = (const ITEM *)p2;
+
+    if (a->size != b->size) return (a->size < b->size) ? -1 : 1;
+    if (a->volume != b->volume) return (a->volume < b->volume) ? -1 : 1;
+    if (a->partial != b->partial) return (a->partial < b->partial) ? -1 : 1;
+    if (a->full != b->full) return (a->full < b->full) ? -1 : 1;
+
+    return memcmp(&a->id, &b->id, sizeof(FILE_ID_128));
+}
+
+static BOOL same_file(const ITEM *a, const ITEM *b)
+{
+    return a->volume == b->volume && memcmp(&a->id, &b->id, sizeof(FILE_ID_128)) == 0;
+}
+
+/* equal size and hashes; 'full' is still 0 before the files were hashed */
+static BOOL same_hash(const ITEM *a, const ITEM *b)
+{
+    return a->size == b->size && a->volume == b->volume &&
+           a->partial == b->partial && a->full == b->full;
+}
+
+static int collect_file(void *ctx, const WALK_ENTRY *entry)
+{
+    DEDUP *d = (DEDUP *)ctx;
+    ITEM *p;
+    uint32_t id;
+
+    /* links are never followed; empty files have nothing to share */
+    if (entry->reparse_tag != 0 || entry->size == 0 ||
+        (entry->attributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        return WALK_CONTINUE;
+    }
+
+    if (d->count == d->capacity) {
+        size_t n = d->capacity ? d->capacity * 2 : 256;
+
+        if ((p = realloc(d->items, n * sizeof(ITEM))) == NULL) {
+            d->nomem = TRUE;
+            return WALK_STOP;
+        }
+
+        d->items = p;
+        d->capacity = n;
+    }
+
+    if ((id = strpool_intern(&d->pool, entry->path, entry->path_len)) == STRPOOL_NONE) {
+        d->nomem = TRUE;
+        return WALK_STOP;
+    }
+
+    p = &d->items[d->count++];
+    memset(p, 0, sizeof(ITEM));
+    p->path = id;
+    p->size = entry->size;
+
+    return WALK_CONTINUE;
+}
+
+/* get the identity, the link count and the partial hash of a file */
+static void probe_file(void *ctx, size_t index)
+{
+    DEDUP *d = (DEDUP *)ctx;
+    ITEM *item = &d->items[index];
+    BY_HANDLE_FILE_INFORMATION info;
+    FILE_ID_INFO idInfo;
+    unsigned char buf[PARTIAL_SIZE];
+    DWORD total = 0, n;
+    HANDLE handle;
+
+    handle = CreateFileW(strpool_get(&d->pool, item->path),
+                         GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_DELETE,
+                         NULL,
+                         OPEN_EXISTING,
+                         FILE_FLAG_SEQUENTIAL_SCAN,
+                         NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        item->error = GetLastError();
+        return;
+    }
+
+    if (!GetFileInformationByHandle(handle, &info)) {
+        item->error = GetLastError();
+        CloseHandle(handle);
+        return;
+    }
+
+    item->nlinks = info.nNumberOfLinks;
+
+    if (GetFileInformationByHandleEx(handle, FileIdInfo, &idInfo, sizeof(idInfo))) {
+        item->volume = idInfo.VolumeSerialNumber;
+        item->id = idInfo.FileId;
+    } else {
+        /* FileIdInfo requires Windows 8 or later; fall back to the 64 bit index */
+        item->volume = info.dwVolumeSerialNumber;
+        memcpy(item->id.Identifier, &info.nFileIndexLow, sizeof(DWORD));
+        memcpy(item->id.Identifier + sizeof(DWORD), &info.nFileIndexHigh, sizeof(DWORD));
+    }
+
+    while (total < sizeof(buf) && ReadFile(handle, buf + total, sizeof(buf) - total, &n, NULL) && n > 0) {
+        total += n;
+    }
+
+    CloseHandle(handle);
+
+    item->partial = hash_final(hash_update(HASH_SEED, buf, total), item->size);
+
+    /* small files were read completely */
+    if (item->size <= PARTIAL_SIZE) {
+        item->full = item->partial;
+    }
+}
+
+static void hash_file(void *ctx, size_t index)
+{
+    DEDUP *d = (DEDUP *)ctx;
+    ITEM *item = &d->items[d->work[index]];
+    const unsigned char *p;
+    uint64_t h = HASH_SEED, pos;
+    size_t len;
+    MAPPED m;
+
+    if (!map_open(&m, strpool_get(&d->pool, item->path))) {
+        item->error = GetLastError();
+        return;
+    }
+
+    for (pos = 0; pos < item->size; pos += len) {
+        len = (item->size - pos < VIEW_SIZE) ? (size_t)(item->size - pos) : VIEW_SIZE;
+
+        if ((p = map_view(&m, pos, len)) == NULL) {
+            item->error = GetLastError();
+            map_close(&m);
+            return;
+        }
+
+        h = hash_update(h, p, len);
+    }
+
+    map_close(&m);
+
+    item->full = hash_final(h, item->size);
+}
+
+/* returns 1 if both files are equal, 0 if not and -1 on errors */
+static int compare_files(const wchar_t *path1, const wchar_t *path2, uint64_t size)
+{
+    const unsigned char *p1, *p2;
+    MAPPED m1, m2;
+    uint64_t pos;
+    size_t len;
+    int rv = 1;
+
+    if (!map_open(&m1, path1)) {
+        return -1;
+    }
+
+    if (!map_open(&m2, path2)) {
+        map_close(&m1);
+        return -1;
+    }
+
+    for (pos = 0; pos < size && rv == 1; pos += len) {
+        len = (size - pos < VIEW_SIZE) ? (size_t)(size - pos) : VIEW_SIZE;
+
+        if ((p1 = map_view(&m1, pos, len)) == NULL ||
+            (p2 = map_view(&m2, pos, len)) == NULL)
+        {
+            rv = -1;
+        } else if (memcmp(p1, p2, len) != 0) {
+            rv = 0;
+        }
+    }
+
+    map_close(&m1);
+    map_close(&m2);
+
+    return rv;
+}
+
+static volatile LONG temp_counter = 0;
+
+static size_t append_hex(wchar_t *buf, size_t len, DWORD value)
+{
+    int i;
+
+    for (i = 28; i >= 0; i -= 4) {
+        buf[len++] = L"0123456789abcdef"[(value >> i) & 0xf];
+    }
+
+    return len;
+}
+
+/* "<path>.dedup~<process ID>.<counter>", unique among the threads of this
+ * process; 'buf' must hold len + 25 characters */
+static void temp_name(wchar_t *buf, const wchar_t *path, size_t len)
+{
+    wmemcpy(buf, path, len);
+    wmemcpy(buf + len, L".dedup~", 7);
+    len = append_hex(buf, len + 7, GetCurrentProcessId());
+    buf[len++] = L'.';
+    len = append_hex(buf, len, (DWORD)InterlockedIncrement(&temp_counter));
+    buf[len] = 0;
+}
+
+/* replace 'path' by a hard link to 'canonical' in one rename */
+static BOOL replace_with_link(const wchar_t *path, size_t len, const wchar_t *canonical)
+{
+    wchar_t *tmp;
+    DWORD err;
+    BOOL ok = FALSE;
+    int tries;
+
+    if ((tmp = malloc((len + 25) * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    /* a leftover of a crashed run may hold the name; try the next one */
+    for (tries = 0; tries < TEMP_TRIES; tries++) {
+        temp_name(tmp, path, len);
+
+        if ((ok = CreateHardLinkW(tmp, canonical, NULL)) != FALSE ||
+            (GetLastError() != ERROR_ALREADY_EXISTS &&
+             GetLastError() != ERROR_FILE_EXISTS))
+        {
+            break;
+        }
+    }
+
+    if (!ok) {
+        err = GetLastError();
+        free(tmp);
+        SetLastError(err);
+        return FALSE;
+    }
+
+    if (!MoveFileExW(tmp, path, MOVEFILE_REPLACE_EXISTING)) {
+        err = GetLastError();
+        DeleteFileW(tmp);
+        free(tmp);
+        SetLastError(err);
+        return FALSE;
+    }
+
+    free(tmp);
+
+    return TRUE;
+}
+
+static void write_line(FILE *fp, const char *what, const wchar_t *path, const wchar_t *canonical)
+{
+    char *s_path = convert_wcs_to_utf8(path);
+    char *s_canonical = canonical ? convert_wcs_to_utf8(canonical) : NULL;
+
+    if (canonical) {
+        fprintf(fp, "%s: %s -> %s\n", what, s_path ? s_path : "?", s_canonical ? s_canonical : "?");
+    } else {
+        fprintf(fp, "%s: %s\n", what, s_path ? s_path : "?");
+    }
+
+    free(s_path);
+    free(s_canonical);
+}
+
+static void report_error(DEDUP *d, const ITEM *item)
+{
+    d->st.failed++;
+
+    if (d->report) {
+        fprintf(d->report, "error %lu: ", (unsigned long)item->error);
+        write_line(d->report, "file", strpool_get(&d->pool, item->path), NULL);
+    }
+}
+
+/* end of the run of names of the same file starting at 'i' */
+static size_t same_file_end(const DEDUP *d, size_t i, size_t end)
+{
+    size_t j = i + 1;
+
+    while (j < end && same_file(&d->items[i], &d->items[j])) j++;
+
+    return j;
+}
+
+/* relink all files of the group [begin, end), which have equal hashes */
+static void dedup_group(DEDUP *d, size_t begin, size_t end)
+{
+    const ITEM *canon = &d->items[begin];
+    const wchar_t *canon_path, *path;
+    uint32_t canon_links;
+    size_t i, j, k, linked;
+    int equal;
+
+    /* use the file that already has the most names as canonical copy */
+    for (i = begin; i < end; i = same_file_end(d, i, end)) {
+        if (d->items[i].nlinks > canon->nlinks) canon = &d->items[i];
+    }
+
+    canon_path = strpool_get(&d->pool, canon->path);
+    canon_links = canon->nlinks;
+
+    for (i = begin; i < end; i = j) {
+        j = same_file_end(d, i, end);
+
+        if (same_file(&d->items[i], canon)) {
+            continue;
+        }
+
+        /* the hashes only make equality likely */
+        if ((equal = compare_files(canon_path, strpool_get(&d->pool, d->items[i].path),
+                                   canon->size)) != 1)
+        {
+            if (equal < 0) {
+                d->items[i].error = GetLastError();
+                report_error(d, &d->items[i]);
+            }
+            continue;
+        }
+
+        /* no room for all names: continue with this file as canonical copy */
+        if (canon_links + (j - i) > MAX_LINKS) {
+            canon = &d->items[i];
+            canon_path = strpool_get(&d->pool, canon->path);
+            canon_links = canon->nlinks;
+            continue;
+        }
+
+        for (k = i, linked = 0; k < j; k++) {
+            path = strpool_get(&d->pool, d->items[k].path);
+
+            if ((d->flags & DEDUP_DRY_RUN) == 0 &&
+                !replace_with_link(path, strpool_length(&d->pool, d->items[k].path), canon_path))
+            {
+                d->items[k].error = GetLastError();
+
+                if (d->items[k].error == ERROR_TOO_MANY_LINKS) {
+                    /* more names outside of the tree than known */
+                    canon_links = MAX_LINKS;
+                }
+
+                report_error(d, &d->items[k]);
+                continue;
+            }
+
+            if (d->report) {
+                write_line(d->report, (d->flags & DEDUP_DRY_RUN) ? "duplicate" : "link",
+                           path, canon_path);
+            }
+
+            canon_links++;
+            linked++;
+        }
+
+        d->st.linked += linked;
+
+        /* the data is only freed if no other name is left */
+        if (linked == d->items[i].nlinks) {
+            d->st.bytes_saved += canon->size;
+        }
+    }
+}
+
+BOOL dedupTreeW(const wchar_t *lpRootDir, DWORD flags, unsigned int threads,
+                FILE *report, DEDUP_STATS *pStats)
+{
+    DEDUP d;
+    size_t i, j, k, n, files;
+    BOOL ret = FALSE;
+
+    memset(&d, 0, sizeof(d));
+
+    if (!lpRootDir || !*lpRootDir) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!strpool_init(&d.pool, FALSE)) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    d.flags = flags;
+    d.report = report;
+
+    if (!walk_tree(lpRootDir, collect_file, &d)) {
+        goto done;
+    }
+
+    if (d.nomem) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        goto done;
+    }
+
+    d.st.files = d.count;
+
+    /* only files with a size found more than once are candidates */
+    qsort(d.items, d.count, sizeof(ITEM), compare_item);
+
+    for (i = 0, n = 0; i < d.count; i = j) {
+        for (j = i + 1; j < d.count && d.items[j].size == d.items[i].size; j++)
+            ;
+
+        if (j - i > 1) {
+            memmove(d.items + n, d.items + i, (j - i) * sizeof(ITEM));
+            n += j - i;
+        }
+    }
+
+    d.count = n;
+
+    if (d.count > 0) {
+        parallel_for(d.count, threads, probe_file, &d);
+    }
+
+    /* drop unreadable files */
+    for (i = 0, n = 0; i < d.count; i++) {
+        if (d.items[i].error != 0) {
+            report_error(&d, &d.items[i]);
+        } else {
+            d.items[n++] = d.items[i];
+        }
+    }
+
+    d.count = n;
+    qsort(d.items, d.count, sizeof(ITEM), compare_item);
+
+    if ((d.work = malloc((d.count + 1) * sizeof(size_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        goto done;
+    }
+
+    /* hash one name of each distinct file whose partial hash is not unique */
+    for (i = 0, n = 0; i < d.count; i = j) {
+        for (j = i + 1, files = 1; j < d.count && same_hash(&d.items[i], &d.items[j]); j++) {
+            if (!same_file(&d.items[j-1], &d.items[j])) files++;
+        }
+
+        if (files > 1 && d.items[i].full == 0) {
+            for (k = i; k < j; k = same_file_end(&d, k, j)) {
+                d.work[n++] = k;
+            }
+        }
+    }
+
+    if (n > 0) {
+        parallel_for(n, threads, hash_file, &d);
+    }
+
+    /* pass the result on to the other names of the same file */
+    for (i = 0; i < n; i++) {
+        k = d.work[i];
+
+        for (j = k + 1; j < d.count && same_file(&d.items[k], &d.items[j]); j++) {
+            d.items[j].full = d.items[k].full;
+            d.items[j].error = d.items[k].error;
+        }
+
+        if (d.items[k].error != 0) {
+            report_error(&d, &d.items[k]);
+        }
+    }
+
+    qsort(d.items, d.count, sizeof(ITEM), compare_item);
+
+    for (i = 0; i < d.count; i = j) {
+        for (j = i + 1, files = 1; j < d.count && same_hash(&d.items[i], &d.items[j]); j++) {
+            if (!same_file(&d.items[j-1], &d.items[j])) files++;
+        }
+
+        if (files > 1 && d.items[i].full != 0) {
+            dedup_group(&d, i, j);
+        }
+    }
+
+    if (report) {
+        fprintf(report, "files: %zu, %s: %zu, saved: %" PRIu64 " bytes, errors: %zu\n",
+                d.st.files, (flags & DEDUP_DRY_RUN) ? "duplicates" : "linked",
+                d.st.linked, d.st.bytes_saved, d.st.failed);
+    }
+
+    ret = TRUE;
+
+done:
+    if (pStats) *pStats = d.st;
+
+    strpool_free(&d.pool);
+    free(d.items);
+    free(d.work);
+
+    return ret;
+}
+
+BOOL dedupTreeA(const char *lpRootDir, DWORD flags, unsigned int threads,
+                FILE *report, DEDUP_STATS *pStats)
+{
+    wchar_t *wstr;
+    BOOL ret;
+
+    if ((wstr = convert_str_to_wcs(lpRootDir)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = dedupTreeW(wstr, flags, threads, report, pStats);
+    free(wstr);
+
+    return ret;
+}
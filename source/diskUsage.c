@@ -0,0 +1,486 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "strpool.h"
+#include "workers.h"
+#include "w32-symlink.h"
+
+/* number of independently locked parts of the file ID set */
+#define SHARD_COUNT   64
+
+#define NO_DIR        ((size_t)-1)
+
+/* buffer for GetFileInformationByHandleEx(FileIdBothDirectoryInfo) */
+#define LIST_SIZE     (64 * 1024)
+
+
+/* a distinct file, owned by the first directory (in breadth-first order)
+ * that contains one of its names */
+typedef struct {
+    uint64_t volume;
+    uint64_t id;
+    uint64_t apparent;
+    uint64_t allocated;
+    size_t   dir;        /* NO_DIR = empty slot */
+} FILE_SLOT;
+
+typedef struct {
+    SRWLOCK    lock;
+    FILE_SLOT *slots;
+    size_t     mask;     /* capacity - 1 */
+    size_t     used;
+} SHARD;
+
+/* subdirectories found by one worker, separated by NUL characters */
+typedef struct {
+    wchar_t *buf;
+    size_t   len;
+    size_t   size;
+    size_t   count;
+    DWORD    error;      /* 0 or the error of listing the directory */
+} CHILDREN;
+
+typedef struct {
+    STRPOOL         pool;
+    DISK_USAGE_DIR *dirs;
+    size_t          count;
+    size_t          capacity;
+    size_t          level;     /* first directory of the current level */
+    CHILDREN       *children;
+    SHARD           shards[SHARD_COUNT];
+    size_t          failed;    /* directories that could not be listed */
+    volatile LONG64 names;     /* file names seen */
+    volatile LONG   nomem;
+} DU;
+
+typedef struct {
+    DISK_USAGE pub;
+    STRPOOL    pool;
+} RESULT;
+
+
+static uint64_t hash_id(uint64_t volume, uint64_t id)
+{
+    uint64_t h = id ^ (volume * UINT64_C(0x9e3779b97f4a7c15));
+
+    h = (h ^ (h >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    h = (h ^ (h >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+    return h ^ (h >> 31);
+}
+
+static BOOL shard_grow(SHARD *s)
+{
+    size_t capacity = s->slots ? (s->mask + 1) * 2 : 256;
+    FILE_SLOT *slots;
+    size_t i, j;
+
+    if ((slots = malloc(capacity * sizeof(FILE_SLOT))) == NULL) {
+        return FALSE;
+    }
+
+    for (i = 0; i < capacity; i++) {
+        slots[i].dir = NO_DIR;
+    }
+
+    for (i = 0; s->slots && i <= s->mask; i++) {
+        if (s->slots[i].dir == NO_DIR) continue;
+
+        j = (size_t)hash_id(s->slots[i].volume, s->slots[i].id) / SHARD_COUNT & (capacity - 1);
+        while (slots[j].dir != NO_DIR) j = (j + 1) & (capacity - 1);
+        slots[j] = s->slots[i];
+    }
+
+    free(s->slots);
+    s->slots = slots;
+    s->mask = capacity - 1;
+
+    return TRUE;
+}
+
+/* add a file to the set; if it is already known, the directory that comes
+ * first keeps it, so the result does not depend on the thread timing */
+static BOOL add_file(DU *du, uint64_t volume, uint64_t id, size_t dir,
+                     uint64_t apparent, uint64_t allocated)
+{
+    uint64_t h = hash_id(volume, id);
+    SHARD *s = &du->shards[h % SHARD_COUNT];
+    FILE_SLOT *slot;
+    size_t i;
+    BOOL ret = TRUE;
+
+    AcquireSRWLockExclusive(&s->lock);
+
+    if ((s->used + 1) * 4 > (s->slots ? (s->mask + 1) * 3 : 0) && !shard_grow(s)) {
+        ret = FALSE;
+        goto done;
+    }
+
+    for (i = (size_t)h / SHARD_COUNT & s->mask; ; i = (i + 1) & s->mask) {
+        slot = &s->slots[i];
+
+        if (slot->dir == NO_DIR) {
+            slot->volume = volume;
+            slot->id = id;
+            slot->apparent = apparent;
+            slot->allocated = allocated;
+            slot->dir = dir;
+            s->used++;
+            break;
+        }
+
+        if (slot->id == id && slot->volume == volume) {
+            if (dir < slot->dir) slot->dir = dir;
+            break;
+        }
+    }
+
+done:
+    ReleaseSRWLockExclusive(&s->lock);
+
+    return ret;
+}
+
+static BOOL add_child(CHILDREN *c, const wchar_t *name, size_t len)
+{
+    size_t n;
+    wchar_t *p;
+
+    if (c->len + len + 1 > c->size) {
+        n = c->size ? c->size * 2 : 256;
+        while (n < c->len + len + 1) n *= 2;
+
+        if ((p = realloc(c->buf, n * sizeof(wchar_t))) == NULL) {
+            return FALSE;
+        }
+
+        c->buf = p;
+        c->size = n;
+    }
+
+    wmemcpy(c->buf + c->len, name, len);
+    c->buf[c->len + len] = 0;
+    c->len += len + 1;
+    c->count++;
+
+    return TRUE;
+}
+
+/* list one directory; the sizes and file IDs come with the listing */
+static void scan_dir(void *ctx, size_t index)
+{
+    DU *du = (DU *)ctx;
+    size_t dir = du->level + index;
+    CHILDREN *c = &du->children[index];
+    BY_HANDLE_FILE_INFORMATION info;
+    FILE_ID_BOTH_DIR_INFO *entry;
+    unsigned char *buf;
+    size_t len;
+    HANDLE handle;
+
+    handle = CreateFileW(du->dirs[dir].path,
+                         FILE_LIST_DIRECTORY,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         NULL,
+                         OPEN_EXISTING,
+                         FILE_FLAG_BACKUP_SEMANTICS,
+                         NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        c->error = GetLastError();
+        return;
+    }
+
+    if (!GetFileInformationByHandle(handle, &info)) {
+        c->error = GetLastError();
+        CloseHandle(handle);
+        return;
+    }
+
+    if ((buf = malloc(LIST_SIZE)) == NULL) {
+        InterlockedExchange(&du->nomem, 1);
+        CloseHandle(handle);
+        return;
+    }
+
+    while (GetFileInformationByHandleEx(handle, FileIdBothDirectoryInfo, buf, LIST_SIZE)) {
+        for (entry = (FILE_ID_BOTH_DIR_INFO *)buf; ;
+             entry = (FILE_ID_BOTH_DIR_INFO *)((unsigned char *)entry + entry->NextEntryOffset))
+        {
+            len = entry->FileNameLength / sizeof(wchar_t);
+
+            /* For reparse points EaSize holds the tag. Links and junctions are
+             * never followed; compressed, deduplicated and cloud files and
+             * directories are counted like any other. */
+            if ((entry->FileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+                IsReparseTagNameSurrogate(entry->EaSize))
+            {
+                /* skipped */
+            } else if (entry->FileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                if (!(len == 1 && entry->FileName[0] == L'.') &&
+                    !(len == 2 && entry->FileName[0] == L'.' && entry->FileName[1] == L'.') &&
+                    !add_child(c, entry->FileName, len))
+                {
+                    InterlockedExchange(&du->nomem, 1);
+                }
+            } else {
+                InterlockedIncrement64(&du->names);
+
+                if (!add_file(du, info.dwVolumeSerialNumber, (uint64_t)entry->FileId.QuadPart, dir,
+                              (uint64_t)entry->EndOfFile.QuadPart,
+                              (uint64_t)entry->AllocationSize.QuadPart))
+                {
+                    InterlockedExchange(&du->nomem, 1);
+                }
+            }
+
+            if (entry->NextEntryOffset == 0) break;
+        }
+    }
+
+    if (GetLastError() != ERROR_NO_MORE_FILES) {
+        c->error = GetLastError();
+    }
+
+    free(buf);
+    CloseHandle(handle);
+}
+
+static BOOL add_dir(DU *du, const wchar_t *parent, size_t parentlen,
+                    const wchar_t *name, size_t namelen, size_t parent_index)
+{
+    DISK_USAGE_DIR *p;
+    wchar_t *path;
+    size_t len = parentlen;
+    uint32_t id;
+
+    if (du->count == du->capacity) {
+        size_t n = du->capacity ? du->capacity * 2 : 256;
+
+        if ((p = realloc(du->dirs, n * sizeof(DISK_USAGE_DIR))) == NULL) {
+            return FALSE;
+        }
+
+        du->dirs = p;
+        du->capacity = n;
+    }
+
+    if ((path = malloc((parentlen + namelen + 2) * sizeof(wchar_t))) == NULL) {
+        return FALSE;
+    }
+
+    wmemcpy(path, parent, parentlen);
+
+    if (namelen > 0) {
+        if (len > 0 && path[len-1] != L'\\' && path[len-1] != L'/') {
+            path[len++] = L'\\';
+        }
+        wmemcpy(path + len, name, namelen);
+        len += namelen;
+    }
+
+    path[len] = 0;
+    id = strpool_intern(&du->pool, path, len);
+    free(path);
+
+    if (id == STRPOOL_NONE) {
+        return FALSE;
+    }
+
+    p = &du->dirs[du->count++];
+    memset(p, 0, sizeof(DISK_USAGE_DIR));
+    p->path = strpool_get(&du->pool, id);
+    p->parent = parent_index;
+
+    return TRUE;
+}
+
+static void free_du(DU *du)
+{
+    size_t i;
+
+    for (i = 0; i < SHARD_COUNT; i++) {
+        free(du->shards[i].slots);
+    }
+
+    strpool_free(&du->pool);
+    free(du->dirs);
+}
+
+DISK_USAGE *diskUsageW(const wchar_t *lpRootDir, unsigned int threads)
+{
+    DU du;
+    RESULT *result;
+    const wchar_t *p;
+    size_t i, j, end, files = 0;
+    uint64_t names;
+    DWORD err = 0;
+
+    memset(&du, 0, sizeof(du));
+
+    if (!lpRootDir || !*lpRootDir) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if (!strpool_init(&du.pool, FALSE)) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    for (i = 0; i < SHARD_COUNT; i++) {
+        InitializeSRWLock(&du.shards[i].lock);
+    }
+
+    if (!add_dir(&du, lpRootDir, wcslen(lpRootDir), NULL, 0, DISK_USAGE_NONE)) {
+        err = ERROR_NOT_ENOUGH_MEMORY;
+        goto error;
+    }
+
+    /* breadth-first, one level at a time; all directories of a level
+     * are listed in parallel and parents always come before children */
+    for (du.level = 0; du.level < du.count && !du.nomem; du.level = end) {
+        end = du.count;
+
+        if ((du.children = calloc(end - du.level, sizeof(CHILDREN))) == NULL) {
+            err = ERROR_NOT_ENOUGH_MEMORY;
+            goto error;
+        }
+
+        parallel_for(end - du.level, threads, scan_dir, &du);
+
+        /* the root could not be listed */
+        if (du.level == 0) {
+            err = du.children[0].error;
+        }
+
+        for (i = du.level; i < end; i++) {
+            CHILDREN *c = &du.children[i - du.level];
+
+            if (c->error != 0) du.failed++;
+
+            for (j = 0, p = c->buf; err == 0 && !du.nomem && j < c->count; j++) {
+                size_t len = wcslen(p);
+
+                /* 'dirs' may be moved by add_dir() */
+                if (!add_dir(&du, du.dirs[i].path, wcslen(du.dirs[i].path), p, len, i)) {
+                    du.nomem = 1;
+                }
+
+                p += len + 1;
+            }
+
+            free(c->buf);
+        }
+
+        free(du.children);
+        du.children = NULL;
+
+        if (err != 0) goto error;
+    }
+
+    if (du.nomem) {
+        err = ERROR_NOT_ENOUGH_MEMORY;
+        goto error;
+    }
+
+    /* merge the shards: each file is added to the directory that owns it */
+    for (i = 0; i < SHARD_COUNT; i++) {
+        for (j = 0; du.shards[i].slots && j <= du.shards[i].mask; j++) {
+            const FILE_SLOT *slot = &du.shards[i].slots[j];
+
+            if (slot->dir == NO_DIR) continue;
+
+            du.dirs[slot->dir].files++;
+            du.dirs[slot->dir].apparent += slot->apparent;
+            du.dirs[slot->dir].allocated += slot->allocated;
+            files++;
+        }
+    }
+
+    /* sum up the subdirectories; children always come after their parent */
+    for (i = du.count; i-- > 1; ) {
+        DISK_USAGE_DIR *d = &du.dirs[du.dirs[i].parent];
+
+        d->files += du.dirs[i].files;
+        d->apparent += du.dirs[i].apparent;
+        d->allocated += du.dirs[i].allocated;
+    }
+
+    if ((result = malloc(sizeof(RESULT))) == NULL) {
+        err = ERROR_NOT_ENOUGH_MEMORY;
+        goto error;
+    }
+
+    names = (uint64_t)du.names;
+
+    result->pool = du.pool;
+    result->pub.dirs = du.dirs;
+    result->pub.count = du.count;
+    result->pub.failed = du.failed;
+    result->pub.hardlinks = names - files;
+
+    for (i = 0; i < SHARD_COUNT; i++) {
+        free(du.shards[i].slots);
+    }
+
+    return &result->pub;
+
+error:
+    free_du(&du);
+    SetLastError(err);
+
+    return NULL;
+}
+
+DISK_USAGE *diskUsageA(const char *lpRootDir, unsigned int threads)
+{
+    DISK_USAGE *result;
+    wchar_t *wstr;
+
+    if ((wstr = convert_str_to_wcs(lpRootDir)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    result = diskUsageW(wstr, threads);
+    free(wstr);
+
+    return result;
+}
+
+void freeDiskUsage(DISK_USAGE *du)
+{
+    RESULT *result = (RESULT *)du;
+
+    if (!result) return;
+
+    strpool_free(&result->pool);
+    free((void *)result->pub.dirs);
+    free(result);
+}
@@ -26,58 +26,45 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "calltrace.h"
 #include "convert.h"
+#include "ntapi.h"
+#include "slice.h"
+#include "volmap.h"
 #include "w32-symlink.h"
 
-#ifndef GetFinalPathNameByHandle
-extern DWORD GetFinalPathNameByHandleW(HANDLE hFile, LPWSTR lpszFilePath, DWORD cchFilePath, DWORD dwFlags);
-#endif
+/* like Linux' MAXSYMLINKS */
+#define MAX_LX_HOPS  40
 
 
 /**
  * Result must be deallocated with free().
  */
-static wchar_t *canonical_path(const wchar_t *path)
+static wchar_t *canonical_path(const wchar_t *path, DWORD volume_name)
 {
-    wchar_t *buf = NULL;
+    wchar_t *buf;
     HANDLE handle;
-    DWORD len;
 
     const DWORD flags =
         FILE_NAME_NORMALIZED | /* Normalize the path. -> This is what we want! */
-        VOLUME_NAME_DOS;       /* Return path with drive letter (uses "\\?\" syntax). */
+        volume_name;           /* VOLUME_NAME_DOS returns the drive letter (uses "\\?\" syntax). */
 
     /* open for reading */
-    handle = CreateFileW(path,
-                         0,
-                         FILE_SHARE_READ | FILE_SHARE_WRITE,
-                         NULL,
-                         OPEN_EXISTING,
-                         FILE_FLAG_BACKUP_SEMANTICS,
-                         NULL);
+    handle = traced_CreateFileW(path,
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS);
 
     if (handle == INVALID_HANDLE_VALUE) {
         return NULL;
     }
 
-    /* figure out length */
-    len = GetFinalPathNameByHandleW(handle, NULL, 0, flags);
-
-    if (len > 0) {
-        buf = malloc((len + 1) * sizeof(wchar_t));
-
-        /* resolve path from handle */
-        if (buf && GetFinalPathNameByHandleW(handle, buf, len+1, flags) > 0) {
-            buf[len] = 0;
-            CloseHandle(handle);
-            return buf;
-        }
-    }
-
+    /* resolve path from handle */
+    buf = final_path_by_handle(handle, flags);
     CloseHandle(handle);
-    free(buf);
 
-    return NULL;
+    return buf;
 }
 
 /**
@@ -112,7 +99,47 @@ static BOOL is_absolute_path(const wchar_t *p)
     return FALSE;
 }
 
-char *getCanonicalPathA(const char *path)
+/**
+ * GetFinalPathNameByHandle cannot follow LXSS symlinks, so translate
+ * their targets until we reach something it can open.
+ * Takes ownership of 'link'. Result must be deallocated with free().
+ */
+static wchar_t *canonical_lx_path(const wchar_t *path, wchar_t *link, DWORD flags)
+{
+    wchar_t *current = NULL, *next, *buf = NULL;
+    ULONG tag = 0;
+    int hops;
+
+    for (hops = 0; hops < MAX_LX_HOPS; hops++) {
+        next = translateLxTargetW(current ? current : path, link);
+        free(link);
+        link = NULL;
+        free(current);
+
+        if ((current = next) == NULL ||
+            (buf = canonical_path(current, flags)) != NULL ||
+            (link = getLinkTargetW(current, &tag)) == NULL)
+        {
+            break;
+        }
+
+        if (tag != IO_REPARSE_TAG_LX_SYMLINK) {
+            SetLastError(ERROR_NOT_SUPPORTED);
+            break;
+        }
+    }
+
+    if (hops == MAX_LX_HOPS) {
+        SetLastError(ERROR_CANT_RESOLVE_FILENAME);
+    }
+
+    free(link);
+    free(current);
+
+    return buf;
+}
+
+char *getCanonicalPathExA(const char *path, DWORD flags)
 {
     wchar_t *wcs_in, *wcs_out;
     char *buf;
@@ -122,7 +149,7 @@ char *getCanonicalPathA(const char *path)
     if (!wcs_in) return NULL;
 
     /* call wide character function */
-    wcs_out = getCanonicalPathW(wcs_in);
+    wcs_out = getCanonicalPathExW(wcs_in, flags);
     free(wcs_in);
     if (!wcs_out) return NULL;
 
@@ -133,15 +160,13 @@ char *getCanonicalPathA(const char *path)
     return buf;
 }
 
-/**
- * Result must be deallocated with free().
- */
-wchar_t *getCanonicalPathW(const wchar_t *path)
+static wchar_t *resolve_path(const wchar_t *path, DWORD flags)
 {
     wchar_t *buf, *link;
     ULONG tag = 0;
 
-    buf = canonical_path(path);
+    /* CANONICAL_PATH_* are the VOLUME_NAME_* values */
+    buf = canonical_path(path, flags);
     if (buf) return buf;
 
     /* canonical_path() has failed.
@@ -149,11 +174,8 @@ wchar_t *getCanonicalPathW(const wchar_t *path)
     link = getLinkTargetW(path, (ULONG *)&tag);
     if (!link) return NULL;
 
-    /* We cannot reliably resolve LXSS symlinks to their Windows counterparts
-     * using GetFinalPathNameByHandle. */
     if (tag == IO_REPARSE_TAG_LX_SYMLINK) {
-        SetLastError(ERROR_NOT_SUPPORTED);
-        return NULL;
+        return canonical_lx_path(path, link, flags);
     }
 
     /* Try again with the link target.
@@ -161,7 +183,7 @@ wchar_t *getCanonicalPathW(const wchar_t *path)
      * To prevent an erronous canonicalization we should only do a second
      * attempt on an absolute path. */
     if (is_absolute_path(link)) {
-        buf = canonical_path(link);
+        buf = canonical_path(link, flags);
     } else {
         /* buf is still set to NULL */
         SetLastError(ERROR_NOT_SUPPORTED);
@@ -171,3 +193,82 @@ wchar_t *getCanonicalPathW(const wchar_t *path)
 
     return buf;
 }
+
+/**
+ * Result must be deallocated with free().
+ */
+wchar_t *getCanonicalPathExW(const wchar_t *path, DWORD flags)
+{
+    LONGLONG call;
+    wchar_t *buf;
+
+    if (!path || (flags & ~(DWORD)(CANONICAL_PATH_GUID | CANONICAL_PATH_NT)) ||
+        flags == (CANONICAL_PATH_GUID | CANONICAL_PATH_NT))
+    {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    call = traced_enter(TRACE_API_CANONICAL_PATH, flags, path, wcslen(path));
+    buf = resolve_path(path, flags);
+    traced_leave(call, buf == NULL);
+
+    return buf;
+}
+
+char *getCanonicalPathA(const char *path)
+{
+    return getCanonicalPathExA(path, CANONICAL_PATH_DOS);
+}
+
+wchar_t *getCanonicalPathW(const wchar_t *path)
+{
+    return getCanonicalPathExW(path, CANONICAL_PATH_DOS);
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+wchar_t *getCanonicalPathExNW(const wchar_t *path, size_t len, DWORD flags)
+{
+    wchar_t *buf = NULL;
+    PATH_SLICE s;
+
+    if (slice_init(&s, path, len)) {
+        buf = s.ntname ? nt_canonical_path(s.ntname, s.ntlen, flags)
+                       : getCanonicalPathExW(s.path, flags);
+    }
+    slice_free(&s);
+
+    return buf;
+}
+
+char *getCanonicalPathExNA(const char *path, size_t len, DWORD flags)
+{
+    wchar_t *wcs_out = NULL;
+    char *buf = NULL;
+    PATH_SLICE s;
+
+    if (slice_init_a(&s, path, len)) {
+        wcs_out = s.ntname ? nt_canonical_path(s.ntname, s.ntlen, flags)
+                           : getCanonicalPathExW(s.path, flags);
+    }
+    slice_free(&s);
+
+    if (wcs_out) {
+        buf = convert_wcs_to_str(wcs_out);
+        free(wcs_out);
+    }
+
+    return buf;
+}
+
+char *getCanonicalPathNA(const char *path, size_t len)
+{
+    return getCanonicalPathExNA(path, len, CANONICAL_PATH_DOS);
+}
+
+wchar_t *getCanonicalPathNW(const wchar_t *path, size_t len)
+{
+    return getCanonicalPathExNW(path, len, CANONICAL_PATH_DOS);
+}
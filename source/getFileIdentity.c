@@ -0,0 +1,237 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <errno.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "calltrace.h"
+#include "convert.h"
+#include "identity.h"
+#include "winerr.h"
+#include "w32-symlink.h"
+
+
+BOOL handle_identity(HANDLE handle, FILE_IDENTITY *id)
+{
+    BY_HANDLE_FILE_INFORMATION info;
+    FILE_ID_INFO idInfo;
+
+    if (traced_GetFileInformationByHandleEx(handle, FileIdInfo, &idInfo, sizeof(idInfo))) {
+        id->volume = idInfo.VolumeSerialNumber;
+        id->file_id = idInfo.FileId;
+        return TRUE;
+    }
+
+    /* FileIdInfo requires Windows 8 or later; fall back to the 64 bit index */
+    if (!GetFileInformationByHandle(handle, &info)) {
+        return FALSE;
+    }
+
+    id->volume = info.dwVolumeSerialNumber;
+    memset(&id->file_id, 0, sizeof(id->file_id));
+    memcpy(id->file_id.Identifier, &info.nFileIndexLow, sizeof(DWORD));
+    memcpy(id->file_id.Identifier + sizeof(DWORD), &info.nFileIndexHigh, sizeof(DWORD));
+
+    return TRUE;
+}
+
+/* _ino_t only has 16 bits */
+static _ino_t fold_file_id(const FILE_IDENTITY *id)
+{
+    _ino_t ino = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(id->file_id.Identifier); i += sizeof(_ino_t)) {
+        _ino_t part;
+        memcpy(&part, id->file_id.Identifier + i, sizeof(_ino_t));
+        ino ^= part;
+    }
+
+    return ino;
+}
+
+void set_stat_identity(struct _stat64 *statbuf, const FILE_IDENTITY *id)
+{
+
+    statbuf->st_dev = (_dev_t)id->volume;
+    statbuf->st_ino = fold_file_id(id);
+}
+
+static BOOL path_identity(const wchar_t *path, BOOL follow, FILE_IDENTITY *id)
+{
+    HANDLE handle;
+    DWORD err;
+    BOOL ret;
+
+    /* no access rights are needed for the file ID */
+    handle = traced_CreateFileW(path,
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS | (follow ? 0 : FILE_FLAG_OPEN_REPARSE_POINT));
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    ret = handle_identity(handle, id);
+    err = GetLastError();
+    CloseHandle(handle);
+    SetLastError(err);
+
+    return ret;
+}
+
+/* fill statbuf from an open handle and close it */
+int stat_handle(HANDLE handle, struct _stat64 *statbuf)
+{
+    FILE_IDENTITY id;
+    BOOL hasId;
+    int fd, errsav, rv;
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    /* _fstat64() leaves st_ino at 0 */
+    hasId = handle_identity(handle, &id);
+
+    /* get file descriptor from handle */
+    fd = _open_osfhandle((intptr_t)handle, _O_RDONLY);
+
+    if (fd == -1) {
+        CloseHandle(handle);
+        errno = EBADF; /* Bad file descriptor */
+        return -1;
+    }
+
+    /* get status information */
+    rv = _fstat64(fd, statbuf);
+
+    if (rv == 0 && hasId) {
+        set_stat_identity(statbuf, &id);
+    }
+
+    /* don't call CloseHandle()! */
+    errsav = errno;
+    _close(fd);
+    errno = errsav;
+
+    return rv;
+}
+
+int wstat64_identity(const wchar_t *path, struct _stat64 *statbuf)
+{
+    FILE_IDENTITY id;
+
+    /* _fstat64() would lose _S_IEXEC, which depends on the file name,
+     * and the drive number in st_dev */
+    if (_wstat64(path, statbuf) != 0) {
+        return -1;
+    }
+
+    /* the stat data is still valid without it */
+    if (path_identity(path, TRUE, &id)) {
+        statbuf->st_ino = fold_file_id(&id);
+    }
+
+    return 0;
+}
+
+BOOL getFileIdentityW(const wchar_t *lpFileName, BOOL follow, FILE_IDENTITY *pIdentity)
+{
+    if (!lpFileName || !*lpFileName || !pIdentity) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    return path_identity(lpFileName, follow, pIdentity);
+}
+
+BOOL getFileIdentityA(const char *lpFileName, BOOL follow, FILE_IDENTITY *pIdentity)
+{
+    wchar_t *wstr;
+    BOOL ret;
+
+    if ((wstr = convert_str_to_wcs(lpFileName)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = getFileIdentityW(wstr, follow, pIdentity);
+    free(wstr);
+
+    return ret;
+}
+
+int _wequivalent(const wchar_t *path1, const wchar_t *path2)
+{
+    FILE_IDENTITY id1, id2;
+
+    if (!path1 || !*path1 || !path2 || !*path2) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (!path_identity(path1, TRUE, &id1) || !path_identity(path2, TRUE, &id2)) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    return (id1.volume == id2.volume &&
+            memcmp(&id1.file_id, &id2.file_id, sizeof(FILE_ID_128)) == 0) ? 1 : 0;
+}
+
+int equivalent(const char *path1, const char *path2)
+{
+    wchar_t *wcs_path1, *wcs_path2;
+    int rv;
+
+    if (!path1 || !*path1 || !path2 || !*path2) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    wcs_path1 = convert_str_to_wcs(path1);
+    wcs_path2 = convert_str_to_wcs(path2);
+
+    if (!wcs_path1 || !wcs_path2) {
+        free(wcs_path1);
+        free(wcs_path2);
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    rv = _wequivalent(wcs_path1, wcs_path2);
+    free(wcs_path1);
+    free(wcs_path2);
+
+    return rv;
+}
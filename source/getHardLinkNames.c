@@ -0,0 +1,368 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "strpool.h"
+#include "workers.h"
+#include "w32-symlink.h"
+
+
+/* names collected by one batch worker, separated by NUL characters */
+typedef struct {
+    wchar_t *buf;
+    size_t   len;
+    size_t   size;
+    size_t   count;
+    DWORD    error;
+} NAME_LIST;
+
+typedef struct {
+    HARD_LINK_NAMES  pub;
+    STRPOOL          pool;
+    size_t          *first;
+    const wchar_t  **names;
+    DWORD           *error;
+} BATCH;
+
+typedef struct {
+    const wchar_t * const *paths;
+    NAME_LIST             *lists;
+} BATCH_CTX;
+
+
+/* get the mount point of the file's volume without the trailing separator */
+static wchar_t *volume_root(const wchar_t *path, size_t *plen)
+{
+    DWORD size = (DWORD)wcslen(path) + MAX_PATH;
+    wchar_t *buf;
+    size_t len;
+
+    if ((buf = malloc(size * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if (!GetVolumePathNameW(path, buf, size)) {
+        free(buf);
+        return NULL;
+    }
+
+    /* the names all begin with a separator */
+    len = wcslen(buf);
+    if (len > 0 && buf[len-1] == L'\\') buf[--len] = 0;
+
+    *plen = len;
+
+    return buf;
+}
+
+static BOOL enum_names(const wchar_t *path, HARD_LINK_FUNC func, void *ctx)
+{
+    wchar_t *root, *buf, *p;
+    size_t rootlen;
+    DWORD size = MAX_PATH, len, err = 0;
+    HANDLE hFind;
+
+    if ((root = volume_root(path, &rootlen)) == NULL) {
+        return FALSE;
+    }
+
+    if ((buf = malloc((rootlen + size) * sizeof(wchar_t))) == NULL) {
+        free(root);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    wmemcpy(buf, root, rootlen);
+    free(root);
+
+    /* the names are written behind the volume root */
+    len = size;
+    hFind = FindFirstFileNameW(path, 0, &len, buf + rootlen);
+
+    while (hFind == INVALID_HANDLE_VALUE && GetLastError() == ERROR_MORE_DATA) {
+        size = len;
+
+        if ((p = realloc(buf, (rootlen + size) * sizeof(wchar_t))) == NULL) {
+            free(buf);
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return FALSE;
+        }
+
+        buf = p;
+        hFind = FindFirstFileNameW(path, 0, &len, buf + rootlen);
+    }
+
+    if (hFind == INVALID_HANDLE_VALUE) {
+        err = GetLastError();
+        free(buf);
+        SetLastError(err);
+        return FALSE;
+    }
+
+    for (;;) {
+        if (!func(ctx, buf)) {
+            break;
+        }
+
+        len = size;
+
+        if (FindNextFileNameW(hFind, &len, buf + rootlen)) {
+            continue;
+        }
+
+        if ((err = GetLastError()) == ERROR_MORE_DATA) {
+            size = len;
+
+            if ((p = realloc(buf, (rootlen + size) * sizeof(wchar_t))) == NULL) {
+                err = ERROR_NOT_ENOUGH_MEMORY;
+                break;
+            }
+
+            buf = p;
+
+            if (FindNextFileNameW(hFind, &len, buf + rootlen)) {
+                err = 0;
+                continue;
+            }
+
+            err = GetLastError();
+        }
+
+        if (err == ERROR_HANDLE_EOF) {
+            err = 0;
+        }
+
+        break;
+    }
+
+    FindClose(hFind);
+    free(buf);
+
+    if (err != 0) {
+        SetLastError(err);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL getHardLinkNamesW(const wchar_t *lpFileName, HARD_LINK_FUNC func, void *ctx)
+{
+    if (!lpFileName || !*lpFileName || !func) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    return enum_names(lpFileName, func, ctx);
+}
+
+BOOL getHardLinkNamesA(const char *lpFileName, HARD_LINK_FUNC func, void *ctx)
+{
+    wchar_t *wstr;
+    BOOL ret;
+
+    if ((wstr = convert_str_to_wcs(lpFileName)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = getHardLinkNamesW(wstr, func, ctx);
+    free(wstr);
+
+    return ret;
+}
+
+static BOOL append_name(void *ctx, const wchar_t *name)
+{
+    NAME_LIST *list = (NAME_LIST *)ctx;
+    size_t len = wcslen(name) + 1;
+    size_t n;
+    wchar_t *p;
+
+    if (list->len + len > list->size) {
+        n = list->size ? list->size * 2 : 512;
+        while (n < list->len + len) n *= 2;
+
+        if ((p = realloc(list->buf, n * sizeof(wchar_t))) == NULL) {
+            list->error = ERROR_NOT_ENOUGH_MEMORY;
+            return FALSE;
+        }
+
+        list->buf = p;
+        list->size = n;
+    }
+
+    wmemcpy(list->buf + list->len, name, len);
+    list->len += len;
+    list->count++;
+
+    return TRUE;
+}
+
+static void collect_names(void *ctx, size_t index)
+{
+    BATCH_CTX *b = (BATCH_CTX *)ctx;
+    NAME_LIST *list = &b->lists[index];
+
+    if (!b->paths[index] || !*b->paths[index]) {
+        list->error = ERROR_INVALID_PARAMETER;
+    } else if (!enum_names(b->paths[index], append_name, list) && list->error == 0) {
+        list->error = GetLastError();
+    }
+
+    if (list->error != 0) {
+        list->count = 0;
+    }
+}
+
+HARD_LINK_NAMES *getHardLinkNamesBatchW(const wchar_t * const *paths, size_t count,
+                                        unsigned int threads)
+{
+    BATCH_CTX ctx;
+    BATCH *b;
+    const wchar_t *p;
+    size_t i, j, total = 0;
+    uint32_t id;
+    BOOL nomem = FALSE;
+
+    if (!paths && count > 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if ((b = calloc(1, sizeof(BATCH))) == NULL ||
+        (ctx.lists = calloc(count + 1, sizeof(NAME_LIST))) == NULL ||
+        (b->first = malloc((count + 1) * sizeof(size_t))) == NULL ||
+        (b->error = malloc((count + 1) * sizeof(DWORD))) == NULL ||
+        !strpool_init(&b->pool, FALSE))
+    {
+        if (b) {
+            free(b->first);
+            free(b->error);
+            free(ctx.lists);
+            free(b);
+        }
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    ctx.paths = paths;
+
+    if (count > 0) {
+        parallel_for(count, threads, collect_names, &ctx);
+    }
+
+    for (i = 0; i < count; i++) {
+        total += ctx.lists[i].count;
+    }
+
+    if ((b->names = malloc((total + 1) * sizeof(wchar_t *))) == NULL) {
+        nomem = TRUE;
+    }
+
+    /* Intern the names, so siblings share their strings. The system spells
+     * a name the same for every link of a file; comparing case-sensitively
+     * keeps "A" and "a" apart in case-sensitive directories. */
+    for (i = 0, total = 0; i < count; i++) {
+        b->first[i] = total;
+        b->error[i] = ctx.lists[i].error;
+
+        for (j = 0, p = ctx.lists[i].buf; !nomem && j < ctx.lists[i].count; j++) {
+            if ((id = strpool_intern(&b->pool, p, wcslen(p))) == STRPOOL_NONE) {
+                nomem = TRUE;
+                break;
+            }
+
+            b->names[total++] = strpool_get(&b->pool, id);
+            p += wcslen(p) + 1;
+        }
+
+        free(ctx.lists[i].buf);
+    }
+
+    b->first[count] = total;
+    free(ctx.lists);
+
+    if (nomem) {
+        freeHardLinkNames(&b->pub);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    b->pub.count = count;
+    b->pub.first = b->first;
+    b->pub.names = b->names;
+    b->pub.error = b->error;
+
+    return &b->pub;
+}
+
+HARD_LINK_NAMES *getHardLinkNamesBatchA(const char * const *paths, size_t count,
+                                        unsigned int threads)
+{
+    HARD_LINK_NAMES *result;
+    wchar_t **wpaths;
+    size_t i;
+
+    if (!paths && count > 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if ((wpaths = calloc(count + 1, sizeof(wchar_t *))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    /* invalid strings are reported per file */
+    for (i = 0; i < count; i++) {
+        wpaths[i] = paths[i] ? convert_str_to_wcs(paths[i]) : NULL;
+    }
+
+    result = getHardLinkNamesBatchW((const wchar_t * const *)wpaths, count, threads);
+
+    for (i = 0; i < count; i++) {
+        free(wpaths[i]);
+    }
+    free(wpaths);
+
+    return result;
+}
+
+void freeHardLinkNames(HARD_LINK_NAMES *names)
+{
+    BATCH *b = (BATCH *)names;
+
+    if (!b) return;
+
+    strpool_free(&b->pool);
+    free(b->first);
+    free(b->names);
+    free(b->error);
+    free(b);
+}
@@ -26,8 +26,13 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
+#include "calltrace.h"
 #include "convert.h"
 #include "reparse_data_buffer.h"
+#include "reparse_decode.h"
+#include "linktarget.h"
+#include "ntapi.h"
+#include "slice.h"
 #include "w32-symlink.h"
 
 /* https://learn.microsoft.com/en-us/openspecs/windows_protocols/ms-fscc/ff4df658-7f27-476a-8025-4074c0121eec */
@@ -41,7 +46,7 @@ typedef struct {
 } LINK_TARGET;
 
 
-static BOOL get_link_target(const wchar_t *path, LINK_TARGET *ltarget)
+static BOOL read_link_target(const wchar_t *path, LINK_TARGET *ltarget)
 {
     uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
     uint8_t *pDataEnd;
@@ -79,28 +84,18 @@ static BOOL get_link_target(const wchar_t *path, LINK_TARGET *ltarget)
     }
 
     /* open path for reading */
-    handle = CreateFileW(path,
-                         0,
-                         FILE_SHARE_READ | FILE_SHARE_WRITE,
-                         NULL,
-                         OPEN_EXISTING,
-                         FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS,
-                         NULL);
+    handle = traced_CreateFileW(path,
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
 
     if (handle == INVALID_HANDLE_VALUE) {
         return FALSE;
     }
 
     /* retrieve reparse data */
-    if (!DeviceIoControl(handle,
-                         FSCTL_GET_REPARSE_POINT,
-                         NULL,
-                         0,
-                         data,
-                         MAXIMUM_REPARSE_DATA_BUFFER_SIZE,
-                         NULL,
-                         NULL))
-    {
+    if (!traced_get_reparse_point(handle, data, MAXIMUM_REPARSE_DATA_BUFFER_SIZE, NULL)) {
         CloseHandle(handle);
         return FALSE;
     }
@@ -222,6 +217,18 @@ static BOOL get_link_target(const wchar_t *path, LINK_TARGET *ltarget)
     return TRUE;
 }
 
+static BOOL get_link_target(const wchar_t *path, LINK_TARGET *ltarget)
+{
+    LONGLONG call;
+    BOOL ok;
+
+    call = traced_enter(TRACE_API_LINK_TARGET, 0, path, path ? wcslen(path) : 0);
+    ok = read_link_target(path, ltarget);
+    traced_leave(call, !ok);
+
+    return ok;
+}
+
 char *getLinkTargetA(const char *path, ULONG *tag)
 {
     LINK_TARGET ltarget = { 0, NULL, NULL };
@@ -270,3 +277,183 @@ wchar_t *getLinkTargetW(const wchar_t *path, ULONG *tag)
 
     return wstr;
 }
+
+BOOL decode_link_view(const void *buffer, DWORD size, LINK_TARGET_VIEW *pView)
+{
+    REPARSE_VIEW view;
+
+    switch (reparse_decode((const uint8_t *)buffer, size, &view))
+    {
+    case REPARSE_DECODE_OK:
+        break;
+
+    case REPARSE_DECODE_NOLINK:
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return FALSE;
+
+    default:
+        SetLastError(ERROR_INVALID_REPARSE_DATA);
+        return FALSE;
+    }
+
+    pView->tag = view.tag;
+    pView->flags = view.flags;
+    pView->utf8 = view.utf8 ? TRUE : FALSE;
+    pView->subst_off = view.subst_off;
+    pView->subst_len = view.subst_len;
+    pView->print_off = view.print_off;
+    pView->print_len = view.print_len;
+    pView->target_off = view.target_off;
+    pView->target_len = view.target_len;
+    pView->norm_off = view.norm_off;
+    pView->norm_len = view.norm_len;
+
+    return TRUE;
+}
+
+wchar_t *copy_link_target(const void *buffer, const LINK_TARGET_VIEW *pView)
+{
+    const char *str = (const char *)buffer + pView->target_off;
+    wchar_t *buf;
+    int len;
+
+    if (pView->utf8) {
+        /* Linux links */
+        len = MultiByteToWideChar(CP_UTF8, 0, str, (int)pView->target_len, NULL, 0);
+
+        if (len < 1) {
+            SetLastError(ERROR_INVALID_REPARSE_DATA);
+            return NULL;
+        }
+
+        if ((buf = malloc((len + 1) * sizeof(wchar_t))) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return NULL;
+        }
+
+        MultiByteToWideChar(CP_UTF8, 0, str, (int)pView->target_len, buf, len);
+        buf[len] = 0;
+
+        return buf;
+    }
+
+    if ((buf = malloc((pView->target_len + 1) * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    memcpy(buf, str, pView->target_len * sizeof(wchar_t));
+    buf[pView->target_len] = 0;
+
+    return buf;
+}
+
+static BOOL link_target_view(const wchar_t *path, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView)
+{
+    HANDLE handle;
+    DWORD size = 0;
+
+    /* open path for reading; no isSymlinkW() check, a regular file
+     * makes FSCTL_GET_REPARSE_POINT fail anyway */
+    handle = traced_CreateFileW(path,
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    /* retrieve reparse data directly into the caller's buffer */
+    if (!traced_get_reparse_point(handle, buffer, bufsize, &size)) {
+        if (GetLastError() == ERROR_NOT_A_REPARSE_POINT) {
+            SetLastError(ERROR_NOT_SUPPORTED);
+        }
+        CloseHandle(handle);
+        return FALSE;
+    }
+
+    CloseHandle(handle);
+
+    return decode_link_view(buffer, size, pView);
+}
+
+BOOL getLinkTargetViewW(const wchar_t *path, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView)
+{
+    LONGLONG call;
+    BOOL ok;
+
+    if (!path || !buffer || !pView) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    call = traced_enter(TRACE_API_LINK_TARGET_VIEW, 0, path, wcslen(path));
+    ok = link_target_view(path, buffer, bufsize, pView);
+    traced_leave(call, !ok);
+
+    return ok;
+}
+
+BOOL getLinkTargetViewA(const char *path, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView)
+{
+    wchar_t wbuf[MAX_PATH];
+    wchar_t *wstr;
+    size_t n;
+    BOOL ret;
+
+    if (!path) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    /* short paths are converted on the stack */
+    if (mbstowcs_s(&n, wbuf, MAX_PATH, path, _TRUNCATE) == 0) {
+        return getLinkTargetViewW(wbuf, buffer, bufsize, pView);
+    }
+
+    if ((wstr = convert_str_to_wcs(path)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = getLinkTargetViewW(wstr, buffer, bufsize, pView);
+    free(wstr);
+
+    return ret;
+}
+
+wchar_t *getLinkTargetNW(const wchar_t *path, size_t len, ULONG *tag)
+{
+    PATH_SLICE s;
+    wchar_t *wstr = NULL;
+
+    if (slice_init(&s, path, len)) {
+        wstr = s.ntname ? nt_link_target(s.ntname, s.ntlen, tag)
+                        : getLinkTargetW(s.path, tag);
+    }
+    slice_free(&s);
+
+    return wstr;
+}
+
+char *getLinkTargetNA(const char *path, size_t len, ULONG *tag)
+{
+    wchar_t *wstr = NULL;
+    char *str = NULL;
+    PATH_SLICE s;
+
+    if (slice_init_a(&s, path, len)) {
+        wstr = s.ntname ? nt_link_target(s.ntname, s.ntlen, tag)
+                        : getLinkTargetW(s.path, tag);
+    }
+    slice_free(&s);
+
+    if (wstr) {
+        str = convert_wcs_to_str(wstr);
+        free(wstr);
+    }
+
+    return str;
+}
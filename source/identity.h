@@ -0,0 +1,60 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_IDENTITY_H_INCLUDED
+#define W32_SYMLINK_IDENTITY_H_INCLUDED
+
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "w32-symlink.h"
+
+
+/**
+ * Get the volume serial number and file ID of an open handle.
+ */
+BOOL handle_identity(HANDLE handle, FILE_IDENTITY *id);
+
+
+/**
+ * Set st_dev to the volume serial number and st_ino to the file ID,
+ * folded to the size of _ino_t.
+ */
+void set_stat_identity(struct _stat64 *statbuf, const FILE_IDENTITY *id);
+
+
+/**
+ * Fill 'statbuf' from an open handle, st_dev and st_ino included, and
+ * close the handle. Sets errno on failure, also if 'handle' is
+ * INVALID_HANDLE_VALUE.
+ */
+int stat_handle(HANDLE handle, struct _stat64 *statbuf);
+
+
+/**
+ * _wstat64() with st_ino set from the file ID; everything else, st_dev
+ * included, is left as _wstat64() returns it.
+ */
+int wstat64_identity(const wchar_t *path, struct _stat64 *statbuf);
+
+#endif /* W32_SYMLINK_IDENTITY_H_INCLUDED */
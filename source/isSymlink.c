@@ -24,12 +24,15 @@
 #include <windows.h>
 #include <wchar.h>
 #include <inttypes.h>
+#include "calltrace.h"
 #include "convert.h"
+#include "ntapi.h"
 #include "reparse_data_buffer.h"
+#include "slice.h"
 #include "w32-symlink.h"
 
 
-int isSymlinkW(const wchar_t *path, ULONG *tag)
+static int is_symlink(const wchar_t *path, ULONG *tag)
 {
     uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
     REPARSE_DATA_BUFFER *pData;
@@ -41,7 +44,7 @@ int isSymlinkW(const wchar_t *path, ULONG *tag)
         *tag = 0;
     }
 
-    dwAttr = GetFileAttributesW(path);
+    dwAttr = traced_GetFileAttributesW(path);
 
     if (dwAttr == INVALID_FILE_ATTRIBUTES) {
         /* error */
@@ -60,28 +63,18 @@ int isSymlinkW(const wchar_t *path, ULONG *tag)
     }
 
     /* open path for reading */
-    handle = CreateFileW(path,
-                         0,
-                         FILE_SHARE_READ | FILE_SHARE_WRITE,
-                         NULL,
-                         OPEN_EXISTING,
-                         FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS,
-                         NULL);
+    handle = traced_CreateFileW(path,
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
 
     if (handle == INVALID_HANDLE_VALUE) {
         return -1;
     }
 
     /* retrieve reparse data */
-    if (!DeviceIoControl(handle,
-                         FSCTL_GET_REPARSE_POINT,
-                         NULL,
-                         0,
-                         data,
-                         MAXIMUM_REPARSE_DATA_BUFFER_SIZE,
-                         NULL,
-                         NULL))
-    {
+    if (!traced_get_reparse_point(handle, data, MAXIMUM_REPARSE_DATA_BUFFER_SIZE, NULL)) {
         CloseHandle(handle);
         return -1;
     }
@@ -110,6 +103,18 @@ int isSymlinkW(const wchar_t *path, ULONG *tag)
     return FALSE;
 }
 
+int isSymlinkW(const wchar_t *path, ULONG *tag)
+{
+    LONGLONG call;
+    int rv;
+
+    call = traced_enter(TRACE_API_IS_SYMLINK, tag ? TRACE_FLAG_TAG : 0, path, path ? wcslen(path) : 0);
+    rv = is_symlink(path, tag);
+    traced_leave(call, rv == -1);
+
+    return rv;
+}
+
 
 int isSymlinkA(const char *path, ULONG *tag)
 {
@@ -124,3 +129,40 @@ int isSymlinkA(const char *path, ULONG *tag)
 
     return rv;
 }
+
+int isSymlinkNW(const wchar_t *path, size_t len, ULONG *tag)
+{
+    PATH_SLICE s;
+    int rv = -1;
+
+    if (tag) {
+        *tag = 0;
+    }
+
+    if (slice_init(&s, path, len)) {
+        rv = s.ntname ? nt_is_symlink(s.ntname, s.ntlen, tag)
+                      : isSymlinkW(s.path, tag);
+    }
+    slice_free(&s);
+
+    return rv;
+}
+
+
+int isSymlinkNA(const char *path, size_t len, ULONG *tag)
+{
+    PATH_SLICE s;
+    int rv = -1;
+
+    if (tag) {
+        *tag = 0;
+    }
+
+    if (slice_init_a(&s, path, len)) {
+        rv = s.ntname ? nt_is_symlink(s.ntname, s.ntlen, tag)
+                      : isSymlinkW(s.path, tag);
+    }
+    slice_free(&s);
+
+    return rv;
+}
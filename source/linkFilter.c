@@ -0,0 +1,493 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "convert.h"
+#include "identity.h"
+#include "strpool.h"
+#include "walk.h"
+#include "w32-symlink.h"
+
+#define BLOOM_HASHES      8
+#define BITS_PER_LINK     16
+#define MIN_BLOOM_LINKS   1024
+#define QUERY_BUFSIZE     1024  /* longer paths are not looked up */
+
+
+typedef struct {
+    int64_t  mtime;     /* last write time of the directory */
+    uint32_t links;     /* reparse points inside of the directory */
+    BOOL     valid;     /* FALSE if not (successfully) enumerated */
+} DIR_INFO;
+
+struct LINK_FILTER {
+    STRPOOL   dirs;         /* full directory paths without trailing separator */
+    DIR_INFO *info;         /* directory ID -> info */
+    size_t    capacity;
+    uint64_t *bloom;        /* NULL while building */
+    uint64_t  bloom_mask;   /* number of bits - 1 */
+    uint64_t *pending;      /* hashes collected while building */
+    size_t    pending_count;
+    size_t    pending_capacity;
+    BOOL      failed;
+};
+
+typedef struct {
+    LINK_FILTER *filter;
+    uint32_t id;
+} SCAN_CTX;
+
+
+static int64_t filetime_ticks(const FILETIME *ft)
+{
+    return (int64_t)(((uint64_t)ft->dwHighDateTime << 32) | ft->dwLowDateTime);
+}
+
+/* case-insensitive path hash, FNV-1a followed by a final mix
+ * because the Bloom filter uses the upper bits too */
+static uint64_t hash_path(const wchar_t *path, size_t len)
+{
+    uint64_t h = 14695981039346656037ull;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= (uint64_t)towupper(path[i]);
+        h *= 1099511628211ull;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+
+    return h;
+}
+
+static void bloom_set(LINK_FILTER *filter, uint64_t h)
+{
+    uint64_t h1 = h & 0xffffffff, h2 = (h >> 32) | 1, bit;
+    int i;
+
+    for (i = 0; i < BLOOM_HASHES; i++) {
+        bit = (h1 + i * h2) & filter->bloom_mask;
+        filter->bloom[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    }
+}
+
+static BOOL bloom_test(const LINK_FILTER *filter, uint64_t h)
+{
+    uint64_t h1 = h & 0xffffffff, h2 = (h >> 32) | 1, bit;
+    int i;
+
+    for (i = 0; i < BLOOM_HASHES; i++) {
+        bit = (h1 + i * h2) & filter->bloom_mask;
+        if (!(filter->bloom[bit >> 6] & ((uint64_t)1 << (bit & 63)))) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* size the Bloom filter for the links found while building */
+static BOOL bloom_create(LINK_FILTER *filter)
+{
+    uint64_t bits = 64;
+    uint64_t want = (uint64_t)(filter->pending_count * 2 + MIN_BLOOM_LINKS) * BITS_PER_LINK;
+    size_t i;
+
+    while (bits < want) {
+        bits <<= 1;
+    }
+
+    if ((filter->bloom = calloc((size_t)(bits / 64), sizeof(uint64_t))) == NULL) {
+        return FALSE;
+    }
+
+    filter->bloom_mask = bits - 1;
+
+    for (i = 0; i < filter->pending_count; i++) {
+        bloom_set(filter, filter->pending[i]);
+    }
+
+    free(filter->pending);
+    filter->pending = NULL;
+    filter->pending_count = filter->pending_capacity = 0;
+
+    return TRUE;
+}
+
+static BOOL add_link(LINK_FILTER *filter, const wchar_t *path, size_t len)
+{
+    uint64_t *p;
+    size_t n;
+
+    if (filter->bloom) {
+        bloom_set(filter, hash_path(path, len));
+        return TRUE;
+    }
+
+    if (filter->pending_count == filter->pending_capacity) {
+        n = filter->pending_capacity ? filter->pending_capacity * 2 : 256;
+        p = realloc(filter->pending, n * sizeof(uint64_t));
+        if (!p) return FALSE;
+
+        filter->pending = p;
+        filter->pending_capacity = n;
+    }
+
+    filter->pending[filter->pending_count++] = hash_path(path, len);
+
+    return TRUE;
+}
+
+/* returns the ID of the directory, adding it if needed */
+static uint32_t add_dir(LINK_FILTER *filter, const wchar_t *path, size_t len)
+{
+    DIR_INFO *p;
+    uint32_t count = filter->dirs.count;
+    uint32_t id;
+    size_t n;
+
+    if ((id = strpool_intern(&filter->dirs, path, len)) == STRPOOL_NONE) {
+        return STRPOOL_NONE;
+    }
+
+    if (id < count) {
+        return id;
+    }
+
+    if (id >= filter->capacity) {
+        n = filter->capacity ? filter->capacity * 2 : 1024;
+        p = realloc(filter->info, n * sizeof(DIR_INFO));
+        if (!p) return STRPOOL_NONE;
+
+        filter->info = p;
+        filter->capacity = n;
+    }
+
+    filter->info[id].mtime = 0;
+    filter->info[id].links = 0;
+    filter->info[id].valid = FALSE;
+
+    return id;
+}
+
+static int scan_entry(void *ctx, const WALK_ENTRY *entry)
+{
+    SCAN_CTX *scan = (SCAN_CTX *)ctx;
+    LINK_FILTER *filter = scan->filter;
+
+    if (entry->attributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+        filter->info[scan->id].links++;
+
+        if (!add_link(filter, entry->path, entry->path_len)) {
+            filter->failed = TRUE;
+            return WALK_STOP;
+        }
+    } else if (entry->attributes & FILE_ATTRIBUTE_DIRECTORY) {
+        /* new directories are enumerated later by scan_all() */
+        if (add_dir(filter, entry->path, entry->path_len) == STRPOOL_NONE) {
+            filter->failed = TRUE;
+            return WALK_STOP;
+        }
+    }
+
+    /* only a single directory is enumerated at a time */
+    return WALK_SKIP;
+}
+
+/* enumerate a single directory; it stays invalid if that's not possible */
+static BOOL scan_dir(LINK_FILTER *filter, uint32_t id)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    SCAN_CTX scan;
+
+    filter->info[id].valid = FALSE;
+    filter->info[id].links = 0;
+
+    /* take the time before enumerating, so changes made meanwhile
+     * are picked up by the next refresh */
+    if (!GetFileAttributesExW(strpool_get(&filter->dirs, id), GetFileExInfoStandard, &fad) ||
+        !(fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        return TRUE;
+    }
+
+    filter->info[id].mtime = filetime_ticks(&fad.ftLastWriteTime);
+
+    scan.filter = filter;
+    scan.id = id;
+
+    if (walk_tree(strpool_get(&filter->dirs, id), scan_entry, &scan)) {
+        filter->info[id].valid = TRUE;
+    }
+
+    return filter->failed ? FALSE : TRUE;
+}
+
+/* check all directories known so far and enumerate the changed and new ones */
+static BOOL scan_all(LINK_FILTER *filter)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    uint32_t id, known = filter->dirs.count;
+
+    /* directories added by scan_dir() are appended and visited by this loop */
+    for (id = 0; id < filter->dirs.count; id++) {
+        if (id < known && filter->info[id].valid &&
+            GetFileAttributesExW(strpool_get(&filter->dirs, id), GetFileExInfoStandard, &fad) &&
+            filetime_ticks(&fad.ftLastWriteTime) == filter->info[id].mtime)
+        {
+            continue;
+        }
+
+        if (!scan_dir(filter, id)) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* length of the full path of 'path' in 'buf' or 0 on error */
+static size_t full_path(const wchar_t *path, wchar_t *buf, size_t size)
+{
+    DWORD len = GetFullPathNameW(path, (DWORD)size, buf, NULL);
+
+    return (len == 0 || len >= size) ? 0 : len;
+}
+
+/* directories are stored without trailing separator,
+ * except for drive roots like "C:\" */
+static size_t dir_length(const wchar_t *path, size_t len)
+{
+    while (len > 1 && path[len-1] == L'\\' && path[len-2] != L':') {
+        len--;
+    }
+
+    return len;
+}
+
+/* whether 'path' is known not to be a reparse point */
+static BOOL known_no_link(const LINK_FILTER *filter, const wchar_t *path)
+{
+    wchar_t buf[QUERY_BUFSIZE];
+    size_t len, dirlen;
+    uint32_t id;
+
+    if ((len = full_path(path, buf, QUERY_BUFSIZE)) == 0) {
+        return FALSE;
+    }
+
+    if (buf[len-1] == L'\\') {
+        return FALSE;
+    }
+
+    for (dirlen = len; dirlen > 0 && buf[dirlen-1] != L'\\'; dirlen--)
+        ;
+
+    if (dirlen < 2) {
+        return FALSE;
+    }
+
+    /* the parent directory must have been enumerated */
+    id = strpool_find(&filter->dirs, buf, dir_length(buf, dirlen));
+
+    if (id == STRPOOL_NONE || !filter->info[id].valid) {
+        return FALSE;
+    }
+
+    if (filter->info[id].links == 0) {
+        return TRUE;
+    }
+
+    return bloom_test(filter, hash_path(buf, len)) ? FALSE : TRUE;
+}
+
+LINK_FILTER *linkFilterBuildW(const wchar_t *root)
+{
+    LINK_FILTER *filter;
+    wchar_t *buf;
+    size_t len;
+
+    if (!root || !*root) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if ((filter = calloc(1, sizeof(LINK_FILTER))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if (!strpool_init(&filter->dirs, TRUE)) {
+        free(filter);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if ((buf = malloc(MODERN_MAX_PATH * sizeof(wchar_t))) == NULL) {
+        linkFilterFree(filter);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if ((len = full_path(root, buf, MODERN_MAX_PATH)) == 0) {
+        free(buf);
+        linkFilterFree(filter);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if (add_dir(filter, buf, dir_length(buf, len)) == STRPOOL_NONE || !scan_all(filter) ||
+        !bloom_create(filter))
+    {
+        free(buf);
+        linkFilterFree(filter);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    free(buf);
+
+    if (!filter->info[0].valid) {
+        linkFilterFree(filter);
+        SetLastError(ERROR_PATH_NOT_FOUND);
+        return NULL;
+    }
+
+    return filter;
+}
+
+BOOL linkFilterRefresh(LINK_FILTER *filter)
+{
+    if (!filter) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!scan_all(filter)) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void linkFilterFree(LINK_FILTER *filter)
+{
+    if (!filter) return;
+
+    strpool_free(&filter->dirs);
+    free(filter->info);
+    free(filter->bloom);
+    free(filter->pending);
+    free(filter);
+}
+
+int linkFilterIsSymlinkW(const LINK_FILTER *filter, const wchar_t *path, ULONG *tag)
+{
+    if (!path) return -1;
+
+    if (filter && known_no_link(filter, path)) {
+        if (tag) *tag = 0;
+        return FALSE;
+    }
+
+    return isSymlinkW(path, tag);
+}
+
+int linkFilterLstat64W(const LINK_FILTER *filter, const wchar_t *path, struct _stat64 *statbuf)
+{
+    if (!path || !*path || !statbuf) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (filter && known_no_link(filter, path)) {
+        return wstat64_identity(path, statbuf);
+    }
+
+    return _lwstat64(path, statbuf);
+}
+
+LINK_FILTER *linkFilterBuildA(const char *root)
+{
+    LINK_FILTER *filter;
+    wchar_t *wcs_root;
+
+    if ((wcs_root = convert_str_to_wcs(root)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    filter = linkFilterBuildW(wcs_root);
+    free(wcs_root);
+
+    return filter;
+}
+
+int linkFilterIsSymlinkA(const LINK_FILTER *filter, const char *path, ULONG *tag)
+{
+    wchar_t *wcs_path;
+    int rv;
+
+    if ((wcs_path = convert_str_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    rv = linkFilterIsSymlinkW(filter, wcs_path, tag);
+    free(wcs_path);
+
+    return rv;
+}
+
+int linkFilterLstat64A(const LINK_FILTER *filter, const char *path, struct _stat64 *statbuf)
+{
+    wchar_t *wcs_path;
+    int rv;
+
+    if (!path || !*path || !statbuf) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((wcs_path = convert_str_to_wcs(path)) == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    rv = linkFilterLstat64W(filter, wcs_path, statbuf);
+    free(wcs_path);
+
+    return rv;
+}
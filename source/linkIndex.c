@@ -0,0 +1,1017 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "strpool.h"
+#include "walk.h"
+#include "w32-symlink.h"
+
+
+/**
+ * File layout (little endian):
+ *
+ *   INDEX_HEADER
+ *   root directory (root_len characters, padded to 8 bytes)
+ *   records, each followed by its path suffix and target
+ *   (padded to 8 bytes); every RESTART_INTERVAL records a new block
+ *   starts with a record that holds the full path (shared == 0)
+ *   block table: one uint64_t file offset per block
+ */
+
+#define INDEX_MAGIC       "W32LNKIX"
+#define INDEX_VERSION     1
+#define RESTART_INTERVAL  16
+
+#define ALIGN8(x)  (((x) + 7) & ~(size_t)7)
+
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t count;             /* number of records */
+    uint32_t block_count;
+    uint32_t root_len;          /* characters */
+    uint64_t blocks_offset;     /* offset of the block table */
+    uint64_t file_size;
+} INDEX_HEADER;
+
+typedef struct {
+    uint16_t shared;            /* characters shared with the previous path */
+    uint16_t suffix_len;        /* characters following this record */
+    uint16_t target_len;        /* characters following the suffix */
+    uint16_t reserved;
+    uint32_t tag;
+    uint32_t reserved2;
+    int64_t  mtime;
+    uint8_t  file_id[16];
+} INDEX_RECORD;
+
+struct LINK_INDEX {
+    HANDLE file;
+    HANDLE mapping;
+    const uint8_t *base;
+    size_t size;
+    const INDEX_HEADER *hdr;
+    const uint64_t *blocks;
+    const wchar_t *root;
+};
+
+typedef struct {
+    const wchar_t *path;
+    size_t path_len;
+    const wchar_t *target;
+    size_t target_len;
+    ULONG tag;
+    int64_t mtime;
+    FILE_ID_128 file_id;
+    void *owned;                /* allocation holding path and target */
+} BUILD_ENTRY;
+
+typedef struct {
+    BUILD_ENTRY *items;
+    size_t count;
+    size_t capacity;
+    BOOL failed;
+} ENTRY_LIST;
+
+
+/* ordinal, case-insensitive comparison */
+static int path_cmp(const wchar_t *a, size_t alen, const wchar_t *b, size_t blen)
+{
+    size_t i, n = (alen < blen) ? alen : blen;
+    wint_t ca, cb;
+
+    for (i = 0; i < n; i++) {
+        if (a[i] == b[i]) continue;
+
+        ca = towupper(a[i]);
+        cb = towupper(b[i]);
+        if (ca != cb) return (ca < cb) ? -1 : 1;
+    }
+
+    if (alen == blen) return 0;
+
+    return (alen < blen) ? -1 : 1;
+}
+
+static int entry_cmp(const void *p1, const void *p2)
+{
+    const BUILD_ENTRY *a = (const BUILD_ENTRY *)p1;
+    const BUILD_ENTRY *b = (const BUILD_ENTRY *)p2;
+
+    return path_cmp(a->path, a->path_len, b->path, b->path_len);
+}
+
+/**
+ * The one spelling of a path that is stored and compared: absolute, with
+ * backslashes, without "." and ".." and without a trailing separator
+ * (except after a drive). The result must be deallocated with free().
+ */
+static wchar_t *normalize_path(const wchar_t *path)
+{
+    wchar_t *buf;
+    DWORD len;
+
+    if ((len = GetFullPathNameW(path, 0, NULL, NULL)) == 0) {
+        return NULL;
+    }
+
+    if ((buf = malloc(len * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if ((len = GetFullPathNameW(path, len, buf, NULL)) == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    while (len > 1 && (buf[len-1] == L'\\' || buf[len-1] == L'/') && buf[len-2] != L':') {
+        buf[--len] = 0;
+    }
+
+    return buf;
+}
+
+static int64_t filetime_ticks(const FILETIME *ft)
+{
+    return (int64_t)(((uint64_t)ft->dwHighDateTime << 32) | ft->dwLowDateTime);
+}
+
+static void free_entries(ENTRY_LIST *list)
+{
+    size_t i;
+
+    for (i = 0; i < list->count; i++) {
+        free(list->items[i].owned);
+    }
+
+    free(list->items);
+    memset(list, 0, sizeof(ENTRY_LIST));
+}
+
+/* add an entry; path and target are copied */
+static BOOL add_entry(ENTRY_LIST *list, const wchar_t *path, size_t path_len,
+                      const wchar_t *target, size_t target_len,
+                      ULONG tag, int64_t mtime, const FILE_ID_128 *file_id)
+{
+    BUILD_ENTRY *p, *e;
+    wchar_t *buf;
+    size_t n;
+
+    if (path_len > MODERN_MAX_PATH || target_len > UINT16_MAX) {
+        /* doesn't fit into the record; leave it out */
+        return TRUE;
+    }
+
+    if (list->count == list->capacity) {
+        n = list->capacity ? list->capacity * 2 : 256;
+        if ((p = realloc(list->items, n * sizeof(BUILD_ENTRY))) == NULL) return FALSE;
+
+        list->items = p;
+        list->capacity = n;
+    }
+
+    if ((buf = malloc((path_len + target_len + 2) * sizeof(wchar_t))) == NULL) {
+        return FALSE;
+    }
+
+    wmemcpy(buf, path, path_len);
+    buf[path_len] = 0;
+    wmemcpy(buf + path_len + 1, target, target_len);
+    buf[path_len + 1 + target_len] = 0;
+
+    e = &list->items[list->count++];
+    e->path = buf;
+    e->path_len = path_len;
+    e->target = buf + path_len + 1;
+    e->target_len = target_len;
+    e->tag = tag;
+    e->mtime = mtime;
+    e->owned = buf;
+
+    if (file_id) {
+        e->file_id = *file_id;
+    } else {
+        memset(&e->file_id, 0, sizeof(FILE_ID_128));
+    }
+
+    return TRUE;
+}
+
+/* read a link from the file system; returns FALSE on memory errors only */
+static BOOL add_live_entry(ENTRY_LIST *list, const wchar_t *path, size_t path_len, int64_t mtime)
+{
+    struct lstatx stx;
+    wchar_t *target;
+    ULONG tag = 0;
+    BOOL ret;
+
+    if ((target = getLinkTargetW(path, &tag)) == NULL) {
+        /* not a link (anymore) */
+        return TRUE;
+    }
+
+    ret = add_entry(list, path, path_len, target, wcslen(target), tag, mtime,
+                    (lwstatx(path, LSTATX_INO, &stx) == 0) ? &stx.stx_ino : NULL);
+    free(target);
+
+    return ret;
+}
+
+static int collect_entry(void *ctx, const WALK_ENTRY *entry)
+{
+    ENTRY_LIST *list = (ENTRY_LIST *)ctx;
+
+    if (entry->reparse_tag == 0) {
+        return WALK_CONTINUE;
+    }
+
+    if (!add_live_entry(list, entry->path, entry->path_len, filetime_ticks(&entry->mtime))) {
+        list->failed = TRUE;
+        return WALK_STOP;
+    }
+
+    return WALK_CONTINUE;
+}
+
+/**
+ * Serialize sorted entries into a newly allocated buffer.
+ */
+static uint8_t *serialize(const wchar_t *root, const ENTRY_LIST *list, size_t *psize)
+{
+    INDEX_HEADER hdr;
+    INDEX_RECORD rec;
+    const BUILD_ENTRY *e, *prev = NULL;
+    uint8_t *buf;
+    uint64_t *blocks;
+    size_t i, size, off, shared, root_len;
+    uint32_t block_count;
+
+    root_len = wcslen(root);
+    block_count = (uint32_t)((list->count + RESTART_INTERVAL - 1) / RESTART_INTERVAL);
+
+    /* the worst case: no front-coding at all */
+    size = ALIGN8(sizeof(INDEX_HEADER) + root_len * sizeof(wchar_t));
+
+    for (i = 0; i < list->count; i++) {
+        e = &list->items[i];
+        size += ALIGN8(sizeof(INDEX_RECORD) + (e->path_len + e->target_len) * sizeof(wchar_t));
+    }
+
+    size += block_count * sizeof(uint64_t);
+
+    if ((buf = calloc(1, size)) == NULL) {
+        return NULL;
+    }
+
+    off = sizeof(INDEX_HEADER);
+    memcpy(buf + off, root, root_len * sizeof(wchar_t));
+    off = ALIGN8(off + root_len * sizeof(wchar_t));
+
+    blocks = malloc((block_count + 1) * sizeof(uint64_t));
+
+    if (!blocks) {
+        free(buf);
+        return NULL;
+    }
+
+    for (i = 0; i < list->count; i++) {
+        e = &list->items[i];
+        shared = 0;
+
+        if (i % RESTART_INTERVAL == 0) {
+            blocks[i / RESTART_INTERVAL] = off;
+        } else {
+            /* length of the common prefix */
+            while (shared < e->path_len && shared < prev->path_len &&
+                   shared < UINT16_MAX && e->path[shared] == prev->path[shared])
+            {
+                shared++;
+            }
+        }
+
+        memset(&rec, 0, sizeof(rec));
+        rec.shared = (uint16_t)shared;
+        rec.suffix_len = (uint16_t)(e->path_len - shared);
+        rec.target_len = (uint16_t)e->target_len;
+        rec.tag = e->tag;
+        rec.mtime = e->mtime;
+        memcpy(rec.file_id, e->file_id.Identifier, sizeof(rec.file_id));
+
+        memcpy(buf + off, &rec, sizeof(rec));
+        off += sizeof(rec);
+        memcpy(buf + off, e->path + shared, rec.suffix_len * sizeof(wchar_t));
+        off += rec.suffix_len * sizeof(wchar_t);
+        memcpy(buf + off, e->target, rec.target_len * sizeof(wchar_t));
+        off = ALIGN8(off + rec.target_len * sizeof(wchar_t));
+
+        prev = e;
+    }
+
+    memcpy(buf + off, blocks, block_count * sizeof(uint64_t));
+    free(blocks);
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = INDEX_VERSION;
+    hdr.count = (uint32_t)list->count;
+    hdr.block_count = block_count;
+    hdr.root_len = (uint32_t)root_len;
+    hdr.blocks_offset = off;
+    hdr.file_size = off + block_count * sizeof(uint64_t);
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    *psize = (size_t)hdr.file_size;
+
+    return buf;
+}
+
+/* write into a temporary file and move it over the old index */
+static BOOL write_index(const wchar_t *file, const wchar_t *root, ENTRY_LIST *list)
+{
+    uint8_t *buf;
+    wchar_t *tmp;
+    HANDLE handle;
+    size_t size, len;
+    DWORD written;
+    BOOL ok;
+
+    qsort(list->items, list->count, sizeof(BUILD_ENTRY), entry_cmp);
+
+    if ((buf = serialize(root, list, &size)) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    if (size > MAXDWORD) {
+        free(buf);
+        SetLastError(ERROR_FILE_TOO_LARGE);
+        return FALSE;
+    }
+
+    len = wcslen(file);
+
+    if ((tmp = malloc((len + 5) * sizeof(wchar_t))) == NULL) {
+        free(buf);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    wmemcpy(tmp, file, len);
+    wmemcpy(tmp + len, L".tmp", 5);
+
+    handle = CreateFileW(tmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        free(tmp);
+        free(buf);
+        return FALSE;
+    }
+
+    ok = WriteFile(handle, buf, (DWORD)size, &written, NULL) && written == size;
+    ok = FlushFileBuffers(handle) && ok;
+    CloseHandle(handle);
+    free(buf);
+
+    if (!ok || !MoveFileExW(tmp, file, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileW(tmp);
+        free(tmp);
+        return FALSE;
+    }
+
+    free(tmp);
+
+    return TRUE;
+}
+
+BOOL linkIndexBuildW(const wchar_t *root, const wchar_t *file)
+{
+    ENTRY_LIST list = { NULL, 0, 0, FALSE };
+    wchar_t *full;
+    BOOL ret;
+
+    if (!root || !*root || !file || !*file) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    /* the walk builds the keys from the root, so they are normalized too */
+    if ((full = normalize_path(root)) == NULL) {
+        return FALSE;
+    }
+
+    if (!walk_tree(full, collect_entry, &list) || list.failed) {
+        if (list.failed) SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        free_entries(&list);
+        free(full);
+        return FALSE;
+    }
+
+    ret = write_index(file, full, &list);
+    free_entries(&list);
+    free(full);
+
+    return ret;
+}
+
+LINK_INDEX *linkIndexOpenW(const wchar_t *file)
+{
+    LINK_INDEX *index;
+    LARGE_INTEGER size;
+    const INDEX_HEADER *hdr;
+    uint32_t i;
+
+    if (!file || !*file) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if ((index = calloc(1, sizeof(LINK_INDEX))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    index->file = CreateFileW(file, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (index->file == INVALID_HANDLE_VALUE) {
+        free(index);
+        return NULL;
+    }
+
+    if (!GetFileSizeEx(index->file, &size) || size.QuadPart < (LONGLONG)sizeof(INDEX_HEADER)) {
+        goto invalid;
+    }
+
+    index->size = (size_t)size.QuadPart;
+    index->mapping = CreateFileMappingW(index->file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (!index->mapping) {
+        goto error;
+    }
+
+    index->base = MapViewOfFile(index->mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!index->base) {
+        goto error;
+    }
+
+    /* validate the header and the block table */
+    hdr = (const INDEX_HEADER *)index->base;
+
+    if (memcmp(hdr->magic, INDEX_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != INDEX_VERSION ||
+        hdr->file_size != index->size ||
+        hdr->root_len > MODERN_MAX_PATH ||
+        hdr->blocks_offset % 8 != 0 ||
+        hdr->blocks_offset > index->size ||
+        hdr->blocks_offset < sizeof(INDEX_HEADER) ||
+        hdr->root_len > (hdr->blocks_offset - sizeof(INDEX_HEADER)) / sizeof(wchar_t) ||
+        (index->size - hdr->blocks_offset) / sizeof(uint64_t) < hdr->block_count ||
+        hdr->block_count != (hdr->count + RESTART_INTERVAL - 1) / RESTART_INTERVAL)
+    {
+        goto invalid;
+    }
+
+    index->hdr = hdr;
+    index->root = (const wchar_t *)(index->base + sizeof(INDEX_HEADER));
+    index->blocks = (const uint64_t *)(index->base + hdr->blocks_offset);
+
+    for (i = 0; i < hdr->block_count; i++) {
+        if (index->blocks[i] % 8 != 0 || index->blocks[i] >= hdr->blocks_offset) {
+            goto invalid;
+        }
+    }
+
+    return index;
+
+invalid:
+    SetLastError(ERROR_INVALID_DATA);
+error:
+    linkIndexClose(index);
+    return NULL;
+}
+
+void linkIndexClose(LINK_INDEX *index)
+{
+    if (!index) return;
+
+    if (index->base) UnmapViewOfFile(index->base);
+    if (index->mapping) CloseHandle(index->mapping);
+    if (index->file != INVALID_HANDLE_VALUE) CloseHandle(index->file);
+
+    free(index);
+}
+
+/**
+ * Read the record at 'off' and append its suffix to 'path'.
+ * Returns the offset of the next record or 0 if the record is invalid.
+ */
+static size_t read_record(const LINK_INDEX *index, size_t off, wchar_t *path,
+                          size_t *path_len, const INDEX_RECORD **prec)
+{
+    const INDEX_RECORD *rec;
+    size_t end;
+
+    if (off + sizeof(INDEX_RECORD) > index->hdr->blocks_offset) {
+        return 0;
+    }
+
+    rec = (const INDEX_RECORD *)(index->base + off);
+    end = off + sizeof(INDEX_RECORD) + (rec->suffix_len + rec->target_len) * sizeof(wchar_t);
+
+    if (end > index->hdr->blocks_offset ||
+        rec->shared > *path_len ||
+        rec->shared + rec->suffix_len > MODERN_MAX_PATH)
+    {
+        return 0;
+    }
+
+    wmemcpy(path + rec->shared, (const wchar_t *)(rec + 1), rec->suffix_len);
+    *path_len = rec->shared + rec->suffix_len;
+    *prec = rec;
+
+    return ALIGN8(end);
+}
+
+static void fill_entry(const INDEX_RECORD *rec, LINK_INDEX_ENTRY *pEntry)
+{
+    pEntry->tag = rec->tag;
+    pEntry->mtime = rec->mtime;
+    memcpy(pEntry->file_id.Identifier, rec->file_id, sizeof(rec->file_id));
+    pEntry->target = (const wchar_t *)(rec + 1) + rec->suffix_len;
+    pEntry->target_len = rec->target_len;
+}
+
+/* look up a normalized path */
+static BOOL lookup(const LINK_INDEX *index, const wchar_t *path, LINK_INDEX_ENTRY *pEntry)
+{
+    wchar_t buf[MODERN_MAX_PATH + 1];
+    const INDEX_RECORD *rec;
+    size_t lo, hi, mid, off, len, plen, i, n;
+    int cmp;
+
+    plen = wcslen(path);
+
+    if (index->hdr->block_count == 0) {
+        SetLastError(ERROR_NOT_FOUND);
+        return FALSE;
+    }
+
+    /* find the last block whose first path is <= path */
+    lo = 0;
+    hi = index->hdr->block_count;
+
+    while (hi - lo > 1) {
+        mid = lo + (hi - lo) / 2;
+        len = 0;
+
+        if (read_record(index, (size_t)index->blocks[mid], buf, &len, &rec) == 0) {
+            SetLastError(ERROR_INVALID_DATA);
+            return FALSE;
+        }
+
+        if (path_cmp(buf, len, path, plen) <= 0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    /* scan the block */
+    off = (size_t)index->blocks[lo];
+    n = index->hdr->count - lo * RESTART_INTERVAL;
+    if (n > RESTART_INTERVAL) n = RESTART_INTERVAL;
+    len = 0;
+
+    for (i = 0; i < n; i++) {
+        if ((off = read_record(index, off, buf, &len, &rec)) == 0) {
+            SetLastError(ERROR_INVALID_DATA);
+            return FALSE;
+        }
+
+        cmp = path_cmp(buf, len, path, plen);
+
+        if (cmp == 0) {
+            fill_entry(rec, pEntry);
+            return TRUE;
+        }
+
+        if (cmp > 0) break;
+    }
+
+    SetLastError(ERROR_NOT_FOUND);
+    return FALSE;
+}
+
+BOOL linkIndexLookupW(const LINK_INDEX *index, const wchar_t *path, LINK_INDEX_ENTRY *pEntry)
+{
+    wchar_t *full;
+    BOOL ret;
+
+    if (!index || !path || !pEntry) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((full = normalize_path(path)) == NULL) {
+        return FALSE;
+    }
+
+    ret = lookup(index, full, pEntry);
+    free(full);
+
+    return ret;
+}
+
+/* whether the normalized path lies inside of the indexed directory tree */
+static BOOL in_indexed_tree(const LINK_INDEX *index, const wchar_t *path)
+{
+    size_t rlen = index->hdr->root_len;
+
+    if (rlen == 0 || wcslen(path) <= rlen ||
+        path_cmp(path, rlen, index->root, rlen) != 0)
+    {
+        return FALSE;
+    }
+
+    return (path[rlen] == L'\\' || path[rlen] == L'/' ||
+            index->root[rlen-1] == L'\\' || index->root[rlen-1] == L'/') ? TRUE : FALSE;
+}
+
+/**
+ * Returns 1 if the entry can be used, 0 if the path is known to be
+ * no link and -1 if the live functions must be used.
+ */
+static int check_entry(const LINK_INDEX *index, const wchar_t *path,
+                       DWORD flags, LINK_INDEX_ENTRY *pEntry)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    wchar_t *full;
+    BOOL found;
+
+    if (!index || (full = normalize_path(path)) == NULL) {
+        return -1;
+    }
+
+    if (!in_indexed_tree(index, full)) {
+        free(full);
+        return -1;
+    }
+
+    found = lookup(index, full, pEntry);
+    free(full);
+
+    if (!(flags & LINK_INDEX_VERIFY)) {
+        return found ? 1 : 0;
+    }
+
+    if (!GetFileAttributesExW(path, GetFileExInfoStandard, &fad)) {
+        return -1;
+    }
+
+    if (!(fad.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+        return 0;
+    }
+
+    if (found && pEntry->mtime == filetime_ticks(&fad.ftLastWriteTime)) {
+        return 1;
+    }
+
+    /* stale or missing entry */
+    return -1;
+}
+
+int linkIndexIsSymlinkW(const LINK_INDEX *index, const wchar_t *path, ULONG *tag, DWORD flags)
+{
+    LINK_INDEX_ENTRY entry;
+
+    if (!path) return -1;
+
+    switch (check_entry(index, path, flags, &entry))
+    {
+    case 1:
+        if (tag) *tag = entry.tag;
+        return TRUE;
+    case 0:
+        if (tag) *tag = 0;
+        return FALSE;
+    default:
+        break;
+    }
+
+    return isSymlinkW(path, tag);
+}
+
+wchar_t *linkIndexGetLinkTargetW(const LINK_INDEX *index, const wchar_t *path, ULONG *tag, DWORD flags)
+{
+    LINK_INDEX_ENTRY entry;
+    wchar_t *buf;
+
+    if (!path) return NULL;
+
+    switch (check_entry(index, path, flags, &entry))
+    {
+    case 1:
+        if ((buf = malloc((entry.target_len + 1) * sizeof(wchar_t))) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return NULL;
+        }
+        wmemcpy(buf, entry.target, entry.target_len);
+        buf[entry.target_len] = 0;
+        if (tag) *tag = entry.tag;
+        return buf;
+    case 0:
+        /* same error as getLinkTargetW() on a regular file */
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return NULL;
+    default:
+        break;
+    }
+
+    return getLinkTargetW(path, tag);
+}
+
+BOOL linkIndexUpdateW(const wchar_t *file, const wchar_t * const *paths, size_t count)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    ENTRY_LIST list = { NULL, 0, 0, FALSE };
+    STRPOOL changed;
+    LINK_INDEX *index;
+    const INDEX_RECORD *rec;
+    LINK_INDEX_ENTRY e;
+    wchar_t buf[MODERN_MAX_PATH + 1];
+    wchar_t *root = NULL;
+    size_t i, off, len = 0;
+    uint32_t id;
+    BOOL ret = FALSE;
+
+    if (!file || !*file || (!paths && count > 0)) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((index = linkIndexOpenW(file)) == NULL) {
+        return FALSE;
+    }
+
+    if (!strpool_init(&changed, TRUE)) {
+        linkIndexClose(index);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    /* keys are normalized; differently spelled paths must not add duplicates */
+    for (i = 0; i < count; i++) {
+        if ((root = normalize_path(paths[i])) == NULL) {
+            DWORD err = GetLastError();
+            linkIndexClose(index);
+            strpool_free(&changed);
+            SetLastError(err);
+            return FALSE;
+        }
+
+        id = strpool_intern(&changed, root, wcslen(root));
+        free(root);
+        root = NULL;
+
+        if (id == STRPOOL_NONE) {
+            goto nomem;
+        }
+    }
+
+    /* keep the entries that did not change */
+    off = index->hdr->count > 0 ? (size_t)index->blocks[0] : 0;
+
+    for (i = 0; i < index->hdr->count; i++) {
+        if (i % RESTART_INTERVAL == 0) len = 0;
+
+        if ((off = read_record(index, off, buf, &len, &rec)) == 0) {
+            linkIndexClose(index);
+            strpool_free(&changed);
+            free_entries(&list);
+            SetLastError(ERROR_INVALID_DATA);
+            return FALSE;
+        }
+
+        if (strpool_find(&changed, buf, len) != STRPOOL_NONE) {
+            continue;
+        }
+
+        fill_entry(rec, &e);
+
+        if (!add_entry(&list, buf, len, e.target, e.target_len, e.tag, e.mtime, &e.file_id)) {
+            goto nomem;
+        }
+    }
+
+    /* re-read the changed paths; duplicates were merged by the pool */
+    for (i = 0; i < changed.count; i++) {
+        if (!GetFileAttributesExW(strpool_get(&changed, i), GetFileExInfoStandard, &fad) ||
+            !(fad.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+        {
+            /* removed or no longer a reparse point */
+            continue;
+        }
+
+        if (!add_live_entry(&list, strpool_get(&changed, i), strpool_length(&changed, i),
+                            filetime_ticks(&fad.ftLastWriteTime)))
+        {
+            goto nomem;
+        }
+    }
+
+    root = malloc((index->hdr->root_len + 1) * sizeof(wchar_t));
+    if (!root) goto nomem;
+
+    wmemcpy(root, index->root, index->hdr->root_len);
+    root[index->hdr->root_len] = 0;
+
+    /* the old file must be unmapped before it can be replaced */
+    linkIndexClose(index);
+    index = NULL;
+
+    ret = write_index(file, root, &list);
+
+    free(root);
+    strpool_free(&changed);
+    free_entries(&list);
+
+    return ret;
+
+nomem:
+    linkIndexClose(index);
+    strpool_free(&changed);
+    free_entries(&list);
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+
+    return FALSE;
+}
+
+BOOL linkIndexBuildA(const char *root, const char *file)
+{
+    wchar_t *wcs_root, *wcs_file;
+    BOOL ret;
+
+    if ((wcs_root = convert_str_to_wcs(root)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((wcs_file = convert_str_to_wcs(file)) == NULL) {
+        free(wcs_root);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = linkIndexBuildW(wcs_root, wcs_file);
+
+    free(wcs_root);
+    free(wcs_file);
+
+    return ret;
+}
+
+BOOL linkIndexUpdateA(const char *file, const char * const *paths, size_t count)
+{
+    wchar_t *wcs_file, **wcs_paths;
+    size_t i;
+    BOOL ret = FALSE;
+
+    if (!paths && count > 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((wcs_file = convert_str_to_wcs(file)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((wcs_paths = calloc(count + 1, sizeof(wchar_t *))) == NULL) {
+        free(wcs_file);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    for (i = 0; i < count; i++) {
+        if ((wcs_paths[i] = convert_str_to_wcs(paths[i])) == NULL) {
+            SetLastError(ERROR_INVALID_PARAMETER);
+            goto done;
+        }
+    }
+
+    ret = linkIndexUpdateW(wcs_file, (const wchar_t * const *)wcs_paths, count);
+
+done:
+    for (i = 0; i < count; i++) {
+        free(wcs_paths[i]);
+    }
+
+    free(wcs_paths);
+    free(wcs_file);
+
+    return ret;
+}
+
+LINK_INDEX *linkIndexOpenA(const char *file)
+{
+    LINK_INDEX *index;
+    wchar_t *wcs_file;
+
+    if ((wcs_file = convert_str_to_wcs(file)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    index = linkIndexOpenW(wcs_file);
+    free(wcs_file);
+
+    return index;
+}
+
+BOOL linkIndexLookupA(const LINK_INDEX *index, const char *path, LINK_INDEX_ENTRY *pEntry)
+{
+    wchar_t *wcs;
+    BOOL ret;
+
+    if (!path) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((wcs = convert_str_to_wcs(path)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = linkIndexLookupW(index, wcs, pEntry);
+    free(wcs);
+
+    return ret;
+}
+
+int linkIndexIsSymlinkA(const LINK_INDEX *index, const char *path, ULONG *tag, DWORD flags)
+{
+    wchar_t *wcs;
+    int rv;
+
+    if (!path || (wcs = convert_str_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    rv = linkIndexIsSymlinkW(index, wcs, tag, flags);
+    free(wcs);
+
+    return rv;
+}
+
+char *linkIndexGetLinkTargetA(const LINK_INDEX *index, const char *path, ULONG *tag, DWORD flags)
+{
+    wchar_t *wcs, *target;
+    char *str;
+
+    if (!path || (wcs = convert_str_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    target = linkIndexGetLinkTargetW(index, wcs, tag, flags);
+    free(wcs);
+
+    if (!target) {
+        return NULL;
+    }
+
+    str = convert_wcs_to_str(target);
+    free(target);
+
+    return str;
+}
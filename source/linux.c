@@ -0,0 +1,338 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+/* Native Linux backend: the narrow character core of the API on top of
+ * symlinkat(), linkat(), readlinkat(), statx() and realpath(). */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* statx() */
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "w32-symlink.h"
+
+/* link targets up to this size are read on the stack */
+#define TARGET_BUFSIZE  PATH_MAX
+
+
+/**
+ * NUL-terminate a slice in 'tmp', which must hold PATH_MAX bytes.
+ */
+static const char *slice_path(const char *path, size_t len, char *tmp)
+{
+    if (!path || memchr(path, 0, len) != NULL) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    if (len >= PATH_MAX) {
+        errno = ENAMETOOLONG; /* Filename too long */
+        return NULL;
+    }
+
+    memcpy(tmp, path, len);
+    tmp[len] = 0;
+
+    return tmp;
+}
+
+BOOL createLinkA(const char *lpLinkName, const char *lpTargetName, char mode)
+{
+    int rv;
+
+    if (!lpLinkName || !lpTargetName) {
+        errno = EINVAL; /* Invalid argument */
+        return FALSE;
+    }
+
+    switch (mode)
+    {
+    case 'h':
+    case 'H':
+        rv = linkat(AT_FDCWD, lpTargetName, AT_FDCWD, lpLinkName, 0);
+        break;
+    default:
+        /* no distinction between file and directory links */
+        rv = symlinkat(lpTargetName, AT_FDCWD, lpLinkName);
+        break;
+    }
+
+    return (rv == 0) ? TRUE : FALSE;
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+char *getCanonicalPathA(const char *lpFileName)
+{
+    if (!lpFileName) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return realpath(lpFileName, NULL);
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+char *getLinkTargetA(const char *lpFileName, ULONG *pReparseTag)
+{
+    char stackbuf[TARGET_BUFSIZE];
+    char *heap = NULL, *buf = stackbuf, *p;
+    size_t size = sizeof(stackbuf);
+    ssize_t len;
+
+    if (!lpFileName) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    /* a result that fills the whole buffer may be truncated */
+    while ((len = readlinkat(AT_FDCWD, lpFileName, buf, size)) >= 0 &&
+           (size_t)len == size)
+    {
+        size *= 2;
+
+        if ((p = realloc(heap, size)) == NULL) {
+            len = -1;
+            break;
+        }
+
+        heap = buf = p;
+    }
+
+    if (len < 0) {
+        free(heap);
+        return NULL;
+    }
+
+    if (!heap) {
+        if ((heap = malloc(len + 1)) == NULL) return NULL;
+        memcpy(heap, stackbuf, len);
+    }
+
+    heap[len] = 0;
+
+    if (pReparseTag) *pReparseTag = IO_REPARSE_TAG_SYMLINK;
+
+    return heap;
+}
+
+BOOL getLinkTargetViewA(const char *lpFileName, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView)
+{
+    ssize_t len;
+
+    if (!lpFileName || !buffer || !pView) {
+        errno = EINVAL; /* Invalid argument */
+        return FALSE;
+    }
+
+    if ((len = readlinkat(AT_FDCWD, lpFileName, buffer, bufsize)) < 0) {
+        return FALSE;
+    }
+
+    if ((size_t)len == bufsize) {
+        errno = ERANGE; /* Result too large */
+        return FALSE;
+    }
+
+    /* the target is all there is */
+    memset(pView, 0, sizeof(LINK_TARGET_VIEW));
+    pView->tag = IO_REPARSE_TAG_SYMLINK;
+    pView->flags = (len > 0 && ((const char *)buffer)[0] != '/') ? 0x1 : 0;
+    pView->utf8 = TRUE;
+    pView->subst_len = pView->print_len = (size_t)len;
+    pView->target_len = pView->norm_len = (size_t)len;
+
+    return TRUE;
+}
+
+/* file type of 'path' without following a final symlink */
+static int link_mode(const char *path, mode_t *mode)
+{
+    struct stat st;
+
+#ifdef STATX_TYPE
+    /* only the file type is needed, don't let network file systems sync */
+    struct statx stx;
+
+    if (statx(AT_FDCWD, path, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+              STATX_TYPE, &stx) == 0)
+    {
+        *mode = stx.stx_mode;
+        return 0;
+    }
+
+    /* the headers have statx but the kernel (before 4.11) or a seccomp
+     * filter rejects the call itself */
+    if (errno != ENOSYS && errno != EPERM) {
+        return -1;
+    }
+#endif
+
+    if (fstatat(AT_FDCWD, path, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return -1;
+    }
+
+    *mode = st.st_mode;
+    return 0;
+}
+
+int isSymlinkA(const char *lpFileName, ULONG *pReparseTag)
+{
+    mode_t mode;
+
+    if (!lpFileName) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (link_mode(lpFileName, &mode) != 0) {
+        return -1;
+    }
+
+    if (!S_ISLNK(mode)) {
+        return FALSE;
+    }
+
+    if (pReparseTag) *pReparseTag = IO_REPARSE_TAG_SYMLINK;
+
+    return TRUE;
+}
+
+char *readlink_s(const char *path, char *buf, size_t bufsize)
+{
+    ssize_t len;
+
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    if (!buf) {
+        /* return allocated string */
+        return getLinkTargetA(path, NULL);
+    }
+
+    if ((len = readlinkat(AT_FDCWD, path, buf, bufsize)) < 0) {
+        return NULL;
+    }
+
+    /* no room for the terminating NUL */
+    if ((size_t)len >= bufsize) {
+        errno = ENOMEM; /* Not enough space/cannot allocate memory */
+        return NULL;
+    }
+
+    buf[len] = 0;
+
+    return buf;
+}
+
+char *realpath_s(const char *path, char *buf, size_t bufsize)
+{
+    char tmp[PATH_MAX];
+    size_t len;
+
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    if (!buf) {
+        /* return allocated string */
+        return realpath(path, NULL);
+    }
+
+    if (!realpath(path, tmp)) {
+        return NULL;
+    }
+
+    if ((len = strlen(tmp)) >= bufsize) {
+        errno = ENOMEM; /* Not enough space/cannot allocate memory */
+        return NULL;
+    }
+
+    return memcpy(buf, tmp, len + 1);
+}
+
+int isSymlinkNA(const char *lpFileName, size_t len, ULONG *pReparseTag)
+{
+    char tmp[PATH_MAX];
+
+    if (!slice_path(lpFileName, len, tmp)) return -1;
+
+    return isSymlinkA(tmp, pReparseTag);
+}
+
+char *getLinkTargetNA(const char *lpFileName, size_t len, ULONG *pReparseTag)
+{
+    char tmp[PATH_MAX];
+
+    if (!slice_path(lpFileName, len, tmp)) return NULL;
+
+    return getLinkTargetA(tmp, pReparseTag);
+}
+
+char *getCanonicalPathNA(const char *lpFileName, size_t len)
+{
+    char tmp[PATH_MAX];
+
+    if (!slice_path(lpFileName, len, tmp)) return NULL;
+
+    return getCanonicalPathA(tmp);
+}
+
+char *readlinkn_s(const char *path, size_t len, char *buf, size_t bufsize)
+{
+    char tmp[PATH_MAX];
+
+    if (!path || len == 0 || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    if (!slice_path(path, len, tmp)) return NULL;
+
+    return readlink_s(tmp, buf, bufsize);
+}
+
+char *realpathn_s(const char *path, size_t len, char *buf, size_t bufsize)
+{
+    char tmp[PATH_MAX];
+
+    if (!path || len == 0 || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    if (!slice_path(path, len, tmp)) return NULL;
+
+    return realpath_s(tmp, buf, bufsize);
+}
@@ -0,0 +1,119 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "workers.h"
+#include "w32-symlink.h"
+
+
+typedef struct {
+    const void * const *paths;
+    BOOL wide;
+    unsigned int mask;
+    const LSTAT_COLUMNS *cols;
+    volatile LONG64 failed;
+} COLUMN_JOB;
+
+
+static unsigned int columns_to_mask(const LSTAT_COLUMNS *cols)
+{
+    unsigned int mask = 0;
+
+    if (cols->mode)    mask |= LSTATX_TYPE;
+    if (cols->size)    mask |= LSTATX_SIZE;
+    if (cols->mtime)   mask |= LSTATX_MTIME;
+    if (cols->tag)     mask |= LSTATX_TAG;
+    if (cols->file_id) mask |= LSTATX_INO;
+
+    return mask;
+}
+
+static void column_worker(void *ctx, size_t i)
+{
+    COLUMN_JOB *job = (COLUMN_JOB *)ctx;
+    const LSTAT_COLUMNS *cols = job->cols;
+    struct lstatx stx;
+    int rv, err = 0;
+
+    if (job->wide) {
+        rv = lwstatx((const wchar_t *)job->paths[i], job->mask, &stx);
+    } else {
+        rv = lstatx((const char *)job->paths[i], job->mask, &stx);
+    }
+
+    if (rv != 0) {
+        err = errno;
+        memset(&stx, 0, sizeof(stx));
+        InterlockedIncrement64(&job->failed);
+    }
+
+    /* scatter into the selected columns */
+    if (cols->mode)    cols->mode[i] = stx.stx_mode;
+    if (cols->size)    cols->size[i] = stx.stx_size;
+    if (cols->tag)     cols->tag[i] = stx.stx_reparse_tag;
+    if (cols->file_id) cols->file_id[i] = stx.stx_ino;
+    if (cols->error)   cols->error[i] = err;
+
+    if (cols->mtime) {
+        cols->mtime[i] = (rv != 0) ? 0 :
+            stx.stx_mtime.tv_sec * 10000000LL + stx.stx_mtime.tv_nsec / 100;
+    }
+}
+
+static ssize_t run_columns(const void * const *paths, BOOL wide, size_t count,
+                           const LSTAT_COLUMNS *columns, unsigned int threads)
+{
+    COLUMN_JOB job;
+
+    if (!paths || !columns || count > SSIZE_MAX) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    job.paths = paths;
+    job.wide = wide;
+    job.mask = columns_to_mask(columns);
+    job.cols = columns;
+    job.failed = 0;
+
+    parallel_for(count, threads, column_worker, &job);
+
+    return (ssize_t)job.failed;
+}
+
+ssize_t lstat_columns(const char * const *paths, size_t count,
+                      const LSTAT_COLUMNS *columns, unsigned int threads)
+{
+    return run_columns((const void * const *)paths, FALSE, count, columns, threads);
+}
+
+ssize_t lwstat_columns(const wchar_t * const *paths, size_t count,
+                       const LSTAT_COLUMNS *columns, unsigned int threads)
+{
+    return run_columns((const void * const *)paths, TRUE, count, columns, threads);
+}
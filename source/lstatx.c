@@ -0,0 +1,290 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "calltrace.h"
+#include "convert.h"
+#include "reparse_data_buffer.h"
+#include "winerr.h"
+#include "w32-symlink.h"
+
+
+/* difference between 1601-01-01 and 1970-01-01 in 100 ns intervals */
+#define EPOCH_DIFF  116444736000000000LL
+
+/* fields that cannot be read without opening the file */
+#define LSTATX_HANDLE_FIELDS  (LSTATX_CTIME | LSTATX_INO | LSTATX_NLINK)
+
+
+static void set_timestamp(struct lstatx_timestamp *ts, LONGLONG ticks)
+{
+    LONGLONG t = ticks - EPOCH_DIFF;
+    LONGLONG rem = t % 10000000LL;
+
+    if (rem < 0) rem += 10000000LL;
+
+    ts->tv_sec = (t - rem) / 10000000LL;
+    ts->tv_nsec = (uint32_t)rem * 100;
+}
+
+static LONGLONG filetime_ticks(const FILETIME *ft)
+{
+    return (LONGLONG)(((ULONGLONG)ft->dwHighDateTime << 32) | ft->dwLowDateTime);
+}
+
+/* same link types that are recognized by isSymlinkW() */
+static BOOL is_link_tag(HANDLE handle, ULONG tag)
+{
+    uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    REPARSE_DATA_BUFFER *pData = (REPARSE_DATA_BUFFER *)data;
+    NFS_REPARSE_BUFFER *pNfs;
+
+    switch (tag)
+    {
+    case IO_REPARSE_TAG_SYMLINK:
+    case IO_REPARSE_TAG_MOUNT_POINT:
+    case IO_REPARSE_TAG_APPEXECLINK:
+    case IO_REPARSE_TAG_LX_SYMLINK:
+        return TRUE;
+
+    case IO_REPARSE_TAG_NFS:
+        /* the only case where we need to read the reparse data */
+        if (!traced_get_reparse_point(handle, data, sizeof(data), NULL)) {
+            return FALSE;
+        }
+        pNfs = (NFS_REPARSE_BUFFER *)pData->DataBuffer;
+        return (pNfs->Type == NFS_SPECFILE_LNK) ? TRUE : FALSE;
+
+    default:
+        break;
+    }
+
+    return FALSE;
+}
+
+static uint16_t get_mode(DWORD dwAttr, BOOL isLink)
+{
+    uint16_t mode = _S_IREAD;
+
+    if (isLink) {
+        mode |= _S_IFLNK | _S_IWRITE | _S_IEXEC;
+    } else if (dwAttr & FILE_ATTRIBUTE_DIRECTORY) {
+        mode |= _S_IFDIR | _S_IEXEC;
+    } else {
+        mode |= _S_IFREG;
+    }
+
+    if (!isLink && !(dwAttr & FILE_ATTRIBUTE_READONLY)) {
+        mode |= _S_IWRITE;
+    }
+
+    /* copy user permissions to group and other, like _stat() does */
+    mode |= (mode & 0700) >> 3;
+    mode |= (mode & 0700) >> 6;
+
+    return mode;
+}
+
+/**
+ * Query the fields that need a file handle.
+ * If 'tagOnly' is set the attributes, size and times were already
+ * retrieved and only the reparse tag is missing.
+ */
+static BOOL query_handle(const wchar_t *path, unsigned int mask,
+                         BOOL tagOnly, struct lstatx *stx)
+{
+    FILE_BASIC_INFO basic;
+    FILE_STANDARD_INFO standard;
+    FILE_ATTRIBUTE_TAG_INFO tagInfo;
+    FILE_ID_INFO idInfo;
+    BY_HANDLE_FILE_INFORMATION info;
+    HANDLE handle;
+    BOOL isLink = FALSE;
+
+    handle = traced_CreateFileW(path,
+                                FILE_READ_ATTRIBUTES,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    if (!tagOnly) {
+        if (!traced_GetFileInformationByHandleEx(handle, FileBasicInfo, &basic, sizeof(basic))) {
+            goto error;
+        }
+
+        stx->stx_attributes = basic.FileAttributes;
+        set_timestamp(&stx->stx_atime, basic.LastAccessTime.QuadPart);
+        set_timestamp(&stx->stx_mtime, basic.LastWriteTime.QuadPart);
+        set_timestamp(&stx->stx_btime, basic.CreationTime.QuadPart);
+        set_timestamp(&stx->stx_ctime, basic.ChangeTime.QuadPart);
+        stx->stx_mask |= LSTATX_ATIME | LSTATX_MTIME | LSTATX_BTIME | LSTATX_CTIME;
+
+        if (mask & (LSTATX_SIZE | LSTATX_NLINK)) {
+            if (!traced_GetFileInformationByHandleEx(handle, FileStandardInfo,
+                                                     &standard, sizeof(standard)))
+            {
+                goto error;
+            }
+
+            stx->stx_nlink = standard.NumberOfLinks;
+            stx->stx_size = standard.Directory ? 0 : (uint64_t)standard.EndOfFile.QuadPart;
+            stx->stx_mask |= LSTATX_SIZE | LSTATX_NLINK;
+        }
+
+        if (mask & LSTATX_INO) {
+            if (traced_GetFileInformationByHandleEx(handle, FileIdInfo, &idInfo, sizeof(idInfo))) {
+                stx->stx_dev = idInfo.VolumeSerialNumber;
+                stx->stx_ino = idInfo.FileId;
+            } else if (GetFileInformationByHandle(handle, &info)) {
+                /* FileIdInfo requires Windows 8 or later; fall back to the 64 bit index */
+                stx->stx_dev = info.dwVolumeSerialNumber;
+                memset(&stx->stx_ino, 0, sizeof(stx->stx_ino));
+                memcpy(stx->stx_ino.Identifier, &info.nFileIndexLow, sizeof(DWORD));
+                memcpy(stx->stx_ino.Identifier + sizeof(DWORD), &info.nFileIndexHigh, sizeof(DWORD));
+            } else {
+                goto error;
+            }
+
+            stx->stx_mask |= LSTATX_INO;
+        }
+    }
+
+    /* the reparse tag is needed to tell links apart from other reparse points */
+    if ((stx->stx_attributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+        (mask & (LSTATX_TYPE | LSTATX_TAG)))
+    {
+        if (!traced_GetFileInformationByHandleEx(handle, FileAttributeTagInfo,
+                                                 &tagInfo, sizeof(tagInfo)))
+        {
+            goto error;
+        }
+
+        stx->stx_reparse_tag = tagInfo.ReparseTag;
+        isLink = is_link_tag(handle, tagInfo.ReparseTag);
+    }
+
+    CloseHandle(handle);
+
+    /* without the tag a reparse point cannot be told apart from a link */
+    if (!(stx->stx_attributes & FILE_ATTRIBUTE_REPARSE_POINT) ||
+        (mask & (LSTATX_TYPE | LSTATX_TAG)))
+    {
+        stx->stx_mode = get_mode(stx->stx_attributes, isLink);
+        stx->stx_mask |= LSTATX_TYPE | LSTATX_TAG;
+    }
+
+    return TRUE;
+
+error:
+    CloseHandle(handle);
+    return FALSE;
+}
+
+int lwstatx(const wchar_t *path, unsigned int mask, struct lstatx *stx)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+
+    if (!path || !*path || !stx) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    memset(stx, 0, sizeof(struct lstatx));
+
+    if (!(mask & LSTATX_HANDLE_FIELDS)) {
+        /* Everything we need can be read from the directory entry.
+         * GetFileAttributesExW() does not follow symbolic links. */
+        if (!GetFileAttributesExW(path, GetFileExInfoStandard, &fad)) {
+            errno = map_winerr_to_errno(GetLastError());
+            return -1;
+        }
+
+        stx->stx_attributes = fad.dwFileAttributes;
+        set_timestamp(&stx->stx_atime, filetime_ticks(&fad.ftLastAccessTime));
+        set_timestamp(&stx->stx_mtime, filetime_ticks(&fad.ftLastWriteTime));
+        set_timestamp(&stx->stx_btime, filetime_ticks(&fad.ftCreationTime));
+
+        if (!(fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            stx->stx_size = ((uint64_t)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+        }
+
+        stx->stx_mask = LSTATX_SIZE | LSTATX_ATIME | LSTATX_MTIME | LSTATX_BTIME;
+
+        if (!(fad.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+            /* not a reparse point: done without opening the file */
+            stx->stx_mode = get_mode(fad.dwFileAttributes, FALSE);
+            stx->stx_mask |= LSTATX_TYPE | LSTATX_TAG;
+            return 0;
+        }
+
+        if (!(mask & (LSTATX_TYPE | LSTATX_TAG))) {
+            /* reparse point, but neither type nor tag were requested */
+            return 0;
+        }
+
+        /* reparse point: open it only to read the tag */
+        if (!query_handle(path, mask, TRUE, stx)) {
+            errno = map_winerr_to_errno(GetLastError());
+            return -1;
+        }
+        return 0;
+    }
+
+    if (!query_handle(path, mask, FALSE, stx)) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    return 0;
+}
+
+int lstatx(const char *path, unsigned int mask, struct lstatx *stx)
+{
+    wchar_t *wcs_path;
+    int rv;
+
+    if (!path || !*path || !stx) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((wcs_path = convert_str_to_wcs(path)) == NULL) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    rv = lwstatx(wcs_path, mask, stx);
+    free(wcs_path);
+
+    return rv;
+}
@@ -0,0 +1,628 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lx_path.h"
+
+/* characters that DrvFs stores as U+F000 + c on Windows file systems */
+#define ESCAPED_CHARS  "\\:*?\"<>|"
+
+
+typedef struct {
+    char  *p;
+    size_t len;
+    size_t cap;
+    int    failed;
+} STRBUF;
+
+
+static void sb_append(STRBUF *sb, const char *s, size_t n)
+{
+    char *p;
+    size_t cap;
+
+    if (sb->failed) return;
+
+    if (n >= SIZE_MAX / 2 - sb->len) {
+        sb->failed = 1;
+        return;
+    }
+
+    if (sb->len + n + 1 > sb->cap) {
+        cap = sb->cap ? sb->cap : 64;
+        while (sb->len + n + 1 > cap) cap *= 2;
+
+        if ((p = realloc(sb->p, cap)) == NULL) {
+            sb->failed = 1;
+            return;
+        }
+
+        sb->p = p;
+        sb->cap = cap;
+    }
+
+    memcpy(sb->p + sb->len, s, n);
+    sb->len += n;
+    sb->p[sb->len] = 0;
+}
+
+static void sb_putc(STRBUF *sb, char c)
+{
+    sb_append(sb, &c, 1);
+}
+
+static int is_sep(char c)
+{
+    return (c == '\\' || c == '/');
+}
+
+/* length without trailing separators */
+static size_t trimmed_len(const char *s)
+{
+    size_t n = strlen(s);
+
+    while (n > 0 && is_sep(s[n-1])) n--;
+
+    return n;
+}
+
+static int is_escaped(unsigned char c)
+{
+    return (c > 0 && c < 0x20) || (c != 0 && strchr(ESCAPED_CHARS, c) != NULL);
+}
+
+/* case-insensitive ASCII prefix match on a component boundary;
+ * returns the length of 'prefix' or 0 */
+static size_t match_windows(const char *path, const char *prefix)
+{
+    size_t i, n = trimmed_len(prefix);
+
+    if (n == 0) return 0;
+
+    for (i = 0; i < n; i++) {
+        char a = path[i], b = prefix[i];
+
+        if (is_sep(a) && is_sep(b)) continue;
+        if (tolower((unsigned char)a) != tolower((unsigned char)b)) return 0;
+    }
+
+    return (path[n] == 0 || is_sep(path[n])) ? n : 0;
+}
+
+/* case-sensitive variant for Linux paths */
+static size_t match_linux(const char *path, const char *prefix)
+{
+    size_t n = trimmed_len(prefix);
+
+    if (n == 0 || strncmp(path, prefix, n) != 0) return 0;
+
+    return (path[n] == 0 || path[n] == '/') ? n : 0;
+}
+
+/* append a Windows path as a Linux path, undoing the DrvFs escapes */
+static void append_as_linux(STRBUF *sb, const char *s, size_t n)
+{
+    const unsigned char *p = (const unsigned char *)s;
+    unsigned char c;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        /* U+F000 + c is EF 80|(c >> 6) 80|(c & 0x3F) */
+        c = (i + 2 < n && p[i] == 0xEF && (p[i+1] & 0xFE) == 0x80 &&
+             (p[i+2] & 0xC0) == 0x80)
+            ? (unsigned char)(((p[i+1] & 1) << 6) | (p[i+2] & 0x3F)) : 0;
+
+        if (is_sep(p[i])) {
+            sb_putc(sb, '/');
+        } else if (is_escaped(c)) {
+            sb_putc(sb, (char)c);
+            i += 2;
+        } else {
+            sb_putc(sb, (char)p[i]);
+        }
+    }
+}
+
+/* append a Linux path as a Windows path, applying the DrvFs escapes */
+static void append_as_windows(STRBUF *sb, const char *s)
+{
+    char esc[3];
+
+    for ( ; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+
+        if (c == '/') {
+            sb_putc(sb, '\\');
+        } else if (is_escaped(c)) {
+            /* UTF-8 encoding of U+F000 + c */
+            esc[0] = (char)0xEF;
+            esc[1] = (char)(0x80 | (c >> 6));
+            esc[2] = (char)(0x80 | (c & 0x3F));
+            sb_append(sb, esc, 3);
+        } else {
+            sb_putc(sb, (char)c);
+        }
+    }
+}
+
+/* append 'path' to 'sb', resolving "." and ".." lexically */
+static void append_normalized(STRBUF *sb, const char *path)
+{
+    const char *p = path, *end;
+    size_t n;
+
+    while (*p) {
+        while (*p == '/') p++;
+        for (end = p; *end && *end != '/'; end++)
+            ;
+        n = (size_t)(end - p);
+
+        if (n == 0 || (n == 1 && p[0] == '.')) {
+            /* skip */
+        } else if (n == 2 && p[0] == '.' && p[1] == '.') {
+            while (sb->len > 0 && sb->p[sb->len-1] != '/') sb->len--;
+            if (sb->len > 0) sb->len--;
+            if (sb->p) sb->p[sb->len] = 0;
+        } else {
+            sb_putc(sb, '/');
+            sb_append(sb, p, n);
+        }
+
+        p = end;
+    }
+}
+
+/**
+ * Express the directory of the Windows path 'link' as a Linux path.
+ * Sets 'distro' to "\\<server>\<name>" if it's inside of a distribution.
+ * Returns 0 if the directory isn't visible from Linux.
+ */
+static int link_dir_to_linux(const LX_PATH_TABLE *table, const char *root,
+                             const char *link, STRBUF *out, STRBUF *distro)
+{
+    STRBUF win = {0};
+    const char *p = link, *name, *rest;
+    size_t i, n, best = 0, len;
+    const LX_MOUNT *mount = NULL;
+    int unc = 0, ok = 0;
+
+    if (strncmp(p, "\\\\?\\UNC\\", 8) == 0) {
+        p += 8;
+        unc = 1;
+    } else if (strncmp(p, "\\\\?\\", 4) == 0) {
+        p += 4;
+    } else if (is_sep(p[0]) && is_sep(p[1])) {
+        p += 2;
+        unc = 1;
+    }
+
+    /* directory part */
+    for (len = strlen(p); len > 0 && !is_sep(p[len-1]); len--)
+        ;
+    while (len > 0 && is_sep(p[len-1])) len--;
+
+    if (unc) sb_append(&win, "\\\\", 2);
+    sb_append(&win, p, len);
+
+    if (win.failed) {
+        free(win.p);
+        out->failed = 1;
+        return 0;
+    }
+
+    for (i = 0; i < table->mount_count; i++) {
+        n = match_windows(win.p, table->mounts[i].windows_prefix);
+        if (n > best) {
+            best = n;
+            mount = &table->mounts[i];
+        }
+    }
+
+    if (mount) {
+        sb_append(out, mount->linux_prefix, trimmed_len(mount->linux_prefix));
+        append_as_linux(out, win.p + best, win.len - best);
+        ok = 1;
+    } else if (!unc && isalpha((unsigned char)win.p[0]) && win.p[1] == ':' &&
+               (win.p[2] == 0 || is_sep(win.p[2])))
+    {
+        /* "X:\dir" -> "/mnt/x/dir" */
+        sb_append(out, root, strlen(root));
+        sb_putc(out, (char)tolower((unsigned char)win.p[0]));
+        append_as_linux(out, win.p + 2, win.len - 2);
+        ok = 1;
+    } else if (unc && ((n = match_windows(win.p, "\\\\wsl$")) > 0 ||
+                       (n = match_windows(win.p, "\\\\wsl.localhost")) > 0) &&
+               win.p[n] != 0)
+    {
+        /* "\\wsl$\<name>\dir" -> "/dir" */
+        name = win.p + n + 1;
+        for (rest = name; *rest && !is_sep(*rest); rest++)
+            ;
+
+        if (rest > name) {
+            sb_append(distro, win.p, (size_t)(rest - win.p));
+            append_as_linux(out, rest, strlen(rest));
+            ok = 1;
+        }
+    }
+
+    free(win.p);
+
+    return ok;
+}
+
+/* case-insensitive ASCII comparison of the 'n' bytes at 's' with 'name' */
+static int name_equal(const char *s, size_t n, const char *name)
+{
+    size_t i;
+
+    if (strlen(name) != n) return 0;
+
+    for (i = 0; i < n; i++) {
+        if (tolower((unsigned char)s[i]) != tolower((unsigned char)name[i])) return 0;
+    }
+
+    return 1;
+}
+
+/* the listed distribution whose settings apply to 'link' or NULL */
+static const LX_DISTRO *find_distro(const LX_PATH_TABLE *table, const char *link)
+{
+    const char *p = NULL, *name = NULL;
+    size_t i, n, len = 0;
+
+    if (strncmp(link, "\\\\?\\UNC\\", 8) == 0) {
+        p = link + 8;
+    } else if (is_sep(link[0]) && is_sep(link[1]) && link[2] != '?') {
+        p = link + 2;
+    }
+
+    if (p && ((n = match_windows(p, "wsl$")) > 0 || (n = match_windows(p, "wsl.localhost")) > 0) &&
+        p[n] != 0)
+    {
+        /* "\\wsl$\<name>\..." */
+        name = p + n + 1;
+        while (name[len] && !is_sep(name[len])) len++;
+    } else if (table->default_distro) {
+        name = table->default_distro;
+        len = strlen(name);
+    }
+
+    for (i = 0; name && i < table->distro_count; i++) {
+        if (name_equal(name, len, table->distros[i].name)) {
+            return &table->distros[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* relative target of a link that Linux can't see: join on the Windows side */
+static void join_windows(STRBUF *out, const char *link, const char *target)
+{
+    size_t len;
+
+    for (len = strlen(link); len > 0 && !is_sep(link[len-1]); len--)
+        ;
+
+    sb_append(out, link, len);
+    append_as_windows(out, target);
+}
+
+int lx_path_translate(const LX_PATH_TABLE *table, const char *link,
+                      const char *target, char **result)
+{
+    STRBUF dir = {0}, distro = {0}, norm = {0}, out = {0};
+    const LX_MOUNT *mount = NULL;
+    const LX_DISTRO *d;
+    LX_PATH_TABLE view;
+    const char *root, *path;
+    char rootbuf[260];
+    size_t i, n, best = 0;
+    int rv = LX_PATH_OK;
+
+    *result = NULL;
+
+    /* the link is seen through the settings of its distribution */
+    if ((d = find_distro(table, link)) != NULL) {
+        view = *table;
+        view.automount_root = d->automount_root;
+        view.mounts = d->mounts;
+        view.mount_count = d->mount_count;
+        table = &view;
+    }
+
+    /* automount root with a trailing slash */
+    root = table->automount_root ? table->automount_root : "/mnt/";
+    n = strlen(root);
+
+    if (n == 0 || n + 2 > sizeof(rootbuf)) return LX_PATH_UNRESOLVED;
+
+    memcpy(rootbuf, root, n + 1);
+    if (rootbuf[n-1] != '/') memcpy(rootbuf + n, "/", 2);
+    root = rootbuf;
+
+    if (target[0] != '/') {
+        if (!link_dir_to_linux(table, root, link, &dir, &distro)) {
+            free(dir.p);
+            free(distro.p);
+
+            if (dir.failed || distro.failed) return LX_PATH_NOMEM;
+
+            join_windows(&out, link, target);
+            if (out.failed) return LX_PATH_NOMEM;
+
+            *result = out.p;
+            return LX_PATH_OK;
+        }
+    } else {
+        /* only the distribution is of interest */
+        link_dir_to_linux(table, root, link, &dir, &distro);
+        dir.len = 0;
+        if (dir.p) dir.p[0] = 0;
+    }
+
+    if (dir.len > 0) append_normalized(&norm, dir.p);
+    append_normalized(&norm, target);
+    path = norm.p ? norm.p : "";
+
+    if (dir.failed || distro.failed || norm.failed) {
+        rv = LX_PATH_NOMEM;
+        goto done;
+    }
+
+    /* additional mounts, longest match wins */
+    for (i = 0; i < table->mount_count; i++) {
+        n = match_linux(path, table->mounts[i].linux_prefix);
+        if (n > best) {
+            best = n;
+            mount = &table->mounts[i];
+        }
+    }
+
+    if (mount) {
+        sb_append(&out, mount->windows_prefix, trimmed_len(mount->windows_prefix));
+        if (path[best] == 0) sb_putc(&out, '\\');
+        append_as_windows(&out, path + best);
+    } else if (strncmp(path, root, (n = strlen(root))) == 0 &&
+               isalpha((unsigned char)path[n]) &&
+               (path[n+1] == 0 || path[n+1] == '/'))
+    {
+        /* "/mnt/x/dir" -> "X:\dir" */
+        sb_putc(&out, (char)toupper((unsigned char)path[n]));
+        sb_putc(&out, ':');
+        if (path[n+1] == 0) sb_putc(&out, '\\');
+        append_as_windows(&out, path + n + 1);
+    } else if (distro.len > 0 || table->default_distro) {
+        if (distro.len > 0) {
+            sb_append(&out, distro.p, distro.len);
+        } else {
+            sb_append(&out, "\\\\wsl$\\", 7);
+            sb_append(&out, table->default_distro, strlen(table->default_distro));
+        }
+        if (path[0] == 0) sb_putc(&out, '\\');
+        append_as_windows(&out, path);
+    } else {
+        rv = LX_PATH_UNRESOLVED;
+    }
+
+    if (out.failed) rv = LX_PATH_NOMEM;
+
+done:
+    free(dir.p);
+    free(distro.p);
+    free(norm.p);
+
+    if (rv == LX_PATH_OK) {
+        *result = out.p;
+    } else {
+        free(out.p);
+    }
+
+    return rv;
+}
+
+
+
+
+static char *dup_n(const char *s, size_t n)
+{
+    char *buf;
+
+    if ((buf = malloc(n + 1)) != NULL) {
+        memcpy(buf, s, n);
+        buf[n] = 0;
+    }
+
+    return buf;
+}
+
+/* copy 'n' bytes, undoing the octal escapes of fstab ("\040" is a space) */
+static char *unescape_field(const char *s, size_t n)
+{
+    char *buf, *q;
+    size_t i;
+
+    if ((buf = malloc(n + 1)) == NULL) return NULL;
+
+    for (q = buf, i = 0; i < n; i++) {
+        if (s[i] == '\\' && i + 3 < n &&
+            s[i+1] >= '0' && s[i+1] <= '3' &&
+            s[i+2] >= '0' && s[i+2] <= '7' &&
+            s[i+3] >= '0' && s[i+3] <= '7')
+        {
+            *q++ = (char)(((s[i+1] - '0') << 6) | ((s[i+2] - '0') << 3) | (s[i+3] - '0'));
+            i += 3;
+        } else {
+            *q++ = s[i];
+        }
+    }
+
+    *q = 0;
+
+    return buf;
+}
+
+static const char *skip_space(const char *p, const char *end)
+{
+    while (p < end && isspace((unsigned char)*p)) p++;
+
+    return p;
+}
+
+/* [automount] root and mountFsTab of /etc/wsl.conf */
+static int parse_wsl_conf(const char *text, LX_CONFIG *config, int *use_fstab)
+{
+    const char *line, *end, *p, *eq, *key_end, *v, *v_end;
+    int automount = 0;
+
+    for (line = text; *line; line = *end ? end + 1 : end) {
+        for (end = line; *end && *end != '\n'; end++)
+            ;
+
+        p = skip_space(line, end);
+
+        if (p == end || *p == '#' || *p == ';') {
+            continue;
+        }
+
+        if (*p == '[') {
+            for (key_end = p + 1; key_end < end && *key_end != ']'; key_end++)
+                ;
+            automount = name_equal(p + 1, (size_t)(key_end - p - 1), "automount");
+            continue;
+        }
+
+        if (!automount || (eq = memchr(p, '=', (size_t)(end - p))) == NULL) {
+            continue;
+        }
+
+        for (key_end = eq; key_end > p && isspace((unsigned char)key_end[-1]); key_end--)
+            ;
+
+        /* the value ends at a comment */
+        v = skip_space(eq + 1, end);
+        for (v_end = v; v_end < end && *v_end != '#'; v_end++)
+            ;
+        while (v_end > v && isspace((unsigned char)v_end[-1])) v_end--;
+
+        if (v_end - v >= 2 && (*v == '"' || *v == '\'') && v_end[-1] == *v) {
+            v++;
+            v_end--;
+        }
+
+        if (name_equal(p, (size_t)(key_end - p), "root") && v_end > v) {
+            free(config->automount_root);
+
+            if ((config->automount_root = dup_n(v, (size_t)(v_end - v))) == NULL) {
+                return LX_PATH_NOMEM;
+            }
+        } else if (name_equal(p, (size_t)(key_end - p), "mountFsTab")) {
+            *use_fstab = !name_equal(v, (size_t)(v_end - v), "false");
+        }
+    }
+
+    return LX_PATH_OK;
+}
+
+/* "drvfs" entries of /etc/fstab: "D:\data /data drvfs ..." */
+static int parse_fstab(const char *text, LX_CONFIG *config)
+{
+    const char *line, *end, *p, *field[3];
+    size_t len[3];
+    LX_MOUNT *m;
+    char *win, *lnx;
+    int nf;
+
+    for (line = text; *line; line = *end ? end + 1 : end) {
+        for (end = line; *end && *end != '\n'; end++)
+            ;
+
+        for (p = line, nf = 0; nf < 3; nf++) {
+            p = skip_space(p, end);
+            if (p == end || *p == '#') break;
+
+            field[nf] = p;
+            while (p < end && !isspace((unsigned char)*p)) p++;
+            len[nf] = (size_t)(p - field[nf]);
+        }
+
+        if (nf < 3 || field[1][0] != '/' || !name_equal(field[2], len[2], "drvfs")) {
+            continue;
+        }
+
+        if ((m = realloc(config->mounts, (config->mount_count + 1) * sizeof(LX_MOUNT))) == NULL) {
+            return LX_PATH_NOMEM;
+        }
+
+        config->mounts = m;
+        win = unescape_field(field[0], len[0]);
+        lnx = unescape_field(field[1], len[1]);
+
+        if (!win || !lnx) {
+            free(win);
+            free(lnx);
+            return LX_PATH_NOMEM;
+        }
+
+        m[config->mount_count].windows_prefix = win;
+        m[config->mount_count].linux_prefix = lnx;
+        config->mount_count++;
+    }
+
+    return LX_PATH_OK;
+}
+
+int lx_config_parse(const char *wsl_conf, const char *fstab, LX_CONFIG *config)
+{
+    int use_fstab = 1, rv = LX_PATH_OK;
+
+    memset(config, 0, sizeof(LX_CONFIG));
+
+    if (wsl_conf) {
+        rv = parse_wsl_conf(wsl_conf, config, &use_fstab);
+    }
+
+    if (rv == LX_PATH_OK && fstab && use_fstab) {
+        rv = parse_fstab(fstab, config);
+    }
+
+    return rv;
+}
+
+void lx_config_free(LX_CONFIG *config)
+{
+    size_t i;
+
+    for (i = 0; i < config->mount_count; i++) {
+        free((char *)config->mounts[i].linux_prefix);
+        free((char *)config->mounts[i].windows_prefix);
+    }
+
+    free(config->mounts);
+    free(config->automount_root);
+    memset(config, 0, sizeof(LX_CONFIG));
+}
@@ -0,0 +1,104 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_LX_PATH_H_INCLUDED
+#define W32_SYMLINK_LX_PATH_H_INCLUDED
+
+/* This file must not depend on windows.h so the translation can be
+ * built and tested on other platforms. All strings are UTF-8. */
+
+#include <stddef.h>
+
+
+#define LX_PATH_OK           0
+#define LX_PATH_NOMEM       -1
+#define LX_PATH_UNRESOLVED  -2  /* no Windows counterpart */
+
+
+/* a Linux directory that is mounted from a Windows path (DrvFs) */
+typedef struct {
+    const char *linux_prefix;    /* "/data" */
+    const char *windows_prefix;  /* "D:\\data" */
+} LX_MOUNT;
+
+/* the settings of one WSL distribution */
+typedef struct {
+    const char     *name;            /* "Ubuntu" */
+    const char     *automount_root;  /* "/mnt/" if NULL */
+    const LX_MOUNT *mounts;
+    size_t          mount_count;
+} LX_DISTRO;
+
+/**
+ * What the Linux side looks like.
+ *
+ * Drives are mounted below 'automount_root' ("/mnt/" if NULL) as
+ * lowercase drive letters. 'mounts' are additional DrvFs mounts.
+ * Absolute paths outside of any mount are located inside of the
+ * distribution the link belongs to, or 'default_distro' if the link
+ * is on a Windows drive. A NULL 'default_distro' leaves those unresolved.
+ *
+ * If that distribution is listed in 'distros', its automount root and
+ * mounts are used instead of the ones above.
+ */
+typedef struct {
+    const char      *automount_root;
+    const LX_MOUNT  *mounts;
+    size_t           mount_count;
+    const char      *default_distro;
+    const LX_DISTRO *distros;
+    size_t           distro_count;
+} LX_PATH_TABLE;
+
+
+/* settings read from a distribution's configuration files */
+typedef struct {
+    char     *automount_root;    /* NULL if not configured */
+    LX_MOUNT *mounts;            /* the strings are owned by the config */
+    size_t    mount_count;
+} LX_CONFIG;
+
+/**
+ * Parse the contents of a distribution's /etc/wsl.conf and /etc/fstab,
+ * either of which may be NULL. The automount root is read from the
+ * "root" key of the [automount] section; the "drvfs" entries of fstab
+ * become mounts unless "mountFsTab = false" is set there.
+ * Returns LX_PATH_OK or LX_PATH_NOMEM; free 'config' with
+ * lx_config_free() in either case.
+ */
+int lx_config_parse(const char *wsl_conf, const char *fstab, LX_CONFIG *config);
+
+void lx_config_free(LX_CONFIG *config);
+
+
+/**
+ * Translate the target of a LX symlink into a Windows path.
+ * 'link' is the Windows path of the link itself; distribution roots are
+ * recognized as "\\wsl$\<name>" and "\\wsl.localhost\<name>".
+ * On success *result is set to a string that must be deallocated with
+ * free(). Returns one of the LX_PATH_* values.
+ */
+int lx_path_translate(const LX_PATH_TABLE *table, const char *link,
+                      const char *target, char **result);
+
+#endif /* W32_SYMLINK_LX_PATH_H_INCLUDED */
@@ -0,0 +1,353 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calltrace.h"
+#include "convert.h"
+#include "volmap.h"
+#include "w32-symlink.h"
+
+/* "Volume{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}" */
+#define GUID_NAME_LEN  44
+
+
+typedef struct {
+    wchar_t guid[GUID_NAME_LEN + 1];
+    wchar_t *device;    /* "\Device\HarddiskVolume1" */
+    wchar_t *mount;     /* first mount path, "C:\"; NULL if not mounted */
+} VOLUME;
+
+
+static SRWLOCK cache_lock = SRWLOCK_INIT;
+static VOLUME *volumes = NULL;
+static size_t volume_count = 0;
+static DWORD drive_mask = 0;     /* GetLogicalDrives() when loaded */
+static BOOL loaded = FALSE;
+
+
+/* cache_lock must be held exclusively */
+static void free_volumes(void)
+{
+    size_t i;
+
+    for (i = 0; i < volume_count; i++) {
+        free(volumes[i].device);
+        free(volumes[i].mount);
+    }
+
+    free(volumes);
+    volumes = NULL;
+    volume_count = 0;
+    loaded = FALSE;
+}
+
+/* 'volume' is "\\?\Volume{...}\" */
+static wchar_t *first_mount_path(const wchar_t *volume)
+{
+    wchar_t *buf = NULL, *p;
+    DWORD size = MAX_PATH, needed = 0;
+
+    for (;;) {
+        if ((p = realloc(buf, size * sizeof(wchar_t))) == NULL) {
+            break;
+        }
+
+        buf = p;
+
+        /* a list of strings; the first one is the preferred path */
+        if (GetVolumePathNamesForVolumeNameW(volume, buf, size, &needed)) {
+            if (buf[0] != 0) return buf;
+            break;
+        }
+
+        if (GetLastError() != ERROR_MORE_DATA || needed <= size) {
+            break;
+        }
+
+        size = needed;
+    }
+
+    free(buf);
+
+    return NULL;
+}
+
+/* cache_lock must be held exclusively */
+static void load_volumes(void)
+{
+    wchar_t name[MAX_PATH], device[MAX_PATH];
+    VOLUME *v, *p;
+    size_t len, cap = 0;
+    HANDLE hFind;
+
+    free_volumes();
+    drive_mask = GetLogicalDrives();
+    loaded = TRUE;
+
+    if ((hFind = FindFirstVolumeW(name, MAX_PATH)) == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    do {
+        len = wcslen(name);
+
+        /* "\\?\Volume{...}\" */
+        if (len != GUID_NAME_LEN + 5 || wcsncmp(name, L"\\\\?\\Volume{", 11) != 0) {
+            continue;
+        }
+
+        if (volume_count == cap) {
+            if ((p = realloc(volumes, (cap ? cap * 2 : 16) * sizeof(VOLUME))) == NULL) {
+                break;
+            }
+            volumes = p;
+            cap = cap ? cap * 2 : 16;
+        }
+
+        v = &volumes[volume_count++];
+        wmemcpy(v->guid, name + 4, GUID_NAME_LEN);
+        v->guid[GUID_NAME_LEN] = 0;
+
+        /* QueryDosDevice() wants the name without "\\?\" and the trailing '\' */
+        name[len-1] = 0;
+        v->device = QueryDosDeviceW(name + 4, device, MAX_PATH) ? _wcsdup(device) : NULL;
+        name[len-1] = L'\\';
+
+        v->mount = first_mount_path(name);
+    } while (FindNextVolumeW(hFind, name, MAX_PATH));
+
+    FindVolumeClose(hFind);
+}
+
+/* mount path + rest, skipping the separator between them */
+static wchar_t *join_mount(const wchar_t *mount, const wchar_t *rest)
+{
+    wchar_t *buf;
+    size_t mlen = wcslen(mount), rlen;
+
+    if (*rest == L'\\') rest++;
+    rlen = wcslen(rest);
+
+    if ((buf = malloc((mlen + rlen + 1) * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    wmemcpy(buf, mount, mlen);
+    wmemcpy(buf + mlen, rest, rlen + 1);
+
+    return buf;
+}
+
+/**
+ * "\??\Volume{...}\rest", "\\?\Volume{...}\rest" or "\Device\...\rest"
+ * -> "C:\rest" or "\\server\share\rest".
+ * Result must be deallocated with free().
+ */
+static wchar_t *map_path(const wchar_t *path)
+{
+    wchar_t *buf = NULL;
+    const wchar_t *guid = NULL, *rest;
+    size_t i, n;
+    BOOL found = FALSE, mounted = FALSE;
+
+    if (_wcsnicmp(path, L"\\Device\\Mup\\", 12) == 0) {
+        /* network paths don't need a lookup */
+        if ((buf = join_mount(L"\\\\", path + 12)) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        }
+        return buf;
+    }
+
+    if ((wcsncmp(path, L"\\??\\", 4) == 0 || wcsncmp(path, L"\\\\?\\", 4) == 0) &&
+        _wcsnicmp(path + 4, L"Volume{", 7) == 0)
+    {
+        guid = path + 4;
+        if (wcsnlen(guid, GUID_NAME_LEN + 1) < GUID_NAME_LEN ||
+            (guid[GUID_NAME_LEN] != 0 && guid[GUID_NAME_LEN] != L'\\'))
+        {
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return NULL;
+        }
+    } else if (_wcsnicmp(path, L"\\Device\\", 8) != 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    AcquireSRWLockShared(&cache_lock);
+
+    /* new or removed drive letters invalidate the cache */
+    if (!loaded || GetLogicalDrives() != drive_mask) {
+        ReleaseSRWLockShared(&cache_lock);
+        AcquireSRWLockExclusive(&cache_lock);
+        if (!loaded || GetLogicalDrives() != drive_mask) load_volumes();
+        ReleaseSRWLockExclusive(&cache_lock);
+        AcquireSRWLockShared(&cache_lock);
+    }
+
+    for (i = 0; i < volume_count && !found; i++) {
+        const VOLUME *v = &volumes[i];
+
+        if (guid) {
+            if (_wcsnicmp(guid, v->guid, GUID_NAME_LEN) != 0) continue;
+            rest = guid + GUID_NAME_LEN;
+        } else {
+            if (!v->device) continue;
+            n = wcslen(v->device);
+            if (_wcsnicmp(path, v->device, n) != 0 || (path[n] != 0 && path[n] != L'\\')) {
+                continue;
+            }
+            rest = path + n;
+        }
+
+        found = TRUE;
+
+        if (v->mount) {
+            mounted = TRUE;
+            buf = join_mount(v->mount, rest);
+        }
+    }
+
+    ReleaseSRWLockShared(&cache_lock);
+
+    if (!buf) {
+        SetLastError(mounted ? ERROR_NOT_ENOUGH_MEMORY : ERROR_PATH_NOT_FOUND);
+    }
+
+    return buf;
+}
+
+static wchar_t *get_final_path(HANDLE handle, DWORD flags)
+{
+    wchar_t *buf;
+    DWORD len;
+
+    if ((len = traced_GetFinalPathNameByHandleW(handle, NULL, 0, flags)) == 0) {
+        return NULL;
+    }
+
+    if ((buf = malloc((len + 1) * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if (traced_GetFinalPathNameByHandleW(handle, buf, len + 1, flags) == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    buf[len] = 0;
+
+    return buf;
+}
+
+wchar_t *final_path_by_handle(HANDLE handle, DWORD flags)
+{
+    wchar_t *ntpath, *mapped, *buf;
+    size_t len;
+
+    if ((flags & (VOLUME_NAME_GUID | VOLUME_NAME_NT | VOLUME_NAME_NONE)) != 0) {
+        return get_final_path(handle, flags);
+    }
+
+    ntpath = get_final_path(handle, flags | VOLUME_NAME_NT);
+    mapped = ntpath ? map_path(ntpath) : NULL;
+    free(ntpath);
+
+    if (!mapped) {
+        /* not in the cache, let the mount manager figure it out */
+        return get_final_path(handle, flags);
+    }
+
+    /* same form as VOLUME_NAME_DOS: "\\?\C:\..." or "\\?\UNC\server\..." */
+    len = wcslen(mapped);
+
+    if ((buf = malloc((len + 7) * sizeof(wchar_t))) == NULL) {
+        free(mapped);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if (mapped[0] == L'\\' && mapped[1] == L'\\') {
+        wmemcpy(buf, L"\\\\?\\UNC", 7);
+        wmemcpy(buf + 7, mapped + 1, len);
+    } else {
+        wmemcpy(buf, L"\\\\?\\", 4);
+        wmemcpy(buf + 4, mapped, len + 1);
+    }
+
+    free(mapped);
+
+    return buf;
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+char *mapVolumePathA(const char *lpPath)
+{
+    wchar_t *wcs_in, *wcs_out;
+    char *buf;
+
+    if (!lpPath) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    /* convert string */
+    wcs_in = convert_str_to_wcs(lpPath);
+    if (!wcs_in) return NULL;
+
+    /* call wide character function */
+    wcs_out = mapVolumePathW(wcs_in);
+    free(wcs_in);
+    if (!wcs_out) return NULL;
+
+    /* convert string */
+    buf = convert_wcs_to_str(wcs_out);
+    free(wcs_out);
+
+    return buf;
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+wchar_t *mapVolumePathW(const wchar_t *lpPath)
+{
+    if (!lpPath) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    return map_path(lpPath);
+}
+
+void flushVolumeMountCache(void)
+{
+    AcquireSRWLockExclusive(&cache_lock);
+    free_volumes();
+    ReleaseSRWLockExclusive(&cache_lock);
+}
@@ -0,0 +1,450 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "strpool.h"
+#include "walk.h"
+#include "workers.h"
+#include "w32-symlink.h"
+
+
+typedef struct {
+    uint32_t path;      /* path relative to the source directory */
+    BOOL     is_dir;    /* taken from the enumeration */
+} ITEM;
+
+typedef struct {
+    DWORD          flags;
+    const wchar_t *source;       /* full path of the source directory */
+    size_t         source_len;
+    size_t         rel_offset;   /* start of the relative part of an entry path */
+    const wchar_t *target;       /* full path of the target directory */
+    size_t         target_len;
+    wchar_t       *up;           /* relative path from target to source, NULL = absolute */
+    size_t         up_len;
+    STRPOOL        pool;
+    ITEM          *items;
+    size_t         count;
+    size_t         capacity;
+    BOOL           nomem;
+    MIRROR_STATS   st;
+    volatile LONG  links;
+    volatile LONG  failed;
+    volatile LONG  error;        /* first error, 0 = none */
+} MIRROR;
+
+
+static void set_error(MIRROR *m, DWORD err)
+{
+    InterlockedIncrement(&m->failed);
+    InterlockedCompareExchange(&m->error, (LONG)err, 0);
+}
+
+/* "dir" + "\\" + "rel"; with 'prefix' set, "\\?\\" is put in front of paths
+ * that are too long for the legacy functions */
+static wchar_t *join(const wchar_t *dir, size_t dirlen,
+                     const wchar_t *rel, size_t rellen, BOOL prefix)
+{
+    size_t n = 0, len = dirlen + 1 + rellen;
+    wchar_t *buf;
+
+    if (prefix && len >= MAX_PATH && wcsncmp(dir, L"\\\\", 2) != 0) {
+        n = 4;
+    }
+
+    if ((buf = malloc((n + len + 1) * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    if (n) wmemcpy(buf, L"\\\\?\\", 4);
+    wmemcpy(buf + n, dir, dirlen);
+    buf[n + dirlen] = L'\\';
+    wmemcpy(buf + n + dirlen + 1, rel, rellen);
+    buf[n + len] = 0;
+
+    return buf;
+}
+
+static size_t next_component(const wchar_t *path, size_t pos, size_t len)
+{
+    while (pos < len && path[pos] != L'\\') pos++;
+    return pos;
+}
+
+/* length of "C:" or "\\\\server\\share" (also "\\\\?\\C:") */
+static size_t root_length(const wchar_t *path, size_t len)
+{
+    size_t pos = 0;
+    int i;
+
+    if (len < 2 || path[0] != L'\\' || path[1] != L'\\') {
+        return next_component(path, 0, len);
+    }
+
+    for (i = 0, pos = 2; i < 2 && pos < len; i++) {
+        pos = next_component(path, pos, len);
+        if (i == 0) pos++;
+    }
+
+    return pos;
+}
+
+/* compute the relative path from the target to the source directory,
+ * i.e. "..\..\src\" for "C:\a\out\farm" and "C:\a\src" */
+static BOOL make_up_path(MIRROR *m)
+{
+    const wchar_t *s = m->source, *t = m->target;
+    size_t common = 0, si = 0, ti = 0, ups = 0, rest, i, n;
+
+    /* find the common leading components */
+    for (;;) {
+        size_t se = next_component(s, si, m->source_len);
+        size_t te = next_component(t, ti, m->target_len);
+
+        if (se - si != te - ti || _wcsnicmp(s + si, t + ti, se - si) != 0) {
+            break;
+        }
+
+        common = se;
+        si = ti = se + 1;
+
+        if (se >= m->source_len || te >= m->target_len) {
+            break;
+        }
+    }
+
+    /* different drives or shares: use absolute targets */
+    if (common < root_length(s, m->source_len)) {
+        return TRUE;
+    }
+
+    /* count the target's components below the common part */
+    for (i = common; i < m->target_len; i++) {
+        if (t[i] == L'\\') ups++;
+    }
+
+    if (t[m->target_len-1] == L'\\') {
+        /* root directory */
+        ups--;
+    }
+
+    rest = (common < m->source_len) ? m->source_len - common - 1 : 0;
+    m->up_len = ups * 3 + rest + (rest ? 1 : 0);
+
+    if ((m->up = malloc((m->up_len + 1) * sizeof(wchar_t))) == NULL) {
+        return FALSE;
+    }
+
+    for (i = 0, n = 0; i < ups; i++, n += 3) {
+        wmemcpy(m->up + n, L"..\\", 3);
+    }
+
+    if (rest) {
+        wmemcpy(m->up + n, s + common + 1, rest);
+        m->up[n + rest] = L'\\';
+    }
+
+    m->up[m->up_len] = 0;
+
+    return TRUE;
+}
+
+static wchar_t *link_target(const MIRROR *m, const wchar_t *rel, size_t rellen)
+{
+    size_t depth = 0, i, n, len;
+    wchar_t *buf;
+
+    if (!m->up) {
+        return join(m->source, m->source_len, rel, rellen, FALSE);
+    }
+
+    /* one more ".." for every directory between the link and the target root */
+    for (i = 0; i < rellen; i++) {
+        if (rel[i] == L'\\') depth++;
+    }
+
+    len = depth * 3 + m->up_len + rellen;
+
+    if ((buf = malloc((len + 1) * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    for (i = 0, n = 0; i < depth; i++, n += 3) {
+        wmemcpy(buf + n, L"..\\", 3);
+    }
+
+    wmemcpy(buf + n, m->up, m->up_len);
+    wmemcpy(buf + n + m->up_len, rel, rellen);
+    buf[len] = 0;
+
+    return buf;
+}
+
+static BOOL add_item(MIRROR *m, const wchar_t *rel, size_t rellen, BOOL is_dir)
+{
+    ITEM *p;
+    uint32_t id;
+
+    if (m->count == m->capacity) {
+        size_t n = m->capacity ? m->capacity * 2 : 256;
+
+        if ((p = realloc(m->items, n * sizeof(ITEM))) == NULL) {
+            return FALSE;
+        }
+
+        m->items = p;
+        m->capacity = n;
+    }
+
+    if ((id = strpool_intern(&m->pool, rel, rellen)) == STRPOOL_NONE) {
+        return FALSE;
+    }
+
+    m->items[m->count].path = id;
+    m->items[m->count].is_dir = is_dir;
+    m->count++;
+
+    return TRUE;
+}
+
+static BOOL make_dir(MIRROR *m, const wchar_t *path)
+{
+    DWORD dwAttr;
+
+    if (CreateDirectoryW(path, NULL)) {
+        m->st.dirs++;
+        return TRUE;
+    }
+
+    /* reuse existing directories */
+    if (GetLastError() == ERROR_ALREADY_EXISTS &&
+        (dwAttr = GetFileAttributesW(path)) != INVALID_FILE_ATTRIBUTES &&
+        (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        return TRUE;
+    }
+
+    set_error(m, GetLastError());
+
+    return FALSE;
+}
+
+static int collect_entry(void *ctx, const WALK_ENTRY *entry)
+{
+    MIRROR *m = (MIRROR *)ctx;
+    const wchar_t *rel = entry->path + m->rel_offset;
+    size_t rellen = entry->path_len - m->rel_offset;
+    BOOL is_dir = (entry->attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    wchar_t *path;
+    BOOL ok;
+
+    if (is_dir && entry->path_len == m->target_len &&
+        _wcsicmp(entry->path, m->target) == 0)
+    {
+        /* the target directory is inside of the source */
+        return WALK_SKIP;
+    }
+
+    /* links and junctions are linked as they are, never followed */
+    if (!is_dir || entry->reparse_tag != 0 || (m->flags & MIRROR_LINK_DIRS) != 0) {
+        if (!add_item(m, rel, rellen, is_dir)) {
+            m->nomem = TRUE;
+            return WALK_STOP;
+        }
+
+        return WALK_SKIP;
+    }
+
+    /* directories are created in walking order, so parents come first */
+    if ((path = join(m->target, m->target_len, rel, rellen, TRUE)) == NULL) {
+        m->nomem = TRUE;
+        return WALK_STOP;
+    }
+
+    ok = make_dir(m, path);
+    free(path);
+
+    return ok ? WALK_CONTINUE : WALK_SKIP;
+}
+
+static void create_link(void *ctx, size_t index)
+{
+    MIRROR *m = (MIRROR *)ctx;
+    const ITEM *item = &m->items[index];
+    const wchar_t *rel = strpool_get(&m->pool, item->path);
+    size_t rellen = strpool_length(&m->pool, item->path);
+    wchar_t *link, *target;
+
+    link = join(m->target, m->target_len, rel, rellen, TRUE);
+    target = link_target(m, rel, rellen);
+
+    if (!link || !target) {
+        set_error(m, ERROR_NOT_ENOUGH_MEMORY);
+    } else if (createLinkW(link, target, item->is_dir ? 'd' : 'f')) {
+        InterlockedIncrement(&m->links);
+    } else {
+        set_error(m, GetLastError());
+    }
+
+    free(link);
+    free(target);
+}
+
+/* full path without a trailing separator (except for root directories) */
+static wchar_t *full_dir_path(const wchar_t *path, size_t *plen)
+{
+    wchar_t *buf;
+    DWORD len;
+
+    if ((len = GetFullPathNameW(path, 0, NULL, NULL)) == 0) {
+        return NULL;
+    }
+
+    if ((buf = malloc(len * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if ((len = GetFullPathNameW(path, len, buf, NULL)) == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    while (len > 3 && buf[len-1] == L'\\') {
+        buf[--len] = 0;
+    }
+
+    *plen = len;
+
+    return buf;
+}
+
+BOOL mirrorTreeW(const wchar_t *lpSourceDir, const wchar_t *lpTargetDir,
+                 DWORD flags, unsigned int threads, MIRROR_STATS *pStats)
+{
+    MIRROR m;
+    wchar_t *source = NULL, *target = NULL;
+    DWORD err = 0;
+    BOOL ret = FALSE;
+
+    memset(&m, 0, sizeof(m));
+
+    if (!lpSourceDir || !*lpSourceDir || !lpTargetDir || !*lpTargetDir) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((source = full_dir_path(lpSourceDir, &m.source_len)) == NULL ||
+        (target = full_dir_path(lpTargetDir, &m.target_len)) == NULL)
+    {
+        free(source);
+        return FALSE;
+    }
+
+    m.flags = flags;
+    m.source = source;
+    m.target = target;
+    m.rel_offset = m.source_len + (source[m.source_len-1] == L'\\' ? 0 : 1);
+
+    if (!strpool_init(&m.pool, FALSE)) {
+        free(source);
+        free(target);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    if ((flags & MIRROR_RELATIVE) != 0 && !make_up_path(&m)) {
+        err = ERROR_NOT_ENOUGH_MEMORY;
+        goto done;
+    }
+
+    if (!make_dir(&m, target)) {
+        err = (DWORD)m.error;
+        goto done;
+    }
+
+    /* directories are created while walking, links are collected */
+    if (!walk_tree(source, collect_entry, &m)) {
+        err = GetLastError();
+        goto done;
+    }
+
+    if (m.nomem) {
+        err = ERROR_NOT_ENOUGH_MEMORY;
+        goto done;
+    }
+
+    if (m.count > 0) {
+        parallel_for(m.count, threads, create_link, &m);
+    }
+
+    if (m.failed == 0) {
+        ret = TRUE;
+    } else {
+        err = (DWORD)m.error;
+    }
+
+done:
+    m.st.links = (size_t)m.links;
+    m.st.failed = (size_t)m.failed;
+
+    if (pStats) *pStats = m.st;
+
+    strpool_free(&m.pool);
+    free(m.items);
+    free(m.up);
+    free(source);
+    free(target);
+
+    if (!ret) SetLastError(err);
+
+    return ret;
+}
+
+BOOL mirrorTreeA(const char *lpSourceDir, const char *lpTargetDir,
+                 DWORD flags, unsigned int threads, MIRROR_STATS *pStats)
+{
+    wchar_t *wsource, *wtarget;
+    BOOL ret;
+
+    if ((wsource = convert_str_to_wcs(lpSourceDir)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((wtarget = convert_str_to_wcs(lpTargetDir)) == NULL) {
+        free(wsource);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = mirrorTreeW(wsource, wtarget, flags, threads, pStats);
+    free(wsource);
+    free(wtarget);
+
+    return ret;
+}
@@ -0,0 +1,322 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <winternl.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calltrace.h"
+#include "linktarget.h"
+#include "ntapi.h"
+#include "reparse_data_buffer.h"
+#include "volmap.h"
+#include "w32-symlink.h"
+
+
+
+static HANDLE open_nt_path(const wchar_t *ntpath, size_t len, BOOL follow)
+{
+    if (!ntpath || len == 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return traced_nt_open(NULL, ntpath, len, FILE_READ_ATTRIBUTES,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE,
+                          FILE_OPEN_FOR_BACKUP_INTENT | (follow ? 0 : FILE_OPEN_REPARSE_POINT));
+}
+
+/* calls on a handle need no path translation, so the Win32 functions do */
+static BOOL get_reparse_data(HANDLE handle, void *buffer, DWORD bufsize, DWORD *psize)
+{
+    if (!traced_get_reparse_point(handle, buffer, bufsize, psize)) {
+        if (GetLastError() == ERROR_NOT_A_REPARSE_POINT) {
+            SetLastError(ERROR_NOT_SUPPORTED);
+        }
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+wchar_t *getNtPathW(const wchar_t *path)
+{
+    const NT_API *nt = nt_api();
+    UNICODE_STRING us;
+    NTSTATUS status;
+    wchar_t *buf;
+
+    if (!path || !*path) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if (!nt->RtlDosPathNameToNtPathName_U_WithStatus || !nt->RtlFreeUnicodeString) {
+        SetLastError(ERROR_CALL_NOT_IMPLEMENTED);
+        return NULL;
+    }
+
+    status = nt->RtlDosPathNameToNtPathName_U_WithStatus(path, &us, NULL, NULL);
+
+    if (!NT_SUCCESS(status)) {
+        nt_set_error(status);
+        return NULL;
+    }
+
+    if ((buf = malloc(us.Length + sizeof(wchar_t))) != NULL) {
+        memcpy(buf, us.Buffer, us.Length);
+        buf[us.Length / sizeof(wchar_t)] = 0;
+    } else {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    }
+
+    nt->RtlFreeUnicodeString(&us);
+
+    return buf;
+}
+
+static int is_symlink(const wchar_t *ntpath, size_t len, ULONG *tag)
+{
+    uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    FILE_ATTRIBUTE_TAG_INFO fati;
+    LINK_TARGET_VIEW view;
+    HANDLE handle;
+    DWORD attr, size = 0;
+    BOOL ok;
+
+    if (tag) {
+        *tag = 0;
+    }
+
+    if (!ntpath || len == 0 || len * sizeof(wchar_t) > 0xFFFE) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    /* like GetFileAttributesW(), no handle is opened */
+    if (!traced_nt_query_attributes(ntpath, len, &attr)) {
+        return -1;
+    }
+
+    if (!(attr & FILE_ATTRIBUTE_REPARSE_POINT)) {
+        /* not a symbolic link */
+        return FALSE;
+    }
+
+    if (!tag) {
+        /* a symbolic link but we don't
+         * need to know what kind of symlink */
+        return TRUE;
+    }
+
+    if ((handle = open_nt_path(ntpath, len, FALSE)) == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+
+    if (!traced_GetFileInformationByHandleEx(handle, FileAttributeTagInfo, &fati, sizeof(fati))) {
+        CloseHandle(handle);
+        return -1;
+    }
+
+    *tag = fati.ReparseTag;
+
+    if (*tag != IO_REPARSE_TAG_NFS) {
+        CloseHandle(handle);
+
+        switch (*tag)
+        {
+        case IO_REPARSE_TAG_SYMLINK:
+        case IO_REPARSE_TAG_MOUNT_POINT:
+        case IO_REPARSE_TAG_APPEXECLINK:
+        case IO_REPARSE_TAG_LX_SYMLINK:
+            return TRUE;
+
+        default:
+            break;
+        }
+
+        return FALSE;
+    }
+
+    /* only NFS symbolic links are links */
+    ok = get_reparse_data(handle, data, sizeof(data), &size);
+    CloseHandle(handle);
+
+    if (!ok) {
+        return -1;
+    }
+
+    return decode_link_view(data, size, &view) ? TRUE : FALSE;
+}
+
+int nt_is_symlink(const wchar_t *ntpath, size_t len, ULONG *tag)
+{
+    LONGLONG call;
+    int rv;
+
+    call = traced_enter(TRACE_API_NT_IS_SYMLINK, tag ? TRACE_FLAG_TAG : 0, ntpath, len);
+    rv = is_symlink(ntpath, len, tag);
+    traced_leave(call, rv == -1);
+
+    return rv;
+}
+
+int ntIsSymlinkW(const wchar_t *ntpath, ULONG *tag)
+{
+    return nt_is_symlink(ntpath, ntpath ? wcslen(ntpath) : 0, tag);
+}
+
+static BOOL link_target_view(const wchar_t *ntpath, size_t len, void *buffer, DWORD bufsize,
+                             LINK_TARGET_VIEW *pView)
+{
+    HANDLE handle;
+    DWORD size = 0;
+    BOOL ok;
+
+    if (!buffer || !pView) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((handle = open_nt_path(ntpath, len, FALSE)) == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    ok = get_reparse_data(handle, buffer, bufsize, &size);
+    CloseHandle(handle);
+
+    return ok ? decode_link_view(buffer, size, pView) : FALSE;
+}
+
+BOOL ntGetLinkTargetViewW(const wchar_t *ntpath, void *buffer, DWORD bufsize, LINK_TARGET_VIEW *pView)
+{
+    return link_target_view(ntpath, ntpath ? wcslen(ntpath) : 0, buffer, bufsize, pView);
+}
+
+wchar_t *nt_link_target(const wchar_t *ntpath, size_t len, ULONG *tag)
+{
+    uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    LINK_TARGET_VIEW view;
+    wchar_t *buf = NULL;
+    LONGLONG call;
+
+    call = traced_enter(TRACE_API_NT_LINK_TARGET, 0, ntpath, len);
+
+    if (link_target_view(ntpath, len, data, sizeof(data), &view) &&
+        (buf = copy_link_target(data, &view)) != NULL && tag)
+    {
+        *tag = view.tag;
+    }
+
+    traced_leave(call, buf == NULL);
+
+    return buf;
+}
+
+wchar_t *ntGetLinkTargetW(const wchar_t *ntpath, ULONG *tag)
+{
+    return nt_link_target(ntpath, ntpath ? wcslen(ntpath) : 0, tag);
+}
+
+static wchar_t *canonical_path(const wchar_t *ntpath, size_t len, DWORD flags)
+{
+    wchar_t *buf = NULL, *link;
+    HANDLE handle;
+    ULONG tag = 0;
+
+    if ((flags & ~(DWORD)(CANONICAL_PATH_GUID | CANONICAL_PATH_NT)) ||
+        flags == (CANONICAL_PATH_GUID | CANONICAL_PATH_NT))
+    {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if ((handle = open_nt_path(ntpath, len, TRUE)) == INVALID_HANDLE_VALUE) {
+        /* AppExec links can't be opened; try again with their target
+         * like getCanonicalPathW() does */
+        if ((link = nt_link_target(ntpath, len, &tag)) == NULL) {
+            return NULL;
+        }
+
+        if (tag == IO_REPARSE_TAG_LX_SYMLINK) {
+            /* translating the target needs the DOS path of the link */
+            free(link);
+            link = NULL;
+
+            if (len >= 4 && wcsncmp(ntpath, L"\\??\\", 4) == 0 &&
+                (link = malloc((len + 1) * sizeof(wchar_t))) != NULL)
+            {
+                wmemcpy(link, ntpath, len);
+                link[len] = 0;
+                link[1] = L'\\';  /* "\??\" -> "\\?\" */
+                buf = getCanonicalPathExW(link, flags);
+            } else {
+                SetLastError(ERROR_NOT_SUPPORTED);
+            }
+        } else if (wcsncmp(link, L"\\??\\", 4) == 0 || wcsncmp(link, L"\\\\?\\", 4) == 0) {
+            link[1] = L'\\';  /* "\??\" -> "\\?\" */
+            buf = getCanonicalPathExW(link, flags);
+        } else if (iswalpha(link[0]) && link[1] == L':' && (link[2] == L'\\' || link[2] == L'/')) {
+            /* only absolute DOS paths, like getCanonicalPathW() */
+            buf = getCanonicalPathExW(link, flags);
+        } else if (link[0] == L'\\' &&
+                   (handle = open_nt_path(link, wcslen(link), TRUE)) != INVALID_HANDLE_VALUE)
+        {
+            /* any other rooted target is an NT path, e.g. "\Device\..." */
+            buf = final_path_by_handle(handle, flags | FILE_NAME_NORMALIZED);
+            CloseHandle(handle);
+        } else if (link[0] != L'\\') {
+            SetLastError(ERROR_NOT_SUPPORTED);
+        }
+
+        free(link);
+
+        return buf;
+    }
+
+    /* CANONICAL_PATH_* are the VOLUME_NAME_* values */
+    buf = final_path_by_handle(handle, flags | FILE_NAME_NORMALIZED);
+    CloseHandle(handle);
+
+    return buf;
+}
+
+wchar_t *nt_canonical_path(const wchar_t *ntpath, size_t len, DWORD flags)
+{
+    LONGLONG call;
+    wchar_t *buf;
+
+    call = traced_enter(TRACE_API_NT_CANONICAL_PATH, flags, ntpath, len);
+    buf = canonical_path(ntpath, len, flags);
+    traced_leave(call, buf == NULL);
+
+    return buf;
+}
+
+wchar_t *ntGetCanonicalPathW(const wchar_t *ntpath, DWORD flags)
+{
+    return nt_canonical_path(ntpath, ntpath ? wcslen(ntpath) : 0, flags);
+}
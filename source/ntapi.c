@@ -0,0 +1,143 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <winternl.h>
+#include <wchar.h>
+#include "ntapi.h"
+
+
+static INIT_ONCE api_once = INIT_ONCE_STATIC_INIT;
+static NT_API api;
+
+
+#define LOAD(name)  api.name = (name##_t)(void *)GetProcAddress(ntdll, #name)
+
+static BOOL CALLBACK load_api(PINIT_ONCE once, PVOID param, PVOID *ctx)
+{
+    HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+
+    (void)once;
+    (void)param;
+    (void)ctx;
+
+    if (ntdll) {
+        LOAD(NtCreateFile);
+        LOAD(NtQueryAttributesFile);
+        LOAD(RtlDosPathNameToNtPathName_U_WithStatus);
+        LOAD(RtlFreeUnicodeString);
+        LOAD(RtlNtStatusToDosError);
+    }
+
+    return TRUE;
+}
+
+const NT_API *nt_api(void)
+{
+    InitOnceExecuteOnce(&api_once, load_api, NULL, NULL);
+    return &api;
+}
+
+BOOL nt_set_error(NTSTATUS status)
+{
+    const NT_API *nt = nt_api();
+
+    SetLastError(nt->RtlNtStatusToDosError ?
+                 nt->RtlNtStatusToDosError(status) : ERROR_GEN_FAILURE);
+
+    return FALSE;
+}
+
+HANDLE nt_open(HANDLE root, const wchar_t *name, size_t len,
+               ACCESS_MASK access, ULONG share, ULONG options)
+{
+    const NT_API *nt = nt_api();
+    OBJECT_ATTRIBUTES oa;
+    UNICODE_STRING us;
+    IO_STATUS_BLOCK iosb;
+    HANDLE handle;
+    NTSTATUS status;
+
+    if (!nt->NtCreateFile) {
+        SetLastError(ERROR_CALL_NOT_IMPLEMENTED);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    if (len * sizeof(wchar_t) > 0xFFFE) {
+        SetLastError(ERROR_FILENAME_EXCED_RANGE);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    us.Buffer = (PWSTR)name;
+    us.Length = (USHORT)(len * sizeof(wchar_t));
+    us.MaximumLength = us.Length;
+
+    InitializeObjectAttributes(&oa, &us, OBJ_CASE_INSENSITIVE, root, NULL);
+
+    /* synchronous I/O on the handle requires SYNCHRONIZE access */
+    status = nt->NtCreateFile(&handle, access | SYNCHRONIZE, &oa, &iosb, NULL, 0,
+                              share, FILE_OPEN, options | FILE_SYNCHRONOUS_IO_NONALERT,
+                              NULL, 0);
+
+    if (!NT_SUCCESS(status)) {
+        nt_set_error(status);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return handle;
+}
+
+BOOL nt_query_attributes(const wchar_t *name, size_t len, DWORD *attr)
+{
+    const NT_API *nt = nt_api();
+    FILE_BASIC_INFO fbi;
+    OBJECT_ATTRIBUTES oa;
+    UNICODE_STRING us;
+    NTSTATUS status;
+
+    if (!nt->NtQueryAttributesFile) {
+        SetLastError(ERROR_CALL_NOT_IMPLEMENTED);
+        return FALSE;
+    }
+
+    if (len * sizeof(wchar_t) > 0xFFFE) {
+        SetLastError(ERROR_FILENAME_EXCED_RANGE);
+        return FALSE;
+    }
+
+    us.Buffer = (PWSTR)name;
+    us.Length = (USHORT)(len * sizeof(wchar_t));
+    us.MaximumLength = us.Length;
+
+    InitializeObjectAttributes(&oa, &us, OBJ_CASE_INSENSITIVE, NULL, NULL);
+
+    status = nt->NtQueryAttributesFile(&oa, &fbi);
+
+    if (!NT_SUCCESS(status)) {
+        return nt_set_error(status);
+    }
+
+    *attr = fbi.FileAttributes;
+
+    return TRUE;
+}
@@ -0,0 +1,96 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_NTAPI_H_INCLUDED
+#define W32_SYMLINK_NTAPI_H_INCLUDED
+
+#include <windows.h>
+#include <winternl.h>
+#include <wchar.h>
+
+/* NtCreateFile() dispositions and options */
+#ifndef FILE_OPEN
+#define FILE_OPEN                     0x00000001
+#endif
+#ifndef FILE_SYNCHRONOUS_IO_NONALERT
+#define FILE_SYNCHRONOUS_IO_NONALERT  0x00000020
+#endif
+#ifndef FILE_OPEN_FOR_BACKUP_INTENT
+#define FILE_OPEN_FOR_BACKUP_INTENT   0x00004000
+#endif
+#ifndef FILE_OPEN_REPARSE_POINT
+#define FILE_OPEN_REPARSE_POINT       0x00200000
+#endif
+
+#ifndef NT_SUCCESS
+#define NT_SUCCESS(status)  ((NTSTATUS)(status) >= 0)
+#endif
+
+
+typedef NTSTATUS (NTAPI *NtCreateFile_t)(PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES,
+                                         PIO_STATUS_BLOCK, PLARGE_INTEGER, ULONG,
+                                         ULONG, ULONG, ULONG, PVOID, ULONG);
+typedef NTSTATUS (NTAPI *NtQueryAttributesFile_t)(POBJECT_ATTRIBUTES, FILE_BASIC_INFO *);
+typedef NTSTATUS (NTAPI *RtlDosPathNameToNtPathName_U_WithStatus_t)(PCWSTR, PUNICODE_STRING,
+                                                                    PWSTR *, PVOID);
+typedef VOID (NTAPI *RtlFreeUnicodeString_t)(PUNICODE_STRING);
+typedef ULONG (NTAPI *RtlNtStatusToDosError_t)(NTSTATUS);
+
+
+/* ntdll functions, resolved once; NULL if not available */
+typedef struct {
+    NtCreateFile_t                           NtCreateFile;
+    NtQueryAttributesFile_t                  NtQueryAttributesFile;
+    RtlDosPathNameToNtPathName_U_WithStatus_t RtlDosPathNameToNtPathName_U_WithStatus;
+    RtlFreeUnicodeString_t                   RtlFreeUnicodeString;
+    RtlNtStatusToDosError_t                  RtlNtStatusToDosError;
+} NT_API;
+
+const NT_API *nt_api(void);
+
+/* translate an NTSTATUS and set it as last error; always returns FALSE */
+BOOL nt_set_error(NTSTATUS status);
+
+/**
+ * Open the 'len' characters of 'name' with NtCreateFile(), relative to
+ * the directory 'root' if it is not NULL. No Win32 path translation is
+ * done, so 'name' must be an NT path or a plain relative name.
+ * Returns INVALID_HANDLE_VALUE and sets the last error on failure.
+ */
+HANDLE nt_open(HANDLE root, const wchar_t *name, size_t len,
+               ACCESS_MASK access, ULONG share, ULONG options);
+
+/**
+ * The attributes of the 'len' characters of the NT path 'name' through
+ * NtQueryAttributesFile(), which doesn't open a handle.
+ * Returns FALSE and sets the last error on failure.
+ */
+BOOL nt_query_attributes(const wchar_t *name, size_t len, DWORD *attr);
+
+/* ntNative.c: ntIsSymlinkW(), ntGetLinkTargetW() and ntGetCanonicalPathW()
+ * on the 'len' characters of 'ntpath', which need not be NUL-terminated */
+int      nt_is_symlink(const wchar_t *ntpath, size_t len, ULONG *tag);
+wchar_t *nt_link_target(const wchar_t *ntpath, size_t len, ULONG *tag);
+wchar_t *nt_canonical_path(const wchar_t *ntpath, size_t len, DWORD flags);
+
+#endif /* W32_SYMLINK_NTAPI_H_INCLUDED */
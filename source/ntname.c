@@ -0,0 +1,176 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "ntname.h"
+
+
+/* names that Win32 maps to devices when they are the last component */
+static const char * const dos_devices[] = {
+    "CON", "PRN", "AUX", "NUL", "CONIN$", "CONOUT$", NULL
+};
+
+
+static int is_sep(uint16_t c)
+{
+    return (c == '\\' || c == '/');
+}
+
+static int is_alpha(uint16_t c)
+{
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+}
+
+static uint16_t upper(uint16_t c)
+{
+    return (c >= 'a' && c <= 'z') ? (uint16_t)(c - 'a' + 'A') : c;
+}
+
+static int equals_ascii(const uint16_t *s, size_t n, const char *ascii)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (ascii[i] == 0 || upper(s[i]) != (uint16_t)ascii[i]) return 0;
+    }
+
+    return ascii[n] == 0;
+}
+
+/* "NUL", "nul.txt", "COM1 " ... */
+static int is_dos_device(const uint16_t *s, size_t n)
+{
+    size_t i, base = 0;
+
+    while (base < n && s[base] != '.' && s[base] != ':') base++;
+    while (base > 0 && s[base - 1] == ' ') base--;
+
+    for (i = 0; dos_devices[i]; i++) {
+        if (equals_ascii(s, base, dos_devices[i])) return 1;
+    }
+
+    /* COM1-COM9 and LPT1-LPT9, also with the superscript digits 1-3 */
+    if (base == 4 && (equals_ascii(s, 3, "COM") || equals_ascii(s, 3, "LPT"))) {
+        return (s[3] >= '0' && s[3] <= '9') ||
+               s[3] == 0xB9 || s[3] == 0xB2 || s[3] == 0xB3;
+    }
+
+    return 0;
+}
+
+static size_t put_ascii(uint16_t *buf, size_t k, const char *s)
+{
+    for ( ; *s; s++) {
+        buf[k++] = (uint16_t)*s;
+    }
+
+    return k;
+}
+
+/* Copy the components of path[pos..len) to buf[k..], separated by '\'.
+ * Returns the new length, or 0 if a component needs the Win32 rules. */
+static size_t copy_components(const uint16_t *path, size_t pos, size_t len,
+                              uint16_t *buf, size_t k, size_t *count)
+{
+    size_t start;
+
+    *count = 0;
+
+    while (pos < len) {
+        for (start = pos; pos < len && !is_sep(path[pos]); pos++) {
+            if (path[pos] == 0) return 0;
+            buf[k++] = path[pos];
+        }
+
+        /* empty (also a trailing separator), ".", ".." and "name." */
+        if (pos == start || path[pos - 1] == '.' || path[pos - 1] == ' ') {
+            return 0;
+        }
+
+        (*count)++;
+
+        if (pos == len) {
+            return is_dos_device(path + start, pos - start) ? 0 : k;
+        }
+
+        buf[k++] = '\\';
+        pos++;
+
+        if (pos == len) {
+            return 0;
+        }
+    }
+
+    return k;
+}
+
+size_t nt_name(const uint16_t *path, size_t len, uint16_t *buf, const uint16_t **name)
+{
+    size_t k, i, count;
+
+    *name = buf;
+
+    if (len == 0 || len > NT_NAME_MAX) {
+        return 0;
+    }
+
+    if (len >= 4 && path[0] == '\\' && path[3] == '\\' &&
+        (path[1] == '?' || path[1] == '\\') && path[2] == '?')
+    {
+        /* "\??\" and "\\?\" are not normalized by Win32 either */
+        for (i = 4; i < len; i++) {
+            if (path[i] == 0) return 0;
+        }
+
+        if (path[1] == '?') {
+            *name = path;
+            return len;
+        }
+
+        k = put_ascii(buf, 0, "\\??\\");
+        memcpy(buf + k, path + 4, (len - 4) * sizeof(uint16_t));
+
+        return len;
+    }
+
+    if (len >= 3 && is_alpha(path[0]) && path[1] == ':' && is_sep(path[2])) {
+        k = put_ascii(buf, 0, "\\??\\");
+        buf[k++] = path[0];
+        k = put_ascii(buf, k, ":\\");
+        k = copy_components(path, 3, len, buf, k, &count);
+    } else if (len >= 3 && is_sep(path[0]) && is_sep(path[1]) &&
+               path[2] != '?' && path[2] != '.')
+    {
+        k = put_ascii(buf, 0, "\\??\\UNC\\");
+        k = copy_components(path, 2, len, buf, k, &count);
+
+        /* at least "\\server\share" */
+        if (count < 2) k = 0;
+    } else {
+        return 0;
+    }
+
+    return (k > NT_NAME_MAX) ? 0 : k;
+}
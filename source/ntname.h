@@ -0,0 +1,61 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_NTNAME_H_INCLUDED
+#define W32_SYMLINK_NTNAME_H_INCLUDED
+
+/* This file must not depend on windows.h so it can be built and tested
+ * on other platforms. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* longest name a UNICODE_STRING can hold */
+#define NT_NAME_MAX    32767
+
+/* 'buf' of nt_name() must hold the length of the path plus this */
+#define NT_NAME_EXTRA  6
+
+
+/**
+ * Build the NT name of the fully qualified DOS path in the 'len'
+ * characters at 'path', which need not be NUL-terminated:
+ *
+ *  "\??\..."             is used as is, '*name' points into 'path'
+ *  "\\?\..."             becomes "\??\..."
+ *  "C:\..."              becomes "\??\C:\..."
+ *  "\\server\share\..."  becomes "\??\UNC\server\share\..."
+ *
+ * The last two forms may use '/' as a separator. Other names are
+ * written to 'buf'.
+ *
+ * Returns the length of the NT name, or 0 if the path needs the Win32
+ * path rules: relative and drive-relative paths, "\\.\" device paths,
+ * empty, "." and ".." components, components ending in a dot or space,
+ * DOS device names like "NUL" as the last component, NUL characters and
+ * names longer than NT_NAME_MAX.
+ */
+size_t nt_name(const uint16_t *path, size_t len, uint16_t *buf, const uint16_t **name);
+
+#endif /* W32_SYMLINK_NTNAME_H_INCLUDED */
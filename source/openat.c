@@ -0,0 +1,564 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calltrace.h"
+#include "ntapi.h"
+#include "openat.h"
+#include "linktarget.h"
+#include "volmap.h"
+#include "w32-symlink.h"
+
+
+#define DIR_CACHE_SIZE  16
+#define NAME_BUFSIZE    512  /* longer names are copied to the heap */
+
+
+/* a cached directory handle; freed when the last reference is gone */
+typedef struct {
+    wchar_t *path;
+    size_t len;
+    HANDLE handle;
+    FILE_NAME_INFO *name;    /* the name of 'handle' when it was opened */
+    DWORD name_size;
+    volatile LONG refs;
+    volatile LONG64 used;    /* for LRU eviction */
+} DIR_ENTRY;
+
+
+static DIR_ENTRY *dir_cache[DIR_CACHE_SIZE];
+static SRWLOCK cache_lock = SRWLOCK_INIT;
+static volatile LONG64 cache_clock = 0;
+
+
+static void entry_release(DIR_ENTRY *e)
+{
+    if (InterlockedDecrement(&e->refs) == 0) {
+        CloseHandle(e->handle);
+        free(e->name);
+        free(e->path);
+        free(e);
+    }
+}
+
+/* FileNameInfo of 'handle'; result must be deallocated with free() */
+static FILE_NAME_INFO *handle_name(HANDLE handle, DWORD *psize)
+{
+    FILE_NAME_INFO *info = NULL;
+    DWORD size = sizeof(FILE_NAME_INFO) + NAME_BUFSIZE * sizeof(wchar_t);
+
+    for (;;) {
+        if ((info = malloc(size)) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return NULL;
+        }
+
+        if (traced_GetFileInformationByHandleEx(handle, FileNameInfo, info, size)) {
+            *psize = size;
+            return info;
+        }
+
+        free(info);
+
+        if (GetLastError() != ERROR_MORE_DATA || size >= 0x10000 * sizeof(wchar_t)) {
+            return NULL;
+        }
+
+        size *= 2;
+    }
+}
+
+/* cache_lock must be held */
+static DIR_ENTRY *cache_find(const wchar_t *dir, size_t len)
+{
+    DIR_ENTRY *e;
+    int i;
+
+    for (i = 0; i < DIR_CACHE_SIZE; i++) {
+        e = dir_cache[i];
+
+        if (e && e->len == len && _wcsnicmp(e->path, dir, len) == 0) {
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * The directory may have been renamed, deleted or replaced since it was
+ * cached. Its handle still knows the directory's current name, so compare
+ * that with the name it had when it was opened, without opening anything.
+ * Both come from the handle, which also works on SUBST and network drives,
+ * volumes mounted in folders and 8.3 paths.
+ */
+static BOOL entry_valid(const DIR_ENTRY *e)
+{
+    DWORD buf[(sizeof(FILE_NAME_INFO) + NAME_BUFSIZE * sizeof(wchar_t)) / sizeof(DWORD)];
+    FILE_NAME_INFO *pName = (FILE_NAME_INFO *)buf;
+    FILE_STANDARD_INFO standard;
+    BOOL ret;
+
+    if (!traced_GetFileInformationByHandleEx(e->handle, FileStandardInfo, &standard, sizeof(standard)) ||
+        standard.DeletePending)
+    {
+        return FALSE;
+    }
+
+    /* a longer current name doesn't fit and differs anyway */
+    if (e->name_size > sizeof(buf) && (pName = malloc(e->name_size)) == NULL) {
+        return FALSE;
+    }
+
+    ret = (traced_GetFileInformationByHandleEx(e->handle, FileNameInfo, pName,
+                                               (e->name_size > sizeof(buf)) ? e->name_size : sizeof(buf)) &&
+           pName->FileNameLength == e->name->FileNameLength &&
+           memcmp(pName->FileName, e->name->FileName, pName->FileNameLength) == 0) ? TRUE : FALSE;
+
+    if (pName != (FILE_NAME_INFO *)buf) {
+        free(pName);
+    }
+
+    return ret;
+}
+
+/* drop a stale entry unless another thread did already */
+static void cache_evict(DIR_ENTRY *e)
+{
+    int i;
+
+    AcquireSRWLockExclusive(&cache_lock);
+
+    for (i = 0; i < DIR_CACHE_SIZE; i++) {
+        if (dir_cache[i] == e) {
+            dir_cache[i] = NULL;
+            break;
+        }
+    }
+
+    ReleaseSRWLockExclusive(&cache_lock);
+
+    if (i < DIR_CACHE_SIZE) entry_release(e);
+}
+
+/* returns a referenced handle of the directory, opening it if needed */
+static DIR_ENTRY *cache_acquire(const wchar_t *dir, size_t len)
+{
+    DIR_ENTRY *e, *old;
+    int i, slot;
+
+    AcquireSRWLockShared(&cache_lock);
+
+    if ((e = cache_find(dir, len)) != NULL) {
+        InterlockedIncrement(&e->refs);
+        e->used = InterlockedIncrement64(&cache_clock);
+    }
+
+    ReleaseSRWLockShared(&cache_lock);
+
+    if (e) {
+        if (entry_valid(e)) return e;
+
+        /* reopen it by its path */
+        cache_evict(e);
+        entry_release(e);
+    }
+
+    if ((e = calloc(1, sizeof(DIR_ENTRY))) == NULL) {
+        return NULL;
+    }
+
+    if ((e->path = malloc((len + 1) * sizeof(wchar_t))) == NULL) {
+        free(e);
+        return NULL;
+    }
+
+    wmemcpy(e->path, dir, len);
+    e->path[len] = 0;
+    e->len = len;
+
+    /* allow the directory to be renamed or deleted meanwhile */
+    e->handle = traced_CreateFileW(e->path,
+                                   FILE_TRAVERSE,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                   OPEN_EXISTING,
+                                   FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (e->handle == INVALID_HANDLE_VALUE) {
+        free(e->path);
+        free(e);
+        return NULL;
+    }
+
+    if ((e->name = handle_name(e->handle, &e->name_size)) == NULL) {
+        CloseHandle(e->handle);
+        free(e->path);
+        free(e);
+        return NULL;
+    }
+
+    e->refs = 2; /* the cache and the caller */
+    e->used = InterlockedIncrement64(&cache_clock);
+
+    AcquireSRWLockExclusive(&cache_lock);
+
+    if ((old = cache_find(dir, len)) != NULL) {
+        /* another thread was faster */
+        InterlockedIncrement(&old->refs);
+        ReleaseSRWLockExclusive(&cache_lock);
+
+        CloseHandle(e->handle);
+        free(e->name);
+        free(e->path);
+        free(e);
+
+        return old;
+    }
+
+    /* take an empty slot or evict the least recently used entry */
+    for (i = 0, slot = 0; i < DIR_CACHE_SIZE; i++) {
+        if (!dir_cache[i]) {
+            slot = i;
+            break;
+        }
+
+        if (dir_cache[i]->used < dir_cache[slot]->used) {
+            slot = i;
+        }
+    }
+
+    old = dir_cache[slot];
+    dir_cache[slot] = e;
+
+    ReleaseSRWLockExclusive(&cache_lock);
+
+    if (old) entry_release(old);
+
+    return e;
+}
+
+void flushDirectoryHandleCache(void)
+{
+    DIR_ENTRY *entries[DIR_CACHE_SIZE];
+    int i;
+
+    AcquireSRWLockExclusive(&cache_lock);
+
+    for (i = 0; i < DIR_CACHE_SIZE; i++) {
+        entries[i] = dir_cache[i];
+        dir_cache[i] = NULL;
+    }
+
+    ReleaseSRWLockExclusive(&cache_lock);
+
+    /* handles still in use are closed by their last user */
+    for (i = 0; i < DIR_CACHE_SIZE; i++) {
+        if (entries[i]) entry_release(entries[i]);
+    }
+}
+
+/* absolute or drive relative; these ignore the directory handle */
+static BOOL is_absolute(const wchar_t *name)
+{
+    return (name[0] == L'\\' || name[0] == L'/' ||
+            (iswalpha(name[0]) && name[1] == L':')) ? TRUE : FALSE;
+}
+
+/**
+ * Copy a relative name that NT can open relative to a directory handle:
+ * '/' becomes '\' and empty, "." and ".." components are not allowed
+ * because NT doesn't process them. 'out' must be as large as 'name'.
+ */
+static BOOL nt_relative_name(const wchar_t *name, wchar_t *out, size_t *plen)
+{
+    size_t i, n, start = 0;
+
+    for (i = 0; ; i++) {
+        if (name[i] != 0 && name[i] != L'\\' && name[i] != L'/') {
+            out[i] = name[i];
+            continue;
+        }
+
+        n = i - start;
+
+        if (n == 0 || (n == 1 && name[start] == L'.') ||
+            (n == 2 && name[start] == L'.' && name[start+1] == L'.'))
+        {
+            return FALSE;
+        }
+
+        if (name[i] == 0) break;
+
+        out[i] = L'\\';
+        start = i + 1;
+    }
+
+    out[i] = 0;
+    *plen = i;
+
+    return TRUE;
+}
+
+/* the regular way, through Win32 path translation */
+static HANDLE open_path(const wchar_t *path, ACCESS_MASK access, BOOL follow)
+{
+    return traced_CreateFileW(path,
+                              access,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              OPEN_EXISTING,
+                              FILE_FLAG_BACKUP_SEMANTICS | (follow ? 0 : FILE_FLAG_OPEN_REPARSE_POINT));
+}
+
+/* open a path relative to the cached handle of its parent directory */
+static HANDLE open_cached(const wchar_t *name, ACCESS_MASK access, ULONG options, BOOL follow)
+{
+    wchar_t buf[NAME_BUFSIZE];
+    DIR_ENTRY *e;
+    HANDLE handle;
+    size_t len, dirlen, skip = 0;
+
+    if (!nt_api()->NtCreateFile) {
+        return open_path(name, access, follow);
+    }
+
+    len = GetFullPathNameW(name, NAME_BUFSIZE, buf, NULL);
+
+    if (len == 0 || len >= NAME_BUFSIZE) {
+        return open_path(name, access, follow);
+    }
+
+    /* only drive paths, optionally in the "\\?\" namespace */
+    if (wcsncmp(buf, L"\\\\?\\", 4) == 0) {
+        skip = 4;
+    }
+
+    if (!iswalpha(buf[skip]) || buf[skip+1] != L':' || buf[skip+2] != L'\\') {
+        return open_path(name, access, follow);
+    }
+
+    for (dirlen = len; dirlen > skip + 3 && buf[dirlen-1] != L'\\'; dirlen--)
+        ;
+
+    if (dirlen == len || wcscmp(buf + dirlen, L".") == 0 || wcscmp(buf + dirlen, L"..") == 0) {
+        return open_path(name, access, follow);
+    }
+
+    /* drive roots keep their separator */
+    if ((e = cache_acquire(buf, (dirlen == skip + 3) ? dirlen : dirlen - 1)) == NULL) {
+        return open_path(name, access, follow);
+    }
+
+    handle = traced_nt_open(e->handle, buf + dirlen, len - dirlen, access,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, options);
+
+    entry_release(e);
+
+    return handle;
+}
+
+HANDLE open_at(HANDLE dir, const wchar_t *name, ACCESS_MASK access, BOOL follow)
+{
+    wchar_t stackbuf[NAME_BUFSIZE];
+    wchar_t *buf, *full;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    ULONG options;
+    size_t len;
+
+    if (!name || !*name) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    options = FILE_OPEN_FOR_BACKUP_INTENT | (follow ? 0 : FILE_OPEN_REPARSE_POINT);
+
+    if (dir == AT_FDCWD || is_absolute(name)) {
+        return open_cached(name, access, options, follow);
+    }
+
+    len = wcslen(name);
+    buf = (len < NAME_BUFSIZE) ? stackbuf : malloc((len + 1) * sizeof(wchar_t));
+
+    if (!buf) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    if (nt_api()->NtCreateFile && nt_relative_name(name, buf, &len)) {
+        handle = traced_nt_open(dir, buf, len, access, FILE_SHARE_READ | FILE_SHARE_WRITE, options);
+    } else if ((full = path_at(dir, name)) != NULL) {
+        handle = open_path(full, access, follow);
+        free(full);
+    }
+
+    if (buf != stackbuf) free(buf);
+
+    return handle;
+}
+
+/* GetFullPathNameW() with a "\\?\" prefix added to long results */
+static wchar_t *full_path(const wchar_t *path)
+{
+    wchar_t *buf, *p;
+    DWORD len;
+
+    if ((len = GetFullPathNameW(path, 0, NULL, NULL)) == 0) {
+        return NULL;
+    }
+
+    /* leave room for a "\\?\UNC" prefix */
+    if ((buf = malloc((len + 7) * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    p = buf + 7;
+
+    if (GetFullPathNameW(path, len, p, NULL) == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    if (wcslen(p) >= MAX_PATH) {
+        if (iswalpha(p[0]) && p[1] == L':') {
+            p -= 4;
+            wmemcpy(p, L"\\\\?\\", 4);
+        } else if (p[0] == L'\\' && p[1] == L'\\' && p[2] != L'?' && p[2] != L'.') {
+            /* "\\server\share" -> "\\?\UNC\server\share" */
+            p -= 6;
+            wmemcpy(p, L"\\\\?\\UNC", 7);
+        }
+    }
+
+    memmove(buf, p, (wcslen(p) + 1) * sizeof(wchar_t));
+
+    return buf;
+}
+
+wchar_t *path_at(HANDLE dir, const wchar_t *name)
+{
+    const DWORD flags = FILE_NAME_NORMALIZED | VOLUME_NAME_DOS;
+    wchar_t *dirpath, *joined, *p, *buf;
+    size_t dlen, nlen;
+
+    if (!name || !*name) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if (dir == AT_FDCWD || is_absolute(name)) {
+        return full_path(name);
+    }
+
+    if ((dirpath = final_path_by_handle(dir, flags)) == NULL) {
+        return NULL;
+    }
+
+    /* drop the "\\?\" prefix, so "." and ".." in 'name' are processed */
+    p = dirpath;
+
+    if (wcsncmp(p, L"\\\\?\\UNC\\", 8) == 0) {
+        p += 6;
+        *p = L'\\';
+    } else if (wcsncmp(p, L"\\\\?\\", 4) == 0) {
+        p += 4;
+    }
+
+    dlen = wcslen(p);
+    nlen = wcslen(name);
+
+    if ((joined = malloc((dlen + nlen + 2) * sizeof(wchar_t))) == NULL) {
+        free(dirpath);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    wmemcpy(joined, p, dlen);
+    joined[dlen] = L'\\';
+    wmemcpy(joined + dlen + 1, name, nlen + 1);
+    free(dirpath);
+
+    buf = full_path(joined);
+    free(joined);
+
+    return buf;
+}
+
+wchar_t *link_target_at(HANDLE dir, const wchar_t *name)
+{
+    uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    LINK_TARGET_VIEW view;
+    HANDLE handle;
+    DWORD size = 0;
+
+    if ((handle = open_at(dir, name, 0, FALSE)) == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    /* retrieve reparse data */
+    if (!traced_get_reparse_point(handle, data, MAXIMUM_REPARSE_DATA_BUFFER_SIZE, &size)) {
+        if (GetLastError() == ERROR_NOT_A_REPARSE_POINT) {
+            SetLastError(ERROR_NOT_SUPPORTED);
+        }
+        CloseHandle(handle);
+        return NULL;
+    }
+
+    CloseHandle(handle);
+
+    if (!decode_link_view(data, size, &view)) {
+        return NULL;
+    }
+
+    return copy_link_target(data, &view);
+}
+
+wchar_t *canonical_path_at(HANDLE dir, const wchar_t *name)
+{
+    const DWORD flags = FILE_NAME_NORMALIZED | VOLUME_NAME_DOS;
+    wchar_t *buf, *full;
+    HANDLE handle;
+
+    handle = open_at(dir, name, 0, TRUE);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        /* getCanonicalPathW() knows how to deal with AppExec links */
+        if ((full = path_at(dir, name)) == NULL) {
+            return NULL;
+        }
+
+        buf = getCanonicalPathW(full);
+        free(full);
+
+        return buf;
+    }
+
+    buf = final_path_by_handle(handle, flags);
+    CloseHandle(handle);
+
+    return buf;
+}
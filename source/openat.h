@@ -0,0 +1,51 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_OPENAT_H_INCLUDED
+#define W32_SYMLINK_OPENAT_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include "w32-symlink.h"
+
+
+/**
+ * Open 'name' relative to the directory handle 'dir' through the NT
+ * RootDirectory mechanism, so only the components of 'name' are walked.
+ * Absolute names and AT_FDCWD are opened relative to a cached handle of
+ * their parent directory. Names containing "." or ".." components are
+ * opened by their full path instead.
+ *
+ * A final link is not followed unless 'follow' is set.
+ * Returns INVALID_HANDLE_VALUE and sets the last error on failure.
+ */
+HANDLE open_at(HANDLE dir, const wchar_t *name, ACCESS_MASK access, BOOL follow);
+
+/* Full path of 'name' relative to 'dir'. Result must be deallocated with free(). */
+wchar_t *path_at(HANDLE dir, const wchar_t *name);
+
+/* Like getLinkTargetW() and getCanonicalPathW() but relative to 'dir'. */
+wchar_t *link_target_at(HANDLE dir, const wchar_t *name);
+wchar_t *canonical_path_at(HANDLE dir, const wchar_t *name);
+
+#endif /* W32_SYMLINK_OPENAT_H_INCLUDED */
@@ -30,13 +30,18 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include "calltrace.h"
 #include "convert.h"
+#include "deadline.h"
+#include "identity.h"
+#include "openat.h"
+#include "winerr.h"
 #include "w32-symlink.h"
 
 
 /* try to map some Windows error codes that might appear
  * to an errno value (mostly file operation error codes) */
-static int map_winerr_to_errno(DWORD dwErr)
+int map_winerr_to_errno(DWORD dwErr)
 {
     switch (dwErr)
     {
@@ -51,6 +56,7 @@ static int map_winerr_to_errno(DWORD dwErr)
         return ENODEV;
 
     case ERROR_FILE_EXISTS:
+    case ERROR_ALREADY_EXISTS:
         return EEXIST;
 
     case ERROR_FILE_TOO_LARGE:
@@ -83,6 +89,10 @@ static int map_winerr_to_errno(DWORD dwErr)
     case ERROR_BUFFER_OVERFLOW:
         return EOVERFLOW;
 
+    case ERROR_TIMEOUT:
+    case ERROR_SEM_TIMEOUT:
+        return ETIMEDOUT;
+
     default:
         break;
     }
@@ -220,7 +230,7 @@ int link(const char *oldpath, const char *newpath)
         return -1;
     }
 
-    if (createLinkA(oldpath, newpath, 'H') == FALSE) {
+    if (createLinkA(newpath, oldpath, 'H') == FALSE) {
         errno = map_winerr_to_errno(GetLastError());
         return -1;
     }
@@ -236,7 +246,7 @@ int _wlink(const wchar_t *oldpath, const wchar_t *newpath)
         return -1;
     }
 
-    if (createLinkW(oldpath, newpath, 'H') == FALSE) {
+    if (createLinkW(newpath, oldpath, 'H') == FALSE) {
         errno = map_winerr_to_errno(GetLastError());
         return -1;
     }
@@ -335,6 +345,94 @@ wchar_t *_wrealpath_s(const wchar_t *path, wchar_t *buf, size_t numwcs)
 }
 
 
+char *readlinkn_s(const char *path, size_t len, char *buf, size_t bufsize)
+{
+    if (!path || len == 0 || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return return_path(getLinkTargetNA(path, len, NULL), buf, bufsize);
+}
+
+
+wchar_t *_wreadlinkn_s(const wchar_t *path, size_t len, wchar_t *buf, size_t numwcs)
+{
+    if (!path || len == 0 || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(getLinkTargetNW(path, len, NULL), buf, numwcs);
+}
+
+
+char *realpathn_s(const char *path, size_t len, char *buf, size_t bufsize)
+{
+    if (!path || len == 0 || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return return_path(getCanonicalPathNA(path, len), buf, bufsize);
+}
+
+
+wchar_t *_wrealpathn_s(const wchar_t *path, size_t len, wchar_t *buf, size_t numwcs)
+{
+    if (!path || len == 0 || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(getCanonicalPathNW(path, len), buf, numwcs);
+}
+
+
+char *readlink_timeout(const char *path, char *buf, size_t bufsize, DWORD ms)
+{
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return return_path(getLinkTargetTimeoutA(path, NULL, ms), buf, bufsize);
+}
+
+
+wchar_t *_wreadlink_timeout(const wchar_t *path, wchar_t *buf, size_t numwcs, DWORD ms)
+{
+    if (!path || !*path || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(getLinkTargetTimeoutW(path, NULL, ms), buf, numwcs);
+}
+
+
+char *realpath_timeout(const char *path, char *buf, size_t bufsize, DWORD ms)
+{
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return return_path(getCanonicalPathTimeoutA(path, CANONICAL_PATH_DOS, ms), buf, bufsize);
+}
+
+
+wchar_t *_wrealpath_timeout(const wchar_t *path, wchar_t *buf, size_t numwcs, DWORD ms)
+{
+    if (!path || !*path || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(getCanonicalPathTimeoutW(path, CANONICAL_PATH_DOS, ms), buf, numwcs);
+}
+
+
 char *realpath(const char *path, char *resolved_path)
 {
     char buf[PATH_MAX];
@@ -395,51 +493,330 @@ int _lstat64(const char *pathname, struct _stat64 *statbuf)
 }
 
 
-int _lwstat64(const wchar_t *pathname, struct _stat64 *statbuf)
+static int lstat_path(const wchar_t *pathname, struct _stat64 *statbuf)
 {
-    int fd, errsav, rv;
     HANDLE handle;
 
+    if (isSymlinkW(pathname, NULL) != TRUE) {
+        /* no symlink or an error (i.e. the file doesn't exist),
+         * stat the file itself */
+        return wstat64_identity(pathname, statbuf);
+    }
+
+    /* get symbolic link file handle */
+    handle = traced_CreateFileW(pathname,
+                                0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
+
+    return stat_handle(handle, statbuf);
+}
+
+int _lwstat64(const wchar_t *pathname, struct _stat64 *statbuf)
+{
+    LONGLONG call;
+    int rv;
+
     if (!pathname || !*pathname || !statbuf) {
         errno = EINVAL; /* Invalid argument */
         return -1;
     }
 
-    if (!isSymlinkW(pathname, NULL)) {
-        /* no symlink, use regular _wstat() function */
-        return _wstat64(pathname, statbuf);
+    call = traced_enter(TRACE_API_LSTAT, 0, pathname, wcslen(pathname));
+    rv = lstat_path(pathname, statbuf);
+    traced_leave(call, rv != 0);
+
+    return rv;
+}
+
+
+int _lstat64_timeout(const char *pathname, struct _stat64 *statbuf, DWORD ms)
+{
+    wchar_t *wcs_path;
+    int rv;
+
+    if (!pathname || !*pathname || !statbuf) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
     }
 
-    /* get symbolic link file handle */
-    handle = CreateFileW(pathname,
-                         0,
-                         FILE_SHARE_READ | FILE_SHARE_WRITE,
-                         NULL,
-                         OPEN_EXISTING,
-                         FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS,
-                         NULL);
-
-    if (handle == INVALID_HANDLE_VALUE) {
+    wcs_path = convert_str_to_wcs(pathname);
+    rv = _lwstat64_timeout(wcs_path, statbuf, ms);
+    free(wcs_path);
+
+    return rv;
+}
+
+
+int _lwstat64_timeout(const wchar_t *pathname, struct _stat64 *statbuf, DWORD ms)
+{
+    DEADLINE dl;
+    int rv;
+
+    if (!pathname || !*pathname || !statbuf) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (!deadline_begin(&dl, pathname, ms)) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    rv = _lwstat64(pathname, statbuf);
+
+    if (deadline_end(&dl, rv != 0) && rv != 0) {
+        errno = ETIMEDOUT; /* Connection timed out */
+    }
+
+    return rv;
+}
+
+
+int fstatat64(HANDLE dirfd, const char *path, struct _stat64 *statbuf, int flags)
+{
+    wchar_t *wcs_path;
+    int rv;
+
+    if (!path || !*path || !statbuf) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((wcs_path = convert_str_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    rv = _wfstatat64(dirfd, wcs_path, statbuf, flags);
+    free(wcs_path);
+
+    return rv;
+}
+
+
+int _wfstatat64(HANDLE dirfd, const wchar_t *path, struct _stat64 *statbuf, int flags)
+{
+    if (!path || !*path || !statbuf) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    return stat_handle(open_at(dirfd, path, FILE_READ_ATTRIBUTES,
+                               (flags & AT_SYMLINK_NOFOLLOW) ? FALSE : TRUE),
+                       statbuf);
+}
+
+
+ssize_t readlinkat(HANDLE dirfd, const char *path, char *buf, size_t bufsize)
+{
+    wchar_t *wcs_path, *wcs_target;
+    char *ptr;
+
+    if (!path || !*path || !buf || bufsize == 0) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (bufsize > SSIZE_MAX) {
+        bufsize = SSIZE_MAX;
+    }
+
+    if ((wcs_path = convert_str_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    wcs_target = link_target_at(dirfd, wcs_path);
+    free(wcs_path);
+
+    if (!wcs_target) {
         errno = map_winerr_to_errno(GetLastError());
         return -1;
     }
 
-    /* get file descriptor from handle */
-    fd = _open_osfhandle((intptr_t)handle, _O_RDONLY);
+    ptr = return_path(convert_wcs_to_str(wcs_target), buf, bufsize);
+    free(wcs_target);
+
+    if (!ptr) {
+        return -1;
+    }
+
+    return (ssize_t)strlen(buf);
+}
+
+
+ssize_t _wreadlinkat(HANDLE dirfd, const wchar_t *path, wchar_t *buf, size_t numwcs)
+{
+    wchar_t *ptr;
+
+    if (!path || !*path || !buf || numwcs == 0) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (numwcs > SSIZE_MAX) {
+        numwcs = SSIZE_MAX;
+    }
+
+    ptr = _wreturn_path(link_target_at(dirfd, path), buf, numwcs);
 
-    if (fd == -1) {
-        CloseHandle(handle);
-        errno = EBADF; /* Bad file descriptor */
+    if (!ptr) {
         return -1;
     }
 
-    /* get status information */
-    rv = _fstat64(fd, statbuf);
+    return (ssize_t)wcslen(buf);
+}
 
-    /* don't call CloseHandle()! */
-    errsav = errno;
-    _close(fd);
-    errno = errsav;
+
+int symlinkat(const char *target, HANDLE newdirfd, const char *linkpath)
+{
+    int rv;
+    wchar_t *wcs_linkpath, *wcs_target;
+
+    if (!target || !*target || !linkpath || !*linkpath) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((wcs_target = convert_str_to_wcs(target)) == NULL) {
+        return -1;
+    }
+
+    if ((wcs_linkpath = convert_str_to_wcs(linkpath)) == NULL) {
+        free(wcs_target);
+        return -1;
+    }
+
+    rv = _wsymlinkat(wcs_target, newdirfd, wcs_linkpath);
+
+    free(wcs_target);
+    free(wcs_linkpath);
 
     return rv;
 }
+
+
+int _wsymlinkat(const wchar_t *target, HANDLE newdirfd, const wchar_t *linkpath)
+{
+    wchar_t *path;
+    int rv;
+
+    if (!target || !*target || !linkpath || !*linkpath) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((path = path_at(newdirfd, linkpath)) == NULL) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    rv = _wsymlink(target, path);
+    free(path);
+
+    return rv;
+}
+
+
+int linkat(HANDLE olddirfd, const char *oldpath, HANDLE newdirfd, const char *newpath, int flags)
+{
+    int rv;
+    wchar_t *wcs_oldpath, *wcs_newpath;
+
+    if (!oldpath || !*oldpath || !newpath || !*newpath) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((wcs_oldpath = convert_str_to_wcs(oldpath)) == NULL) {
+        return -1;
+    }
+
+    if ((wcs_newpath = convert_str_to_wcs(newpath)) == NULL) {
+        free(wcs_oldpath);
+        return -1;
+    }
+
+    rv = _wlinkat(olddirfd, wcs_oldpath, newdirfd, wcs_newpath, flags);
+
+    free(wcs_oldpath);
+    free(wcs_newpath);
+
+    return rv;
+}
+
+
+int _wlinkat(HANDLE olddirfd, const wchar_t *oldpath, HANDLE newdirfd, const wchar_t *newpath, int flags)
+{
+    wchar_t *old, *new;
+    int rv;
+
+    if (!oldpath || !*oldpath || !newpath || !*newpath) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if (flags & AT_SYMLINK_FOLLOW) {
+        old = canonical_path_at(olddirfd, oldpath);
+    } else {
+        old = path_at(olddirfd, oldpath);
+    }
+
+    if (!old) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    if ((new = path_at(newdirfd, newpath)) == NULL) {
+        errno = map_winerr_to_errno(GetLastError());
+        free(old);
+        return -1;
+    }
+
+    rv = _wlink(old, new);
+
+    free(old);
+    free(new);
+
+    return rv;
+}
+
+
+char *realpathat(HANDLE dirfd, const char *path, char *buf, size_t bufsize)
+{
+    wchar_t *wcs_path, *wcs_buf;
+    char *str;
+
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    if ((wcs_path = convert_str_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    wcs_buf = canonical_path_at(dirfd, wcs_path);
+    free(wcs_path);
+
+    if (!wcs_buf) {
+        errno = map_winerr_to_errno(GetLastError());
+        return NULL;
+    }
+
+    str = convert_wcs_to_str(wcs_buf);
+    free(wcs_buf);
+
+    return return_path(str, buf, bufsize);
+}
+
+
+wchar_t *_wrealpathat(HANDLE dirfd, const wchar_t *path, wchar_t *buf, size_t numwcs)
+{
+    if (!path || !*path || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(canonical_path_at(dirfd, path), buf, numwcs);
+}
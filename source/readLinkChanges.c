@@ -0,0 +1,271 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "usn_feed.h"
+#include "w32-symlink.h"
+
+
+typedef struct {
+    HANDLE volume;
+    READ_USN_JOURNAL_DATA_V0 rd;
+} JOURNAL;
+
+typedef struct {
+    LINK_CHANGE_FUNC func;
+    void *ctx;
+} CALLBACK_DATA;
+
+
+static int journal_read(void *ctx, uint8_t *buf, size_t size, size_t *len)
+{
+    JOURNAL *j = (JOURNAL *)ctx;
+    DWORD n = 0;
+
+    if (size > MAXDWORD) size = MAXDWORD;
+
+    if (!DeviceIoControl(j->volume, FSCTL_READ_USN_JOURNAL, &j->rd, sizeof(j->rd),
+                         buf, (DWORD)size, &n, NULL))
+    {
+        return (GetLastError() == ERROR_HANDLE_EOF) ? 0 : -1;
+    }
+
+    /* the output starts with the USN to continue from */
+    if (n <= sizeof(USN)) {
+        return 0;
+    }
+
+    memcpy(&j->rd.StartUsn, buf, sizeof(USN));
+    memmove(buf, buf + sizeof(USN), n - sizeof(USN));
+    *len = n - sizeof(USN);
+
+    return 1;
+}
+
+static int journal_get_reparse_data(void *ctx, const uint8_t file_id[16],
+                                    uint8_t *buf, size_t size, size_t *len)
+{
+    JOURNAL *j = (JOURNAL *)ctx;
+    FILE_ID_DESCRIPTOR desc;
+    HANDLE handle;
+    DWORD n = 0, dwErr;
+    const uint8_t zero[8] = { 0 };
+
+    memset(&desc, 0, sizeof(desc));
+    desc.dwSize = sizeof(desc);
+
+    if (memcmp(file_id + 8, zero, 8) == 0) {
+        desc.Type = FileIdType;
+        memcpy(&desc.FileId, file_id, 8);
+    } else {
+        desc.Type = ExtendedFileIdType;
+        memcpy(&desc.ExtendedFileId, file_id, 16);
+    }
+
+    handle = OpenFileById(j->volume, &desc, FILE_READ_ATTRIBUTES,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          NULL, FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        dwErr = GetLastError();
+        return (dwErr == ERROR_INVALID_PARAMETER || dwErr == ERROR_FILE_NOT_FOUND) ? 0 : -1;
+    }
+
+    if (!DeviceIoControl(handle, FSCTL_GET_REPARSE_POINT, NULL, 0,
+                         buf, (DWORD)size, &n, NULL))
+    {
+        dwErr = GetLastError();
+        CloseHandle(handle);
+        return (dwErr == ERROR_NOT_A_REPARSE_POINT) ? 0 : -1;
+    }
+
+    CloseHandle(handle);
+    *len = n;
+
+    return 1;
+}
+
+/* NUL-terminated copy of the target; must be deallocated with free() */
+static wchar_t *copy_target(const USN_LINK_EVENT *ev)
+{
+    wchar_t *wstr;
+    char *str;
+
+    if (!ev->target) return NULL;
+
+    if (ev->target_utf8) {
+        if ((str = malloc(ev->target_len + 1)) == NULL) return NULL;
+
+        memcpy(str, ev->target, ev->target_len);
+        str[ev->target_len] = 0;
+        wstr = convert_utf8_to_wcs(str);
+        free(str);
+
+        return wstr;
+    }
+
+    if ((wstr = malloc((ev->target_len + 1) * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    memcpy(wstr, ev->target, ev->target_len * sizeof(wchar_t));
+    wstr[ev->target_len] = 0;
+
+    return wstr;
+}
+
+static int forward_event(void *ctx, const USN_LINK_EVENT *ev)
+{
+    CALLBACK_DATA *cb = (CALLBACK_DATA *)ctx;
+    LINK_CHANGE change;
+    wchar_t *target;
+    BOOL ret;
+
+    target = copy_target(ev);
+
+    change.type = ev->type;
+    change.usn = ev->usn;
+    memcpy(change.file_id.Identifier, ev->file_id, 16);
+    memcpy(change.parent_id.Identifier, ev->parent_id, 16);
+    change.reason = ev->reason;
+    change.name = (const wchar_t *)ev->name;
+    change.name_len = ev->name_len;
+    change.tag = ev->tag;
+    change.target = target;
+
+    ret = cb->func(cb->ctx, &change);
+    free(target);
+
+    return ret ? 0 : 1;
+}
+
+BOOL readLinkChangesW(const wchar_t *volume, ULONGLONG *pUsn,
+                      LINK_CHANGE_FUNC func, void *ctx, FILE *record)
+{
+    USN_JOURNAL_DATA_V0 jd;
+    USN_SOURCE src;
+    CALLBACK_DATA cb;
+    JOURNAL j;
+    wchar_t path[8];
+    uint64_t last = 0;
+    DWORD n;
+    int rv;
+
+    if (!volume || !pUsn || !func || wcslen(volume) < 2) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    /* "C:" -> "\\.\C:" */
+    if (wcsncmp(volume, L"\\\\.\\", 4) == 0) {
+        volume += 4;
+    }
+
+    if (volume[1] != L':') {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    wmemcpy(path, L"\\\\.\\", 4);
+    path[4] = volume[0];
+    path[5] = L':';
+    path[6] = 0;
+
+    j.volume = CreateFileW(path,
+                           GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           NULL,
+                           OPEN_EXISTING,
+                           0,
+                           NULL);
+
+    if (j.volume == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    if (!DeviceIoControl(j.volume, FSCTL_QUERY_USN_JOURNAL, NULL, 0,
+                         &jd, sizeof(jd), &n, NULL))
+    {
+        CloseHandle(j.volume);
+        return FALSE;
+    }
+
+    if (*pUsn != 0 && (USN)*pUsn < jd.FirstUsn) {
+        /* we've missed some changes */
+        CloseHandle(j.volume);
+        SetLastError(ERROR_JOURNAL_ENTRY_DELETED);
+        return FALSE;
+    }
+
+    memset(&j.rd, 0, sizeof(j.rd));
+    j.rd.StartUsn = (*pUsn != 0) ? (USN)*pUsn : jd.FirstUsn;
+    j.rd.ReasonMask = USN_FEED_REASON_MASK | USN_FEED_CLOSE;
+    j.rd.ReturnOnlyOnClose = 0;  /* renames need the old name */
+    j.rd.UsnJournalID = jd.UsnJournalID;
+
+    src.read = journal_read;
+    src.get_reparse_data = journal_get_reparse_data;
+    src.ctx = &j;
+
+    cb.func = func;
+    cb.ctx = ctx;
+
+    rv = usn_feed_run(&src, forward_event, &cb, record, &last);
+
+    /* continue after the last record next time */
+    if (rv >= 0) {
+        *pUsn = (rv == 1) ? last + 1 : (ULONGLONG)j.rd.StartUsn;
+    }
+
+    CloseHandle(j.volume);
+
+    if (rv == -1) {
+        if (GetLastError() == ERROR_SUCCESS) SetLastError(ERROR_INVALID_DATA);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL readLinkChangesA(const char *volume, ULONGLONG *pUsn,
+                      LINK_CHANGE_FUNC func, void *ctx, FILE *record)
+{
+    wchar_t *wstr;
+    BOOL ret;
+
+    if ((wstr = convert_str_to_wcs(volume)) == NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ret = readLinkChangesW(wstr, pUsn, func, ctx, record);
+    free(wstr);
+
+    return ret;
+}
@@ -0,0 +1,175 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "reparse_decode.h"
+
+/* keep these in sync with w32-symlink.h and reparse_data_buffer.h */
+#define TAG_SYMLINK       0xA000000CU
+#define TAG_MOUNT_POINT   0xA0000003U
+#define TAG_NFS           0x80000014U
+#define TAG_APPEXECLINK   0x8000001BU
+#define TAG_LX_SYMLINK    0xA000001DU
+
+#define NFS_SPECFILE_LNK_TYPE       0x00000000014B4E4CULL
+#define NFS_SPECFILE_LNK_MAX_BYTES  2050
+
+/* ReparseTag + ReparseDataLength + Reserved */
+#define HEADER_SIZE  8
+
+
+/* strip "\??\" from a UTF-16 string */
+static void set_normalized(const uint8_t *buf, REPARSE_VIEW *view)
+{
+    const uint8_t *p = buf + view->target_off;
+
+    view->norm_off = view->target_off;
+    view->norm_len = view->target_len;
+
+    if (!view->utf8 && view->target_len >= 4 &&
+        get_le16(p) == '\\' && get_le16(p+2) == '?' &&
+        get_le16(p+4) == '?' && get_le16(p+6) == '\\')
+    {
+        view->norm_off += 8;
+        view->norm_len -= 4;
+    }
+}
+
+/* symbolic links and junctions */
+static int decode_names(const uint8_t *buf, size_t end, size_t pathbuf, REPARSE_VIEW *view)
+{
+    const uint8_t *p = buf + HEADER_SIZE;
+    size_t soff, slen, poff, plen;
+
+    if (pathbuf > end) return REPARSE_DECODE_INVALID;
+
+    soff = get_le16(p);
+    slen = get_le16(p+2);
+    poff = get_le16(p+4);
+    plen = get_le16(p+6);
+
+    if ((soff | slen | poff | plen) & 1 ||
+        pathbuf + soff + slen > end ||
+        pathbuf + poff + plen > end ||
+        slen == 0)
+    {
+        return REPARSE_DECODE_INVALID;
+    }
+
+    view->subst_off = pathbuf + soff;
+    view->subst_len = slen / 2;
+    view->print_off = pathbuf + poff;
+    view->print_len = plen / 2;
+    view->target_off = view->subst_off;
+    view->target_len = view->subst_len;
+
+    return REPARSE_DECODE_OK;
+}
+
+int reparse_decode(const uint8_t *buf, size_t size, REPARSE_VIEW *view)
+{
+    size_t end, off, len, i;
+    int rv;
+
+    memset(view, 0, sizeof(REPARSE_VIEW));
+
+    if (!buf || size < HEADER_SIZE) {
+        return REPARSE_DECODE_INVALID;
+    }
+
+    view->tag = get_le32(buf);
+    end = HEADER_SIZE + get_le16(buf+4);
+
+    if (end > size) {
+        return REPARSE_DECODE_INVALID;
+    }
+
+    switch (view->tag)
+    {
+    /* symbolic links */
+    case TAG_SYMLINK:
+        if (end < HEADER_SIZE + 12) return REPARSE_DECODE_INVALID;
+        view->flags = get_le32(buf + HEADER_SIZE + 8);
+        rv = decode_names(buf, end, HEADER_SIZE + 12, view);
+        break;
+
+    /* junctions */
+    case TAG_MOUNT_POINT:
+        rv = decode_names(buf, end, HEADER_SIZE + 8, view);
+        break;
+
+    /* Network File System (NFS) */
+    case TAG_NFS:
+        if (end < HEADER_SIZE + 8) return REPARSE_DECODE_INVALID;
+        if (get_le64(buf + HEADER_SIZE) != NFS_SPECFILE_LNK_TYPE) return REPARSE_DECODE_NOLINK;
+
+        len = end - (HEADER_SIZE + 8);
+        if (len > NFS_SPECFILE_LNK_MAX_BYTES) return REPARSE_DECODE_INVALID;
+
+        view->target_off = HEADER_SIZE + 8;
+        view->target_len = len / 2;
+        rv = REPARSE_DECODE_OK;
+        break;
+
+    /* Windows execution aliases: NUL separated string list, we want the third entry */
+    case TAG_APPEXECLINK:
+        if (end < HEADER_SIZE + 4) return REPARSE_DECODE_INVALID;
+        if (get_le32(buf + HEADER_SIZE) != 3) return REPARSE_DECODE_NOLINK;
+
+        off = HEADER_SIZE + 4;
+
+        for (i = 0; i < 3; i++) {
+            for (len = 0; off + len*2 + 1 < end && get_le16(buf + off + len*2) != 0; len++)
+                ;
+            if (len == 0 || off + len*2 + 1 >= end) return REPARSE_DECODE_INVALID;
+            if (i < 2) off += (len + 1) * 2;
+        }
+
+        view->target_off = off;
+        view->target_len = len;
+        rv = REPARSE_DECODE_OK;
+        break;
+
+    /* Linux links (UTF-8, no trailing NUL) */
+    case TAG_LX_SYMLINK:
+        if (end < HEADER_SIZE + 4) return REPARSE_DECODE_INVALID;
+        if (get_le32(buf + HEADER_SIZE) != 2) return REPARSE_DECODE_NOLINK;
+
+        view->utf8 = 1;
+        view->target_off = HEADER_SIZE + 4;
+        view->target_len = end - view->target_off;
+        rv = REPARSE_DECODE_OK;
+        break;
+
+    default:
+        return REPARSE_DECODE_NOLINK;
+    }
+
+    if (rv == REPARSE_DECODE_OK) {
+        set_normalized(buf, view);
+    }
+
+    return rv;
+}
@@ -0,0 +1,71 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_REPARSE_DECODE_H_INCLUDED
+#define W32_SYMLINK_REPARSE_DECODE_H_INCLUDED
+
+/* This file must not depend on windows.h so it can be built and tested
+ * on other platforms. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define REPARSE_DECODE_OK        0
+#define REPARSE_DECODE_INVALID  -1  /* corrupted or truncated data */
+#define REPARSE_DECODE_NOLINK   -2  /* valid data, but not a link */
+
+
+/**
+ * Offsets (in bytes from the start of the buffer) and lengths (in
+ * characters) of the strings inside of a raw reparse data buffer.
+ * UTF-16 unless 'utf8' is set (LXSS symlinks).
+ */
+typedef struct {
+    uint32_t tag;
+    uint32_t flags;          /* symlink flags, 1 = relative target */
+    int      utf8;           /* target strings are UTF-8 encoded */
+    size_t   subst_off;      /* substitute name */
+    size_t   subst_len;
+    size_t   print_off;      /* print name, 0 length if there is none */
+    size_t   print_len;
+    size_t   target_off;     /* what getLinkTarget() returns */
+    size_t   target_len;
+    size_t   norm_off;       /* target without the "\??\" prefix */
+    size_t   norm_len;
+} REPARSE_VIEW;
+
+
+/**
+ * Decode the raw output of FSCTL_GET_REPARSE_POINT.
+ * Returns one of the REPARSE_DECODE_* values.
+ */
+int reparse_decode(const uint8_t *buf, size_t size, REPARSE_VIEW *view);
+
+
+/* little endian helpers */
+#define get_le16(p)  ((uint16_t)((p)[0] | ((uint16_t)(p)[1] << 8)))
+#define get_le32(p)  ((uint32_t)(get_le16(p) | ((uint32_t)get_le16((p)+2) << 16)))
+#define get_le64(p)  ((uint64_t)(get_le32(p) | ((uint64_t)get_le32((p)+4) << 32)))
+
+#endif /* W32_SYMLINK_REPARSE_DECODE_H_INCLUDED */
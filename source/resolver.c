@@ -0,0 +1,1074 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "resolver_core.h"
+#include "resolver_os.h"
+#ifdef _WIN32
+#include "winerr.h"
+#endif
+
+/* The resolver service and its client. The transport and the local
+ * backend are provided by resolver_os_win32.c or resolver_os_posix.c. */
+
+#ifdef _WIN32
+#define ERR_INVALID  ERROR_INVALID_PARAMETER
+#define ERR_NOMEM    ERROR_NOT_ENOUGH_MEMORY
+#else
+#define ERR_INVALID  EINVAL
+#define ERR_NOMEM    ENOMEM
+#endif
+
+#define CACHE_ENTRIES  65536
+
+/* requests a client keeps in flight before it reads responses */
+#define CLIENT_WINDOW  64
+
+
+typedef struct CLIENT {
+    struct CLIENT   *next;
+    RESOLVER_SERVER *server;
+    RSV_CONN        *conn;
+    RSV_THREAD      *reader;
+    RSV_LOCK        *write_lock;
+    unsigned int     refs;      /* reader and queued jobs; server->lock */
+} CLIENT;
+
+typedef struct {
+    RSV_JOB  base;
+    CLIENT  *client;
+    uint32_t id;
+    size_t   keylen;
+    uint8_t  key[1];  /* op, path, NUL */
+} JOB;
+
+#define JOB_OP(job)    ((job)->key[0])
+#define JOB_PATH(job)  ((const char *)(job)->key + 1)
+
+struct RESOLVER_SERVER {
+    RESOLVER_BACKEND backend;
+    RSV_LISTENER    *listener;
+    RSV_THREAD      *acceptor;
+    RSV_THREAD     **workers;
+    unsigned int     nworkers;
+    RSV_LOCK        *lock;       /* everything below */
+    RSV_COND        *cond;
+    RSV_QUEUE        queue;
+    RSV_CACHE        cache;
+    CLIENT          *clients;
+    int              stopping;
+};
+
+
+
+/******************************************************************************/
+/*                                  server                                    */
+/******************************************************************************/
+
+/* unlink the clients whose reader has ended and whose jobs are done;
+ * called with the lock held */
+static CLIENT *take_finished_clients(RESOLVER_SERVER *s)
+{
+    CLIENT **pp = &s->clients;
+    CLIENT *done = NULL, *c;
+
+    while ((c = *pp) != NULL) {
+        if (c->refs == 0) {
+            *pp = c->next;
+            c->next = done;
+            done = c;
+        } else {
+            pp = &c->next;
+        }
+    }
+
+    return done;
+}
+
+static void free_clients(CLIENT *c)
+{
+    CLIENT *next;
+
+    for ( ; c; c = next) {
+        next = c->next;
+        rsv_thread_join(c->reader);
+        rsv_close(c->conn);
+        rsv_lock_free(c->write_lock);
+        free(c);
+    }
+}
+
+static void reader_thread(void *arg)
+{
+    CLIENT *c = arg;
+    RESOLVER_SERVER *s = c->server;
+    uint8_t hdr[RSV_REQUEST_HEADER];
+    RSV_REQUEST req;
+    size_t pathlen;
+    JOB *job;
+
+    for (;;) {
+        if (rsv_read(c->conn, hdr, sizeof(hdr)) != 0 || rsv_get_request(hdr, &req) != 0) {
+            break;
+        }
+
+        pathlen = req.length - RSV_REQUEST_HEADER;
+
+        if ((job = malloc(sizeof(JOB) + pathlen + 1)) == NULL) {
+            break;
+        }
+
+        if (rsv_read(c->conn, job->key + 1, pathlen) != 0 ||
+            memchr(job->key + 1, 0, pathlen) != NULL)
+        {
+            free(job);
+            break;
+        }
+
+        job->base.bulk = (req.flags & RSV_FLAG_BULK) != 0;
+        job->client = c;
+        job->id = req.id;
+        job->keylen = pathlen + 1;
+        job->key[0] = req.op;
+        job->key[pathlen + 1] = 0;
+
+        rsv_lock(s->lock);
+        c->refs++;
+        rsv_queue_push(&s->queue, &job->base);
+        rsv_cond_broadcast(s->cond);
+        rsv_unlock(s->lock);
+    }
+
+    /* let the workers' writes fail quickly */
+    rsv_shutdown(c->conn);
+
+    rsv_lock(s->lock);
+    c->refs--;
+    rsv_unlock(s->lock);
+}
+
+static void acceptor_thread(void *arg)
+{
+    RESOLVER_SERVER *s = arg;
+    RSV_CONN *conn;
+    CLIENT *c, *done;
+
+    while ((conn = rsv_accept(s->listener)) != NULL) {
+        rsv_lock(s->lock);
+        done = take_finished_clients(s);
+        rsv_unlock(s->lock);
+        free_clients(done);
+
+        if ((c = calloc(1, sizeof(CLIENT))) == NULL ||
+            (c->write_lock = rsv_lock_new()) == NULL)
+        {
+            free(c);
+            rsv_close(conn);
+            continue;
+        }
+
+        c->server = s;
+        c->conn = conn;
+        c->refs = 1;
+
+        /* the list is only changed by this thread until it's joined */
+        if ((c->reader = rsv_thread_start(reader_thread, c)) == NULL) {
+            rsv_lock_free(c->write_lock);
+            rsv_close(conn);
+            free(c);
+            continue;
+        }
+
+        rsv_lock(s->lock);
+        c->next = s->clients;
+        s->clients = c;
+        rsv_unlock(s->lock);
+    }
+}
+
+/* Run the query and return the response frame; the header is filled in
+ * except for the request ID. */
+static uint8_t *run_backend(RESOLVER_SERVER *s, uint8_t op, const char *path, size_t *size)
+{
+    const RESOLVER_BACKEND *b = &s->backend;
+    RESOLVER_STAT st;
+    ULONG tag = 0;
+    char *str = NULL;
+    const void *data = NULL;
+    size_t datalen = 0;
+    DWORD error = 0;
+    int result = -1;
+    uint8_t *frame;
+
+    rsv_set_error(0);
+
+    switch (op)
+    {
+    case RSV_OP_ISSYMLINK:
+        result = b->isSymlink(b->ctx, path, &tag);
+        break;
+
+    case RSV_OP_READLINK:
+        str = b->getLinkTarget(b->ctx, path, &tag);
+        break;
+
+    case RSV_OP_REALPATH:
+        str = b->getCanonicalPath(b->ctx, path);
+        break;
+
+    case RSV_OP_LSTAT:
+        if ((result = b->lstat(b->ctx, path, &st)) == 0) {
+            datalen = RSV_STAT_SIZE;
+        }
+        break;
+    }
+
+    if (op == RSV_OP_READLINK || op == RSV_OP_REALPATH) {
+        result = str ? 0 : -1;
+        data = str;
+        datalen = str ? strlen(str) : 0;
+    }
+
+    if (result < 0) {
+        error = rsv_get_error();
+        datalen = 0;
+    }
+
+    if (datalen > RSV_MAX_FRAME - RSV_RESPONSE_HEADER) {
+        result = -1;
+        error = ERR_NOMEM;
+        datalen = 0;
+    }
+
+    if ((frame = malloc(RSV_RESPONSE_HEADER + RSV_STAT_SIZE + datalen)) == NULL) {
+        free(str);
+        return NULL;
+    }
+
+    rsv_put_response(frame, 0, result, error, tag, datalen);
+
+    if (op == RSV_OP_LSTAT && result == 0) {
+        uint8_t *p = frame + RSV_RESPONSE_HEADER;
+
+        rsv_put_le(p, st.size, 8);
+        rsv_put_le(p + 8, (uint64_t)st.mtime, 8);
+        rsv_put_le(p + 16, st.ino, 8);
+        rsv_put_le(p + 24, st.dev, 8);
+        rsv_put_le(p + 32, st.mode, 4);
+        rsv_put_le(p + 36, st.nlink, 4);
+    } else if (datalen > 0) {
+        memcpy(frame + RSV_RESPONSE_HEADER, data, datalen);
+    }
+
+    free(str);
+    *size = RSV_RESPONSE_HEADER + datalen;
+
+    return frame;
+}
+
+static void process_job(RESOLVER_SERVER *s, JOB *job)
+{
+    const uint8_t *cached;
+    uint8_t *frame = NULL;
+    size_t size = 0, vallen;
+
+    /* Cached values are the response without length and ID. */
+    rsv_lock(s->lock);
+
+    if ((cached = rsv_cache_get(&s->cache, job->key, job->keylen, rsv_now_ms(), &vallen)) != NULL &&
+        (frame = malloc(8 + vallen)) != NULL)
+    {
+        size = 8 + vallen;
+        memcpy(frame + 8, cached, vallen);
+    }
+
+    rsv_unlock(s->lock);
+
+    if (!frame) {
+        if ((frame = run_backend(s, JOB_OP(job), JOB_PATH(job), &size)) == NULL) {
+            rsv_shutdown(job->client->conn);
+            return;
+        }
+
+        rsv_lock(s->lock);
+        rsv_cache_put(&s->cache, job->key, job->keylen, frame + 8, size - 8, rsv_now_ms());
+        rsv_unlock(s->lock);
+    }
+
+    rsv_put_le(frame, size, 4);
+    rsv_put_le(frame + 4, job->id, 4);
+
+    rsv_lock(job->client->write_lock);
+
+    if (rsv_write(job->client->conn, frame, size) != 0) {
+        rsv_shutdown(job->client->conn);
+    }
+
+    rsv_unlock(job->client->write_lock);
+    free(frame);
+}
+
+static void worker_thread(void *arg)
+{
+    RESOLVER_SERVER *s = arg;
+    JOB *job = NULL;
+
+    rsv_lock(s->lock);
+
+    for (;;) {
+        while (!s->stopping && (job = (JOB *)rsv_queue_pop(&s->queue)) == NULL) {
+            rsv_cond_wait(s->cond, s->lock);
+        }
+
+        if (s->stopping) {
+            break;
+        }
+
+        rsv_unlock(s->lock);
+        process_job(s, job);
+        rsv_lock(s->lock);
+
+        job->client->refs--;
+        free(job);
+    }
+
+    rsv_unlock(s->lock);
+}
+
+static void free_server(RESOLVER_SERVER *s)
+{
+    rsv_cache_free(&s->cache);
+    if (s->cond) rsv_cond_free(s->cond);
+    if (s->lock) rsv_lock_free(s->lock);
+    free(s->workers);
+    free(s);
+}
+
+RESOLVER_SERVER *resolverStart(const char *name, const RESOLVER_BACKEND *backend,
+                               unsigned int threads, unsigned int cacheTtlMs)
+{
+    RESOLVER_SERVER *s;
+    DWORD error;
+
+    if (!backend) {
+        backend = &rsv_local_backend;
+    }
+
+    if (!backend->isSymlink || !backend->getLinkTarget ||
+        !backend->getCanonicalPath || !backend->lstat)
+    {
+        rsv_set_error(ERR_INVALID);
+        return NULL;
+    }
+
+    if (threads == 0) {
+        threads = rsv_cpu_count();
+    }
+
+    if ((s = calloc(1, sizeof(RESOLVER_SERVER))) == NULL ||
+        (s->workers = calloc(threads, sizeof(RSV_THREAD *))) == NULL ||
+        (s->lock = rsv_lock_new()) == NULL ||
+        (s->cond = rsv_cond_new()) == NULL ||
+        rsv_cache_init(&s->cache, cacheTtlMs ? CACHE_ENTRIES : 0, cacheTtlMs) != 0)
+    {
+        if (s) free_server(s);
+        rsv_set_error(ERR_NOMEM);
+        return NULL;
+    }
+
+    s->backend = *backend;
+
+    if ((s->listener = rsv_listen(name)) == NULL) {
+        error = rsv_get_error();
+        free_server(s);
+        rsv_set_error(error);
+        return NULL;
+    }
+
+    for (s->nworkers = 0; s->nworkers < threads; s->nworkers++) {
+        if ((s->workers[s->nworkers] = rsv_thread_start(worker_thread, s)) == NULL) {
+            break;
+        }
+    }
+
+    if (s->nworkers == 0 || (s->acceptor = rsv_thread_start(acceptor_thread, s)) == NULL) {
+        error = rsv_get_error();
+        resolverStop(s);
+        rsv_set_error(error);
+        return NULL;
+    }
+
+    return s;
+}
+
+void resolverFlush(RESOLVER_SERVER *server)
+{
+    if (server) {
+        rsv_lock(server->lock);
+        rsv_cache_clear(&server->cache);
+        rsv_unlock(server->lock);
+    }
+}
+
+void resolverStop(RESOLVER_SERVER *server)
+{
+    RESOLVER_SERVER *s = server;
+    RSV_JOB *job;
+    CLIENT *c;
+    unsigned int i;
+
+    if (!s) {
+        return;
+    }
+
+    rsv_lock(s->lock);
+    s->stopping = 1;
+    rsv_cond_broadcast(s->cond);
+    rsv_unlock(s->lock);
+
+    rsv_listener_close(s->listener);
+
+    if (s->acceptor) {
+        rsv_thread_join(s->acceptor);
+    }
+
+    for (i = 0; i < s->nworkers; i++) {
+        rsv_thread_join(s->workers[i]);
+    }
+
+    /* end the readers; jobs they still queue are dropped below */
+    rsv_lock(s->lock);
+    for (c = s->clients; c; c = c->next) {
+        rsv_shutdown(c->conn);
+    }
+    rsv_unlock(s->lock);
+
+    for (c = s->clients; c; c = c->next) {
+        rsv_thread_join(c->reader);
+    }
+
+    while ((job = rsv_queue_pop(&s->queue)) != NULL) {
+        free(job);
+    }
+
+    while ((c = s->clients) != NULL) {
+        s->clients = c->next;
+        rsv_close(c->conn);
+        rsv_lock_free(c->write_lock);
+        free(c);
+    }
+
+    rsv_listener_free(s->listener);
+    free_server(s);
+}
+
+
+
+/******************************************************************************/
+/*                                  client                                    */
+/******************************************************************************/
+
+/* The connection of this process is shared by all threads: a thread
+ * sends its requests and one thread at a time reads responses, for
+ * whichever thread they are. The lock of the connection is held only
+ * to send and to match a response to its request. */
+typedef struct CALL {
+    struct CALL     *next;
+    RESOLVER_QUERY  *queries;
+    uint8_t         *state;     /* 0 = local, 1 = in flight, 2 = answered */
+    size_t           count;
+    size_t           pending;
+    uint32_t         base;      /* request ID of queries[0] */
+} CALL;
+
+typedef struct {
+    RSV_CONN   *conn;
+    RSV_LOCK   *lock;      /* everything below, and writes */
+    RSV_COND   *cond;      /* a response was matched or the reader left */
+    CALL       *calls;     /* calls with requests in flight */
+    uint32_t    next_id;
+    uint8_t     flags;
+    BOOL        reading;   /* a thread reads a response */
+    BOOL        broken;
+    unsigned int refs;     /* client_conn and running calls; rsv_global_lock() */
+} CLIENT_CONN;
+
+/* the connection of this process; rsv_global_lock() */
+static CLIENT_CONN *client_conn = NULL;
+
+
+/* called with rsv_global_lock() held */
+static void client_release(CLIENT_CONN *cc)
+{
+    if (--cc->refs > 0) {
+        return;
+    }
+
+    rsv_close(cc->conn);
+    rsv_cond_free(cc->cond);
+    rsv_lock_free(cc->lock);
+    free(cc);
+}
+
+BOOL resolverConnect(const char *name, DWORD flags)
+{
+    CLIENT_CONN *cc;
+
+    if ((cc = calloc(1, sizeof(CLIENT_CONN))) == NULL) {
+        rsv_set_error(ERR_NOMEM);
+        return FALSE;
+    }
+
+    if ((cc->lock = rsv_lock_new()) == NULL ||
+        (cc->cond = rsv_cond_new()) == NULL ||
+        (cc->conn = rsv_connect(name)) == NULL)
+    {
+        if (cc->cond) rsv_cond_free(cc->cond);
+        if (cc->lock) rsv_lock_free(cc->lock);
+        free(cc);
+        return FALSE;
+    }
+
+    cc->flags = (flags & RESOLVER_BULK) ? RSV_FLAG_BULK : 0;
+    cc->refs = 1;
+
+    rsv_global_lock();
+
+    /* calls still running on the old connection finish on it */
+    if (client_conn) {
+        client_release(client_conn);
+    }
+
+    client_conn = cc;
+
+    rsv_global_unlock();
+
+    return TRUE;
+}
+
+void resolverDisconnect(void)
+{
+    rsv_global_lock();
+
+    if (client_conn) {
+        client_release(client_conn);
+        client_conn = NULL;
+    }
+
+    rsv_global_unlock();
+}
+
+static void run_local(RESOLVER_QUERY *q)
+{
+    const RESOLVER_BACKEND *b = &rsv_local_backend;
+
+    q->tag = 0;
+    q->value = NULL;
+    q->error = 0;
+    rsv_set_error(0);
+
+    switch (q->op)
+    {
+    case RESOLVER_ISSYMLINK:
+        q->result = b->isSymlink(b->ctx, q->path, &q->tag);
+        break;
+
+    case RESOLVER_READLINK:
+        q->value = b->getLinkTarget(b->ctx, q->path, &q->tag);
+        q->result = q->value ? 0 : -1;
+        break;
+
+    case RESOLVER_REALPATH:
+        q->value = b->getCanonicalPath(b->ctx, q->path);
+        q->result = q->value ? 0 : -1;
+        break;
+
+    case RESOLVER_LSTAT:
+        q->result = b->lstat(b->ctx, q->path, &q->st);
+        break;
+
+    default:
+        q->result = -1;
+        rsv_set_error(ERR_INVALID);
+        break;
+    }
+
+    if (q->result < 0) {
+        q->error = rsv_get_error();
+    }
+}
+
+/* called with cc->lock held */
+static int send_query(CLIENT_CONN *cc, const RESOLVER_QUERY *q, uint32_t id)
+{
+    uint8_t hdr[RSV_REQUEST_HEADER];
+    size_t len = strlen(q->path);
+
+    if (len == 0 || len > RSV_MAX_FRAME - RSV_REQUEST_HEADER) {
+        return 1;  /* run locally */
+    }
+
+    rsv_put_request(hdr, id, (uint8_t)q->op, cc->flags, len);
+
+    if (rsv_write(cc->conn, hdr, sizeof(hdr)) != 0 ||
+        rsv_write(cc->conn, q->path, len) != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* read one response without holding the lock; 'data' must be
+ * deallocated with free() */
+static int read_response(CLIENT_CONN *cc, RSV_RESPONSE *res, uint8_t **data)
+{
+    uint8_t hdr[RSV_RESPONSE_HEADER];
+    size_t datalen;
+
+    *data = NULL;
+
+    if (rsv_read(cc->conn, hdr, sizeof(hdr)) != 0 || rsv_get_response(hdr, res) != 0) {
+        return -1;
+    }
+
+    datalen = res->length - RSV_RESPONSE_HEADER;
+
+    /* room for the NUL of a path */
+    if ((*data = malloc(datalen + 1)) == NULL) {
+        return -1;
+    }
+
+    if (datalen > 0 && rsv_read(cc->conn, *data, datalen) != 0) {
+        free(*data);
+        *data = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Store a response in the query of whichever call it belongs to; called
+ * with cc->lock held. Takes ownership of 'data'. Returns -1 if the
+ * response doesn't fit a request in flight. */
+static int match_response(CLIENT_CONN *cc, const RSV_RESPONSE *res, uint8_t *data)
+{
+    size_t datalen = res->length - RSV_RESPONSE_HEADER;
+    RESOLVER_QUERY *q;
+    CALL *call;
+    size_t i = 0;
+
+    for (call = cc->calls; call; call = call->next) {
+        i = (uint32_t)(res->id - call->base);
+        if (i < call->count && call->state[i] == 1) break;
+    }
+
+    if (!call) {
+        free(data);
+        return -1;
+    }
+
+    q = &call->queries[i];
+    q->value = NULL;
+
+    if (q->op == RESOLVER_LSTAT && res->result == 0) {
+        if (datalen != RSV_STAT_SIZE) {
+            free(data);
+            return -1;
+        }
+
+        q->st.size = rsv_get_le(data, 8);
+        q->st.mtime = (int64_t)rsv_get_le(data + 8, 8);
+        q->st.ino = rsv_get_le(data + 16, 8);
+        q->st.dev = rsv_get_le(data + 24, 8);
+        q->st.mode = (uint32_t)rsv_get_le(data + 32, 4);
+        q->st.nlink = (uint32_t)rsv_get_le(data + 36, 4);
+        free(data);
+    } else if ((q->op == RESOLVER_READLINK || q->op == RESOLVER_REALPATH) && res->result == 0) {
+        data[datalen] = 0;
+        q->value = (char *)data;
+    } else {
+        free(data);
+        if (datalen != 0) return -1;
+    }
+
+    q->result = res->result;
+    q->error = res->error;
+    q->tag = res->tag;
+
+    call->state[i] = 2;
+    call->pending--;
+
+    return 0;
+}
+
+/* Pipeline the queries of 'call' over the connection. Returns -1 if the
+ * connection broke; the queries that were not answered are left to the
+ * caller. */
+static int run_remote(CLIENT_CONN *cc, CALL *call)
+{
+    RSV_RESPONSE res;
+    CALL **pp;
+    uint8_t *data;
+    size_t sent = 0;
+    int rv;
+
+    rsv_lock(cc->lock);
+
+    call->base = cc->next_id;
+    cc->next_id += (uint32_t)call->count;
+    call->next = cc->calls;
+    cc->calls = call;
+
+    while (!cc->broken && (sent < call->count || call->pending > 0)) {
+        while (sent < call->count && call->pending < CLIENT_WINDOW) {
+            if ((rv = send_query(cc, &call->queries[sent], call->base + (uint32_t)sent)) < 0) {
+                cc->broken = TRUE;
+                break;
+            }
+
+            if (rv == 0) {
+                call->state[sent] = 1;
+                call->pending++;
+            }
+
+            sent++;
+        }
+
+        if (cc->broken || call->pending == 0) {
+            continue;
+        }
+
+        if (cc->reading) {
+            /* another thread reads, maybe the response of this one */
+            rsv_cond_wait(cc->cond, cc->lock);
+            continue;
+        }
+
+        cc->reading = TRUE;
+        rsv_unlock(cc->lock);
+
+        rv = read_response(cc, &res, &data);
+
+        rsv_lock(cc->lock);
+        cc->reading = FALSE;
+
+        if (rv != 0 || match_response(cc, &res, data) != 0) {
+            cc->broken = TRUE;
+        }
+
+        rsv_cond_broadcast(cc->cond);
+    }
+
+    rv = cc->broken ? -1 : 0;
+
+    for (pp = &cc->calls; *pp != call; pp = &(*pp)->next)
+        ;
+    *pp = call->next;
+
+    /* a waiting thread may have to take over reading */
+    rsv_cond_broadcast(cc->cond);
+    rsv_unlock(cc->lock);
+
+    return rv;
+}
+
+BOOL rsv_run_queries(RESOLVER_QUERY *queries, size_t count)
+{
+    CLIENT_CONN *cc;
+    CALL call;
+    size_t i;
+    int rv;
+
+    memset(&call, 0, sizeof(call));
+    call.queries = queries;
+    call.count = count;
+
+    rsv_global_lock();
+
+    if ((cc = client_conn) != NULL && count > 0) {
+        cc->refs++;
+    } else {
+        cc = NULL;
+    }
+
+    rsv_global_unlock();
+
+    if (cc) {
+        if ((call.state = calloc(count, 1)) == NULL) {
+            rsv_global_lock();
+            client_release(cc);
+            rsv_global_unlock();
+            rsv_set_error(ERR_NOMEM);
+            return FALSE;
+        }
+
+        rv = run_remote(cc, &call);
+
+        rsv_global_lock();
+
+        /* fall back to local queries from now on; the reference of
+         * this call keeps the connection until the release below */
+        if (rv != 0 && client_conn == cc) {
+            client_conn = NULL;
+            cc->refs--;
+        }
+
+        client_release(cc);
+        rsv_global_unlock();
+    }
+
+    for (i = 0; i < count; i++) {
+        if (!call.state || call.state[i] != 2) {
+            run_local(&queries[i]);
+        }
+    }
+
+    free(call.state);
+
+    return TRUE;
+}
+
+BOOL resolverQuery(RESOLVER_QUERY *queries, size_t count)
+{
+    const char **paths;
+    char *abs;
+    size_t i;
+    BOOL rv = FALSE;
+
+    if (!queries && count > 0) {
+        rsv_set_error(ERR_INVALID);
+        return FALSE;
+    }
+
+    if ((paths = calloc(count + 1, sizeof(char *))) == NULL) {
+        rsv_set_error(ERR_NOMEM);
+        return FALSE;
+    }
+
+    /* the cache must not depend on the current directory of the client */
+    for (i = 0; i < count; i++) {
+        paths[i] = queries[i].path;
+
+        if (!paths[i] || !*paths[i]) {
+            rsv_set_error(ERR_INVALID);
+            goto done;
+        }
+
+        if ((abs = rsv_absolute_path(paths[i])) == NULL) {
+            goto done;
+        }
+
+        queries[i].path = abs;
+    }
+
+    rv = rsv_run_queries(queries, count);
+
+done:
+    while (i-- > 0) {
+        free((char *)queries[i].path);
+        queries[i].path = paths[i];
+    }
+
+    free(paths);
+
+    return rv;
+}
+
+
+
+/******************************************************************************/
+/*                              wrapper functions                             */
+/******************************************************************************/
+
+/* a single query for a path in the narrow character set */
+static int query_native(int op, const char *path, RESOLVER_QUERY *q)
+{
+    char *utf8, *abs;
+
+    memset(q, 0, sizeof(*q));
+    q->op = op;
+
+    if (!path || !*path) {
+        rsv_set_error(ERR_INVALID);
+        return -1;
+    }
+
+    if ((utf8 = rsv_native_to_utf8(path)) == NULL) {
+        return -1;
+    }
+
+    abs = rsv_absolute_path(utf8);
+    free(utf8);
+
+    if (!abs) {
+        return -1;
+    }
+
+    q->path = abs;
+
+    if (!rsv_run_queries(q, 1)) {
+        free(abs);
+        return -1;
+    }
+
+    free(abs);
+    q->path = NULL;
+
+    if (q->result < 0) {
+        rsv_set_error(q->error);
+    }
+
+    return 0;
+}
+
+/* convert the UTF-8 value of a query */
+static char *native_value(RESOLVER_QUERY *q)
+{
+    char *str;
+
+    if (q->result < 0) {
+        return NULL;
+    }
+
+    str = rsv_utf8_to_native(q->value);
+    free(q->value);
+
+    return str;
+}
+
+int resolverIsSymlinkA(const char *lpFileName, ULONG *pReparseTag)
+{
+    RESOLVER_QUERY q;
+
+    if (query_native(RESOLVER_ISSYMLINK, lpFileName, &q) != 0) {
+        return -1;
+    }
+
+    if (pReparseTag) {
+        *pReparseTag = q.tag;
+    }
+
+    return q.result;
+}
+
+char *resolverGetLinkTargetA(const char *lpFileName, ULONG *pReparseTag)
+{
+    RESOLVER_QUERY q;
+
+    if (query_native(RESOLVER_READLINK, lpFileName, &q) != 0) {
+        return NULL;
+    }
+
+    if (pReparseTag) {
+        *pReparseTag = q.tag;
+    }
+
+    return native_value(&q);
+}
+
+char *resolverGetCanonicalPathA(const char *lpFileName)
+{
+    RESOLVER_QUERY q;
+
+    if (query_native(RESOLVER_REALPATH, lpFileName, &q) != 0) {
+        return NULL;
+    }
+
+    return native_value(&q);
+}
+
+int resolverLstatA(const char *lpFileName, RESOLVER_STAT *st)
+{
+    RESOLVER_QUERY q;
+
+    if (!st) {
+        rsv_set_error(ERR_INVALID);
+        return -1;
+    }
+
+    if (query_native(RESOLVER_LSTAT, lpFileName, &q) != 0 || q.result != 0) {
+        return -1;
+    }
+
+    *st = q.st;
+
+    return 0;
+}
+
+static void set_errno(void)
+{
+#ifdef _WIN32
+    errno = map_winerr_to_errno(GetLastError());
+#endif
+}
+
+static char *return_path(char *ptr, char *buf, size_t bufsize)
+{
+    size_t len;
+
+    if (!ptr) {
+        set_errno();
+        return NULL;
+    }
+
+    if (!buf) {
+        /* return allocated string */
+        return ptr;
+    }
+
+    len = strlen(ptr);
+
+    if (len >= bufsize) {
+        free(ptr);
+        errno = ENOMEM; /* Not enough space/cannot allocate memory */
+        return NULL;
+    }
+
+    memcpy(buf, ptr, len + 1);
+    free(ptr);
+
+    return buf;
+}
+
+char *resolver_readlink_s(const char *path, char *buf, size_t bufsize)
+{
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return return_path(resolverGetLinkTargetA(path, NULL), buf, bufsize);
+}
+
+char *resolver_realpath_s(const char *path, char *buf, size_t bufsize)
+{
+    if (!path || !*path || (buf && bufsize == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return return_path(resolverGetCanonicalPathA(path), buf, bufsize);
+}
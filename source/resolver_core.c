@@ -0,0 +1,306 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "resolver_core.h"
+
+
+struct RSV_CACHE_ENTRY {
+    RSV_CACHE_ENTRY *hnext;   /* hash chain */
+    RSV_CACHE_ENTRY *newer;   /* LRU list */
+    RSV_CACHE_ENTRY *older;
+    uint64_t         expires;
+    uint32_t         hash;
+    size_t           keylen;
+    size_t           vallen;
+    /* key and value follow */
+};
+
+#define ENTRY_KEY(e)  ((uint8_t *)((e) + 1))
+#define ENTRY_VAL(e)  (ENTRY_KEY(e) + (e)->keylen)
+
+
+void rsv_put_le(uint8_t *p, uint64_t value, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(value >> (8*i));
+    }
+}
+
+uint64_t rsv_get_le(const uint8_t *p, int bytes)
+{
+    uint64_t value = 0;
+    int i;
+
+    for (i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+
+    return value;
+}
+
+void rsv_put_request(uint8_t *hdr, uint32_t id, uint8_t op, uint8_t flags, size_t pathlen)
+{
+    rsv_put_le(hdr, RSV_REQUEST_HEADER + pathlen, 4);
+    rsv_put_le(hdr + 4, id, 4);
+    hdr[8] = op;
+    hdr[9] = flags;
+    rsv_put_le(hdr + 10, 0, 2);
+}
+
+void rsv_put_response(uint8_t *hdr, uint32_t id, int32_t result, uint32_t error,
+                      uint32_t tag, size_t datalen)
+{
+    rsv_put_le(hdr, RSV_RESPONSE_HEADER + datalen, 4);
+    rsv_put_le(hdr + 4, id, 4);
+    rsv_put_le(hdr + 8, (uint32_t)result, 4);
+    rsv_put_le(hdr + 12, error, 4);
+    rsv_put_le(hdr + 16, tag, 4);
+    rsv_put_le(hdr + 20, 0, 4);
+}
+
+int rsv_get_request(const uint8_t *hdr, RSV_REQUEST *req)
+{
+    req->length = (uint32_t)rsv_get_le(hdr, 4);
+    req->id = (uint32_t)rsv_get_le(hdr + 4, 4);
+    req->op = hdr[8];
+    req->flags = hdr[9];
+
+    if (req->length <= RSV_REQUEST_HEADER || req->length > RSV_MAX_FRAME ||
+        req->op == 0 || req->op > RSV_OP_MAX)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int rsv_get_response(const uint8_t *hdr, RSV_RESPONSE *res)
+{
+    res->length = (uint32_t)rsv_get_le(hdr, 4);
+    res->id = (uint32_t)rsv_get_le(hdr + 4, 4);
+    res->result = (int32_t)(uint32_t)rsv_get_le(hdr + 8, 4);
+    res->error = (uint32_t)rsv_get_le(hdr + 12, 4);
+    res->tag = (uint32_t)rsv_get_le(hdr + 16, 4);
+
+    if (res->length < RSV_RESPONSE_HEADER || res->length > RSV_MAX_FRAME) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* FNV-1a */
+static uint32_t hash_key(const uint8_t *key, size_t len)
+{
+    uint32_t h = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h = (h ^ key[i]) * 16777619U;
+    }
+
+    return h;
+}
+
+int rsv_cache_init(RSV_CACHE *c, size_t max, uint64_t ttl)
+{
+    memset(c, 0, sizeof(*c));
+
+    c->nbuckets = 64;
+    while (c->nbuckets < max) c->nbuckets *= 2;
+
+    if ((c->buckets = calloc(c->nbuckets, sizeof(RSV_CACHE_ENTRY *))) == NULL) {
+        return -1;
+    }
+
+    c->max = max;
+    c->ttl = ttl;
+
+    return 0;
+}
+
+static void unlink_lru(RSV_CACHE *c, RSV_CACHE_ENTRY *e)
+{
+    if (e->newer) e->newer->older = e->older; else c->newest = e->older;
+    if (e->older) e->older->newer = e->newer; else c->oldest = e->newer;
+    e->newer = e->older = NULL;
+}
+
+static void push_newest(RSV_CACHE *c, RSV_CACHE_ENTRY *e)
+{
+    e->older = c->newest;
+    e->newer = NULL;
+    if (c->newest) c->newest->newer = e; else c->oldest = e;
+    c->newest = e;
+}
+
+static void remove_entry(RSV_CACHE *c, RSV_CACHE_ENTRY *e)
+{
+    RSV_CACHE_ENTRY **pp = &c->buckets[e->hash & (c->nbuckets - 1)];
+
+    while (*pp != e) pp = &(*pp)->hnext;
+    *pp = e->hnext;
+
+    unlink_lru(c, e);
+    free(e);
+    c->count--;
+}
+
+static RSV_CACHE_ENTRY *find_entry(RSV_CACHE *c, const uint8_t *key, size_t keylen, uint32_t hash)
+{
+    RSV_CACHE_ENTRY *e;
+
+    for (e = c->buckets[hash & (c->nbuckets - 1)]; e; e = e->hnext) {
+        if (e->hash == hash && e->keylen == keylen && memcmp(ENTRY_KEY(e), key, keylen) == 0) {
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+void rsv_cache_clear(RSV_CACHE *c)
+{
+    while (c->oldest) {
+        remove_entry(c, c->oldest);
+    }
+}
+
+void rsv_cache_free(RSV_CACHE *c)
+{
+    if (c->buckets) {
+        rsv_cache_clear(c);
+        free(c->buckets);
+    }
+
+    memset(c, 0, sizeof(*c));
+}
+
+const uint8_t *rsv_cache_get(RSV_CACHE *c, const uint8_t *key, size_t keylen,
+                             uint64_t now, size_t *vallen)
+{
+    RSV_CACHE_ENTRY *e = find_entry(c, key, keylen, hash_key(key, keylen));
+
+    if (e && now >= e->expires) {
+        remove_entry(c, e);
+        e = NULL;
+    }
+
+    if (!e) {
+        c->misses++;
+        return NULL;
+    }
+
+    unlink_lru(c, e);
+    push_newest(c, e);
+    c->hits++;
+
+    *vallen = e->vallen;
+
+    return ENTRY_VAL(e);
+}
+
+int rsv_cache_put(RSV_CACHE *c, const uint8_t *key, size_t keylen,
+                  const uint8_t *val, size_t vallen, uint64_t now)
+{
+    uint32_t hash = hash_key(key, keylen);
+    RSV_CACHE_ENTRY *e, *old, **bucket;
+
+    if (c->max == 0) {
+        return 0;
+    }
+
+    if ((e = malloc(sizeof(*e) + keylen + vallen)) == NULL) {
+        return -1;
+    }
+
+    e->expires = now + c->ttl;
+    e->hash = hash;
+    e->keylen = keylen;
+    e->vallen = vallen;
+    memcpy(ENTRY_KEY(e), key, keylen);
+    memcpy(ENTRY_VAL(e), val, vallen);
+
+    /* replace an older result */
+    if ((old = find_entry(c, key, keylen, hash)) != NULL) {
+        remove_entry(c, old);
+    }
+
+    bucket = &c->buckets[hash & (c->nbuckets - 1)];
+    e->hnext = *bucket;
+    *bucket = e;
+    push_newest(c, e);
+    c->count++;
+
+    if (c->count > c->max) {
+        remove_entry(c, c->oldest);
+    }
+
+    return 0;
+}
+
+
+void rsv_queue_push(RSV_QUEUE *q, RSV_JOB *job)
+{
+    int k = job->bulk ? 1 : 0;
+
+    job->next = NULL;
+
+    if (q->tail[k]) {
+        q->tail[k]->next = job;
+    } else {
+        q->head[k] = job;
+    }
+
+    q->tail[k] = job;
+}
+
+RSV_JOB *rsv_queue_pop(RSV_QUEUE *q)
+{
+    RSV_JOB *job;
+    int k;
+
+    if (q->head[0] && (q->head[1] == NULL || q->streak < RSV_INTERACTIVE_BURST)) {
+        k = 0;
+        q->streak++;
+    } else if (q->head[1]) {
+        k = 1;
+        q->streak = 0;
+    } else {
+        return NULL;
+    }
+
+    job = q->head[k];
+    q->head[k] = job->next;
+    if (!q->head[k]) q->tail[k] = NULL;
+    job->next = NULL;
+
+    return job;
+}
@@ -0,0 +1,159 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_RESOLVER_CORE_H_INCLUDED
+#define W32_SYMLINK_RESOLVER_CORE_H_INCLUDED
+
+/* This file must not depend on windows.h so it can be built and tested
+ * on other platforms. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Wire format of the resolver service. All numbers are little endian,
+ * paths and strings are UTF-8 without a terminating NUL.
+ *
+ * Request:
+ *  0  uint32  frame length (header + path)
+ *  4  uint32  request ID, echoed in the response
+ *  8  uint8   RSV_OP_*
+ *  9  uint8   RSV_FLAG_*
+ * 10  uint16  reserved (0)
+ * 12  path
+ *
+ * Response:
+ *  0  uint32  frame length (header + data)
+ *  4  uint32  request ID
+ *  8  int32   return value (isSymlink: 1, 0 or -1; others: 0 or -1)
+ * 12  uint32  error code (GetLastError() or errno) if it failed
+ * 16  uint32  reparse tag
+ * 20  uint32  reserved (0)
+ * 24  data: the string (readlink, realpath) or a stat record (lstat)
+ *
+ * A client may send any number of requests before reading the responses,
+ * which can arrive in a different order.
+ */
+
+#define RSV_OP_ISSYMLINK  1
+#define RSV_OP_READLINK   2
+#define RSV_OP_REALPATH   3
+#define RSV_OP_LSTAT      4
+#define RSV_OP_MAX        4
+
+#define RSV_FLAG_BULK     0x1  /* queued behind interactive requests */
+
+#define RSV_REQUEST_HEADER   12
+#define RSV_RESPONSE_HEADER  24
+#define RSV_MAX_FRAME        (256 * 1024)
+
+/* stat record: size, mtime, ino, dev (64 bit), mode, nlink (32 bit) */
+#define RSV_STAT_SIZE  40
+
+
+typedef struct {
+    uint32_t length;
+    uint32_t id;
+    uint8_t  op;
+    uint8_t  flags;
+} RSV_REQUEST;
+
+typedef struct {
+    uint32_t length;
+    uint32_t id;
+    int32_t  result;
+    uint32_t error;
+    uint32_t tag;
+} RSV_RESPONSE;
+
+
+void rsv_put_le(uint8_t *p, uint64_t value, int bytes);
+uint64_t rsv_get_le(const uint8_t *p, int bytes);
+
+void rsv_put_request(uint8_t *hdr, uint32_t id, uint8_t op, uint8_t flags, size_t pathlen);
+void rsv_put_response(uint8_t *hdr, uint32_t id, int32_t result, uint32_t error,
+                      uint32_t tag, size_t datalen);
+
+/* Return 0, or -1 if the header is invalid (i.e. too long or an
+ * unknown op). */
+int rsv_get_request(const uint8_t *hdr, RSV_REQUEST *req);
+int rsv_get_response(const uint8_t *hdr, RSV_RESPONSE *res);
+
+
+/**
+ * A cache of responses shared by all clients: a hash table with a
+ * least recently used list. Entries expire after 'ttl' milliseconds;
+ * if more than 'max' entries are stored, the oldest one is dropped.
+ * The caller serializes access.
+ */
+typedef struct RSV_CACHE_ENTRY RSV_CACHE_ENTRY;
+
+typedef struct {
+    RSV_CACHE_ENTRY **buckets;
+    size_t            nbuckets;
+    size_t            count;
+    size_t            max;
+    uint64_t          ttl;
+    RSV_CACHE_ENTRY  *newest;
+    RSV_CACHE_ENTRY  *oldest;
+    uint64_t          hits;
+    uint64_t          misses;
+} RSV_CACHE;
+
+int  rsv_cache_init(RSV_CACHE *c, size_t max, uint64_t ttl);
+void rsv_cache_free(RSV_CACHE *c);
+void rsv_cache_clear(RSV_CACHE *c);
+
+/* Returns the cached value or NULL. The pointer stays valid until the
+ * next call that modifies the cache. */
+const uint8_t *rsv_cache_get(RSV_CACHE *c, const uint8_t *key, size_t keylen,
+                             uint64_t now, size_t *vallen);
+
+/* Returns -1 if there's not enough memory; the cache is unchanged then. */
+int rsv_cache_put(RSV_CACHE *c, const uint8_t *key, size_t keylen,
+                  const uint8_t *val, size_t vallen, uint64_t now);
+
+
+/**
+ * The request queue. Interactive requests are taken first; after
+ * RSV_INTERACTIVE_BURST of them in a row, a waiting bulk request is
+ * taken so bulk clients are not starved. The caller serializes access.
+ */
+#define RSV_INTERACTIVE_BURST  16
+
+typedef struct RSV_JOB {
+    struct RSV_JOB *next;
+    int             bulk;
+} RSV_JOB;
+
+typedef struct {
+    RSV_JOB *head[2];   /* [0] interactive, [1] bulk */
+    RSV_JOB *tail[2];
+    unsigned streak;
+} RSV_QUEUE;
+
+void     rsv_queue_push(RSV_QUEUE *q, RSV_JOB *job);
+RSV_JOB *rsv_queue_pop(RSV_QUEUE *q);
+
+#endif /* W32_SYMLINK_RESOLVER_CORE_H_INCLUDED */
@@ -0,0 +1,115 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_RESOLVER_OS_H_INCLUDED
+#define W32_SYMLINK_RESOLVER_OS_H_INCLUDED
+
+/* What the resolver service needs from the system. Implemented in
+ * resolver_os_win32.c (named pipes) and resolver_os_posix.c (Unix
+ * domain sockets). */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "w32-symlink.h"
+
+
+typedef struct RSV_LOCK     RSV_LOCK;
+typedef struct RSV_COND     RSV_COND;
+typedef struct RSV_THREAD   RSV_THREAD;
+typedef struct RSV_CONN     RSV_CONN;
+typedef struct RSV_LISTENER RSV_LISTENER;
+
+RSV_LOCK *rsv_lock_new(void);
+void rsv_lock_free(RSV_LOCK *lock);
+void rsv_lock(RSV_LOCK *lock);
+void rsv_unlock(RSV_LOCK *lock);
+
+/* the process-wide lock of the client connection */
+void rsv_global_lock(void);
+void rsv_global_unlock(void);
+
+RSV_COND *rsv_cond_new(void);
+void rsv_cond_free(RSV_COND *cond);
+void rsv_cond_wait(RSV_COND *cond, RSV_LOCK *lock);
+void rsv_cond_broadcast(RSV_COND *cond);
+
+RSV_THREAD *rsv_thread_start(void (*func)(void *arg), void *arg);
+void rsv_thread_join(RSV_THREAD *thread);
+
+unsigned int rsv_cpu_count(void);
+uint64_t rsv_now_ms(void);
+
+/* GetLastError() or errno */
+DWORD rsv_get_error(void);
+void rsv_set_error(DWORD error);
+
+
+/**
+ * 'name' is the pipe name ("\\.\pipe\NAME", or NAME alone) or the
+ * socket path; NULL is the default. rsv_listen() fails if another
+ * server is listening on the name already.
+ */
+RSV_LISTENER *rsv_listen(const char *name);
+
+/* Blocks until a client connects. Returns NULL once rsv_listener_close()
+ * was called. */
+RSV_CONN *rsv_accept(RSV_LISTENER *listener);
+
+/* wake up rsv_accept(); the listener is released by rsv_listener_free()
+ * once no thread uses it anymore */
+void rsv_listener_close(RSV_LISTENER *listener);
+void rsv_listener_free(RSV_LISTENER *listener);
+
+RSV_CONN *rsv_connect(const char *name);
+
+/* Read or write exactly 'len' bytes; returns 0, or -1 on errors and at
+ * the end of the stream. A connection may be read and written by two
+ * threads at the same time. */
+int rsv_read(RSV_CONN *conn, void *buf, size_t len);
+int rsv_write(RSV_CONN *conn, const void *buf, size_t len);
+
+/* Make pending and further reads fail. */
+void rsv_shutdown(RSV_CONN *conn);
+void rsv_close(RSV_CONN *conn);
+
+
+/**
+ * The absolute form of the UTF-8 'path', without resolving links.
+ * Result must be deallocated with free().
+ */
+char *rsv_absolute_path(const char *path);
+
+/* conversions between the narrow character set of the A functions and
+ * UTF-8; results must be deallocated with free() */
+char *rsv_native_to_utf8(const char *str);
+char *rsv_utf8_to_native(const char *str);
+
+/* resolver.c: run queries with absolute UTF-8 paths through the service,
+ * or locally if there's no connection */
+BOOL rsv_run_queries(RESOLVER_QUERY *queries, size_t count);
+
+/* the backend used by resolverStart(NULL, ...) and by the client when
+ * no service is connected */
+extern const RESOLVER_BACKEND rsv_local_backend;
+
+#endif /* W32_SYMLINK_RESOLVER_OS_H_INCLUDED */
@@ -0,0 +1,542 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+/* The resolver service on POSIX systems: Unix domain sockets, pthreads
+ * and the native Linux backend. */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "resolver_os.h"
+
+/* below $XDG_RUNTIME_DIR, or in /tmp with the user ID appended */
+#define SOCKET_NAME  "w32-symlink-resolver"
+
+
+struct RSV_LOCK {
+    pthread_mutex_t mutex;
+};
+
+struct RSV_COND {
+    pthread_cond_t cond;
+};
+
+struct RSV_THREAD {
+    pthread_t thread;
+    void    (*func)(void *arg);
+    void     *arg;
+};
+
+struct RSV_CONN {
+    int fd;
+};
+
+struct RSV_LISTENER {
+    int                fd;
+    struct sockaddr_un addr;
+    int                closed;  /* __atomic */
+};
+
+static pthread_mutex_t global_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+RSV_LOCK *rsv_lock_new(void)
+{
+    RSV_LOCK *lock = malloc(sizeof(RSV_LOCK));
+
+    if (lock && (errno = pthread_mutex_init(&lock->mutex, NULL)) != 0) {
+        free(lock);
+        return NULL;
+    }
+
+    return lock;
+}
+
+void rsv_lock_free(RSV_LOCK *lock)
+{
+    pthread_mutex_destroy(&lock->mutex);
+    free(lock);
+}
+
+void rsv_lock(RSV_LOCK *lock)
+{
+    pthread_mutex_lock(&lock->mutex);
+}
+
+void rsv_unlock(RSV_LOCK *lock)
+{
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+void rsv_global_lock(void)
+{
+    pthread_mutex_lock(&global_mutex);
+}
+
+void rsv_global_unlock(void)
+{
+    pthread_mutex_unlock(&global_mutex);
+}
+
+RSV_COND *rsv_cond_new(void)
+{
+    RSV_COND *cond = malloc(sizeof(RSV_COND));
+
+    if (cond && (errno = pthread_cond_init(&cond->cond, NULL)) != 0) {
+        free(cond);
+        return NULL;
+    }
+
+    return cond;
+}
+
+void rsv_cond_free(RSV_COND *cond)
+{
+    pthread_cond_destroy(&cond->cond);
+    free(cond);
+}
+
+void rsv_cond_wait(RSV_COND *cond, RSV_LOCK *lock)
+{
+    pthread_cond_wait(&cond->cond, &lock->mutex);
+}
+
+void rsv_cond_broadcast(RSV_COND *cond)
+{
+    pthread_cond_broadcast(&cond->cond);
+}
+
+static void *thread_main(void *arg)
+{
+    RSV_THREAD *t = arg;
+
+    t->func(t->arg);
+
+    return NULL;
+}
+
+RSV_THREAD *rsv_thread_start(void (*func)(void *arg), void *arg)
+{
+    RSV_THREAD *t = malloc(sizeof(RSV_THREAD));
+
+    if (!t) {
+        return NULL;
+    }
+
+    t->func = func;
+    t->arg = arg;
+
+    if ((errno = pthread_create(&t->thread, NULL, thread_main, t)) != 0) {
+        free(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+void rsv_thread_join(RSV_THREAD *thread)
+{
+    pthread_join(thread->thread, NULL);
+    free(thread);
+}
+
+unsigned int rsv_cpu_count(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (n > 0) ? (unsigned int)n : 1;
+}
+
+uint64_t rsv_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+DWORD rsv_get_error(void)
+{
+    return (DWORD)errno;
+}
+
+void rsv_set_error(DWORD error)
+{
+    errno = (int)error;
+}
+
+
+static int socket_address(const char *name, struct sockaddr_un *addr)
+{
+    const char *dir;
+    int n;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (name) {
+        n = snprintf(addr->sun_path, sizeof(addr->sun_path), "%s", name);
+    } else if ((dir = getenv("XDG_RUNTIME_DIR")) != NULL && *dir == '/') {
+        n = snprintf(addr->sun_path, sizeof(addr->sun_path), "%s/" SOCKET_NAME ".sock", dir);
+    } else {
+        n = snprintf(addr->sun_path, sizeof(addr->sun_path), "/tmp/" SOCKET_NAME "-%lu.sock",
+                     (unsigned long)geteuid());
+    }
+
+    if (n <= 0 || (size_t)n >= sizeof(addr->sun_path)) {
+        errno = ENAMETOOLONG; /* Filename too long */
+        return -1;
+    }
+
+    return 0;
+}
+
+/* the server must run as the same user, or a stale socket in a shared
+ * directory could be taken over by someone else */
+static int check_peer(int fd)
+{
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+        return -1;
+    }
+
+    if (cred.uid != geteuid()) {
+#else
+    uid_t uid;
+    gid_t gid;
+
+    if (getpeereid(fd, &uid, &gid) != 0) {
+        return -1;
+    }
+
+    if (uid != geteuid()) {
+#endif
+        errno = EACCES; /* Permission denied */
+        return -1;
+    }
+
+    return 0;
+}
+
+static int connect_socket(const struct sockaddr_un *addr)
+{
+    int fd, rv;
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
+        return -1;
+    }
+
+    do {
+        rv = connect(fd, (const struct sockaddr *)addr, sizeof(*addr));
+    } while (rv != 0 && errno == EINTR);
+
+    if (rv != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static RSV_CONN *new_conn(int fd)
+{
+    RSV_CONN *conn = malloc(sizeof(RSV_CONN));
+
+    if (!conn) {
+        close(fd);
+        return NULL;
+    }
+
+    conn->fd = fd;
+
+    return conn;
+}
+
+RSV_LISTENER *rsv_listen(const char *name)
+{
+    RSV_LISTENER *l = calloc(1, sizeof(RSV_LISTENER));
+    mode_t mask;
+    int fd, rv;
+
+    if (!l) {
+        return NULL;
+    }
+
+    if (socket_address(name, &l->addr) != 0) {
+        free(l);
+        return NULL;
+    }
+
+    /* a stale socket file is replaced, a live one is not */
+    if ((fd = connect_socket(&l->addr)) >= 0) {
+        close(fd);
+        free(l);
+        errno = EADDRINUSE; /* Address already in use */
+        return NULL;
+    }
+
+    unlink(l->addr.sun_path);
+
+    if ((l->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
+        free(l);
+        return NULL;
+    }
+
+    /* the socket is created accessible to the owner only, there is no
+     * window before a chmod() in which others could connect */
+    mask = umask(077);
+    rv = bind(l->fd, (struct sockaddr *)&l->addr, sizeof(l->addr));
+    umask(mask);
+
+    if (rv != 0 || listen(l->fd, SOMAXCONN) != 0) {
+        int error = errno;
+        close(l->fd);
+        free(l);
+        errno = error;
+        return NULL;
+    }
+
+    return l;
+}
+
+RSV_CONN *rsv_accept(RSV_LISTENER *listener)
+{
+    int fd;
+
+    for (;;) {
+        if (__atomic_load_n(&listener->closed, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+
+        if ((fd = accept4(listener->fd, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+            if (__atomic_load_n(&listener->closed, __ATOMIC_ACQUIRE)) {
+                close(fd);
+                return NULL;
+            }
+
+            return new_conn(fd);
+        }
+
+        switch (errno)
+        {
+        case EINTR:
+        case ECONNABORTED:
+            break;
+        case EMFILE:
+        case ENFILE:
+        case ENOBUFS:
+        case ENOMEM:
+            /* don't spin while out of resources */
+            usleep(100 * 1000);
+            break;
+        default:
+            return NULL;
+        }
+    }
+}
+
+void rsv_listener_close(RSV_LISTENER *listener)
+{
+    int fd;
+
+    __atomic_store_n(&listener->closed, 1, __ATOMIC_RELEASE);
+
+    /* wakes up accept() on Linux; the connection covers other systems */
+    shutdown(listener->fd, SHUT_RDWR);
+
+    if ((fd = connect_socket(&listener->addr)) >= 0) {
+        close(fd);
+    }
+}
+
+void rsv_listener_free(RSV_LISTENER *listener)
+{
+    close(listener->fd);
+    unlink(listener->addr.sun_path);
+    free(listener);
+}
+
+RSV_CONN *rsv_connect(const char *name)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (socket_address(name, &addr) != 0 || (fd = connect_socket(&addr)) < 0) {
+        return NULL;
+    }
+
+    if (check_peer(fd) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return NULL;
+    }
+
+    return new_conn(fd);
+}
+
+int rsv_read(RSV_CONN *conn, void *buf, size_t len)
+{
+    char *p = buf;
+    ssize_t n;
+
+    while (len > 0) {
+        if ((n = recv(conn->fd, p, len, 0)) > 0) {
+            p += n;
+            len -= (size_t)n;
+        } else if (n == 0) {
+            errno = ECONNRESET; /* Connection reset by peer */
+            return -1;
+        } else if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int rsv_write(RSV_CONN *conn, const void *buf, size_t len)
+{
+    const char *p = buf;
+    ssize_t n;
+
+    while (len > 0) {
+        if ((n = send(conn->fd, p, len, MSG_NOSIGNAL)) >= 0) {
+            p += n;
+            len -= (size_t)n;
+        } else if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void rsv_shutdown(RSV_CONN *conn)
+{
+    shutdown(conn->fd, SHUT_RDWR);
+}
+
+void rsv_close(RSV_CONN *conn)
+{
+    close(conn->fd);
+    free(conn);
+}
+
+
+char *rsv_absolute_path(const char *path)
+{
+    char *cwd, *abs;
+    size_t n;
+
+    if (*path == '/') {
+        return strdup(path);
+    }
+
+    if ((cwd = getcwd(NULL, 0)) == NULL) {
+        return NULL;
+    }
+
+    n = strlen(cwd);
+
+    if ((abs = malloc(n + strlen(path) + 2)) != NULL) {
+        memcpy(abs, cwd, n);
+        abs[n] = '/';
+        strcpy(abs + n + 1, path);
+    }
+
+    free(cwd);
+
+    return abs;
+}
+
+char *rsv_native_to_utf8(const char *str)
+{
+    return strdup(str);
+}
+
+char *rsv_utf8_to_native(const char *str)
+{
+    return strdup(str);
+}
+
+
+static int local_is_symlink(void *ctx, const char *path, ULONG *pReparseTag)
+{
+    (void)ctx;
+    return isSymlinkA(path, pReparseTag);
+}
+
+static char *local_get_link_target(void *ctx, const char *path, ULONG *pReparseTag)
+{
+    (void)ctx;
+    return getLinkTargetA(path, pReparseTag);
+}
+
+static char *local_get_canonical_path(void *ctx, const char *path)
+{
+    (void)ctx;
+    return getCanonicalPathA(path);
+}
+
+static int local_lstat(void *ctx, const char *path, RESOLVER_STAT *st)
+{
+    struct stat sb;
+
+    (void)ctx;
+
+    if (lstat(path, &sb) != 0) {
+        return -1;
+    }
+
+    st->size = (uint64_t)sb.st_size;
+    st->mtime = (int64_t)sb.st_mtime;
+    st->ino = (uint64_t)sb.st_ino;
+    st->dev = (uint64_t)sb.st_dev;
+    st->mode = (uint32_t)sb.st_mode;
+    st->nlink = (uint32_t)sb.st_nlink;
+
+    return 0;
+}
+
+const RESOLVER_BACKEND rsv_local_backend = {
+    local_is_symlink,
+    local_get_link_target,
+    local_get_canonical_path,
+    local_lstat,
+    NULL
+};
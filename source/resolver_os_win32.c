@@ -0,0 +1,961 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <sddl.h>
+#include <wchar.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "resolver_os.h"
+#include "winerr.h"
+#include "workers.h"
+
+#ifdef _MSC_VER
+#pragma comment(lib, "advapi32.lib")
+#endif
+
+/* The resolver service on Windows: named pipes, SRW locks and the W
+ * functions of this library. */
+
+#define PIPE_PREFIX    L"\\\\.\\pipe\\"
+/* the default name is followed by the SID of the user */
+#define DEFAULT_PIPE   L"w32-symlink-resolver-"
+#define PIPE_BUFSIZE   (64 * 1024)
+
+/* how long rsv_connect() waits for a busy pipe (ms) */
+#define CONNECT_WAIT   2000
+
+
+struct RSV_LOCK {
+    SRWLOCK lock;
+};
+
+struct RSV_COND {
+    CONDITION_VARIABLE cond;
+};
+
+struct RSV_THREAD {
+    HANDLE  thread;
+    void  (*func)(void *arg);
+    void   *arg;
+};
+
+/* Pipes are opened for overlapped I/O so that a reader and a writer
+ * don't block each other. */
+struct RSV_CONN {
+    HANDLE        pipe;
+    HANDLE        read_event;
+    HANDLE        write_event;
+    BOOL          server;
+    volatile LONG shut;
+};
+
+struct RSV_LISTENER {
+    wchar_t      *name;
+    PSECURITY_DESCRIPTOR sd;  /* grants access to the user only */
+    HANDLE        next;  /* the instance the next client connects to */
+    volatile LONG closed;
+};
+
+static SRWLOCK global_lock = SRWLOCK_INIT;
+
+
+RSV_LOCK *rsv_lock_new(void)
+{
+    RSV_LOCK *lock = malloc(sizeof(RSV_LOCK));
+
+    if (!lock) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    InitializeSRWLock(&lock->lock);
+
+    return lock;
+}
+
+void rsv_lock_free(RSV_LOCK *lock)
+{
+    free(lock);
+}
+
+void rsv_lock(RSV_LOCK *lock)
+{
+    AcquireSRWLockExclusive(&lock->lock);
+}
+
+void rsv_unlock(RSV_LOCK *lock)
+{
+    ReleaseSRWLockExclusive(&lock->lock);
+}
+
+void rsv_global_lock(void)
+{
+    AcquireSRWLockExclusive(&global_lock);
+}
+
+void rsv_global_unlock(void)
+{
+    ReleaseSRWLockExclusive(&global_lock);
+}
+
+RSV_COND *rsv_cond_new(void)
+{
+    RSV_COND *cond = malloc(sizeof(RSV_COND));
+
+    if (!cond) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    InitializeConditionVariable(&cond->cond);
+
+    return cond;
+}
+
+void rsv_cond_free(RSV_COND *cond)
+{
+    free(cond);
+}
+
+void rsv_cond_wait(RSV_COND *cond, RSV_LOCK *lock)
+{
+    SleepConditionVariableSRW(&cond->cond, &lock->lock, INFINITE, 0);
+}
+
+void rsv_cond_broadcast(RSV_COND *cond)
+{
+    WakeAllConditionVariable(&cond->cond);
+}
+
+static DWORD WINAPI thread_main(LPVOID arg)
+{
+    RSV_THREAD *t = (RSV_THREAD *)arg;
+
+    t->func(t->arg);
+
+    return 0;
+}
+
+RSV_THREAD *rsv_thread_start(void (*func)(void *arg), void *arg)
+{
+    RSV_THREAD *t = malloc(sizeof(RSV_THREAD));
+
+    if (!t) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    t->func = func;
+    t->arg = arg;
+
+    if ((t->thread = CreateThread(NULL, 0, thread_main, t, 0, NULL)) == NULL) {
+        free(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+void rsv_thread_join(RSV_THREAD *thread)
+{
+    WaitForSingleObject(thread->thread, INFINITE);
+    CloseHandle(thread->thread);
+    free(thread);
+}
+
+unsigned int rsv_cpu_count(void)
+{
+    return default_thread_count();
+}
+
+uint64_t rsv_now_ms(void)
+{
+    return GetTickCount64();
+}
+
+DWORD rsv_get_error(void)
+{
+    return GetLastError();
+}
+
+void rsv_set_error(DWORD error)
+{
+    SetLastError(error);
+}
+
+
+/* the user of a process; result must be deallocated with free() */
+static TOKEN_USER *process_user(HANDLE process)
+{
+    TOKEN_USER *user = NULL;
+    HANDLE token;
+    DWORD len = 0;
+
+    if (!OpenProcessToken(process, TOKEN_QUERY, &token)) {
+        return NULL;
+    }
+
+    GetTokenInformation(token, TokenUser, NULL, 0, &len);
+
+    if (len > 0 && (user = malloc(len)) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    } else if (user && !GetTokenInformation(token, TokenUser, user, len, &len)) {
+        free(user);
+        user = NULL;
+    }
+
+    CloseHandle(token);
+
+    return user;
+}
+
+/* the SID of the current user as string; must be deallocated with LocalFree() */
+static wchar_t *user_sid_string(void)
+{
+    TOKEN_USER *user = process_user(GetCurrentProcess());
+    wchar_t *sid = NULL;
+
+    if (user) {
+        if (!ConvertSidToStringSidW(user->User.Sid, &sid)) {
+            sid = NULL;
+        }
+        free(user);
+    }
+
+    return sid;
+}
+
+/* "\\.\pipe\NAME" from NAME or a full pipe name */
+static wchar_t *pipe_name(const char *name)
+{
+    wchar_t *wcs, *full, *sid = NULL;
+    size_t len;
+
+    if (name) {
+        if ((wcs = convert_utf8_to_wcs(name)) == NULL) {
+            return NULL;
+        }
+
+        if (wcsncmp(wcs, L"\\\\", 2) == 0) {
+            return wcs;
+        }
+    } else {
+        /* pipes share one namespace, each user has a separate server */
+        if ((sid = user_sid_string()) == NULL) {
+            return NULL;
+        }
+
+        wcs = NULL;
+    }
+
+    len = wcslen(PIPE_PREFIX) + (sid ? wcslen(DEFAULT_PIPE) + wcslen(sid) : wcslen(wcs)) + 1;
+
+    if ((full = malloc(len * sizeof(wchar_t))) != NULL) {
+        wcscpy_s(full, len, PIPE_PREFIX);
+
+        if (sid) {
+            wcscat_s(full, len, DEFAULT_PIPE);
+            wcscat_s(full, len, sid);
+        } else {
+            wcscat_s(full, len, wcs);
+        }
+    } else {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    }
+
+    free(wcs);
+
+    if (sid) {
+        LocalFree(sid);
+    }
+
+    return full;
+}
+
+/* a protected DACL with full access for the current user and nobody else */
+static PSECURITY_DESCRIPTOR owner_only_sd(void)
+{
+    static const wchar_t fmt[] = L"D:P(A;;GA;;;%s)";
+    PSECURITY_DESCRIPTOR sd = NULL;
+    wchar_t *sid, *sddl;
+    size_t len;
+
+    if ((sid = user_sid_string()) == NULL) {
+        return NULL;
+    }
+
+    len = wcslen(fmt) + wcslen(sid);
+
+    if ((sddl = malloc(len * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    } else {
+        swprintf(sddl, len, fmt, sid);
+
+        if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(sddl, SDDL_REVISION_1, &sd, NULL)) {
+            sd = NULL;
+        }
+        free(sddl);
+    }
+
+    LocalFree(sid);
+
+    return sd;
+}
+
+static HANDLE create_instance(RSV_LISTENER *listener, BOOL first)
+{
+    DWORD mode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED;
+    SECURITY_ATTRIBUTES sa;
+
+    sa.nLength = sizeof(sa);
+    sa.lpSecurityDescriptor = listener->sd;
+    sa.bInheritHandle = FALSE;
+
+    if (first) {
+        mode |= FILE_FLAG_FIRST_PIPE_INSTANCE;
+    }
+
+    return CreateNamedPipeW(listener->name, mode,
+                            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT |
+                                PIPE_REJECT_REMOTE_CLIENTS,
+                            PIPE_UNLIMITED_INSTANCES, PIPE_BUFSIZE, PIPE_BUFSIZE,
+                            0, &sa);
+}
+
+static RSV_CONN *new_conn(HANDLE pipe, BOOL server)
+{
+    RSV_CONN *conn = calloc(1, sizeof(RSV_CONN));
+
+    if (!conn) {
+        CloseHandle(pipe);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    conn->pipe = pipe;
+    conn->server = server;
+    conn->read_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    conn->write_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    if (!conn->read_event || !conn->write_event) {
+        rsv_close(conn);
+        return NULL;
+    }
+
+    return conn;
+}
+
+RSV_LISTENER *rsv_listen(const char *name)
+{
+    RSV_LISTENER *l = calloc(1, sizeof(RSV_LISTENER));
+
+    if (!l) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if ((l->name = pipe_name(name)) == NULL) {
+        free(l);
+        return NULL;
+    }
+
+    if ((l->sd = owner_only_sd()) == NULL) {
+        free(l->name);
+        free(l);
+        return NULL;
+    }
+
+    if ((l->next = create_instance(l, TRUE)) == INVALID_HANDLE_VALUE) {
+        /* FILE_FLAG_FIRST_PIPE_INSTANCE: another server owns the name */
+        if (GetLastError() == ERROR_ACCESS_DENIED) {
+            SetLastError(ERROR_ALREADY_EXISTS);
+        }
+        LocalFree(l->sd);
+        free(l->name);
+        free(l);
+        return NULL;
+    }
+
+    return l;
+}
+
+RSV_CONN *rsv_accept(RSV_LISTENER *listener)
+{
+    OVERLAPPED ov;
+    HANDLE pipe, event;
+    DWORD n;
+    BOOL ok;
+
+    if ((event = CreateEventW(NULL, TRUE, FALSE, NULL)) == NULL) {
+        return NULL;
+    }
+
+    for (;;) {
+        if (listener->closed || listener->next == INVALID_HANDLE_VALUE) {
+            CloseHandle(event);
+            return NULL;
+        }
+
+        memset(&ov, 0, sizeof(ov));
+        ov.hEvent = event;
+
+        ok = ConnectNamedPipe(listener->next, &ov);
+
+        if (!ok && GetLastError() == ERROR_IO_PENDING) {
+            ok = GetOverlappedResult(listener->next, &ov, &n, TRUE);
+        } else if (!ok && GetLastError() == ERROR_PIPE_CONNECTED) {
+            ok = TRUE;
+        }
+
+        if (listener->closed) {
+            CloseHandle(event);
+            return NULL;
+        }
+
+        if (!ok) {
+            /* the client went away before it was accepted */
+            DisconnectNamedPipe(listener->next);
+            continue;
+        }
+
+        pipe = listener->next;
+        listener->next = create_instance(listener, FALSE);
+        CloseHandle(event);
+
+        return new_conn(pipe, TRUE);
+    }
+}
+
+void rsv_listener_close(RSV_LISTENER *listener)
+{
+    HANDLE h;
+
+    InterlockedExchange(&listener->closed, 1);
+
+    /* connect once to wake up rsv_accept() */
+    h = CreateFileW(listener->name, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                    OPEN_EXISTING, 0, NULL);
+
+    if (h != INVALID_HANDLE_VALUE) {
+        CloseHandle(h);
+    }
+}
+
+void rsv_listener_free(RSV_LISTENER *listener)
+{
+    if (listener->next != INVALID_HANDLE_VALUE) {
+        CloseHandle(listener->next);
+    }
+
+    LocalFree(listener->sd);
+    free(listener->name);
+    free(listener);
+}
+
+/* The server must run as the same user; anyone could have created a pipe
+ * of that name before it started. */
+static BOOL check_server(HANDLE pipe)
+{
+    TOKEN_USER *self, *server = NULL;
+    HANDLE process;
+    ULONG pid;
+    BOOL ok = FALSE;
+
+    if (!GetNamedPipeServerProcessId(pipe, &pid) ||
+        (process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid)) == NULL)
+    {
+        return FALSE;
+    }
+
+    if ((self = process_user(GetCurrentProcess())) != NULL &&
+        (server = process_user(process)) != NULL)
+    {
+        if ((ok = EqualSid(self->User.Sid, server->User.Sid)) == FALSE) {
+            SetLastError(ERROR_ACCESS_DENIED);
+        }
+    }
+
+    free(self);
+    free(server);
+    CloseHandle(process);
+
+    return ok;
+}
+
+RSV_CONN *rsv_connect(const char *name)
+{
+    wchar_t *wname;
+    HANDLE pipe;
+    int tries;
+
+    if ((wname = pipe_name(name)) == NULL) {
+        return NULL;
+    }
+
+    for (tries = 0; tries < 3; tries++) {
+        /* SECURITY_IDENTIFICATION: the server can't impersonate us */
+        pipe = CreateFileW(wname, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+                           FILE_FLAG_OVERLAPPED | SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION,
+                           NULL);
+
+        if (pipe != INVALID_HANDLE_VALUE || GetLastError() != ERROR_PIPE_BUSY ||
+            !WaitNamedPipeW(wname, CONNECT_WAIT))
+        {
+            break;
+        }
+    }
+
+    free(wname);
+
+    if (pipe == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    if (!check_server(pipe)) {
+        DWORD error = GetLastError();
+        CloseHandle(pipe);
+        SetLastError(error);
+        return NULL;
+    }
+
+    return new_conn(pipe, FALSE);
+}
+
+static int transfer(RSV_CONN *conn, void *buf, size_t len, BOOL writing)
+{
+    char *p = (char *)buf;
+    OVERLAPPED ov;
+    DWORD chunk, n;
+    BOOL ok;
+
+    while (len > 0) {
+        if (conn->shut) {
+            SetLastError(ERROR_OPERATION_ABORTED);
+            return -1;
+        }
+
+        chunk = (len > PIPE_BUFSIZE) ? PIPE_BUFSIZE : (DWORD)len;
+        memset(&ov, 0, sizeof(ov));
+        ov.hEvent = writing ? conn->write_event : conn->read_event;
+
+        if (writing) {
+            ok = WriteFile(conn->pipe, p, chunk, NULL, &ov);
+        } else {
+            ok = ReadFile(conn->pipe, p, chunk, NULL, &ov);
+        }
+
+        if (!ok && GetLastError() != ERROR_IO_PENDING) {
+            return -1;
+        }
+
+        if (!GetOverlappedResult(conn->pipe, &ov, &n, TRUE)) {
+            return -1;
+        }
+
+        if (n == 0) {
+            SetLastError(ERROR_BROKEN_PIPE);
+            return -1;
+        }
+
+        p += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+int rsv_read(RSV_CONN *conn, void *buf, size_t len)
+{
+    return transfer(conn, buf, len, FALSE);
+}
+
+int rsv_write(RSV_CONN *conn, const void *buf, size_t len)
+{
+    return transfer(conn, (void *)buf, len, TRUE);
+}
+
+void rsv_shutdown(RSV_CONN *conn)
+{
+    InterlockedExchange(&conn->shut, 1);
+    CancelIoEx(conn->pipe, NULL);
+
+    /* further reads fail, even if they were started after CancelIoEx() */
+    if (conn->server) {
+        DisconnectNamedPipe(conn->pipe);
+    }
+}
+
+void rsv_close(RSV_CONN *conn)
+{
+    if (conn->server) {
+        DisconnectNamedPipe(conn->pipe);
+    }
+
+    CloseHandle(conn->pipe);
+    if (conn->read_event) CloseHandle(conn->read_event);
+    if (conn->write_event) CloseHandle(conn->write_event);
+    free(conn);
+}
+
+
+static char *absolute_wcs(const wchar_t *path)
+{
+    wchar_t *buf;
+    char *utf8;
+    DWORD len, n;
+
+    if ((len = GetFullPathNameW(path, 0, NULL, NULL)) == 0) {
+        return NULL;
+    }
+
+    if ((buf = malloc(len * sizeof(wchar_t))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return NULL;
+    }
+
+    if ((n = GetFullPathNameW(path, len, buf, NULL)) == 0 || n >= len) {
+        free(buf);
+        return NULL;
+    }
+
+    utf8 = convert_wcs_to_utf8(buf);
+    free(buf);
+
+    return utf8;
+}
+
+char *rsv_absolute_path(const char *path)
+{
+    wchar_t *wcs;
+    char *abs;
+
+    if ((wcs = convert_utf8_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    abs = absolute_wcs(wcs);
+    free(wcs);
+
+    return abs;
+}
+
+char *rsv_native_to_utf8(const char *str)
+{
+    wchar_t *wcs;
+    char *utf8;
+
+    if ((wcs = convert_str_to_wcs(str)) == NULL) {
+        return NULL;
+    }
+
+    utf8 = convert_wcs_to_utf8(wcs);
+    free(wcs);
+
+    return utf8;
+}
+
+char *rsv_utf8_to_native(const char *str)
+{
+    wchar_t *wcs;
+    char *native;
+
+    if ((wcs = convert_utf8_to_wcs(str)) == NULL) {
+        return NULL;
+    }
+
+    native = convert_wcs_to_str(wcs);
+    free(wcs);
+
+    return native;
+}
+
+
+static int local_is_symlink(void *ctx, const char *path, ULONG *pReparseTag)
+{
+    wchar_t *wcs;
+    int rv;
+
+    (void)ctx;
+
+    if ((wcs = convert_utf8_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    rv = isSymlinkW(wcs, pReparseTag);
+    free(wcs);
+
+    return rv;
+}
+
+static char *utf8_result(wchar_t *wcs)
+{
+    char *utf8;
+
+    if (!wcs) {
+        return NULL;
+    }
+
+    utf8 = convert_wcs_to_utf8(wcs);
+    free(wcs);
+
+    return utf8;
+}
+
+static char *local_get_link_target(void *ctx, const char *path, ULONG *pReparseTag)
+{
+    wchar_t *wcs, *target;
+
+    (void)ctx;
+
+    if ((wcs = convert_utf8_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    target = getLinkTargetW(wcs, pReparseTag);
+    free(wcs);
+
+    return utf8_result(target);
+}
+
+static char *local_get_canonical_path(void *ctx, const char *path)
+{
+    wchar_t *wcs, *canon;
+
+    (void)ctx;
+
+    if ((wcs = convert_utf8_to_wcs(path)) == NULL) {
+        return NULL;
+    }
+
+    canon = getCanonicalPathW(wcs);
+    free(wcs);
+
+    return utf8_result(canon);
+}
+
+static int local_lstat(void *ctx, const char *path, RESOLVER_STAT *st)
+{
+    struct lstatx stx;
+    wchar_t *wcs;
+    uint64_t ino;
+    int rv;
+
+    (void)ctx;
+
+    if ((wcs = convert_utf8_to_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    /* reports the Win32 error of the failed call */
+    rv = lwstatx(wcs, LSTATX_TYPE | LSTATX_SIZE | LSTATX_MTIME | LSTATX_INO | LSTATX_NLINK, &stx);
+    free(wcs);
+
+    if (rv != 0) {
+        return -1;
+    }
+
+    /* the low 64 bits of the file ID, like st_ino */
+    memcpy(&ino, stx.stx_ino.Identifier, sizeof(ino));
+
+    st->size = stx.stx_size;
+    st->mtime = stx.stx_mtime.tv_sec;
+    st->ino = ino;
+    st->dev = stx.stx_dev;
+    st->mode = stx.stx_mode;
+    st->nlink = stx.stx_nlink;
+
+    return 0;
+}
+
+const RESOLVER_BACKEND rsv_local_backend = {
+    local_is_symlink,
+    local_get_link_target,
+    local_get_canonical_path,
+    local_lstat,
+    NULL
+};
+
+
+
+/* a single query for a wide character path */
+static int query_wide(int op, const wchar_t *path, RESOLVER_QUERY *q)
+{
+    char *abs;
+
+    memset(q, 0, sizeof(*q));
+    q->op = op;
+
+    if (!path || !*path) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    if ((abs = absolute_wcs(path)) == NULL) {
+        return -1;
+    }
+
+    q->path = abs;
+
+    if (!rsv_run_queries(q, 1)) {
+        free(abs);
+        return -1;
+    }
+
+    free(abs);
+    q->path = NULL;
+
+    if (q->result < 0) {
+        SetLastError(q->error);
+    }
+
+    return 0;
+}
+
+static wchar_t *wide_value(RESOLVER_QUERY *q)
+{
+    wchar_t *wcs;
+
+    if (q->result < 0) {
+        return NULL;
+    }
+
+    wcs = convert_utf8_to_wcs(q->value);
+    free(q->value);
+
+    return wcs;
+}
+
+int resolverIsSymlinkW(const wchar_t *lpFileName, ULONG *pReparseTag)
+{
+    RESOLVER_QUERY q;
+
+    if (query_wide(RESOLVER_ISSYMLINK, lpFileName, &q) != 0) {
+        return -1;
+    }
+
+    if (pReparseTag) {
+        *pReparseTag = q.tag;
+    }
+
+    return q.result;
+}
+
+wchar_t *resolverGetLinkTargetW(const wchar_t *lpFileName, ULONG *pReparseTag)
+{
+    RESOLVER_QUERY q;
+
+    if (query_wide(RESOLVER_READLINK, lpFileName, &q) != 0) {
+        return NULL;
+    }
+
+    if (pReparseTag) {
+        *pReparseTag = q.tag;
+    }
+
+    return wide_value(&q);
+}
+
+wchar_t *resolverGetCanonicalPathW(const wchar_t *lpFileName)
+{
+    RESOLVER_QUERY q;
+
+    if (query_wide(RESOLVER_REALPATH, lpFileName, &q) != 0) {
+        return NULL;
+    }
+
+    return wide_value(&q);
+}
+
+int resolverLstatW(const wchar_t *lpFileName, RESOLVER_STAT *st)
+{
+    RESOLVER_QUERY q;
+
+    if (!st) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    if (query_wide(RESOLVER_LSTAT, lpFileName, &q) != 0 || q.result != 0) {
+        return -1;
+    }
+
+    *st = q.st;
+
+    return 0;
+}
+
+static wchar_t *_wreturn_path(wchar_t *ptr, wchar_t *buf, size_t numwcs)
+{
+    errno_t rv;
+
+    if (!ptr) {
+        errno = map_winerr_to_errno(GetLastError());
+        return NULL;
+    }
+
+    if (!buf) {
+        /* return allocated string */
+        return ptr;
+    }
+
+    /* copy result into target buffer */
+    rv = wcsncpy_s(buf, numwcs, ptr, _TRUNCATE);
+    free(ptr);
+
+    switch (rv)
+    {
+    case 0:
+        break;
+    case STRUNCATE:
+        errno = ENOMEM; /* Not enough space/cannot allocate memory */
+        return NULL;
+    default:
+        errno = rv;
+        return NULL;
+    }
+
+    return buf;
+}
+
+wchar_t *_wresolver_readlink_s(const wchar_t *path, wchar_t *buf, size_t numwcs)
+{
+    if (!path || !*path || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(resolverGetLinkTargetW(path, NULL), buf, numwcs);
+}
+
+wchar_t *_wresolver_realpath_s(const wchar_t *path, wchar_t *buf, size_t numwcs)
+{
+    if (!path || !*path || (buf && numwcs == 0)) {
+        errno = EINVAL; /* Invalid argument */
+        return NULL;
+    }
+
+    return _wreturn_path(resolverGetCanonicalPathW(path), buf, numwcs);
+}
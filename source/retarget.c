@@ -0,0 +1,284 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "reparse_decode.h"
+#include "retarget.h"
+
+/* keep these in sync with w32-symlink.h and reparse_data_buffer.h */
+#define TAG_SYMLINK       0xA000000CU
+#define TAG_MOUNT_POINT   0xA0000003U
+
+#define SYMLINK_FLAG_RELATIVE  1
+
+/* ReparseTag + ReparseDataLength + Reserved */
+#define HEADER_SIZE  8
+
+/* ReparseDataLength is a 16 bit value */
+#define MAX_DATA_LENGTH  0xFFFF
+
+
+/* a UTF-16 string inside of a reparse buffer or a prefix */
+typedef struct {
+    const uint8_t  *bytes;  /* little endian data, or NULL */
+    const uint16_t *chars;  /* native data, or NULL */
+    size_t          len;
+} STR16;
+
+
+static uint16_t char_at(const STR16 *s, size_t i)
+{
+    return s->bytes ? get_le16(s->bytes + i*2) : s->chars[i];
+}
+
+static uint16_t fold(uint16_t c)
+{
+    return (c >= 'a' && c <= 'z') ? (uint16_t)(c - 'a' + 'A') : c;
+}
+
+static int starts_with(const STR16 *s, size_t off, const char *ascii)
+{
+    size_t i;
+
+    for (i = 0; ascii[i]; i++) {
+        if (off + i >= s->len || char_at(s, off + i) != (uint16_t)ascii[i]) return 0;
+    }
+
+    return 1;
+}
+
+/* does the DOS path s[off..] start with the prefix (whole components)? */
+static int match_prefix(const STR16 *s, size_t off, const STR16 *prefix)
+{
+    size_t i;
+
+    if (s->len - off < prefix->len) return 0;
+
+    for (i = 0; i < prefix->len; i++) {
+        uint16_t a = char_at(s, off + i);
+        uint16_t b = char_at(prefix, i);
+
+        if (a == '/') a = '\\';
+        if (b == '/') b = '\\';
+        if (fold(a) != fold(b)) return 0;
+    }
+
+    return off + prefix->len == s->len || char_at(s, off + prefix->len) == '\\' ||
+           (prefix->len > 0 && char_at(prefix, prefix->len - 1) == '\\');
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, (uint16_t)v);
+    put_le16(p+2, (uint16_t)(v >> 16));
+}
+
+/* append an ASCII string; returns the new position */
+static size_t put_ascii(uint8_t *out, size_t pos, const char *s)
+{
+    while (*s) {
+        put_le16(out + pos, (uint16_t)*s++);
+        pos += 2;
+    }
+
+    return pos;
+}
+
+static size_t put_str(uint8_t *out, size_t pos, const STR16 *s, size_t off)
+{
+    size_t i;
+
+    for (i = off; i < s->len; i++, pos += 2) {
+        put_le16(out + pos, char_at(s, i));
+    }
+
+    return pos;
+}
+
+/* write prefix + s[off..]; with 'nt' set, prefix is put into NT form */
+static size_t put_path(uint8_t *out, size_t pos, const STR16 *prefix,
+                       const STR16 *s, size_t off, int nt)
+{
+    size_t skip = 0;
+
+    if (nt) {
+        if (starts_with(prefix, 0, "\\\\")) {
+            /* "\\server\share" -> "\??\UNC\server\share" */
+            pos = put_ascii(out, pos, "\\??\\UNC\\");
+            skip = 2;
+        } else {
+            pos = put_ascii(out, pos, "\\??\\");
+        }
+    }
+
+    pos = put_str(out, pos, prefix, skip);
+
+    return put_str(out, pos, s, off);
+}
+
+/* length of the NT prefix of a substitute name and whether it was UNC */
+static size_t nt_prefix(const STR16 *s, int *unc)
+{
+    *unc = 0;
+
+    if (starts_with(s, 0, "\\??\\UNC\\")) {
+        *unc = 1;
+        return 8;
+    }
+
+    if (starts_with(s, 0, "\\??\\")) {
+        return 4;
+    }
+
+    return 0;
+}
+
+/* does the substitute name (after its NT prefix) match?
+ * For UNC names the prefix "\\server" is compared with "UNC\server". */
+static int match_subst(const STR16 *subst, size_t off, int unc, const STR16 *prefix)
+{
+    STR16 rest;
+
+    if (!unc) {
+        return match_prefix(subst, off, prefix);
+    }
+
+    if (!starts_with(prefix, 0, "\\\\")) {
+        return 0;
+    }
+
+    rest = *prefix;
+    rest.len -= 2;
+
+    if (rest.chars) rest.chars += 2;
+    else rest.bytes += 4;
+
+    return match_prefix(subst, off, &rest);
+}
+
+int reparse_retarget(const uint8_t *in, size_t insize,
+                     const uint16_t *oldp, size_t oldlen,
+                     const uint16_t *newp, size_t newlen,
+                     uint8_t *out, size_t outsize, size_t *written)
+{
+    REPARSE_VIEW view;
+    STR16 subst, print, oldprefix, newprefix;
+    size_t soff, poff, names, slen, plen, pos, hdr, datalen;
+    int unc, print_matches;
+
+    if (reparse_decode(in, insize, &view) != REPARSE_DECODE_OK) {
+        return RETARGET_INVALID;
+    }
+
+    if ((view.tag != TAG_SYMLINK && view.tag != TAG_MOUNT_POINT) ||
+        (view.tag == TAG_SYMLINK && (view.flags & SYMLINK_FLAG_RELATIVE)))
+    {
+        return RETARGET_NOMATCH;
+    }
+
+    subst.bytes = in + view.subst_off;
+    subst.chars = NULL;
+    subst.len = view.subst_len;
+
+    print.bytes = in + view.print_off;
+    print.chars = NULL;
+    print.len = view.print_len;
+
+    oldprefix.bytes = NULL;
+    oldprefix.chars = oldp;
+    oldprefix.len = oldlen;
+
+    newprefix.bytes = NULL;
+    newprefix.chars = newp;
+    newprefix.len = newlen;
+
+    soff = nt_prefix(&subst, &unc);
+
+    if (oldlen == 0 || !match_subst(&subst, soff, unc, &oldprefix)) {
+        return RETARGET_NOMATCH;
+    }
+
+    /* NTFS junctions can only point to local volumes */
+    if (view.tag == TAG_MOUNT_POINT && starts_with(&newprefix, 0, "\\\\")) {
+        return RETARGET_REMOTE;
+    }
+
+    /* skip the matched part; for UNC names "UNC\server" stands for "\\server" */
+    soff += unc ? oldlen - 2 : oldlen;
+
+    print_matches = print.len > 0 && match_prefix(&print, 0, &oldprefix);
+    poff = print_matches ? oldlen : 0;
+
+    /* the new strings; a UNC prefix needs 6 more characters in NT form */
+    slen = 8 + newlen + (subst.len - soff);
+    plen = print_matches ? newlen + (print.len - poff) : print.len;
+
+    /* PathBuffer offset: 12 for symlinks (with flags), 8 for junctions */
+    hdr = (view.tag == TAG_SYMLINK) ? 12 : 8;
+    datalen = hdr + (slen + 1 + plen + 1) * 2;
+
+    if (datalen > MAX_DATA_LENGTH || HEADER_SIZE + datalen > outsize) {
+        return RETARGET_TOOLONG;
+    }
+
+    /* names: substitute name and print name, each NUL-terminated */
+    names = HEADER_SIZE + hdr;
+    pos = put_path(out, names, &newprefix, &subst, soff, 1);
+    slen = (pos - names) / 2;
+    put_le16(out + pos, 0);
+    pos += 2;
+
+    if (print_matches) {
+        pos = put_path(out, pos, &newprefix, &print, poff, 0);
+    } else {
+        pos = put_str(out, pos, &print, 0);
+    }
+
+    plen = (pos - names) / 2 - slen - 1;
+    put_le16(out + pos, 0);
+    pos += 2;
+
+    put_le32(out, view.tag);
+    put_le16(out + 4, (uint16_t)(pos - HEADER_SIZE));
+    put_le16(out + 6, 0);
+    put_le16(out + HEADER_SIZE, 0);                                /* SubstituteNameOffset */
+    put_le16(out + HEADER_SIZE + 2, (uint16_t)(slen * 2));         /* SubstituteNameLength */
+    put_le16(out + HEADER_SIZE + 4, (uint16_t)((slen + 1) * 2));   /* PrintNameOffset */
+    put_le16(out + HEADER_SIZE + 6, (uint16_t)(plen * 2));         /* PrintNameLength */
+
+    if (view.tag == TAG_SYMLINK) {
+        put_le32(out + HEADER_SIZE + 8, view.flags);
+    }
+
+    *written = pos;
+
+    return RETARGET_OK;
+}
@@ -0,0 +1,62 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_RETARGET_H_INCLUDED
+#define W32_SYMLINK_RETARGET_H_INCLUDED
+
+/* This file must not depend on windows.h so it can be built and tested
+ * on other platforms. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define RETARGET_OK         0
+#define RETARGET_NOMATCH    1   /* not a junction or absolute symlink below the prefix */
+#define RETARGET_INVALID   -1   /* corrupted or truncated data */
+#define RETARGET_TOOLONG   -2   /* the result does not fit into 'outsize' bytes */
+#define RETARGET_REMOTE    -3   /* a junction would point to a UNC path */
+
+
+/**
+ * Rewrite the raw reparse data of a symbolic link or junction (as
+ * returned by FSCTL_GET_REPARSE_POINT) whose target lies below 'oldp'
+ * so that it points below 'newp' instead, i.e. "T:\tools\bin" with
+ * old "T:\tools" and new "\\server\tools" becomes "\\server\tools\bin".
+ *
+ * The prefixes are UTF-16 DOS paths without a trailing separator; they
+ * match whole path components only and ignore ASCII case. The substitute
+ * name keeps its NT form ("\??\" or "\??\UNC\"). The print name is
+ * rewritten if it matches as well. Relative symlinks never match.
+ * Junctions cannot point to remote paths, so a matching junction with a
+ * UNC 'newp' gives RETARGET_REMOTE.
+ *
+ * On RETARGET_OK the new data is written into 'out' and its size into
+ * '*written'; it can be passed to FSCTL_SET_REPARSE_POINT as it is.
+ */
+int reparse_retarget(const uint8_t *in, size_t insize,
+                     const uint16_t *oldp, size_t oldlen,
+                     const uint16_t *newp, size_t newlen,
+                     uint8_t *out, size_t outsize, size_t *written);
+
+#endif /* W32_SYMLINK_RETARGET_H_INCLUDED */
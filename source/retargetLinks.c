@@ -0,0 +1,432 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calltrace.h"
+#include "convert.h"
+#include "reparse_decode.h"
+#include "retarget.h"
+#include "strpool.h"
+#include "walk.h"
+#include "workers.h"
+#include "w32-symlink.h"
+
+
+typedef struct {
+    DWORD                  flags;
+    FILE                  *report;
+    const uint16_t        *oldp;
+    size_t                 oldlen;
+    const uint16_t        *newp;
+    size_t                 newlen;
+    const wchar_t * const *paths;   /* list mode */
+    STRPOOL                pool;    /* tree mode */
+    uint32_t              *ids;
+    size_t                 count;
+    size_t                 capacity;
+    BOOL                   nomem;
+    volatile LONG          links;
+    volatile LONG          matched;
+    volatile LONG          rewritten;
+    volatile LONG          failed;
+} RETARGET;
+
+
+static void write_line(FILE *fp, const char *what, const wchar_t *path, const wchar_t *target)
+{
+    char *s_path = convert_wcs_to_utf8(path);
+    char *s_target = target ? convert_wcs_to_utf8(target) : NULL;
+
+    if (target) {
+        fprintf(fp, "%s: %s -> %s\n", what, s_path ? s_path : "?", s_target ? s_target : "?");
+    } else {
+        fprintf(fp, "%s: %s\n", what, s_path ? s_path : "?");
+    }
+
+    free(s_path);
+    free(s_target);
+}
+
+static void report_error(RETARGET *r, const wchar_t *path, DWORD err)
+{
+    InterlockedIncrement(&r->failed);
+
+    if (r->report) {
+        char what[32];
+        sprintf(what, "error %lu", (unsigned long)err);
+        write_line(r->report, what, path, NULL);
+    }
+}
+
+static void retarget_path(RETARGET *r, const wchar_t *path)
+{
+    uint8_t in[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    uint8_t out[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    REPARSE_VIEW view;
+    HANDLE handle;
+    DWORD size = 0, dwRet, access;
+    size_t written = 0;
+    uint32_t tag;
+    int rv;
+
+    /* the link is rewritten through the same handle, so it keeps its identity */
+    access = (r->flags & RETARGET_DRY_RUN) ? 0 : FILE_READ_ATTRIBUTES | FILE_WRITE_DATA;
+
+    handle = traced_CreateFileW(path, access,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        report_error(r, path, GetLastError());
+        return;
+    }
+
+    if (!traced_get_reparse_point(handle, in, sizeof(in), &size)) {
+        /* not a link at all */
+        if (GetLastError() != ERROR_NOT_A_REPARSE_POINT) {
+            report_error(r, path, GetLastError());
+        }
+        CloseHandle(handle);
+        return;
+    }
+
+    tag = (size >= 4) ? get_le32(in) : 0;
+
+    if (tag != IO_REPARSE_TAG_SYMLINK && tag != IO_REPARSE_TAG_MOUNT_POINT) {
+        CloseHandle(handle);
+        return;
+    }
+
+    InterlockedIncrement(&r->links);
+
+    rv = reparse_retarget(in, size, r->oldp, r->oldlen, r->newp, r->newlen,
+                          out, sizeof(out), &written);
+
+    switch (rv)
+    {
+    case RETARGET_OK:
+        break;
+    case RETARGET_NOMATCH:
+        CloseHandle(handle);
+        return;
+    case RETARGET_TOOLONG:
+        report_error(r, path, ERROR_FILENAME_EXCED_RANGE);
+        CloseHandle(handle);
+        return;
+    case RETARGET_REMOTE:
+        report_error(r, path, ERROR_NOT_SUPPORTED);
+        CloseHandle(handle);
+        return;
+    default:
+        report_error(r, path, ERROR_INVALID_REPARSE_DATA);
+        CloseHandle(handle);
+        return;
+    }
+
+    InterlockedIncrement(&r->matched);
+
+    if ((r->flags & RETARGET_DRY_RUN) == 0 &&
+        !DeviceIoControl(handle, FSCTL_SET_REPARSE_POINT, out, (DWORD)written,
+                         NULL, 0, &dwRet, NULL))
+    {
+        report_error(r, path, GetLastError());
+        CloseHandle(handle);
+        return;
+    }
+
+    CloseHandle(handle);
+
+    if ((r->flags & RETARGET_DRY_RUN) == 0) {
+        InterlockedIncrement(&r->rewritten);
+    }
+
+    /* the new substitute name is NUL-terminated */
+    if (r->report && reparse_decode(out, written, &view) == REPARSE_DECODE_OK) {
+        write_line(r->report, (r->flags & RETARGET_DRY_RUN) ? "match" : "retarget",
+                   path, (const wchar_t *)(out + view.norm_off));
+    }
+}
+
+static void retarget_item(void *ctx, size_t index)
+{
+    RETARGET *r = (RETARGET *)ctx;
+
+    if (r->paths) {
+        if (r->paths[index] && *r->paths[index]) {
+            retarget_path(r, r->paths[index]);
+        }
+    } else {
+        retarget_path(r, strpool_get(&r->pool, r->ids[index]));
+    }
+}
+
+static int collect_link(void *ctx, const WALK_ENTRY *entry)
+{
+    RETARGET *r = (RETARGET *)ctx;
+    uint32_t *p;
+    uint32_t id;
+
+    if (entry->reparse_tag != IO_REPARSE_TAG_SYMLINK &&
+        entry->reparse_tag != IO_REPARSE_TAG_MOUNT_POINT)
+    {
+        return WALK_CONTINUE;
+    }
+
+    if (r->count == r->capacity) {
+        size_t n = r->capacity ? r->capacity * 2 : 256;
+
+        if ((p = realloc(r->ids, n * sizeof(uint32_t))) == NULL) {
+            r->nomem = TRUE;
+            return WALK_STOP;
+        }
+
+        r->ids = p;
+        r->capacity = n;
+    }
+
+    if ((id = strpool_intern(&r->pool, entry->path, entry->path_len)) == STRPOOL_NONE) {
+        r->nomem = TRUE;
+        return WALK_STOP;
+    }
+
+    r->ids[r->count++] = id;
+
+    return WALK_CONTINUE;
+}
+
+/* "X:\..." or "\\server\..." */
+static BOOL is_absolute_prefix(const wchar_t *p)
+{
+    if (iswalpha(p[0]) && p[1] == L':') {
+        return (p[2] == L'\\' || p[2] == L'/') ? TRUE : FALSE;
+    }
+
+    return ((p[0] == L'\\' || p[0] == L'/') && (p[1] == L'\\' || p[1] == L'/') &&
+            p[2] != 0 && p[2] != L'\\' && p[2] != L'/' &&
+            p[2] != L'?' && p[2] != L'.') ? TRUE : FALSE;
+}
+
+/* copy a prefix with backslashes and without trailing separators */
+static wchar_t *normalize_prefix(const wchar_t *prefix, size_t *plen)
+{
+    wchar_t *buf;
+    size_t len, i;
+
+    if (!prefix || !is_absolute_prefix(prefix) || (buf = _wcsdup(prefix)) == NULL) {
+        return NULL;
+    }
+
+    len = wcslen(buf);
+
+    for (i = 0; i < len; i++) {
+        if (buf[i] == L'/') buf[i] = L'\\';
+    }
+
+    while (len > 0 && buf[len-1] == L'\\') {
+        buf[--len] = 0;
+    }
+
+    if (len == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    *plen = len;
+
+    return buf;
+}
+
+static BOOL run(RETARGET *r, const wchar_t *root, const wchar_t *lpOldPrefix,
+                const wchar_t *lpNewPrefix, unsigned int threads, RETARGET_STATS *pStats)
+{
+    RETARGET_STATS st;
+    wchar_t *oldp, *newp = NULL;
+    BOOL ret = FALSE;
+
+    memset(&st, 0, sizeof(st));
+
+    if ((oldp = normalize_prefix(lpOldPrefix, &r->oldlen)) == NULL ||
+        (newp = normalize_prefix(lpNewPrefix, &r->newlen)) == NULL)
+    {
+        free(oldp);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    /* wchar_t is UTF-16 on Windows */
+    r->oldp = (const uint16_t *)oldp;
+    r->newp = (const uint16_t *)newp;
+
+    if (root) {
+        if (!strpool_init(&r->pool, FALSE)) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            goto done;
+        }
+
+        if (!walk_tree(root, collect_link, r)) {
+            goto done;
+        }
+
+        if (r->nomem) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            goto done;
+        }
+    }
+
+    if (r->count > 0) {
+        parallel_for(r->count, threads, retarget_item, r);
+    }
+
+    st.links = (size_t)r->links;
+    st.matched = (size_t)r->matched;
+    st.rewritten = (size_t)r->rewritten;
+    st.failed = (size_t)r->failed;
+
+    if (r->report) {
+        fprintf(r->report, "links: %zu, matching: %zu, retargeted: %zu, errors: %zu\n",
+                st.links, st.matched, st.rewritten, st.failed);
+    }
+
+    ret = TRUE;
+
+done:
+    if (pStats) *pStats = st;
+
+    if (root) strpool_free(&r->pool);
+    free(r->ids);
+    free(oldp);
+    free(newp);
+
+    return ret;
+}
+
+BOOL retargetLinksW(const wchar_t *lpRootDir, const wchar_t *lpOldPrefix,
+                    const wchar_t *lpNewPrefix, DWORD flags, unsigned int threads,
+                    FILE *report, RETARGET_STATS *pStats)
+{
+    RETARGET r;
+
+    if (!lpRootDir || !*lpRootDir) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    memset(&r, 0, sizeof(r));
+    r.flags = flags;
+    r.report = report;
+
+    return run(&r, lpRootDir, lpOldPrefix, lpNewPrefix, threads, pStats);
+}
+
+BOOL retargetLinkListW(const wchar_t * const *paths, size_t count,
+                       const wchar_t *lpOldPrefix, const wchar_t *lpNewPrefix,
+                       DWORD flags, unsigned int threads,
+                       FILE *report, RETARGET_STATS *pStats)
+{
+    RETARGET r;
+
+    if (!paths && count > 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    memset(&r, 0, sizeof(r));
+    r.flags = flags;
+    r.report = report;
+    r.paths = paths;
+    r.count = count;
+
+    return run(&r, NULL, lpOldPrefix, lpNewPrefix, threads, pStats);
+}
+
+BOOL retargetLinksA(const char *lpRootDir, const char *lpOldPrefix,
+                    const char *lpNewPrefix, DWORD flags, unsigned int threads,
+                    FILE *report, RETARGET_STATS *pStats)
+{
+    wchar_t *wroot, *wold, *wnew;
+    BOOL ret = FALSE;
+
+    wroot = convert_str_to_wcs(lpRootDir);
+    wold = convert_str_to_wcs(lpOldPrefix);
+    wnew = convert_str_to_wcs(lpNewPrefix);
+
+    if (!wroot || !wold || !wnew) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+    } else {
+        ret = retargetLinksW(wroot, wold, wnew, flags, threads, report, pStats);
+    }
+
+    free(wroot);
+    free(wold);
+    free(wnew);
+
+    return ret;
+}
+
+BOOL retargetLinkListA(const char * const *paths, size_t count,
+                       const char *lpOldPrefix, const char *lpNewPrefix,
+                       DWORD flags, unsigned int threads,
+                       FILE *report, RETARGET_STATS *pStats)
+{
+    wchar_t **wpaths = NULL, *wold, *wnew;
+    size_t i;
+    BOOL ret = FALSE;
+
+    if (!paths && count > 0) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    wold = convert_str_to_wcs(lpOldPrefix);
+    wnew = convert_str_to_wcs(lpNewPrefix);
+
+    if (!wold || !wnew) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+    } else if ((wpaths = calloc(count + 1, sizeof(wchar_t *))) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    } else {
+        /* entries that cannot be converted are skipped */
+        for (i = 0; i < count; i++) {
+            wpaths[i] = paths[i] ? convert_str_to_wcs(paths[i]) : NULL;
+        }
+
+        ret = retargetLinkListW((const wchar_t * const *)wpaths, count, wold, wnew,
+                                flags, threads, report, pStats);
+
+        for (i = 0; i < count; i++) {
+            free(wpaths[i]);
+        }
+    }
+
+    free(wpaths);
+    free(wold);
+    free(wnew);
+
+    return ret;
+}
@@ -0,0 +1,126 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "slice.h"
+
+
+static BOOL init(PATH_SLICE *s, const wchar_t *path, size_t len)
+{
+    wchar_t *buf = s->buf;
+
+    s->ntname = NULL;
+    s->ntlen = 0;
+    s->path = NULL;
+    s->heap = NULL;
+
+    if (!path) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (len >= SLICE_STACK - NT_NAME_EXTRA) {
+        if ((s->heap = malloc((len + NT_NAME_EXTRA + 1) * sizeof(wchar_t))) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return FALSE;
+        }
+        buf = s->heap;
+    }
+
+    /* wchar_t is UTF-16 on Windows */
+    s->ntlen = nt_name((const uint16_t *)path, len, (uint16_t *)buf,
+                       (const uint16_t **)&s->ntname);
+
+    if (s->ntlen > 0) {
+        return TRUE;
+    }
+
+    s->ntname = NULL;
+
+    if (wmemchr(path, 0, len) != NULL) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    wmemcpy(buf, path, len);
+    buf[len] = 0;
+    s->path = buf;
+
+    return TRUE;
+}
+
+BOOL slice_init(PATH_SLICE *s, const wchar_t *path, size_t len)
+{
+    s->wide_heap = NULL;
+
+    return init(s, path, len);
+}
+
+BOOL slice_init_a(PATH_SLICE *s, const char *path, size_t len)
+{
+    wchar_t *wide = s->wide;
+    mbstate_t state;
+    size_t i, k, n;
+
+    s->wide_heap = NULL;
+    s->heap = NULL;
+
+    if (!path) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    /* never more wide characters than bytes */
+    if (len >= SLICE_STACK) {
+        if ((s->wide_heap = malloc(len * sizeof(wchar_t))) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return FALSE;
+        }
+        wide = s->wide_heap;
+    }
+
+    /* like mbstowcs() but limited to the slice */
+    memset(&state, 0, sizeof(state));
+
+    for (i = k = 0; i < len; i += n, k++) {
+        n = mbrtowc(&wide[k], path + i, len - i, &state);
+
+        if (n == 0 || n == (size_t)-1 || n == (size_t)-2) {
+            SetLastError(n == 0 ? ERROR_INVALID_PARAMETER : ERROR_NO_UNICODE_TRANSLATION);
+            return FALSE;
+        }
+    }
+
+    return init(s, wide, k);
+}
+
+void slice_free(PATH_SLICE *s)
+{
+    free(s->heap);
+    free(s->wide_heap);
+    s->heap = NULL;
+    s->wide_heap = NULL;
+}
@@ -0,0 +1,57 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_SLICE_H_INCLUDED
+#define W32_SYMLINK_SLICE_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include "ntname.h"
+
+/* slices up to this length are prepared on the stack */
+#define SLICE_STACK  (MAX_PATH + NT_NAME_EXTRA)
+
+
+/**
+ * A path given as pointer and length, prepared for the *N() functions.
+ * Fully qualified paths get an NT name built from the slice (see
+ * nt_name()); for all others a NUL-terminated copy is made that takes
+ * the usual Win32 route.
+ */
+typedef struct {
+    const wchar_t *ntname;   /* 'ntlen' characters, not NUL-terminated */
+    size_t         ntlen;
+    const wchar_t *path;     /* set if 'ntname' is NULL */
+    wchar_t        buf[SLICE_STACK];
+    wchar_t        wide[SLICE_STACK];
+    wchar_t       *heap;
+    wchar_t       *wide_heap;
+} PATH_SLICE;
+
+/* Return FALSE and set the last error on failure; slice_free() is
+ * needed either way. */
+BOOL slice_init(PATH_SLICE *s, const wchar_t *path, size_t len);
+BOOL slice_init_a(PATH_SLICE *s, const char *path, size_t len);
+void slice_free(PATH_SLICE *s);
+
+#endif /* W32_SYMLINK_SLICE_H_INCLUDED */
@@ -0,0 +1,233 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strpool.h"
+
+#define INITIAL_SLOTS  1024
+#define BLOCK_CHARS    (64 * 1024)
+
+
+/* storage blocks are chained through their first bytes */
+typedef struct BLOCK_HEADER {
+    struct BLOCK_HEADER *next;
+} BLOCK_HEADER;
+
+
+static uint32_t hash_string(const wchar_t *str, size_t len, BOOL ignore_case)
+{
+    uint32_t h = 2166136261u; /* FNV-1a */
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= (uint32_t)(ignore_case ? towupper(str[i]) : str[i]);
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+static BOOL equals(const STRPOOL *pool, uint32_t id, const wchar_t *str, size_t len)
+{
+    const wchar_t *s = pool->strings[id];
+    size_t i;
+
+    if (pool->lengths[id] != len) {
+        return FALSE;
+    }
+
+    if (!pool->ignore_case) {
+        return (wmemcmp(s, str, len) == 0) ? TRUE : FALSE;
+    }
+
+    for (i = 0; i < len; i++) {
+        if (s[i] != str[i] && towupper(s[i]) != towupper(str[i])) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static uint32_t *find_slot(const STRPOOL *pool, const wchar_t *str, size_t len)
+{
+    uint32_t i = hash_string(str, len, pool->ignore_case) & pool->mask;
+
+    /* linear probing; the table is never more than half full */
+    while (pool->slots[i] != 0 && !equals(pool, pool->slots[i] - 1, str, len)) {
+        i = (i + 1) & pool->mask;
+    }
+
+    return &pool->slots[i];
+}
+
+static BOOL grow_slots(STRPOOL *pool)
+{
+    uint32_t *old = pool->slots;
+    uint32_t oldsize = pool->mask + 1;
+    uint32_t i, j, id;
+
+    if ((pool->slots = calloc((size_t)oldsize * 2, sizeof(uint32_t))) == NULL) {
+        pool->slots = old;
+        return FALSE;
+    }
+
+    pool->mask = oldsize * 2 - 1;
+
+    for (i = 0; i < oldsize; i++) {
+        if ((id = old[i]) == 0) continue;
+
+        j = hash_string(pool->strings[id-1], pool->lengths[id-1], pool->ignore_case) & pool->mask;
+
+        while (pool->slots[j] != 0) {
+            j = (j + 1) & pool->mask;
+        }
+        pool->slots[j] = id;
+    }
+
+    free(old);
+
+    return TRUE;
+}
+
+static wchar_t *store_string(STRPOOL *pool, const wchar_t *str, size_t len)
+{
+    BLOCK_HEADER *hdr;
+    size_t size, hdrchars;
+    wchar_t *p;
+
+    hdrchars = (sizeof(BLOCK_HEADER) + sizeof(wchar_t) - 1) / sizeof(wchar_t);
+
+    if (!pool->block || pool->block_used + len + 1 > pool->block_size) {
+        size = (len + 1 > BLOCK_CHARS) ? len + 1 : BLOCK_CHARS;
+
+        if ((hdr = malloc((hdrchars + size) * sizeof(wchar_t))) == NULL) {
+            return NULL;
+        }
+
+        hdr->next = pool->blocks;
+        pool->blocks = hdr;
+        pool->block = (wchar_t *)hdr + hdrchars;
+        pool->block_used = 0;
+        pool->block_size = size;
+    }
+
+    p = pool->block + pool->block_used;
+    wmemcpy(p, str, len);
+    p[len] = 0;
+    pool->block_used += len + 1;
+
+    return p;
+}
+
+BOOL strpool_init(STRPOOL *pool, BOOL ignore_case)
+{
+    memset(pool, 0, sizeof(STRPOOL));
+
+    if ((pool->slots = calloc(INITIAL_SLOTS, sizeof(uint32_t))) == NULL) {
+        return FALSE;
+    }
+
+    pool->mask = INITIAL_SLOTS - 1;
+    pool->ignore_case = ignore_case;
+
+    return TRUE;
+}
+
+void strpool_free(STRPOOL *pool)
+{
+    BLOCK_HEADER *hdr, *next;
+
+    for (hdr = pool->blocks; hdr != NULL; hdr = next) {
+        next = hdr->next;
+        free(hdr);
+    }
+
+    free(pool->strings);
+    free(pool->lengths);
+    free(pool->slots);
+    memset(pool, 0, sizeof(STRPOOL));
+}
+
+uint32_t strpool_find(const STRPOOL *pool, const wchar_t *str, size_t len)
+{
+    uint32_t *slot = find_slot(pool, str, len);
+
+    return (*slot == 0) ? STRPOOL_NONE : *slot - 1;
+}
+
+uint32_t strpool_intern(STRPOOL *pool, const wchar_t *str, size_t len)
+{
+    uint32_t *slot, n;
+    wchar_t **strings;
+    uint32_t *lengths;
+    wchar_t *p;
+
+    if (len >= UINT32_MAX || pool->count >= STRPOOL_NONE - 1) {
+        return STRPOOL_NONE;
+    }
+
+    slot = find_slot(pool, str, len);
+
+    if (*slot != 0) {
+        return *slot - 1;
+    }
+
+    if (pool->count == pool->capacity) {
+        n = pool->capacity ? pool->capacity * 2 : 1024;
+
+        if ((strings = realloc(pool->strings, n * sizeof(wchar_t *))) == NULL) {
+            return STRPOOL_NONE;
+        }
+        pool->strings = strings;
+
+        if ((lengths = realloc(pool->lengths, n * sizeof(uint32_t))) == NULL) {
+            return STRPOOL_NONE;
+        }
+        pool->lengths = lengths;
+        pool->capacity = n;
+    }
+
+    /* keep the load factor below 1/2 */
+    if ((pool->count + 1) * 2 > pool->mask) {
+        if (!grow_slots(pool) && pool->count + 1 >= pool->mask) {
+            /* table would be full */
+            return STRPOOL_NONE;
+        }
+        slot = find_slot(pool, str, len);
+    }
+
+    if ((p = store_string(pool, str, len)) == NULL) {
+        return STRPOOL_NONE;
+    }
+
+    pool->strings[pool->count] = p;
+    pool->lengths[pool->count] = (uint32_t)len;
+    *slot = ++pool->count;
+
+    return pool->count - 1;
+}
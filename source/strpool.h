@@ -0,0 +1,68 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_STRPOOL_H_INCLUDED
+#define W32_SYMLINK_STRPOOL_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include <inttypes.h>
+
+#define STRPOOL_NONE  UINT32_MAX
+
+
+/**
+ * String interning: every distinct string is stored once and identified
+ * by a dense 32 bit ID (0, 1, 2, ...). Strings are never removed.
+ * Not thread-safe.
+ */
+typedef struct {
+    wchar_t **strings;   /* ID -> string */
+    uint32_t *lengths;   /* ID -> string length */
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *slots;     /* open addressing table of ID+1, 0 = empty */
+    uint32_t mask;       /* number of slots - 1 */
+    wchar_t *block;      /* current storage block */
+    size_t block_used;
+    size_t block_size;
+    void *blocks;        /* list of all storage blocks */
+    BOOL ignore_case;
+} STRPOOL;
+
+
+/* If 'ignore_case' is set, strings that only differ in case get the same ID. */
+BOOL strpool_init(STRPOOL *pool, BOOL ignore_case);
+void strpool_free(STRPOOL *pool);
+
+/* Returns the ID of the string, adding it if needed, or STRPOOL_NONE on error. */
+uint32_t strpool_intern(STRPOOL *pool, const wchar_t *str, size_t len);
+
+/* Returns the ID of the string or STRPOOL_NONE if it was never added. */
+uint32_t strpool_find(const STRPOOL *pool, const wchar_t *str, size_t len);
+
+/* Returns the NUL-terminated string with the given ID. */
+#define strpool_get(pool, id)     ((const wchar_t *)(pool)->strings[(id)])
+#define strpool_length(pool, id)  ((size_t)(pool)->lengths[(id)])
+
+#endif /* W32_SYMLINK_STRPOOL_H_INCLUDED */
@@ -0,0 +1,452 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include "calltrace.h"
+#include "convert.h"
+#include "reparse_data_buffer.h"
+#include "winerr.h"
+#include "w32-symlink.h"
+
+/* FileRenameInfoEx; missing in older SDKs */
+#define RENAME_INFO_EX  ((FILE_INFO_BY_HANDLE_CLASS)22)
+
+#ifndef FILE_RENAME_FLAG_REPLACE_IF_EXISTS
+#define FILE_RENAME_FLAG_REPLACE_IF_EXISTS  0x00000001
+#endif
+
+#ifndef FILE_RENAME_FLAG_POSIX_SEMANTICS
+#define FILE_RENAME_FLAG_POSIX_SEMANTICS    0x00000002
+#endif
+
+/* how many temporary names are tried before giving up */
+#define TEMP_TRIES  16
+
+
+/* FILE_RENAME_INFO; older SDKs only have ReplaceIfExists instead of Flags,
+ * which sits at the same offset */
+typedef struct {
+    DWORD  Flags;
+    HANDLE RootDirectory;
+    DWORD  FileNameLength;
+    WCHAR  FileName[1];
+} RENAME_INFO;
+
+
+static BOOL is_absolute(const wchar_t *path)
+{
+    return path[0] == L'\\' || path[0] == L'/' || (path[0] != 0 && path[1] == L':');
+}
+
+/* length of the directory part of 'path' including the separator */
+static size_t dir_length(const wchar_t *path)
+{
+    size_t len = wcslen(path);
+
+    while (len > 0 && path[len-1] != L'\\' && path[len-1] != L'/' && path[len-1] != L':') {
+        len--;
+    }
+
+    return len;
+}
+
+/* a junction needs an absolute target; relative ones are relative to the link */
+static wchar_t *junction_target(const wchar_t *target, const wchar_t *linkpath)
+{
+    wchar_t *joined = NULL, *buf;
+    size_t dirlen, len;
+    DWORD size;
+
+    if (!is_absolute(target)) {
+        dirlen = dir_length(linkpath);
+        len = wcslen(target);
+
+        if ((joined = malloc((dirlen + len + 1) * sizeof(wchar_t))) == NULL) {
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return NULL;
+        }
+
+        wmemcpy(joined, linkpath, dirlen);
+        wmemcpy(joined + dirlen, target, len + 1);
+        target = joined;
+    }
+
+    if ((size = GetFullPathNameW(target, 0, NULL, NULL)) == 0 ||
+        (buf = malloc(size * sizeof(wchar_t))) == NULL)
+    {
+        if (size != 0) SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        free(joined);
+        return NULL;
+    }
+
+    if (GetFullPathNameW(target, size, buf, NULL) == 0) {
+        free(buf);
+        buf = NULL;
+    }
+
+    free(joined);
+
+    return buf;
+}
+
+static volatile LONG temp_counter = 0;
+
+static size_t append_hex(wchar_t *buf, size_t len, DWORD value)
+{
+    int i;
+
+    for (i = 28; i >= 0; i -= 4) {
+        buf[len++] = L"0123456789abcdef"[(value >> i) & 0xf];
+    }
+
+    return len;
+}
+
+/* "<linkpath>.~<process ID>.<counter>", unique among the threads of this
+ * process; 'buf' must hold len + 20 characters */
+static void temp_name(wchar_t *buf, const wchar_t *linkpath, size_t len)
+{
+    wmemcpy(buf, linkpath, len);
+    buf[len++] = L'.';
+    buf[len++] = L'~';
+    len = append_hex(buf, len, GetCurrentProcessId());
+    buf[len++] = L'.';
+    len = append_hex(buf, len, (DWORD)InterlockedIncrement(&temp_counter));
+    buf[len] = 0;
+}
+
+static BOOL set_reparse_point(const wchar_t *path, const void *data, DWORD size)
+{
+    HANDLE handle;
+    DWORD dwRet, err;
+    BOOL ret;
+
+    handle = CreateFileW(path,
+                         GENERIC_WRITE,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         NULL,
+                         OPEN_EXISTING,
+                         FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS,
+                         NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    ret = DeviceIoControl(handle, FSCTL_SET_REPARSE_POINT, (LPVOID)data, size,
+                          NULL, 0, &dwRet, NULL);
+    err = GetLastError();
+    CloseHandle(handle);
+    SetLastError(err);
+
+    return ret;
+}
+
+static BOOL create_junction(const wchar_t *path, const wchar_t *target)
+{
+    uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    REPARSE_DATA_BUFFER *rdb = (REPARSE_DATA_BUFFER *)data;
+    MOUNTPOINT_REPARSE_BUFFER *mp = (MOUNTPOINT_REPARSE_BUFFER *)rdb->DataBuffer;
+    size_t len, sublen, datalen;
+    DWORD err;
+
+    /* "\\?\C:\dir" and "C:\dir" both become "\??\C:\dir" */
+    if (wcsncmp(target, L"\\\\?\\", 4) == 0) target += 4;
+
+    len = wcslen(target);
+    sublen = len + 4;
+    datalen = offsetof(MOUNTPOINT_REPARSE_BUFFER, PathBuffer) + (sublen + 1 + len + 1) * sizeof(WCHAR);
+
+    if (offsetof(REPARSE_DATA_BUFFER, DataBuffer) + datalen > sizeof(data)) {
+        SetLastError(ERROR_FILENAME_EXCED_RANGE);
+        return FALSE;
+    }
+
+    memset(data, 0, sizeof(data));
+    rdb->ReparseTag = IO_REPARSE_TAG_MOUNT_POINT;
+    rdb->ReparseDataLength = (USHORT)datalen;
+
+    mp->SubstituteNameOffset = 0;
+    mp->SubstituteNameLength = (USHORT)(sublen * sizeof(WCHAR));
+    mp->PrintNameOffset = (USHORT)((sublen + 1) * sizeof(WCHAR));
+    mp->PrintNameLength = (USHORT)(len * sizeof(WCHAR));
+    wmemcpy(mp->PathBuffer, L"\\??\\", 4);
+    wmemcpy(mp->PathBuffer + 4, target, len);
+    wmemcpy(mp->PathBuffer + sublen + 1, target, len);
+
+    if (!CreateDirectoryW(path, NULL)) {
+        return FALSE;
+    }
+
+    if (!set_reparse_point(path, data, (DWORD)(offsetof(REPARSE_DATA_BUFFER, DataBuffer) + datalen))) {
+        err = GetLastError();
+        RemoveDirectoryW(path);
+        SetLastError(err);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* rename 'path' to 'name' inside of the same directory, replacing it */
+static BOOL rename_over(const wchar_t *path, const wchar_t *name)
+{
+    size_t len = wcslen(name);
+    size_t size = offsetof(RENAME_INFO, FileName) + (len + 1) * sizeof(WCHAR);
+    RENAME_INFO *info;
+    HANDLE handle;
+    DWORD err;
+    BOOL ret;
+
+    if ((info = calloc(1, size)) == NULL) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    handle = CreateFileW(path,
+                         DELETE | SYNCHRONIZE,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         NULL,
+                         OPEN_EXISTING,
+                         FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS,
+                         NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        err = GetLastError();
+        free(info);
+        SetLastError(err);
+        return FALSE;
+    }
+
+    /* a plain name without RootDirectory renames inside of the same directory */
+    info->Flags = FILE_RENAME_FLAG_REPLACE_IF_EXISTS | FILE_RENAME_FLAG_POSIX_SEMANTICS;
+    info->RootDirectory = NULL;
+    info->FileNameLength = (DWORD)(len * sizeof(WCHAR));
+    wmemcpy(info->FileName, name, len);
+
+    ret = SetFileInformationByHandle(handle, RENAME_INFO_EX, info, (DWORD)size);
+
+    if (!ret) {
+        err = GetLastError();
+
+        /* FileRenameInfoEx requires Windows 10 1709 and NTFS */
+        if (err == ERROR_INVALID_PARAMETER || err == ERROR_NOT_SUPPORTED ||
+            err == ERROR_INVALID_FUNCTION)
+        {
+            info->Flags = TRUE;  /* ReplaceIfExists */
+            ret = SetFileInformationByHandle(handle, FileRenameInfo, info, (DWORD)size);
+        }
+    }
+
+    err = GetLastError();
+    CloseHandle(handle);
+    free(info);
+    SetLastError(err);
+
+    return ret;
+}
+
+/* copy the reparse data of 'from' onto the existing link 'to' */
+static BOOL swap_reparse_data(const wchar_t *from, const wchar_t *to)
+{
+    uint8_t data[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    HANDLE handle;
+    DWORD size = 0, err;
+    BOOL ret;
+
+    handle = traced_CreateFileW(from, 0,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OPEN_REPARSE_POINT | FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    ret = traced_get_reparse_point(handle, data, sizeof(data), &size);
+    err = GetLastError();
+    CloseHandle(handle);
+
+    if (!ret) {
+        SetLastError(err);
+        return FALSE;
+    }
+
+    return set_reparse_point(to, data, size);
+}
+
+int _wsymlink_replace(const wchar_t *target, const wchar_t *linkpath)
+{
+    wchar_t *tmp, *full;
+    size_t len;
+    ULONG tag = 0;
+    DWORD dwAttr, dwTarget, err = 0;
+    BOOL isDir, ok;
+    char mode = 0;
+    int tries;
+
+    if (!target || !*target || !linkpath || !*linkpath) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((dwAttr = GetFileAttributesW(linkpath)) == INVALID_FILE_ATTRIBUTES) {
+        err = GetLastError();
+
+        /* nothing to replace */
+        if (err == ERROR_FILE_NOT_FOUND) {
+            return _wsymlink(target, linkpath);
+        }
+
+        errno = map_winerr_to_errno(err);
+        return -1;
+    }
+
+    isDir = (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0;
+
+    if ((dwAttr & FILE_ATTRIBUTE_REPARSE_POINT) == 0) {
+        if (isDir) {
+            errno = EISDIR; /* Is a directory */
+            return -1;
+        }
+    } else if (isSymlinkW(linkpath, &tag) == -1) {
+        errno = map_winerr_to_errno(GetLastError());
+        return -1;
+    }
+
+    /* the temporary link is created next to the old one */
+    len = wcslen(linkpath);
+
+    if ((tmp = malloc((len + 20) * sizeof(wchar_t))) == NULL) {
+        errno = ENOMEM; /* Out of memory */
+        return -1;
+    }
+
+    full = NULL;
+
+    if (tag == IO_REPARSE_TAG_MOUNT_POINT) {
+        /* keep junctions junctions */
+        full = junction_target(target, linkpath);
+    } else {
+        /* use the type of the target if it exists, else keep the old one */
+        dwTarget = GetFileAttributesW(target);
+
+        if (dwTarget != INVALID_FILE_ATTRIBUTES) {
+            if (dwTarget & FILE_ATTRIBUTE_DIRECTORY) mode = 'D';
+        } else if (isDir) {
+            mode = 'D';
+        }
+    }
+
+    ok = FALSE;
+
+    /* a leftover of a crashed process may hold the name; try the next one */
+    for (tries = 0; tries < TEMP_TRIES; tries++) {
+        temp_name(tmp, linkpath, len);
+
+        if (tag != IO_REPARSE_TAG_MOUNT_POINT) {
+            ok = createLinkW(tmp, target, mode);
+        } else if (full) {
+            ok = create_junction(tmp, full);
+        } else {
+            break;
+        }
+
+        if (ok || (GetLastError() != ERROR_ALREADY_EXISTS &&
+                   GetLastError() != ERROR_FILE_EXISTS))
+        {
+            break;
+        }
+    }
+
+    free(full);
+
+    if (!ok) {
+        err = GetLastError();
+        free(tmp);
+        errno = map_winerr_to_errno(err);
+        return -1;
+    }
+
+    isDir = (tag == IO_REPARSE_TAG_MOUNT_POINT || mode == 'D');
+
+    if (!rename_over(tmp, linkpath + dir_length(linkpath))) {
+        err = GetLastError();
+
+        /* Directories cannot be replaced by renaming, but a link's reparse
+         * data can be rewritten in place. Both must have the same tag. */
+        if (err == ERROR_ACCESS_DENIED && isDir &&
+            (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0 &&
+            swap_reparse_data(tmp, linkpath))
+        {
+            err = 0;
+        }
+
+        if (isDir) {
+            RemoveDirectoryW(tmp);
+        } else {
+            DeleteFileW(tmp);
+        }
+    }
+
+    free(tmp);
+
+    if (err != 0) {
+        errno = map_winerr_to_errno(err);
+        return -1;
+    }
+
+    return 0;
+}
+
+int symlink_replace(const char *target, const char *linkpath)
+{
+    int rv;
+    wchar_t *wcs_linkpath, *wcs_target;
+
+    if (!target || !*target || !linkpath || !*linkpath) {
+        errno = EINVAL; /* Invalid argument */
+        return -1;
+    }
+
+    if ((wcs_target = convert_str_to_wcs(target)) == NULL) {
+        return -1;
+    }
+
+    if ((wcs_linkpath = convert_str_to_wcs(linkpath)) == NULL) {
+        free(wcs_target);
+        return -1;
+    }
+
+    rv = _wsymlink_replace(wcs_target, wcs_linkpath);
+
+    free(wcs_target);
+    free(wcs_linkpath);
+
+    return rv;
+}
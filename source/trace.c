@@ -0,0 +1,503 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "reparse_decode.h"
+#include "trace.h"
+
+/* op, error, arg, elapsed_ns, path_len, data_len, thread, handle, parent */
+#define RECORD_HEADER_SIZE     48
+#define RECORD_HEADER_SIZE_V1  32
+
+
+static void put_le(uint8_t *p, uint64_t v, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8*i));
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    if (timespec_get(&ts, TIME_UTC) != TIME_UTC) return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int trace_write_header(FILE *fp)
+{
+    return (fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_LEN, fp) == TRACE_MAGIC_LEN) ? 0 : -1;
+}
+
+int trace_write(FILE *fp, const TRACE_RECORD *rec)
+{
+    uint8_t hdr[RECORD_HEADER_SIZE];
+
+    put_le(hdr, rec->op, 4);
+    put_le(hdr + 4, rec->error, 4);
+    put_le(hdr + 8, rec->arg, 4);
+    put_le(hdr + 12, rec->elapsed_ns, 8);
+    put_le(hdr + 20, rec->path_len, 4);
+    put_le(hdr + 24, rec->data_len, 4);
+    put_le(hdr + 28, rec->thread, 4);
+    put_le(hdr + 32, rec->handle, 8);
+    put_le(hdr + 40, rec->parent, 8);
+
+    if (fwrite(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) ||
+        (rec->path_len > 0 && fwrite(rec->path, 1, rec->path_len, fp) != rec->path_len) ||
+        (rec->data_len > 0 && fwrite(rec->data, 1, rec->data_len, fp) != rec->data_len))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int trace_next(const uint8_t *buf, size_t size, size_t *pos, TRACE_RECORD *rec)
+{
+    const uint8_t *p;
+    size_t avail, hdr_size;
+
+    if (size < TRACE_MAGIC_LEN ||
+        (memcmp(buf, TRACE_MAGIC, TRACE_MAGIC_LEN) != 0 &&
+         memcmp(buf, TRACE_MAGIC_V1, TRACE_MAGIC_LEN) != 0))
+    {
+        return -1;
+    }
+
+    if (*pos == 0) *pos = TRACE_MAGIC_LEN;
+    if (*pos == size) return 0;
+
+    hdr_size = (buf[TRACE_MAGIC_LEN - 1] == '1') ? RECORD_HEADER_SIZE_V1 : RECORD_HEADER_SIZE;
+    avail = size - *pos;
+    p = buf + *pos;
+
+    if (avail < hdr_size) return -1;
+
+    rec->op = get_le32(p);
+    rec->error = get_le32(p + 4);
+    rec->arg = get_le32(p + 8);
+    rec->elapsed_ns = get_le64(p + 12);
+    rec->path_len = get_le32(p + 20);
+    rec->data_len = get_le32(p + 24);
+    rec->thread = get_le32(p + 28);
+    rec->handle = (hdr_size == RECORD_HEADER_SIZE) ? get_le64(p + 32) : 0;
+    rec->parent = (hdr_size == RECORD_HEADER_SIZE) ? get_le64(p + 40) : 0;
+
+    if (rec->op == 0 || rec->op >= TRACE_OP_COUNT ||
+        rec->path_len > avail - hdr_size ||
+        rec->data_len > avail - hdr_size - rec->path_len)
+    {
+        return -1;
+    }
+
+    rec->path = p + hdr_size;
+    rec->data = rec->path + rec->path_len;
+    *pos += hdr_size + rec->path_len + rec->data_len;
+
+    return 1;
+}
+
+int trace_replay(const uint8_t *buf, size_t size, unsigned int rounds, TRACE_STATS *stats)
+{
+    TRACE_RECORD rec;
+    REPARSE_VIEW view;
+    uint64_t start;
+    size_t pos = 0;
+    unsigned int i;
+    int rv, decoded = REPARSE_DECODE_INVALID;
+
+    memset(stats, 0, sizeof(TRACE_STATS));
+
+    if (rounds == 0) rounds = 1;
+
+    while ((rv = trace_next(buf, size, &pos, &rec)) == 1) {
+        stats->calls[rec.op]++;
+        stats->recorded_ns[rec.op] += rec.elapsed_ns;
+
+        if (rec.error != 0) {
+            stats->errors[rec.op]++;
+            continue;
+        }
+
+        if (rec.op != TRACE_GET_REPARSE) {
+            continue;
+        }
+
+        start = now_ns();
+
+        for (i = 0; i < rounds; i++) {
+            decoded = reparse_decode(rec.data, rec.data_len, &view);
+        }
+
+        stats->decode_ns += now_ns() - start;
+
+        if (decoded == REPARSE_DECODE_OK) {
+            stats->links++;
+        } else if (decoded == REPARSE_DECODE_INVALID) {
+            stats->invalid++;
+        }
+    }
+
+    return rv;
+}
+
+
+/* what a thread is doing while the index is built */
+typedef struct {
+    uint32_t       id;
+    size_t         call;         /* open entry point call or TRACE_NO_CALL */
+    const uint8_t *path;         /* of the last handle it opened (version 1) */
+    size_t         path_len;
+} THREAD_STATE;
+
+/* an open handle and its path while the index is built */
+typedef struct {
+    uint64_t       handle;
+    const uint8_t *path;
+    size_t         path_len;
+} HANDLE_STATE;
+
+typedef struct {
+    HANDLE_STATE *items;
+    size_t        count;
+    size_t        capacity;
+} HANDLE_TABLE;
+
+
+static HANDLE_STATE *handle_find(const HANDLE_TABLE *table, uint64_t handle)
+{
+    size_t i;
+
+    for (i = 0; i < table->count; i++) {
+        if (table->items[i].handle == handle) return &table->items[i];
+    }
+
+    return NULL;
+}
+
+/* handle values are reused once a handle is closed, so the last open wins */
+static int handle_set(HANDLE_TABLE *table, uint64_t handle, const uint8_t *path, size_t len)
+{
+    HANDLE_STATE *h;
+    void *p;
+
+    if ((h = handle_find(table, handle)) == NULL) {
+        if (table->count == table->capacity) {
+            size_t n = table->capacity ? table->capacity * 2 : 64;
+
+            if ((p = realloc(table->items, n * sizeof(HANDLE_STATE))) == NULL) {
+                return -1;
+            }
+            table->items = p;
+            table->capacity = n;
+        }
+
+        h = &table->items[table->count++];
+        h->handle = handle;
+    }
+
+    h->path = path;
+    h->path_len = len;
+
+    return 0;
+}
+
+uint8_t *trace_join_path(const uint8_t *dir, size_t dir_len, const uint8_t *name,
+                         size_t name_len, size_t *plen)
+{
+    uint8_t *buf;
+    size_t len = dir_len;
+
+    if ((buf = malloc(dir_len + 2 + name_len)) == NULL) {
+        return NULL;
+    }
+
+    memcpy(buf, dir, dir_len);
+
+    /* no second separator after a root like "\??\C:\" */
+    if (len < 2 || get_le16(buf + len - 2) != '\\') {
+        buf[len++] = '\\';
+        buf[len++] = 0;
+    }
+
+    memcpy(buf + len, name, name_len);
+    *plen = len + name_len;
+
+    return buf;
+}
+
+/* the full path of a relative open, kept by the index */
+static int join_relative(TRACE_INDEX *index, const HANDLE_TABLE *handles, TRACE_RECORD *rec)
+{
+    const HANDLE_STATE *dir;
+    uint8_t *path, **p;
+    size_t len;
+
+    if ((dir = handle_find(handles, rec->parent)) == NULL) {
+        /* opened before the trace started */
+        return 0;
+    }
+
+    if ((p = realloc(index->joined, (index->joined_count + 1) * sizeof(uint8_t *))) == NULL) {
+        return -1;
+    }
+
+    index->joined = p;
+
+    if ((path = trace_join_path(dir->path, dir->path_len, rec->path, rec->path_len, &len)) == NULL) {
+        return -1;
+    }
+
+    index->joined[index->joined_count++] = path;
+    rec->path = path;
+    rec->path_len = len;
+
+    return 0;
+}
+
+static THREAD_STATE *thread_state(THREAD_STATE **threads, size_t *count, uint32_t id)
+{
+    THREAD_STATE *p;
+    size_t i;
+
+    for (i = 0; i < *count; i++) {
+        if ((*threads)[i].id == id) return &(*threads)[i];
+    }
+
+    if ((p = realloc(*threads, (*count + 1) * sizeof(THREAD_STATE))) == NULL) {
+        return NULL;
+    }
+
+    *threads = p;
+    p += (*count)++;
+    p->id = id;
+    p->call = TRACE_NO_CALL;
+    p->path = NULL;
+    p->path_len = 0;
+
+    return p;
+}
+
+int trace_index_build(const uint8_t *buf, size_t size, TRACE_INDEX *index)
+{
+    THREAD_STATE *threads = NULL, *t;
+    HANDLE_TABLE handles = { NULL, 0, 0 };
+    const HANDLE_STATE *h;
+    TRACE_CALL_INFO *info;
+    TRACE_ENTRY *entry;
+    TRACE_RECORD rec;
+    size_t pos = 0, nthreads = 0, entries_max = 0, calls_max = 0;
+    void *p;
+    int rv;
+
+    memset(index, 0, sizeof(TRACE_INDEX));
+
+    while ((rv = trace_next(buf, size, &pos, &rec)) == 1) {
+        if ((t = thread_state(&threads, &nthreads, rec.thread)) == NULL) {
+            rv = -1;
+            break;
+        }
+
+        if (rec.op == TRACE_CALL) {
+            if (index->call_count == calls_max) {
+                calls_max = calls_max ? calls_max * 2 : 64;
+
+                if ((p = realloc(index->calls, calls_max * sizeof(TRACE_CALL_INFO))) == NULL) {
+                    rv = -1;
+                    break;
+                }
+                index->calls = p;
+            }
+
+            info = &index->calls[index->call_count];
+            memset(info, 0, sizeof(TRACE_CALL_INFO));
+            info->api = TRACE_CALL_API(rec.arg);
+            info->flags = TRACE_CALL_FLAGS(rec.arg);
+            info->thread = rec.thread;
+            info->path = rec.path;
+            info->path_len = rec.path_len;
+            t->call = index->call_count++;
+            continue;
+        }
+
+        if (rec.op == TRACE_RETURN) {
+            if (t->call != TRACE_NO_CALL) {
+                info = &index->calls[t->call];
+                info->error = rec.error;
+                info->elapsed_ns = rec.elapsed_ns;
+                info->returned = 1;
+                t->call = TRACE_NO_CALL;
+            }
+            continue;
+        }
+
+        if (index->count == entries_max) {
+            entries_max = entries_max ? entries_max * 2 : 256;
+
+            if ((p = realloc(index->entries, entries_max * sizeof(TRACE_ENTRY))) == NULL) {
+                rv = -1;
+                break;
+            }
+            index->entries = p;
+        }
+
+        if (rec.op == TRACE_CREATE_FILE || rec.op == TRACE_NT_OPEN) {
+            if (rec.op == TRACE_NT_OPEN && rec.parent != 0 &&
+                join_relative(index, &handles, &rec) != 0)
+            {
+                rv = -1;
+                break;
+            }
+
+            if (rec.error == 0) {
+                t->path = rec.path;
+                t->path_len = rec.path_len;
+
+                if (rec.handle != 0 && handle_set(&handles, rec.handle, rec.path, rec.path_len) != 0) {
+                    rv = -1;
+                    break;
+                }
+            }
+        } else if (rec.path_len == 0 && rec.op != TRACE_GET_ATTRIBUTES &&
+                   rec.op != TRACE_NT_ATTRIBUTES)
+        {
+            /* a call on a handle */
+            if (rec.handle == 0) {
+                rec.path = t->path;
+                rec.path_len = t->path_len;
+            } else if ((h = handle_find(&handles, rec.handle)) != NULL) {
+                rec.path = h->path;
+                rec.path_len = h->path_len;
+            }
+        }
+
+        entry = &index->entries[index->count++];
+        entry->rec = rec;
+        entry->call = t->call;
+
+        if (t->call != TRACE_NO_CALL) {
+            index->calls[t->call].calls[rec.op]++;
+        } else {
+            index->unowned++;
+        }
+    }
+
+    free(threads);
+    free(handles.items);
+
+    if (rv != 0) {
+        trace_index_free(index);
+        return -1;
+    }
+
+    return 0;
+}
+
+void trace_index_free(TRACE_INDEX *index)
+{
+    size_t i;
+
+    for (i = 0; i < index->joined_count; i++) {
+        free(index->joined[i]);
+    }
+
+    free(index->joined);
+    free(index->entries);
+    free(index->calls);
+    memset(index, 0, sizeof(TRACE_INDEX));
+}
+
+/* paths are compared like Windows does, ignoring the case of ASCII letters */
+static int path_equal(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint16_t ca, cb;
+    size_t i;
+
+    for (i = 0; i + 1 < len; i += 2) {
+        ca = get_le16(a + i);
+        cb = get_le16(b + i);
+
+        if (ca >= 'A' && ca <= 'Z') ca += 'a' - 'A';
+        if (cb >= 'A' && cb <= 'Z') cb += 'a' - 'A';
+        if (ca != cb) return 0;
+    }
+
+    return 1;
+}
+
+static int record_matches(const TRACE_RECORD *rec, uint32_t op, uint32_t arg,
+                          const uint8_t *path, size_t path_len)
+{
+    if (rec->op != op || rec->path_len != path_len ||
+        (path_len > 0 && !path_equal(rec->path, path, path_len)))
+    {
+        return 0;
+    }
+
+    switch (op)
+    {
+    case TRACE_GET_ATTRIBUTES:
+    case TRACE_NT_ATTRIBUTES:
+    case TRACE_GET_REPARSE:
+        /* 'arg' is a result or unused */
+        return 1;
+
+    case TRACE_FINAL_PATH:
+        if (rec->error == 0 && rec->data_len == 0) return 0;
+        break;
+
+    default:
+        break;
+    }
+
+    return rec->arg == arg;
+}
+
+const TRACE_RECORD *trace_lookup(const TRACE_INDEX *index, size_t call, uint32_t op,
+                                 uint32_t arg, const uint8_t *path, size_t path_len)
+{
+    const TRACE_ENTRY *e, *end = index->entries + index->count;
+
+    if (call != TRACE_NO_CALL) {
+        for (e = index->entries; e < end; e++) {
+            if (e->call == call && record_matches(&e->rec, op, arg, path, path_len)) {
+                return &e->rec;
+            }
+        }
+    }
+
+    for (e = index->entries; e < end; e++) {
+        if (record_matches(&e->rec, op, arg, path, path_len)) {
+            return &e->rec;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,199 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_TRACE_H_INCLUDED
+#define W32_SYMLINK_TRACE_H_INCLUDED
+
+/* This file must not depend on windows.h so recorded call traces can be
+ * replayed on other platforms. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+/* recorded backend calls */
+#define TRACE_CREATE_FILE     1  /* CreateFileW; 'arg' = flags and attributes */
+#define TRACE_GET_ATTRIBUTES  2  /* GetFileAttributesW; 'arg' = result */
+#define TRACE_GET_REPARSE     3  /* FSCTL_GET_REPARSE_POINT; data = raw reparse buffer */
+#define TRACE_FINAL_PATH      4  /* GetFinalPathNameByHandleW; 'arg' = flags, data = UTF-16 result */
+#define TRACE_NT_OPEN         5  /* NtCreateFile; 'arg' = create options, path = NT path
+                                  * or a name relative to a directory handle */
+#define TRACE_NT_ATTRIBUTES   6  /* NtQueryAttributesFile; 'arg' = attributes */
+#define TRACE_FILE_INFO       7  /* GetFileInformationByHandleEx; 'arg' = information class,
+                                  * data = result */
+
+/* markers around a call of a library entry point */
+#define TRACE_CALL            8  /* 'arg' = TRACE_CALL_ARG(), path = argument */
+#define TRACE_RETURN          9  /* 'error' = error code of the entry point,
+                                  * 'elapsed_ns' = time the whole call took */
+
+#define TRACE_OP_COUNT  10
+
+/* entry points in TRACE_CALL records */
+#define TRACE_API_IS_SYMLINK        1  /* isSymlinkW(); flags = TRACE_FLAG_TAG */
+#define TRACE_API_LINK_TARGET       2  /* getLinkTargetW() */
+#define TRACE_API_LINK_TARGET_VIEW  3  /* getLinkTargetViewW() */
+#define TRACE_API_CANONICAL_PATH    4  /* getCanonicalPathExW(); flags = CANONICAL_PATH_* */
+#define TRACE_API_NT_IS_SYMLINK     5  /* ntIsSymlinkW(); flags = TRACE_FLAG_TAG */
+#define TRACE_API_NT_LINK_TARGET    6  /* ntGetLinkTargetW() */
+#define TRACE_API_NT_CANONICAL_PATH 7  /* ntGetCanonicalPathW(); flags = CANONICAL_PATH_* */
+#define TRACE_API_LSTAT             8  /* _lwstat64() */
+
+#define TRACE_API_COUNT  9
+
+/* the reparse tag was requested, which takes extra calls */
+#define TRACE_FLAG_TAG  1
+
+#define TRACE_CALL_ARG(api, flags)  ((uint32_t)(api) | (uint32_t)(flags) << 8)
+#define TRACE_CALL_API(arg)         ((arg) & 0xFF)
+#define TRACE_CALL_FLAGS(arg)       ((arg) >> 8)
+
+/* file signature; version 1 traces have no handles and are still read */
+#define TRACE_MAGIC      "W32SLTR2"
+#define TRACE_MAGIC_V1   "W32SLTR1"
+#define TRACE_MAGIC_LEN  8
+
+
+/**
+ * One backend call. 'path' is UTF-16LE and empty for calls on a handle.
+ * Lengths are in bytes. Handle values only serve to tell handles apart.
+ */
+typedef struct {
+    uint32_t       op;           /* TRACE_* */
+    uint32_t       error;        /* Win32 error code, 0 on success */
+    uint32_t       arg;
+    uint32_t       thread;       /* ID of the calling thread */
+    uint64_t       elapsed_ns;
+    uint64_t       handle;       /* opened or used by the call, 0 if none */
+    uint64_t       parent;       /* directory a TRACE_NT_OPEN name is relative to */
+    const uint8_t *path;
+    size_t         path_len;
+    const uint8_t *data;
+    size_t         data_len;
+} TRACE_RECORD;
+
+typedef struct {
+    uint64_t calls[TRACE_OP_COUNT];
+    uint64_t errors[TRACE_OP_COUNT];
+    uint64_t recorded_ns[TRACE_OP_COUNT];  /* time the calls took when recorded */
+    uint64_t links;                        /* reparse buffers that decode to a link */
+    uint64_t invalid;                      /* corrupted reparse buffers */
+    uint64_t decode_ns;                    /* time spent decoding during the replay */
+} TRACE_STATS;
+
+
+/* write the file signature and a record; return 0 or -1 */
+int trace_write_header(FILE *fp);
+int trace_write(FILE *fp, const TRACE_RECORD *rec);
+
+
+/**
+ * Read the record at '*pos' of a trace that was loaded into memory and
+ * advance '*pos'. Start with '*pos' = 0, the signature is checked then.
+ * Returns 1 on success, 0 at the end and -1 on corrupted data.
+ * The pointers in 'rec' point into 'buf'.
+ */
+int trace_next(const uint8_t *buf, size_t size, size_t *pos, TRACE_RECORD *rec);
+
+
+/**
+ * Replay a trace: count the calls and run the reparse data through the
+ * same decoder the library uses, 'rounds' times (at least once), so its
+ * cost can be measured independently of the file system. This is all
+ * that runs on other platforms; replaying the entry points through the
+ * library (tools/tracereplay) needs Windows.
+ * Returns 0 on success or -1 on corrupted data.
+ */
+int trace_replay(const uint8_t *buf, size_t size, unsigned int rounds, TRACE_STATS *stats);
+
+
+
+/* one entry point call of a trace */
+typedef struct {
+    uint32_t       api;          /* TRACE_API_* */
+    uint32_t       flags;
+    uint32_t       thread;
+    uint32_t       error;        /* error code of the entry point, 0 on success */
+    int            returned;     /* 0 if the trace ended before the call returned */
+    const uint8_t *path;
+    size_t         path_len;
+    uint64_t       elapsed_ns;
+    uint64_t       calls[TRACE_OP_COUNT];  /* backend calls made by the entry point */
+} TRACE_CALL_INFO;
+
+/* a backend call and the entry point call it belongs to */
+typedef struct {
+    TRACE_RECORD rec;
+    size_t       call;           /* index in TRACE_INDEX.calls or TRACE_NO_CALL */
+} TRACE_ENTRY;
+
+#define TRACE_NO_CALL  ((size_t)-1)
+
+typedef struct {
+    TRACE_ENTRY     *entries;
+    size_t           count;
+    TRACE_CALL_INFO *calls;
+    size_t           call_count;
+    uint64_t         unowned;    /* backend calls made outside of a marked call */
+    uint8_t        **joined;     /* full paths of relative opens, owned by the index */
+    size_t           joined_count;
+} TRACE_INDEX;
+
+
+/**
+ * Index a trace that was loaded into memory, so it can be replayed
+ * through the library itself. The backend calls are assigned to the
+ * TRACE_CALL ... TRACE_RETURN markers of their thread. Calls on a handle
+ * get the path the handle was opened with, and names opened relative to
+ * a directory handle are joined with the directory's path ("dir\name");
+ * in version 1 traces, calls on a handle get the path of the last handle
+ * their thread opened. The index points into 'buf'. Returns 0 on success or -1 on corrupted data or if
+ * memory is exhausted. Free the index with trace_index_free().
+ */
+int trace_index_build(const uint8_t *buf, size_t size, TRACE_INDEX *index);
+
+void trace_index_free(TRACE_INDEX *index);
+
+
+/**
+ * Join a directory path and a relative name as trace_index_build() does
+ * (UTF-16LE, lengths in bytes). Returns NULL if memory is exhausted;
+ * deallocate the result with free().
+ */
+uint8_t *trace_join_path(const uint8_t *dir, size_t dir_len, const uint8_t *name,
+                         size_t name_len, size_t *plen);
+
+
+/**
+ * Find the recorded result of a backend call: the first record with the
+ * same op and path (compared case-insensitively) among those of entry
+ * point call 'call', else among all records. For ops whose 'arg' is an
+ * input (flags, options or an information class) it must match too.
+ * Size queries of GetFinalPathNameByHandleW have no result and are
+ * skipped. Returns NULL if there is no such record.
+ */
+const TRACE_RECORD *trace_lookup(const TRACE_INDEX *index, size_t call, uint32_t op,
+                                 uint32_t arg, const uint8_t *path, size_t path_len);
+
+#endif /* W32_SYMLINK_TRACE_H_INCLUDED */
@@ -0,0 +1,319 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "convert.h"
+#include "lx_path.h"
+#include "w32-symlink.h"
+
+#ifdef _MSC_VER
+#pragma comment(lib, "advapi32.lib")
+#endif
+
+#define LXSS_KEY  L"Software\\Microsoft\\Windows\\CurrentVersion\\Lxss"
+
+/* registry values are small, a GUID is 38 characters */
+#define REG_BUFSIZE  256
+
+/* larger configuration files are ignored */
+#define CONF_MAX_SIZE  (64 * 1024)
+
+
+static SRWLOCK table_lock = SRWLOCK_INIT;
+static BOOL table_loaded = FALSE;
+static const char *default_distro = NULL;  /* one of the names in 'distros' */
+static LX_DISTRO *distros = NULL;          /* names are UTF-8 */
+static LX_CONFIG *configs = NULL;          /* settings of 'distros' */
+static size_t distro_count = 0;
+
+
+/* a registry string or NULL */
+static wchar_t *get_reg_string(HKEY key, const wchar_t *subkey, const wchar_t *value)
+{
+    wchar_t *buf;
+    DWORD size = 0;
+
+    if (RegGetValueW(key, subkey, value, RRF_RT_REG_SZ, NULL, NULL, &size) != ERROR_SUCCESS ||
+        (buf = malloc(size)) == NULL)
+    {
+        return NULL;
+    }
+
+    if (RegGetValueW(key, subkey, value, RRF_RT_REG_SZ, NULL, buf, &size) != ERROR_SUCCESS) {
+        free(buf);
+        return NULL;
+    }
+
+    return buf;
+}
+
+/* contents of "<base>\rootfs\etc\<name>"; only WSL 1 keeps its files there */
+static char *read_etc_file(const wchar_t *base, const wchar_t *name)
+{
+    LARGE_INTEGER size;
+    wchar_t *path;
+    char *buf = NULL;
+    HANDLE handle;
+    DWORD n = 0;
+    size_t len;
+
+    len = wcslen(base) + wcslen(L"\\rootfs\\etc\\") + wcslen(name) + 1;
+
+    if ((path = malloc(len * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    wcscpy(path, base);
+    wcscat(path, L"\\rootfs\\etc\\");
+    wcscat(path, name);
+
+    handle = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         NULL, OPEN_EXISTING, 0, NULL);
+    free(path);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    if (GetFileSizeEx(handle, &size) && size.QuadPart <= CONF_MAX_SIZE &&
+        (buf = malloc((size_t)size.QuadPart + 1)) != NULL)
+    {
+        if (ReadFile(handle, buf, (DWORD)size.QuadPart, &n, NULL)) {
+            buf[n] = 0;
+        } else {
+            free(buf);
+            buf = NULL;
+        }
+    }
+
+    CloseHandle(handle);
+
+    return buf;
+}
+
+/* name and settings of the distribution registered as 'guid' */
+static BOOL load_distro(HKEY lxss, const wchar_t *guid, LX_DISTRO *d, LX_CONFIG *config)
+{
+    wchar_t *name, *base;
+    char *wsl_conf = NULL, *fstab = NULL;
+
+    if ((name = get_reg_string(lxss, guid, L"DistributionName")) == NULL) {
+        return FALSE;
+    }
+
+    d->name = convert_wcs_to_utf8(name);
+    free(name);
+
+    if (!d->name) {
+        return FALSE;
+    }
+
+    if ((base = get_reg_string(lxss, guid, L"BasePath")) != NULL) {
+        wsl_conf = read_etc_file(base, L"wsl.conf");
+        fstab = read_etc_file(base, L"fstab");
+        free(base);
+    }
+
+    /* without the files the defaults apply */
+    if (lx_config_parse(wsl_conf, fstab, config) != LX_PATH_OK) {
+        lx_config_free(config);
+    }
+
+    free(wsl_conf);
+    free(fstab);
+
+    d->automount_root = config->automount_root;
+    d->mounts = config->mounts;
+    d->mount_count = config->mount_count;
+
+    return TRUE;
+}
+
+/* table_lock must be held exclusively */
+static void free_table(void)
+{
+    size_t i;
+
+    for (i = 0; i < distro_count; i++) {
+        free((char *)distros[i].name);
+        lx_config_free(&configs[i]);
+    }
+
+    free(distros);
+    free(configs);
+    distros = NULL;
+    configs = NULL;
+    distro_count = 0;
+    default_distro = NULL;
+}
+
+/* table_lock must be held exclusively */
+static void load_table(void)
+{
+    wchar_t guid[REG_BUFSIZE], *def;
+    DWORD i, count = 0, len;
+    HKEY lxss;
+
+    free_table();
+    table_loaded = TRUE;
+
+    /* every registered distribution is a subkey named by its GUID */
+    if (RegOpenKeyExW(HKEY_CURRENT_USER, LXSS_KEY, 0, KEY_READ, &lxss) != ERROR_SUCCESS) {
+        return;
+    }
+
+    if (RegQueryInfoKeyW(lxss, NULL, NULL, NULL, &count, NULL, NULL, NULL,
+                         NULL, NULL, NULL, NULL) != ERROR_SUCCESS || count == 0 ||
+        (distros = calloc(count, sizeof(LX_DISTRO))) == NULL ||
+        (configs = calloc(count, sizeof(LX_CONFIG))) == NULL)
+    {
+        free(distros);
+        distros = NULL;
+        RegCloseKey(lxss);
+        return;
+    }
+
+    def = get_reg_string(lxss, NULL, L"DefaultDistribution");
+
+    for (i = 0; i < count; i++) {
+        len = REG_BUFSIZE;
+
+        if (RegEnumKeyExW(lxss, i, guid, &len, NULL, NULL, NULL, NULL) != ERROR_SUCCESS) {
+            break;
+        }
+
+        if (load_distro(lxss, guid, &distros[distro_count], &configs[distro_count])) {
+            if (def && _wcsicmp(def, guid) == 0) {
+                default_distro = distros[distro_count].name;
+            }
+            distro_count++;
+        }
+    }
+
+    free(def);
+    RegCloseKey(lxss);
+}
+
+void refreshLxMountTable(void)
+{
+    AcquireSRWLockExclusive(&table_lock);
+    load_table();
+    ReleaseSRWLockExclusive(&table_lock);
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+char *translateLxTargetA(const char *lpLinkName, const char *lpTarget)
+{
+    wchar_t *wcs_link, *wcs_target, *wcs_out = NULL;
+    char *buf;
+
+    if (!lpLinkName || !lpTarget) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    /* convert strings */
+    wcs_link = convert_str_to_wcs(lpLinkName);
+    wcs_target = convert_str_to_wcs(lpTarget);
+
+    /* call wide character function */
+    if (wcs_link && wcs_target) {
+        wcs_out = translateLxTargetW(wcs_link, wcs_target);
+    }
+
+    free(wcs_link);
+    free(wcs_target);
+    if (!wcs_out) return NULL;
+
+    /* convert string */
+    buf = convert_wcs_to_str(wcs_out);
+    free(wcs_out);
+
+    return buf;
+}
+
+/**
+ * Result must be deallocated with free().
+ */
+wchar_t *translateLxTargetW(const wchar_t *lpLinkName, const wchar_t *lpTarget)
+{
+    LX_PATH_TABLE table;
+    char *link, *target, *result = NULL;
+    wchar_t *buf = NULL;
+    int rv = LX_PATH_NOMEM;
+
+    if (!lpLinkName || !lpTarget) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    /* the translation works on UTF-8 strings */
+    link = convert_wcs_to_utf8(lpLinkName);
+    target = convert_wcs_to_utf8(lpTarget);
+
+    if (link && target) {
+        /* load once; readers share the lock afterwards */
+        AcquireSRWLockShared(&table_lock);
+
+        if (!table_loaded) {
+            ReleaseSRWLockShared(&table_lock);
+            AcquireSRWLockExclusive(&table_lock);
+            if (!table_loaded) load_table();
+            ReleaseSRWLockExclusive(&table_lock);
+            AcquireSRWLockShared(&table_lock);
+        }
+
+        memset(&table, 0, sizeof(table));
+        table.default_distro = default_distro;
+        table.distros = distros;
+        table.distro_count = distro_count;
+        rv = lx_path_translate(&table, link, target, &result);
+
+        ReleaseSRWLockShared(&table_lock);
+    }
+
+    free(link);
+    free(target);
+
+    switch (rv)
+    {
+    case LX_PATH_OK:
+        buf = convert_utf8_to_wcs(result);
+        free(result);
+        if (!buf) SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        break;
+    case LX_PATH_UNRESOLVED:
+        SetLastError(ERROR_NOT_SUPPORTED);
+        break;
+    default:
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        break;
+    }
+
+    return buf;
+}
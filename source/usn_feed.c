@@ -0,0 +1,495 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reparse_decode.h"
+#include "usn_feed.h"
+
+#define READ_BUFFER_SIZE     (64 * 1024)
+#define REPARSE_BUFFER_SIZE  (16 * 1024)  /* MAXIMUM_REPARSE_DATA_BUFFER_SIZE */
+
+/* initial number of slots of the KNOWN_TABLE, a power of 2 */
+#define KNOWN_INITIAL_SIZE   1024
+
+/* attributes of cloud file placeholders and other HSM files, which are
+ * reparse points but never links */
+#define USN_ATTRIBUTE_NOT_LINK  (0x00001000U |  /* FILE_ATTRIBUTE_OFFLINE */ \
+                                 0x00040000U |  /* FILE_ATTRIBUTE_RECALL_ON_OPEN */ \
+                                 0x00080000U |  /* FILE_ATTRIBUTE_PINNED */ \
+                                 0x00100000U |  /* FILE_ATTRIBUTE_UNPINNED */ \
+                                 0x00400000U)   /* FILE_ATTRIBUTE_RECALL_ON_DATA_ACCESS */
+
+
+typedef struct {
+    uint32_t length;
+    uint16_t major;
+    uint64_t usn;
+    int64_t  timestamp;
+    uint8_t  file_id[16];
+    uint8_t  parent_id[16];
+    uint32_t reason;
+    uint32_t attributes;
+    const uint8_t *name;
+    size_t   name_len;
+} USN_RECORD_INFO;
+
+/* The reparse points seen during a run, by file ID. A removal record
+ * has no reparse tag and the file may be gone, so this is how deleting
+ * a WOF or cloud file is told apart from deleting a link. */
+typedef struct {
+    uint8_t  file_id[16];
+    uint8_t  state;        /* 0 = empty, 1 = used, 2 = deleted */
+    uint8_t  link;
+} KNOWN_FILE;
+
+typedef struct {
+    KNOWN_FILE *slots;
+    size_t      size;      /* a power of 2 */
+    size_t      used;      /* slots that are not empty */
+} KNOWN_TABLE;
+
+
+/**
+ * Parse a USN_RECORD_V2 or USN_RECORD_V3.
+ * Returns 0 on success, 1 for records of other versions (only their
+ * length is set) and -1 on invalid data.
+ */
+static int parse_record(const uint8_t *p, size_t avail, USN_RECORD_INFO *rec)
+{
+    size_t name_off, name_len;
+
+    memset(rec, 0, sizeof(USN_RECORD_INFO));
+
+    if (avail < 8) return -1;
+
+    rec->length = get_le32(p);
+    rec->major = get_le16(p+4);
+
+    if (rec->length < 8 || rec->length > avail || rec->length % 8 != 0) {
+        return -1;
+    }
+
+    switch (rec->major)
+    {
+    case 2:
+        if (rec->length < 60) return -1;
+        memcpy(rec->file_id, p+8, 8);
+        memcpy(rec->parent_id, p+16, 8);
+        rec->usn = get_le64(p+24);
+        rec->timestamp = (int64_t)get_le64(p+32);
+        rec->reason = get_le32(p+40);
+        rec->attributes = get_le32(p+52);
+        name_len = get_le16(p+56);
+        name_off = get_le16(p+58);
+        break;
+
+    case 3:
+        if (rec->length < 76) return -1;
+        memcpy(rec->file_id, p+8, 16);
+        memcpy(rec->parent_id, p+24, 16);
+        rec->usn = get_le64(p+40);
+        rec->timestamp = (int64_t)get_le64(p+48);
+        rec->reason = get_le32(p+56);
+        rec->attributes = get_le32(p+68);
+        name_len = get_le16(p+72);
+        name_off = get_le16(p+74);
+        break;
+
+    default:
+        /* unknown versions are skipped */
+        return 1;
+    }
+
+    if (name_off + name_len > rec->length || (name_len & 1)) {
+        return -1;
+    }
+
+    rec->name = p + name_off;
+    rec->name_len = name_len / 2;
+
+    return 0;
+}
+
+static size_t known_hash(const uint8_t file_id[16])
+{
+    /* 64 bit IDs are zero-extended, ReFS uses both halves */
+    uint64_t h = get_le64(file_id) ^ get_le64(file_id + 8);
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* the slot of 'file_id', or the first free one on its probe sequence */
+static KNOWN_FILE *known_slot(const KNOWN_TABLE *t, const uint8_t file_id[16])
+{
+    size_t i = known_hash(file_id) & (t->size - 1);
+    KNOWN_FILE *free_slot = NULL;
+
+    while (t->slots[i].state != 0) {
+        if (t->slots[i].state == 1 && memcmp(t->slots[i].file_id, file_id, 16) == 0) {
+            return &t->slots[i];
+        }
+
+        if (t->slots[i].state == 2 && !free_slot) {
+            free_slot = &t->slots[i];
+        }
+
+        i = (i + 1) & (t->size - 1);
+    }
+
+    return free_slot ? free_slot : &t->slots[i];
+}
+
+/* 1 if the file is known to be a link, 0 if not, -1 if unknown */
+static int known_lookup(const KNOWN_TABLE *t, const uint8_t file_id[16])
+{
+    const KNOWN_FILE *k;
+
+    if (!t->slots) return -1;
+
+    k = known_slot(t, file_id);
+
+    return (k->state == 1) ? k->link : -1;
+}
+
+/* remember whether the file is a link; without memory it is just
+ * not remembered */
+static void known_set(KNOWN_TABLE *t, const uint8_t file_id[16], int link)
+{
+    KNOWN_TABLE grown;
+    KNOWN_FILE *k;
+    size_t i;
+
+    if (!t->slots || (t->used + 1) * 4 > t->size * 3) {
+        grown.size = t->slots ? t->size * 2 : KNOWN_INITIAL_SIZE;
+        grown.used = 0;
+
+        if ((grown.slots = calloc(grown.size, sizeof(KNOWN_FILE))) == NULL) {
+            return;
+        }
+
+        /* deleted slots are dropped */
+        for (i = 0; t->slots && i < t->size; i++) {
+            if (t->slots[i].state == 1) {
+                *known_slot(&grown, t->slots[i].file_id) = t->slots[i];
+                grown.used++;
+            }
+        }
+
+        free(t->slots);
+        *t = grown;
+    }
+
+    k = known_slot(t, file_id);
+
+    if (k->state == 0) t->used++;
+
+    memcpy(k->file_id, file_id, 16);
+    k->state = 1;
+    k->link = link ? 1 : 0;
+}
+
+static void known_forget(KNOWN_TABLE *t, const uint8_t file_id[16])
+{
+    KNOWN_FILE *k;
+
+    if (!t->slots) return;
+
+    if ((k = known_slot(t, file_id))->state == 1) {
+        k->state = 2;
+    }
+}
+
+/* which kind of event a record stands for; 0 = not interesting */
+static int event_type(const USN_RECORD_INFO *rec)
+{
+    uint32_t r = rec->reason;
+    int reparse = (rec->attributes & USN_ATTRIBUTE_REPARSE_POINT) ? 1 : 0;
+
+    if (!(r & USN_FEED_CLOSE)) {
+        /* The old name of a renamed or moved file is only in the record
+         * written at the rename itself, the closing record has the new
+         * one. Reasons add up until the file is closed, so once there is
+         * a new name (or the file was created in the same go) the old
+         * name was never reported. */
+        if ((r & USN_FEED_RENAME_OLD_NAME) &&
+            !(r & (USN_FEED_RENAME_NEW_NAME | USN_FEED_FILE_CREATE)))
+        {
+            return reparse ? USN_LINK_REMOVED : 0;
+        }
+
+        return 0;
+    }
+
+    if (!(r & USN_FEED_REASON_MASK)) {
+        return 0;
+    }
+
+    if (r & USN_FEED_FILE_DELETE) {
+        return reparse ? USN_LINK_REMOVED : 0;
+    }
+
+    if (r & (USN_FEED_FILE_CREATE | USN_FEED_RENAME_NEW_NAME)) {
+        return reparse ? USN_LINK_ADDED : 0;
+    }
+
+    if (r & USN_FEED_REPARSE_POINT_CHANGE) {
+        /* the reparse point was either set, replaced or deleted */
+        return reparse ? USN_LINK_CHANGED : USN_LINK_REMOVED;
+    }
+
+    return 0;
+}
+
+/* Whether a removal is about a link, decided like for added links where
+ * possible: by what was seen of the file during this run, else by its
+ * current reparse point if it still exists (the old name of a rename),
+ * else by its attributes. */
+static int removed_link(const USN_SOURCE *src, const USN_RECORD_INFO *rec,
+                        KNOWN_TABLE *known, uint8_t *rbuf, FILE *record)
+{
+    REPARSE_VIEW view;
+    size_t rlen;
+    int link;
+
+    if ((link = known_lookup(known, rec->file_id)) < 0) {
+        if (src->get_reparse_data && !(rec->reason & USN_FEED_FILE_DELETE) &&
+            src->get_reparse_data(src->ctx, rec->file_id, rbuf, REPARSE_BUFFER_SIZE, &rlen) == 1)
+        {
+            if (record) usn_write_chunk(record, USN_CHUNK_REPARSE, rec->file_id, 16, rbuf, rlen);
+
+            link = (reparse_decode(rbuf, rlen, &view) != REPARSE_DECODE_NOLINK);
+        } else {
+            link = !(rec->attributes & USN_ATTRIBUTE_NOT_LINK);
+        }
+    }
+
+    /* the file or its reparse point is gone */
+    if (rec->reason & USN_FEED_CLOSE) {
+        known_forget(known, rec->file_id);
+    }
+
+    return link;
+}
+
+int usn_write_chunk(FILE *fp, uint32_t type, const uint8_t *prefix, size_t prefix_len,
+                    const uint8_t *data, size_t len)
+{
+    uint8_t hdr[8];
+    uint32_t total = (uint32_t)(prefix_len + len);
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        hdr[i] = (uint8_t)(type >> (8*i));
+        hdr[4+i] = (uint8_t)(total >> (8*i));
+    }
+
+    if (fwrite(hdr, 1, 8, fp) != 8 ||
+        (prefix_len > 0 && fwrite(prefix, 1, prefix_len, fp) != prefix_len) ||
+        (len > 0 && fwrite(data, 1, len, fp) != len))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int usn_feed_run(const USN_SOURCE *src, USN_EVENT_FUNC func, void *ctx,
+                 FILE *record, uint64_t *last_usn)
+{
+    USN_RECORD_INFO rec;
+    USN_LINK_EVENT ev;
+    REPARSE_VIEW view;
+    KNOWN_TABLE known = { NULL, 0, 0 };
+    uint8_t *buf, *rbuf;
+    size_t len, rlen, off;
+    int rv, parsed, ret = 0;
+
+    if (!src || !src->read || !func) {
+        return -1;
+    }
+
+    buf = malloc(READ_BUFFER_SIZE);
+    rbuf = malloc(REPARSE_BUFFER_SIZE);
+
+    if (!buf || !rbuf) {
+        free(buf);
+        free(rbuf);
+        return -1;
+    }
+
+    while (ret == 0 && (rv = src->read(src->ctx, buf, READ_BUFFER_SIZE, &len)) == 1) {
+        if (record) usn_write_chunk(record, USN_CHUNK_RECORDS, NULL, 0, buf, len);
+
+        for (off = 0; off < len; off += rec.length) {
+            if ((parsed = parse_record(buf + off, len - off, &rec)) != 0) {
+                if (parsed == 1) continue;
+
+                ret = -1;
+                break;
+            }
+
+            if (last_usn) *last_usn = rec.usn;
+
+            memset(&ev, 0, sizeof(ev));
+
+            if ((ev.type = event_type(&rec)) == 0) {
+                continue;
+            }
+
+            ev.usn = rec.usn;
+            ev.timestamp = rec.timestamp;
+            memcpy(ev.file_id, rec.file_id, 16);
+            memcpy(ev.parent_id, rec.parent_id, 16);
+            ev.reason = rec.reason;
+            ev.attributes = rec.attributes;
+            ev.name = (const uint16_t *)rec.name;
+            ev.name_len = rec.name_len;
+
+            if (ev.type == USN_LINK_REMOVED) {
+                if (!removed_link(src, &rec, &known, rbuf, record)) continue;
+            } else if (src->get_reparse_data &&
+                       src->get_reparse_data(src->ctx, rec.file_id, rbuf, REPARSE_BUFFER_SIZE, &rlen) == 1)
+            {
+                /* decode the current target of added or changed links */
+                if (record) usn_write_chunk(record, USN_CHUNK_REPARSE, rec.file_id, 16, rbuf, rlen);
+
+                switch (reparse_decode(rbuf, rlen, &view))
+                {
+                case REPARSE_DECODE_OK:
+                    ev.tag = view.tag;
+                    ev.target = rbuf + view.target_off;
+                    ev.target_len = view.target_len;
+                    ev.target_utf8 = view.utf8;
+                    known_set(&known, rec.file_id, 1);
+                    break;
+                case REPARSE_DECODE_NOLINK:
+                    /* some other kind of reparse point */
+                    known_set(&known, rec.file_id, 0);
+                    continue;
+                default:
+                    known_set(&known, rec.file_id, 1);
+                    break;
+                }
+            }
+
+            if (func(ctx, &ev) != 0) {
+                ret = 1;
+                break;
+            }
+        }
+    }
+
+    if (ret == 0 && rv == -1) {
+        ret = -1;
+    }
+
+    free(buf);
+    free(rbuf);
+    free(known.slots);
+
+    return ret;
+}
+
+
+/* read the chunk header at replay->pos */
+static int next_chunk(const USN_REPLAY *replay, size_t pos, uint32_t *type, size_t *len)
+{
+    if (replay->size - pos < 8) return 0;
+
+    *type = get_le32(replay->data + pos);
+    *len = get_le32(replay->data + pos + 4);
+
+    return (*len <= replay->size - pos - 8) ? 1 : -1;
+}
+
+static int replay_read(void *ctx, uint8_t *buf, size_t size, size_t *len)
+{
+    USN_REPLAY *replay = (USN_REPLAY *)ctx;
+    uint32_t type;
+    size_t n;
+    int rv;
+
+    /* skip everything up to the next records chunk */
+    while ((rv = next_chunk(replay, replay->pos, &type, &n)) == 1) {
+        replay->pos += 8;
+
+        if (type == USN_CHUNK_RECORDS) {
+            if (n > size) return -1;
+
+            memcpy(buf, replay->data + replay->pos, n);
+            replay->pos += n;
+            *len = n;
+            return 1;
+        }
+
+        replay->pos += n;
+    }
+
+    return rv;
+}
+
+static int replay_get_reparse_data(void *ctx, const uint8_t file_id[16],
+                                   uint8_t *buf, size_t size, size_t *len)
+{
+    USN_REPLAY *replay = (USN_REPLAY *)ctx;
+    size_t pos = replay->pos, n;
+    uint32_t type;
+
+    /* the data recorded for the current records chunk follows it */
+    while (next_chunk(replay, pos, &type, &n) == 1 && type != USN_CHUNK_RECORDS) {
+        pos += 8;
+
+        if (type == USN_CHUNK_REPARSE && n >= 16 &&
+            memcmp(replay->data + pos, file_id, 16) == 0)
+        {
+            if (n - 16 > size) return -1;
+
+            memcpy(buf, replay->data + pos + 16, n - 16);
+            *len = n - 16;
+            return 1;
+        }
+
+        pos += n;
+    }
+
+    return 0;
+}
+
+void usn_replay_source(USN_REPLAY *replay, const uint8_t *data, size_t size, USN_SOURCE *src)
+{
+    replay->data = data;
+    replay->size = size;
+    replay->pos = 0;
+
+    src->read = replay_read;
+    src->get_reparse_data = replay_get_reparse_data;
+    src->ctx = replay;
+}
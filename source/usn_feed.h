@@ -0,0 +1,137 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_USN_FEED_H_INCLUDED
+#define W32_SYMLINK_USN_FEED_H_INCLUDED
+
+/* This file must not depend on windows.h so the change feed can be
+ * replayed from recorded data on other platforms. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+/* https://learn.microsoft.com/en-us/windows/win32/api/winioctl/ns-winioctl-usn_record_v2 */
+/* (same values as USN_REASON_*, renamed to not clash with winioctl.h) */
+#define USN_FEED_FILE_CREATE           0x00000100U
+#define USN_FEED_FILE_DELETE           0x00000200U
+#define USN_FEED_RENAME_OLD_NAME       0x00001000U
+#define USN_FEED_RENAME_NEW_NAME       0x00002000U
+#define USN_FEED_REPARSE_POINT_CHANGE  0x00100000U
+#define USN_FEED_CLOSE                 0x80000000U
+
+#define USN_FEED_REASON_MASK  (USN_FEED_FILE_CREATE | USN_FEED_FILE_DELETE | \
+                               USN_FEED_RENAME_OLD_NAME | USN_FEED_RENAME_NEW_NAME | \
+                               USN_FEED_REPARSE_POINT_CHANGE)
+
+#define USN_ATTRIBUTE_REPARSE_POINT  0x00000400U
+
+/* event types */
+#define USN_LINK_ADDED    1
+#define USN_LINK_CHANGED  2
+#define USN_LINK_REMOVED  3
+
+/* chunk types of recorded data */
+#define USN_CHUNK_RECORDS  1  /* raw USN_RECORD_V2/V3 records */
+#define USN_CHUNK_REPARSE  2  /* 16 byte file ID + raw reparse data */
+
+
+/**
+ * Where the raw journal data comes from.
+ *
+ * read() fills 'buf' with complete USN records (without the leading USN
+ * that FSCTL_READ_USN_JOURNAL returns) and returns 1, or 0 at the end of
+ * the journal, or -1 on error.
+ *
+ * get_reparse_data() reads the raw reparse data of the file with the given
+ * 128 bit file ID (64 bit IDs are zero-extended) and returns 1 on success,
+ * 0 if the file is gone and -1 on error. It may be NULL.
+ */
+typedef struct {
+    int (*read)(void *ctx, uint8_t *buf, size_t size, size_t *len);
+    int (*get_reparse_data)(void *ctx, const uint8_t file_id[16],
+                            uint8_t *buf, size_t size, size_t *len);
+    void *ctx;
+} USN_SOURCE;
+
+typedef struct {
+    int             type;          /* USN_LINK_* */
+    uint64_t        usn;
+    int64_t         timestamp;     /* FILETIME value */
+    uint8_t         file_id[16];
+    uint8_t         parent_id[16];
+    uint32_t        reason;        /* USN_FEED_* */
+    uint32_t        attributes;    /* FILE_ATTRIBUTE_* */
+    const uint16_t *name;          /* UTF-16 file name, not NUL-terminated */
+    size_t          name_len;
+    uint32_t        tag;           /* reparse tag, 0 if unknown */
+    const uint8_t  *target;        /* link target, NULL if unknown */
+    size_t          target_len;    /* characters */
+    int             target_utf8;   /* target is UTF-8 instead of UTF-16 */
+} USN_LINK_EVENT;
+
+/* return non-zero to stop */
+typedef int (*USN_EVENT_FUNC)(void *ctx, const USN_LINK_EVENT *ev);
+
+
+/**
+ * Read all records from 'src' and call func() for every link that was
+ * added, changed or removed. Only records with USN_FEED_CLOSE are
+ * used, so each change is reported once. The exception are renames: the
+ * record written at the rename has the old name and reports the link as
+ * removed, the closing record reports it as added under its new name.
+ * Removal records have no reparse tag, so reparse points that are not
+ * links (WOF, cloud files) are left out when their data was seen in the
+ * same run, when the file still has it, or by the attributes of cloud
+ * placeholders; other removed reparse points are reported.
+ * Records of unknown versions are skipped.
+ * If 'record' is not NULL, everything read from 'src' is written into
+ * it so the same run can be replayed later with usn_replay_source().
+ * The USN of the last record is stored in 'last_usn' (may be NULL).
+ *
+ * Returns 0 on success, -1 on read errors or invalid records
+ * and 1 if func() stopped the feed.
+ */
+int usn_feed_run(const USN_SOURCE *src, USN_EVENT_FUNC func, void *ctx,
+                 FILE *record, uint64_t *last_usn);
+
+
+/**
+ * Replay recorded data (a sequence of chunks: uint32 type, uint32 length,
+ * payload; little endian). 'data' must stay valid while the source is used.
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+} USN_REPLAY;
+
+void usn_replay_source(USN_REPLAY *replay, const uint8_t *data, size_t size, USN_SOURCE *src);
+
+
+/* write a chunk of recorded data */
+int usn_write_chunk(FILE *fp, uint32_t type, const uint8_t *prefix, size_t prefix_len,
+                    const uint8_t *data, size_t len);
+
+#endif /* W32_SYMLINK_USN_FEED_H_INCLUDED */
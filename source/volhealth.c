@@ -0,0 +1,256 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "volhealth.h"
+
+
+typedef struct {
+    uint16_t *buf;
+    size_t    size;
+    size_t    len;
+    int       overflow;
+} KEY_BUFFER;
+
+
+static int is_sep(uint16_t c)
+{
+    return (c == '\\' || c == '/');
+}
+
+static int is_alpha(uint16_t c)
+{
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+}
+
+static uint16_t lower(uint16_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? (uint16_t)(c - 'A' + 'a') : c;
+}
+
+static void append(KEY_BUFFER *k, const uint16_t *s, size_t len)
+{
+    size_t i;
+
+    if (k->len + len > k->size) {
+        k->overflow = 1;
+        return;
+    }
+
+    for (i = 0; i < len; i++) {
+        k->buf[k->len++] = lower(s[i]);
+    }
+}
+
+static void append_ascii(KEY_BUFFER *k, const char *s)
+{
+    uint16_t c;
+
+    for ( ; *s; s++) {
+        c = (uint16_t)*s;
+        append(k, &c, 1);
+    }
+}
+
+/* length of the path component at path[off..] */
+static size_t component(const uint16_t *path, size_t len, size_t off)
+{
+    size_t n = 0;
+
+    while (off + n < len && !is_sep(path[off + n])) n++;
+
+    return n;
+}
+
+/* "server\share" at path[off..] */
+static void append_unc(KEY_BUFFER *k, const uint16_t *path, size_t len, size_t off)
+{
+    size_t n;
+
+    n = component(path, len, off);
+
+    if (n == 0) {
+        k->overflow = 1;
+        return;
+    }
+
+    append_ascii(k, "\\\\");
+    append(k, path + off, n);
+    off += n + 1;
+
+    /* a share name is optional */
+    if (off < len && (n = component(path, len, off)) > 0) {
+        append_ascii(k, "\\");
+        append(k, path + off, n);
+    }
+}
+
+static int has_ci(const uint16_t *path, size_t len, size_t off, const char *ascii)
+{
+    size_t i;
+
+    for (i = 0; ascii[i]; i++) {
+        if (off + i >= len || lower(path[off + i]) != lower((uint16_t)ascii[i])) return 0;
+    }
+
+    return 1;
+}
+
+size_t volume_key(const uint16_t *path, size_t len, uint16_t *key, size_t keysize)
+{
+    KEY_BUFFER k;
+    size_t n;
+
+    k.buf = key;
+    k.size = keysize;
+    k.len = 0;
+    k.overflow = 0;
+
+    if (len >= 4 && is_sep(path[0]) && is_sep(path[3]) &&
+        ((is_sep(path[1]) && (path[2] == '?' || path[2] == '.')) ||
+         (path[1] == '?' && path[2] == '?')))
+    {
+        /* "\\?\", "\\.\" or "\??\" */
+        if (len >= 6 && is_alpha(path[4]) && path[5] == ':') {
+            append(&k, path + 4, 2);
+        } else if (has_ci(path, len, 4, "UNC") && len > 7 && is_sep(path[7])) {
+            append_unc(&k, path, len, 8);
+        } else if ((n = component(path, len, 4)) > 0) {
+            append_ascii(&k, "\\\\?\\");
+            append(&k, path + 4, n);
+        } else {
+            return 0;
+        }
+    } else if (len >= 2 && is_alpha(path[0]) && path[1] == ':') {
+        append(&k, path, 2);
+    } else if (len >= 2 && is_sep(path[0]) && is_sep(path[1])) {
+        append_unc(&k, path, len, 2);
+    } else {
+        return 0;
+    }
+
+    return k.overflow ? 0 : k.len;
+}
+
+
+static VOLHEALTH_SLOT *find_slot(VOLHEALTH *h, const uint16_t *key, size_t keylen)
+{
+    size_t i;
+
+    for (i = 0; i < VOLHEALTH_SLOTS; i++) {
+        if (h->slots[i].keylen == keylen &&
+            memcmp(h->slots[i].key, key, keylen * sizeof(uint16_t)) == 0)
+        {
+            return &h->slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* an unused slot or the least recently used one */
+static VOLHEALTH_SLOT *take_slot(VOLHEALTH *h)
+{
+    VOLHEALTH_SLOT *oldest = &h->slots[0];
+    size_t i;
+
+    for (i = 0; i < VOLHEALTH_SLOTS; i++) {
+        if (h->slots[i].keylen == 0) {
+            return &h->slots[i];
+        }
+
+        if (h->slots[i].last_used < oldest->last_used) {
+            oldest = &h->slots[i];
+        }
+    }
+
+    return oldest;
+}
+
+static uint64_t backoff(unsigned strikes)
+{
+    uint64_t ms = VOLHEALTH_BACKOFF_MIN;
+    unsigned i;
+
+    for (i = 1; i < strikes && ms < VOLHEALTH_BACKOFF_MAX; i++) {
+        ms *= 2;
+    }
+
+    return (ms > VOLHEALTH_BACKOFF_MAX) ? VOLHEALTH_BACKOFF_MAX : ms;
+}
+
+uint64_t volhealth_admit(VOLHEALTH *h, const uint16_t *key, size_t keylen, uint64_t now)
+{
+    VOLHEALTH_SLOT *s;
+
+    if (keylen == 0 || (s = find_slot(h, key, keylen)) == NULL) {
+        return 0;
+    }
+
+    s->last_used = now;
+
+    if (now < s->blocked_until) {
+        return s->blocked_until - now;
+    }
+
+    /* let this one probe the volume, hold back the others */
+    s->blocked_until = now + backoff(s->strikes);
+
+    return 0;
+}
+
+void volhealth_report(VOLHEALTH *h, const uint16_t *key, size_t keylen,
+                      uint64_t now, int timed_out)
+{
+    VOLHEALTH_SLOT *s;
+
+    if (keylen == 0 || keylen > VOLHEALTH_KEY_MAX) {
+        return;
+    }
+
+    s = find_slot(h, key, keylen);
+
+    if (!timed_out) {
+        /* the volume answered */
+        if (s) s->keylen = 0;
+        return;
+    }
+
+    if (!s) {
+        s = take_slot(h);
+        memcpy(s->key, key, keylen * sizeof(uint16_t));
+        s->keylen = keylen;
+        s->strikes = 0;
+    }
+
+    if (s->strikes < 32) s->strikes++;
+    s->blocked_until = now + backoff(s->strikes);
+    s->last_used = now;
+}
+
+void volhealth_clear(VOLHEALTH *h)
+{
+    memset(h, 0, sizeof(*h));
+}
@@ -0,0 +1,95 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_VOLHEALTH_H_INCLUDED
+#define W32_SYMLINK_VOLHEALTH_H_INCLUDED
+
+/* This file must not depend on windows.h so it can be built and tested
+ * on other platforms. Times are milliseconds of a monotonic clock. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* volumes tracked at once; the least recently used one is dropped */
+#define VOLHEALTH_SLOTS    64
+
+/* "\\server\share" keys longer than this are not tracked */
+#define VOLHEALTH_KEY_MAX  128
+
+/* a volume is skipped for BACKOFF_MIN ms after its first timeout,
+ * doubling with every further timeout up to BACKOFF_MAX ms */
+#define VOLHEALTH_BACKOFF_MIN   2000
+#define VOLHEALTH_BACKOFF_MAX  60000
+
+
+typedef struct {
+    uint16_t key[VOLHEALTH_KEY_MAX];
+    size_t   keylen;       /* 0 = unused */
+    unsigned strikes;      /* timeouts in a row */
+    uint64_t blocked_until;
+    uint64_t last_used;
+} VOLHEALTH_SLOT;
+
+/* the caller serializes access */
+typedef struct {
+    VOLHEALTH_SLOT slots[VOLHEALTH_SLOTS];
+} VOLHEALTH;
+
+
+/**
+ * Write the volume part of the absolute path 'path' into 'key' in a
+ * normalized form: "c:" for drive letters (also "\\?\C:\..." and
+ * "\??\C:\..."), "\\server\share" for UNC paths (also "\\?\UNC\...")
+ * and "\\?\volume{...}" for volume GUID paths. ASCII letters are
+ * lowercased.
+ *
+ * Returns the length of the key, or 0 if 'path' is relative or the key
+ * does not fit into 'keysize' characters.
+ */
+size_t volume_key(const uint16_t *path, size_t len, uint16_t *key, size_t keysize);
+
+
+/**
+ * Ask whether a query on the volume 'key' may start at 'now'.
+ *
+ * Returns 0 if it may. While the volume is blocked after a timeout the
+ * number of milliseconds left is returned. Once the block has passed a
+ * single caller is let through to probe the volume; the others stay
+ * blocked until it reports back or another backoff period has passed.
+ */
+uint64_t volhealth_admit(VOLHEALTH *h, const uint16_t *key, size_t keylen, uint64_t now);
+
+/**
+ * Report the outcome of a query on the volume 'key'. A timeout blocks
+ * the volume; any answer from it, even an error, clears its record.
+ */
+void volhealth_report(VOLHEALTH *h, const uint16_t *key, size_t keylen,
+                      uint64_t now, int timed_out);
+
+/**
+ * Forget all volumes.
+ */
+void volhealth_clear(VOLHEALTH *h);
+
+#endif /* W32_SYMLINK_VOLHEALTH_H_INCLUDED */
@@ -0,0 +1,40 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_VOLMAP_H_INCLUDED
+#define W32_SYMLINK_VOLMAP_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+
+
+/**
+ * GetFinalPathNameByHandleW() into an allocated string.
+ * For VOLUME_NAME_DOS the NT path is requested instead and its volume
+ * is looked up in the volume cache, which spares the mount manager
+ * query that VOLUME_NAME_DOS does on every call.
+ * Result must be deallocated with free().
+ */
+wchar_t *final_path_by_handle(HANDLE handle, DWORD flags);
+
+#endif /* W32_SYMLINK_VOLMAP_H_INCLUDED */
@@ -0,0 +1,199 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdlib.h>
+#include <string.h>
+#include "walk.h"
+
+
+typedef struct {
+    wchar_t **items;
+    size_t count;
+    size_t capacity;
+} DIR_STACK;
+
+
+static BOOL push_dir(DIR_STACK *stack, wchar_t *path)
+{
+    wchar_t **p;
+    size_t n;
+
+    if (stack->count == stack->capacity) {
+        n = stack->capacity ? stack->capacity * 2 : 64;
+        p = realloc(stack->items, n * sizeof(wchar_t *));
+        if (!p) return FALSE;
+
+        stack->items = p;
+        stack->capacity = n;
+    }
+
+    stack->items[stack->count++] = path;
+
+    return TRUE;
+}
+
+/* join directory and file name; the result must be deallocated with free() */
+static wchar_t *join_path(const wchar_t *dir, size_t dirlen, const wchar_t *name, size_t *plen)
+{
+    size_t namelen = wcslen(name);
+    size_t len = dirlen + 1 + namelen;
+    wchar_t *buf;
+
+    if ((buf = malloc((len + 1) * sizeof(wchar_t))) == NULL) {
+        return NULL;
+    }
+
+    wmemcpy(buf, dir, dirlen);
+
+    if (dirlen > 0 && (dir[dirlen-1] == L'\\' || dir[dirlen-1] == L'/')) {
+        /* root directories like "C:\" already end on a separator */
+        len--;
+    } else {
+        buf[dirlen++] = L'\\';
+    }
+
+    wmemcpy(buf + dirlen, name, namelen + 1);
+    *plen = len;
+
+    return buf;
+}
+
+/* enumerate a single directory; returns -1 on error, 0 on success,
+ * 1 on WALK_STOP and 2 if memory ran out */
+static int walk_dir(const wchar_t *dir, DIR_STACK *stack, WALK_FUNC func, void *ctx)
+{
+    WIN32_FIND_DATAW fd;
+    WALK_ENTRY entry;
+    HANDLE hFind;
+    wchar_t *pattern, *path;
+    size_t dirlen, len;
+    int rv;
+
+    dirlen = wcslen(dir);
+
+    if ((pattern = join_path(dir, dirlen, L"*", &len)) == NULL) {
+        return 2;
+    }
+
+    hFind = FindFirstFileExW(pattern, FindExInfoBasic, &fd,
+                             FindExSearchNameMatch, NULL,
+                             FIND_FIRST_EX_LARGE_FETCH);
+    free(pattern);
+
+    if (hFind == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+
+    do {
+        /* skip "." and ".." */
+        if (fd.cFileName[0] == L'.' &&
+            (fd.cFileName[1] == 0 || (fd.cFileName[1] == L'.' && fd.cFileName[2] == 0)))
+        {
+            continue;
+        }
+
+        if ((path = join_path(dir, dirlen, fd.cFileName, &len)) == NULL) {
+            FindClose(hFind);
+            return 2;
+        }
+
+        entry.path = path;
+        entry.path_len = len;
+        entry.name = path + (len - wcslen(fd.cFileName));
+        entry.attributes = fd.dwFileAttributes;
+        entry.reparse_tag = (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) ? fd.dwReserved0 : 0;
+        entry.size = ((uint64_t)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+        entry.mtime = fd.ftLastWriteTime;
+
+        rv = func(ctx, &entry);
+
+        if (rv == WALK_STOP) {
+            free(path);
+            FindClose(hFind);
+            return 1;
+        }
+
+        /* never descend into reparse points */
+        if (rv == WALK_CONTINUE &&
+            (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) &&
+            !(fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+        {
+            if (push_dir(stack, path)) continue;
+
+            /* don't drop the subtree silently */
+            free(path);
+            FindClose(hFind);
+            return 2;
+        }
+
+        free(path);
+    }
+    while (FindNextFileW(hFind, &fd));
+
+    FindClose(hFind);
+
+    return 0;
+}
+
+BOOL walk_tree(const wchar_t *root, WALK_FUNC func, void *ctx)
+{
+    DIR_STACK stack = { NULL, 0, 0 };
+    wchar_t *dir;
+    BOOL ret = TRUE;
+    int rv;
+
+    if (!root || !*root || !func) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if ((rv = walk_dir(root, &stack, func, ctx)) != 0) {
+        ret = FALSE;
+    }
+
+    while (ret && stack.count > 0) {
+        dir = stack.items[--stack.count];
+        rv = walk_dir(dir, &stack, func, ctx);
+        free(dir);
+
+        if (rv == 1 || rv == 2) {
+            ret = FALSE;
+            break;
+        }
+    }
+
+    if (rv == 2) {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    }
+
+    /* free what's left after an error or WALK_STOP */
+    while (stack.count > 0) {
+        free(stack.items[--stack.count]);
+    }
+
+    free(stack.items);
+
+    return ret;
+}
@@ -0,0 +1,63 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_WALK_H_INCLUDED
+#define W32_SYMLINK_WALK_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include <inttypes.h>
+
+
+/* return values of the walk callback */
+#define WALK_CONTINUE  0  /* go on (and descend into this directory) */
+#define WALK_SKIP      1  /* don't descend into this directory */
+#define WALK_STOP      2  /* stop walking */
+
+
+typedef struct {
+    const wchar_t *path;   /* full path of the entry */
+    size_t path_len;
+    const wchar_t *name;   /* file name part of 'path' */
+    DWORD attributes;      /* FILE_ATTRIBUTE_* */
+    ULONG reparse_tag;     /* 0 if not a reparse point */
+    uint64_t size;
+    FILETIME mtime;
+} WALK_ENTRY;
+
+typedef int (*WALK_FUNC)(void *ctx, const WALK_ENTRY *entry);
+
+
+/**
+ * Enumerate everything below 'root' with one FindFirstFileExW() pass per
+ * directory and call func() for every entry. Reparse points (symbolic
+ * links, junctions, ...) are reported but never followed.
+ * Directories that cannot be opened are silently skipped.
+ *
+ * Returns FALSE if 'root' could not be enumerated, if func() returned
+ * WALK_STOP or with ERROR_NOT_ENOUGH_MEMORY if memory ran out (in which
+ * case parts of the tree may not have been reported).
+ */
+BOOL walk_tree(const wchar_t *root, WALK_FUNC func, void *ctx);
+
+#endif /* W32_SYMLINK_WALK_H_INCLUDED */
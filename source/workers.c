@@ -0,0 +1,113 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <stdlib.h>
+#include "workers.h"
+
+/* number of indices a worker takes at once */
+#define CHUNK_SIZE  64
+
+/* upper limit for WaitForMultipleObjects() */
+#define MAX_THREADS  MAXIMUM_WAIT_OBJECTS
+
+
+typedef struct {
+    volatile LONG64 next;
+    size_t count;
+    WORKER_FUNC func;
+    void *ctx;
+} WORK_QUEUE;
+
+
+static DWORD WINAPI worker_thread(LPVOID param)
+{
+    WORK_QUEUE *q = (WORK_QUEUE *)param;
+    size_t i, start, end;
+
+    for (;;) {
+        start = (size_t)InterlockedExchangeAdd64(&q->next, CHUNK_SIZE);
+        if (start >= q->count) break;
+
+        end = start + CHUNK_SIZE;
+        if (end > q->count) end = q->count;
+
+        for (i = start; i < end; i++) {
+            q->func(q->ctx, i);
+        }
+    }
+
+    return 0;
+}
+
+unsigned int default_thread_count(void)
+{
+    SYSTEM_INFO si;
+
+    GetSystemInfo(&si);
+
+    return (si.dwNumberOfProcessors > 0) ? si.dwNumberOfProcessors : 1;
+}
+
+BOOL parallel_for(size_t count, unsigned int threads, WORKER_FUNC func, void *ctx)
+{
+    HANDLE handles[MAX_THREADS];
+    WORK_QUEUE q;
+    DWORD n, started = 0;
+
+    q.next = 0;
+    q.count = count;
+    q.func = func;
+    q.ctx = ctx;
+
+    if (threads == 0) {
+        threads = default_thread_count();
+    }
+
+    /* no need for more threads than chunks */
+    if (threads > (count + CHUNK_SIZE - 1) / CHUNK_SIZE) {
+        threads = (unsigned int)((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    }
+
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    /* the calling thread counts as one worker */
+    for (n = 1; n < threads; n++) {
+        handles[started] = CreateThread(NULL, 0, worker_thread, &q, 0, NULL);
+        if (handles[started]) started++;
+    }
+
+    worker_thread(&q);
+
+    if (started > 0) {
+        WaitForMultipleObjects(started, handles, TRUE, INFINITE);
+
+        for (n = 0; n < started; n++) {
+            CloseHandle(handles[n]);
+        }
+    }
+
+    return (threads <= 1 || started > 0) ? TRUE : FALSE;
+}
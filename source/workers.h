@@ -0,0 +1,52 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_WORKERS_H_INCLUDED
+#define W32_SYMLINK_WORKERS_H_INCLUDED
+
+#include <windows.h>
+
+
+/**
+ * Callback for parallel_for(). 'index' runs from 0 to count-1.
+ */
+typedef void (*WORKER_FUNC)(void *ctx, size_t index);
+
+
+/**
+ * Call func(ctx, i) for every i in [0, count) using up to 'threads' threads
+ * (0 = number of processors). The calling thread is one of the workers.
+ * Indices are handed out in small chunks, so the order is not defined.
+ *
+ * Returns FALSE if no worker thread could be started; in this case
+ * all work was still done on the calling thread.
+ */
+BOOL parallel_for(size_t count, unsigned int threads, WORKER_FUNC func, void *ctx);
+
+
+/**
+ * Number of threads parallel_for() uses if 'threads' is 0.
+ */
+unsigned int default_thread_count(void);
+
+#endif /* W32_SYMLINK_WORKERS_H_INCLUDED */
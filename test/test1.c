@@ -2,12 +2,21 @@
 #include <wchar.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "w32-symlink.h"
 
 #define TEST(x)  puts((x) ? "success" : "failure")
 
 
+static BOOL count_name(void *ctx, const wchar_t *name)
+{
+    wprintf(L"%s\n", name);
+    (*(size_t *)ctx)++;
+    return TRUE;
+}
+
+
 int main()
 {
     const char *lnk = "link_to_C";
@@ -16,6 +25,9 @@ int main()
     DeleteFileA(lnk);
     RemoveDirectoryA(lnk);
 
+    printf("symlink capabilities: 0x%lx\n", (unsigned long)getSymlinkCapabilities());
+    puts("");
+
     puts("test createLinkA");
     TEST(createLinkA(lnk, "c:/", 'd') == TRUE);
     puts("");
@@ -55,6 +67,205 @@ int main()
     puts("test isSymlinkA");
     tag = 0;
     TEST(isSymlinkA(lnk, (ULONG *)&tag) == TRUE && tag == IO_REPARSE_TAG_SYMLINK);
+    puts("");
+
+    puts("test getCanonicalPathExA (NT)");
+    path = getCanonicalPathExA(lnk, CANONICAL_PATH_NT);
+    TEST(path && strncmp(path, "\\Device\\", 8) == 0);
+
+    if (path) {
+        puts(path);
+        free(path);
+    }
+    puts("");
+
+    puts("test ntIsSymlinkW and ntGetLinkTargetW");
+    wchar_t *ntpath = getNtPathW(L"link_to_C");
+    wpath = NULL;
+    tag = 0;
+    TEST(ntpath && ntIsSymlinkW(ntpath, (ULONG *)&tag) == TRUE && tag == IO_REPARSE_TAG_SYMLINK &&
+         (wpath = ntGetLinkTargetW(ntpath, NULL)) != NULL);
+
+    if (ntpath) {
+        wprintf(L"%s\n", ntpath);
+        free(ntpath);
+    }
+    free(wpath);
+    puts("");
+
+    puts("test mapVolumePathA");
+    path = getCanonicalPathExA(lnk, CANONICAL_PATH_NT);
+    char *mapped = path ? mapVolumePathA(path) : NULL;
+    TEST(mapped && _stricmp(mapped, "C:\\") == 0);
+
+    if (mapped) puts(mapped);
+    free(mapped);
+    free(path);
+
+    puts("test mirrorTreeA");
+    MIRROR_STATS st;
+    CreateDirectoryA("mirror_src", NULL);
+    CreateDirectoryA("mirror_src\\sub", NULL);
+    fclose(fopen("mirror_src\\a.txt", "w"));
+    fclose(fopen("mirror_src\\sub\\b.txt", "w"));
+    TEST(mirrorTreeA("mirror_src", "mirror_dst", MIRROR_RELATIVE, 0, &st) == TRUE &&
+         st.dirs == 2 && st.links == 2 && st.failed == 0);
+
+    path = getLinkTargetA("mirror_dst\\sub\\b.txt", NULL);
+    TEST(path && strcmp(path, "..\\..\\mirror_src\\sub\\b.txt") == 0);
+
+    if (path) {
+        puts(path);
+        free(path);
+    }
+    DeleteFileA("mirror_dst\\sub\\b.txt");
+    DeleteFileA("mirror_dst\\a.txt");
+    RemoveDirectoryA("mirror_dst\\sub");
+    RemoveDirectoryA("mirror_dst");
+    DeleteFileA("mirror_src\\sub\\b.txt");
+    DeleteFileA("mirror_src\\a.txt");
+    RemoveDirectoryA("mirror_src\\sub");
+    RemoveDirectoryA("mirror_src");
+    puts("");
+
+    puts("test dedupTreeA");
+    DEDUP_STATS ds;
+    FILE *fp;
+    CreateDirectoryA("dedup_test", NULL);
+    if ((fp = fopen("dedup_test\\a.txt", "w")) != NULL) { fputs("same content", fp); fclose(fp); }
+    if ((fp = fopen("dedup_test\\b.txt", "w")) != NULL) { fputs("same content", fp); fclose(fp); }
+    if ((fp = fopen("dedup_test\\c.txt", "w")) != NULL) { fputs("other content", fp); fclose(fp); }
+    TEST(dedupTreeA("dedup_test", DEDUP_DRY_RUN, 0, stdout, &ds) == TRUE &&
+         ds.files == 3 && ds.linked == 1 && ds.bytes_saved == 12);
+    TEST(dedupTreeA("dedup_test", 0, 0, stdout, &ds) == TRUE && ds.linked == 1 && ds.failed == 0);
+    TEST(dedupTreeA("dedup_test", 0, 0, NULL, &ds) == TRUE && ds.linked == 0);
+    DeleteFileA("dedup_test\\a.txt");
+    DeleteFileA("dedup_test\\b.txt");
+    DeleteFileA("dedup_test\\c.txt");
+    RemoveDirectoryA("dedup_test");
+    puts("");
+
+    puts("test getHardLinkNamesA");
+    size_t nnames = 0;
+    if ((fp = fopen("hardlink_a.txt", "w")) != NULL) fclose(fp);
+    TEST(createLinkA("hardlink_b.txt", "hardlink_a.txt", 'h') == TRUE &&
+         getHardLinkNamesA("hardlink_a.txt", count_name, &nnames) == TRUE && nnames == 2);
+
+    const char *hl_paths[] = { "hardlink_a.txt", "hardlink_b.txt", "does_not_exist" };
+    HARD_LINK_NAMES *hl = getHardLinkNamesBatchA(hl_paths, 3, 0);
+    TEST(hl && hl->first[1] - hl->first[0] == 2 && hl->first[2] - hl->first[1] == 2 &&
+         (hl->names[0] == hl->names[2] || hl->names[0] == hl->names[3]) &&
+         hl->error[0] == 0 && hl->error[2] != 0);
+
+
+    puts("test getFileIdentityA and equivalent");
+    FILE_IDENTITY id1, id2;
+    struct _stat64 st1, st2;
+    TEST(getFileIdentityA("hardlink_a.txt", TRUE, &id1) == TRUE &&
+         getFileIdentityA("hardlink_b.txt", TRUE, &id2) == TRUE &&
+         memcmp(&id1, &id2, sizeof(id1)) == 0);
+    TEST(equivalent("hardlink_a.txt", ".\\hardlink_b.txt") == 1 &&
+         equivalent("hardlink_a.txt", lnk) == 0 &&
+         equivalent("hardlink_a.txt", "does_not_exist") == -1);
+    TEST(_lstat64("hardlink_a.txt", &st1) == 0 && _lstat64("hardlink_b.txt", &st2) == 0 &&
+         st1.st_ino == st2.st_ino && st1.st_dev == st2.st_dev);
+    freeHardLinkNames(hl);
+    DeleteFileA("hardlink_a.txt");
+    DeleteFileA("hardlink_b.txt");
+    puts("");
+
+    puts("test _lstat64 (no link)");
+    if ((fp = fopen("lstat_test.exe", "w")) != NULL) fclose(fp);
+    CreateDirectoryA("lstat_test_dir", NULL);
+    TEST(_lstat64("lstat_test.exe", &st1) == 0 && (st1.st_mode & _S_IFMT) == _S_IFREG &&
+         (st1.st_mode & _S_IEXEC) != 0);
+    TEST(_lstat64("lstat_test_dir", &st1) == 0 && _stat64("lstat_test_dir", &st2) == 0 &&
+         (st1.st_mode & _S_IFMT) == _S_IFDIR && st1.st_mode == st2.st_mode &&
+         st1.st_dev == st2.st_dev);
+    DeleteFileA("lstat_test.exe");
+    RemoveDirectoryA("lstat_test_dir");
+    puts("");
+
+    puts("test diskUsageA");
+    char data[100] = { 0 };
+    CreateDirectoryA("du_test", NULL);
+    CreateDirectoryA("du_test\\sub", NULL);
+    if ((fp = fopen("du_test\\a.bin", "wb")) != NULL) { fwrite(data, 1, sizeof(data), fp); fclose(fp); }
+    createLinkA("du_test\\sub\\b.bin", "du_test\\a.bin", 'h');
+    DISK_USAGE *du = diskUsageA("du_test", 0);
+    TEST(du && du->count == 2 && du->dirs[0].files == 1 && du->dirs[0].apparent == 100 &&
+         du->dirs[1].files == 0 && du->hardlinks == 1 && du->failed == 0);
+
+    freeDiskUsage(du);
+    DeleteFileA("du_test\\sub\\b.bin");
+    DeleteFileA("du_test\\a.bin");
+    RemoveDirectoryA("du_test\\sub");
+    RemoveDirectoryA("du_test");
+    puts("");
+
+    puts("test analyzeLinkGraphA");
+    LINK_GRAPH_STATS gs;
+    CreateDirectoryA("graph_test", NULL);
+    createLinkA("graph_test\\a", "b", 'f');
+    createLinkA("graph_test\\b", "a", 'f');
+    /* relative root with forward slashes */
+    TEST(analyzeLinkGraphA("./graph_test/", 0, stdout, &gs) == TRUE &&
+         gs.links == 2 && gs.cycles == 1 && gs.in_cycle == 2);
+    DeleteFileA("graph_test\\a");
+    DeleteFileA("graph_test\\b");
+
+    /* a missing file below a directory link */
+    createLinkA("graph_test\\dir", "C:\\Windows", 'd');
+    createLinkA("graph_test\\m", "dir\\does_not_exist", 'f');
+    TEST(analyzeLinkGraphA("graph_test", 0, stdout, &gs) == TRUE &&
+         gs.links == 2 && gs.dangling == 1 && gs.cycles == 0);
+    DeleteFileA("graph_test\\m");
+    RemoveDirectoryA("graph_test\\dir");
+    RemoveDirectoryA("graph_test");
+    puts("");
+
+    puts("test symlink_replace");
+    path = NULL;
+    TEST(symlink_replace("C:\\Windows", lnk) == 0 &&
+         (path = getLinkTargetA(lnk, NULL)) != NULL && _stricmp(path, "C:\\Windows") == 0);
+    free(path);
+
+    path = NULL;
+    if ((fp = fopen("replace_a.txt", "w")) != NULL) fclose(fp);
+    if ((fp = fopen("replace_b.txt", "w")) != NULL) fclose(fp);
+    TEST(symlink_replace("replace_a.txt", "replace_link") == 0 &&
+         symlink_replace("replace_b.txt", "replace_link") == 0 &&
+         (path = getLinkTargetA("replace_link", NULL)) != NULL && strcmp(path, "replace_b.txt") == 0);
+    free(path);
+    DeleteFileA("replace_link");
+    DeleteFileA("replace_a.txt");
+    DeleteFileA("replace_b.txt");
+    puts("");
+
+    puts("test retargetLinksA");
+    RETARGET_STATS rs;
+    path = NULL;
+    CreateDirectoryA("retarget_test", NULL);
+    createLinkA("retarget_test\\sys", "C:\\Windows\\System32", 'd');
+    createLinkA("retarget_test\\rel", "..\\Windows", 'd');
+    TEST(retargetLinksA("retarget_test", "c:\\windows", "C:\\WinNT", RETARGET_DRY_RUN, 0, stdout, &rs) == TRUE &&
+         rs.links == 2 && rs.matched == 1 && rs.rewritten == 0);
+    TEST(retargetLinksA("retarget_test", "c:\\windows", "C:\\WinNT", 0, 0, stdout, &rs) == TRUE &&
+         rs.matched == 1 && rs.rewritten == 1 && rs.failed == 0 &&
+         (path = getLinkTargetA("retarget_test\\sys", NULL)) != NULL &&
+         strcmp(path, "C:\\WinNT\\System32") == 0);
+    free(path);
+    RemoveDirectoryA("retarget_test\\sys");
+    RemoveDirectoryA("retarget_test\\rel");
+    RemoveDirectoryA("retarget_test");
+    puts("");
+
+    puts("test getLinkTargetTimeoutA");
+    path = NULL;
+    TEST(isSymlinkTimeoutA(lnk, NULL, INFINITE) == TRUE);
+    TEST((path = getLinkTargetTimeoutA(lnk, NULL, 5000)) != NULL && _stricmp(path, "C:\\Windows") == 0);
+    free(path);
+    TEST(_lstat64_timeout(lnk, &st1, 5000) == 0);
 
     return 0;
 }
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "toolio.h"
+
+/* This test doesn't need Windows: only the input splitting and
+ * output encoding of the command-line tools are tested. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+
+static int buf_is(const OUTBUF *b, const char *expected, size_t len)
+{
+    return b->len == len && memcmp(b->data, expected, len) == 0;
+}
+
+
+int main()
+{
+    TOOL_INPUT recs[8];
+    OUTBUF b = { NULL, 0, 0, 0 };
+    TOOL_STAT st;
+    size_t n, used;
+    char buf[64];
+
+    puts("test split_records (newlines)");
+    strcpy(buf, "a\r\n\nbc\nde");
+    n = split_records(buf, 9, '\n', 0, recs, 8, &used);
+    TEST(n == 2 && strcmp(recs[0].str, "a") == 0 && recs[0].len == 1 &&
+         strcmp(recs[1].str, "bc") == 0 && used == 7);
+    n = split_records(buf + used, 9 - used, '\n', 1, recs, 8, &used);
+    TEST(n == 1 && strcmp(recs[0].str, "de") == 0 && used == 2);
+    puts("");
+
+    puts("test split_records (NUL, limit)");
+    memcpy(buf, "x\0y\0\0z\0", 7);
+    n = split_records(buf, 7, '\0', 0, recs, 2, &used);
+    TEST(n == 2 && strcmp(recs[1].str, "y") == 0 && used == 4);
+    n = split_records(buf + used, 7 - used, '\0', 0, recs, 2, &used);
+    TEST(n == 1 && strcmp(recs[0].str, "z") == 0 && used == 3);
+    puts("");
+
+    puts("test outbuf_json");
+    outbuf_json(&b, "C:\\a \"b\"\n\x01", 10);
+    TEST(buf_is(&b, "\"C:\\\\a \\\"b\\\"\\n\\u0001\"", 21));
+    b.len = 0;
+    outbuf_json(&b, "\xc3\xa4", 2);
+    TEST(buf_is(&b, "\"\xc3\xa4\"", 4));
+    puts("");
+
+    puts("test outbuf_u64 and outbuf_i64");
+    b.len = 0;
+    outbuf_u64(&b, 0);
+    outbuf_puts(&b, " ");
+    outbuf_u64(&b, UINT64_MAX);
+    outbuf_puts(&b, " ");
+    outbuf_i64(&b, INT64_MIN);
+    TEST(buf_is(&b, "0 18446744073709551615 -9223372036854775808", 43));
+    puts("");
+
+    puts("test outbuf_record and outbuf_stat");
+    b.len = 0;
+    outbuf_record(&b, 0x0102030405060708ULL, 5, 0xA000000C, 3);
+    TEST(b.len == TOOL_RECORD_SIZE && (uint8_t)b.data[0] == 8 && (uint8_t)b.data[7] == 1 &&
+         (uint8_t)b.data[8] == 5 && (uint8_t)b.data[15] == 0xA0 && (uint8_t)b.data[16] == 3 &&
+         b.data[20] == 0);
+    b.len = 0;
+    memset(&st, 0, sizeof(st));
+    st.mtime = -1;
+    st.mode = 0xA1FF;
+    outbuf_stat(&b, &st);
+    TEST(b.len == TOOL_STAT_SIZE && (uint8_t)b.data[8] == 0xFF && (uint8_t)b.data[15] == 0xFF &&
+         (uint8_t)b.data[32] == 0xFF && (uint8_t)b.data[33] == 0xA1);
+    TEST(!b.nomem);
+    outbuf_free(&b);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "resolver_core.h"
+
+/* This test doesn't need Windows: the wire format, the cache and the
+ * request queue of the resolver service. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+
+static int cache_has(RSV_CACHE *c, const char *key, uint64_t now, const char *expected)
+{
+    const uint8_t *val;
+    size_t len = 0;
+
+    val = rsv_cache_get(c, (const uint8_t *)key, strlen(key), now, &len);
+
+    if (!expected) {
+        return val == NULL;
+    }
+
+    return val && len == strlen(expected) && memcmp(val, expected, len) == 0;
+}
+
+static void cache_put(RSV_CACHE *c, const char *key, const char *val, uint64_t now)
+{
+    rsv_cache_put(c, (const uint8_t *)key, strlen(key), (const uint8_t *)val, strlen(val), now);
+}
+
+
+int main()
+{
+    uint8_t hdr[RSV_RESPONSE_HEADER];
+    RSV_REQUEST req;
+    RSV_RESPONSE res;
+    RSV_CACHE c;
+    RSV_QUEUE q;
+    RSV_JOB jobs[40];
+    RSV_JOB *job;
+    int i, bulk, interactive;
+
+    puts("test request header");
+    rsv_put_request(hdr, 0x01020304, RSV_OP_REALPATH, RSV_FLAG_BULK, 5);
+    TEST(hdr[0] == 17 && hdr[4] == 4 && hdr[7] == 1);
+    TEST(rsv_get_request(hdr, &req) == 0 && req.length == 17 && req.id == 0x01020304 &&
+         req.op == RSV_OP_REALPATH && req.flags == RSV_FLAG_BULK);
+    hdr[8] = RSV_OP_MAX + 1;
+    TEST(rsv_get_request(hdr, &req) == -1);
+    rsv_put_request(hdr, 1, RSV_OP_LSTAT, 0, 0);
+    TEST(rsv_get_request(hdr, &req) == -1);
+    rsv_put_request(hdr, 1, RSV_OP_LSTAT, 0, RSV_MAX_FRAME);
+    TEST(rsv_get_request(hdr, &req) == -1);
+    puts("");
+
+    puts("test response header");
+    rsv_put_response(hdr, 7, -1, 2, 0xA000000C, 0);
+    TEST(rsv_get_response(hdr, &res) == 0 && res.length == RSV_RESPONSE_HEADER &&
+         res.id == 7 && res.result == -1 && res.error == 2 && res.tag == 0xA000000C);
+    rsv_put_le(hdr, 3, 4);
+    TEST(rsv_get_response(hdr, &res) == -1);
+    rsv_put_le(hdr, 0x8000000000000001ULL, 8);
+    TEST(rsv_get_le(hdr, 8) == 0x8000000000000001ULL && rsv_get_le(hdr, 4) == 1);
+    puts("");
+
+    puts("test cache (hits and expiry)");
+    TEST(rsv_cache_init(&c, 2, 100) == 0);
+    cache_put(&c, "\1/a", "x", 1000);
+    TEST(cache_has(&c, "\1/a", 1050, "x"));
+    TEST(cache_has(&c, "\2/a", 1050, NULL));
+    TEST(cache_has(&c, "\1/a", 1100, NULL) && c.count == 0);
+    TEST(c.hits == 1 && c.misses == 2);
+    puts("");
+
+    puts("test cache (least recently used)");
+    cache_put(&c, "a", "1", 0);
+    cache_put(&c, "b", "2", 0);
+    TEST(cache_has(&c, "a", 1, "1"));
+    cache_put(&c, "c", "3", 2);
+    TEST(cache_has(&c, "b", 3, NULL));
+    TEST(cache_has(&c, "a", 3, "1") && cache_has(&c, "c", 3, "3"));
+    cache_put(&c, "c", "new", 4);
+    TEST(cache_has(&c, "c", 5, "new") && c.count == 2);
+    rsv_cache_clear(&c);
+    TEST(c.count == 0 && cache_has(&c, "a", 5, NULL));
+    rsv_cache_free(&c);
+
+    /* max = 0 caches nothing */
+    TEST(rsv_cache_init(&c, 0, 100) == 0);
+    cache_put(&c, "a", "1", 0);
+    TEST(cache_has(&c, "a", 1, NULL));
+    rsv_cache_free(&c);
+    puts("");
+
+    puts("test queue (interactive first)");
+    memset(&q, 0, sizeof(q));
+    TEST(rsv_queue_pop(&q) == NULL);
+    for (i = 0; i < 40; i++) {
+        jobs[i].bulk = (i < 4);
+        rsv_queue_push(&q, &jobs[i]);
+    }
+    TEST(rsv_queue_pop(&q) == &jobs[4]);
+    puts("");
+
+    puts("test queue (bulk is not starved)");
+    /* one interactive job was taken above */
+    bulk = interactive = 0;
+    for (i = 0; i < RSV_INTERACTIVE_BURST && (job = rsv_queue_pop(&q)) != NULL; i++) {
+        if (job->bulk) bulk++; else interactive++;
+    }
+    TEST(bulk == 1 && interactive == RSV_INTERACTIVE_BURST - 1 && job == &jobs[0]);
+    TEST(rsv_queue_pop(&q) == &jobs[4 + RSV_INTERACTIVE_BURST]);
+    for (i = 0; (job = rsv_queue_pop(&q)) != NULL; i++) {}
+    TEST(i == 40 - RSV_INTERACTIVE_BURST - 2);
+    puts("");
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,286 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* mkdtemp() */
+#endif
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "w32-symlink.h"
+
+/* This test runs the resolver service over a Unix socket against a
+ * stand-in backend: paths ending in "fake-link" are links, paths ending
+ * in "missing" don't exist and canonical paths get a "/real" prefix. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+static unsigned long calls = 0;
+
+
+static int ends_with(const char *path, const char *suffix)
+{
+    size_t n = strlen(path), k = strlen(suffix);
+
+    return n >= k && strcmp(path + n - k, suffix) == 0;
+}
+
+static int fake_is_symlink(void *ctx, const char *path, ULONG *pReparseTag)
+{
+    (void)ctx;
+    __atomic_fetch_add(&calls, 1, __ATOMIC_SEQ_CST);
+
+    if (ends_with(path, "missing")) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    *pReparseTag = ends_with(path, "fake-link") ? IO_REPARSE_TAG_SYMLINK : 0;
+
+    return ends_with(path, "fake-link");
+}
+
+static char *fake_get_link_target(void *ctx, const char *path, ULONG *pReparseTag)
+{
+    (void)ctx;
+    __atomic_fetch_add(&calls, 1, __ATOMIC_SEQ_CST);
+
+    if (!ends_with(path, "fake-link")) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    *pReparseTag = IO_REPARSE_TAG_SYMLINK;
+
+    return strdup("target");
+}
+
+static char *fake_get_canonical_path(void *ctx, const char *path)
+{
+    char *real;
+
+    (void)ctx;
+    __atomic_fetch_add(&calls, 1, __ATOMIC_SEQ_CST);
+
+    if ((real = malloc(strlen(path) + 6)) != NULL) {
+        strcpy(real, "/real");
+        strcat(real, path);
+    }
+
+    return real;
+}
+
+static int fake_lstat(void *ctx, const char *path, RESOLVER_STAT *st)
+{
+    (void)ctx;
+    __atomic_fetch_add(&calls, 1, __ATOMIC_SEQ_CST);
+
+    memset(st, 0, sizeof(*st));
+    st->size = strlen(path);
+    st->mtime = -1;
+    st->ino = 0x123456789ULL;
+    st->mode = 0100644;
+    st->nlink = 1;
+
+    return 0;
+}
+
+static const RESOLVER_BACKEND fake = {
+    fake_is_symlink, fake_get_link_target, fake_get_canonical_path, fake_lstat, NULL
+};
+
+static unsigned long call_count(void)
+{
+    return __atomic_load_n(&calls, __ATOMIC_SEQ_CST);
+}
+
+/* query 'path' from another process; returns its exit code */
+static int child_query(const char *sock, DWORD flags, const char *path)
+{
+    ULONG tag = 0;
+    pid_t pid;
+    int status;
+
+    if ((pid = fork()) == 0) {
+        _exit(resolverConnect(sock, flags) && resolverIsSymlinkA(path, &tag) == 1 &&
+              tag == IO_REPARSE_TAG_SYMLINK ? 0 : 1);
+    }
+
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+
+    return WEXITSTATUS(status);
+}
+
+/* a batch of queries answered on the connection shared with other threads */
+static void *thread_queries(void *arg)
+{
+    RESOLVER_QUERY q[200];
+    char paths[200][32];
+    long n = (long)arg;
+    int i, ok = 1;
+
+    for (i = 0; i < 200; i++) {
+        snprintf(paths[i], sizeof(paths[i]), "/t%ld/%d/fake-link", n, i);
+        memset(&q[i], 0, sizeof(q[i]));
+        q[i].op = (i % 2) ? RESOLVER_READLINK : RESOLVER_REALPATH;
+        q[i].path = paths[i];
+    }
+
+    if (resolverQuery(q, 200) != TRUE) return NULL;
+
+    for (i = 0; i < 200; i++) {
+        if (q[i].op == RESOLVER_READLINK) {
+            ok = ok && q[i].result == 0 && strcmp(q[i].value, "target") == 0;
+        } else {
+            ok = ok && q[i].result == 0 && strncmp(q[i].value, "/real", 5) == 0 &&
+                 strcmp(q[i].value + 5, paths[i]) == 0;
+        }
+        free(q[i].value);
+    }
+
+    return ok ? arg : NULL;
+}
+
+
+int main()
+{
+    char dir[] = "/tmp/w32-symlink-XXXXXX";
+    char sock[64], lnk[64], file[64], buf[256];
+    RESOLVER_QUERY queries[300];
+    RESOLVER_SERVER *server;
+    RESOLVER_STAT st;
+    pthread_t threads[4];
+    void *res;
+    struct stat sb;
+    unsigned long before;
+    ULONG tag = 0;
+    char *path;
+    int i, ok;
+    FILE *fp;
+
+    if (!mkdtemp(dir)) return 1;
+
+    snprintf(sock, sizeof(sock), "%s/sock", dir);
+    snprintf(file, sizeof(file), "%s/file", dir);
+    snprintf(lnk, sizeof(lnk), "%s/link", dir);
+
+    if ((fp = fopen(file, "w")) != NULL) fclose(fp);
+    if (symlink("file", lnk) != 0) return 1;
+
+    puts("test resolverStart");
+    TEST((server = resolverStart(sock, &fake, 4, 60000)) != NULL);
+    TEST(resolverStart(sock, &fake, 1, 0) == NULL && errno == EADDRINUSE);
+    TEST(stat(sock, &sb) == 0 && (sb.st_mode & 077) == 0);
+    puts("");
+
+    puts("test local queries without a connection");
+    TEST(resolverIsSymlinkA(lnk, &tag) == 1 && tag == IO_REPARSE_TAG_SYMLINK);
+    TEST(resolverIsSymlinkA("/x/fake-link", NULL) == -1);
+    TEST(call_count() == 0);
+    puts("");
+
+    puts("test single queries");
+    TEST(resolverConnect(sock, 0) == TRUE);
+    tag = 0;
+    TEST(resolverIsSymlinkA("/x/fake-link", &tag) == 1 && tag == IO_REPARSE_TAG_SYMLINK);
+    TEST(resolverIsSymlinkA(lnk, NULL) == 0);
+    TEST(resolverIsSymlinkA("/x/missing", NULL) == -1 && errno == ENOENT);
+    path = resolverGetLinkTargetA("/x/fake-link", &tag);
+    TEST(path && strcmp(path, "target") == 0);
+    free(path);
+    TEST(resolverGetLinkTargetA("/x/file", NULL) == NULL && errno == EINVAL);
+    TEST(resolverLstatA("/x/file", &st) == 0 && st.size == 7 && st.mtime == -1 &&
+         st.ino == 0x123456789ULL && st.mode == 0100644 && st.nlink == 1);
+    TEST(resolver_readlink_s("/x/fake-link", buf, sizeof(buf)) == buf && strcmp(buf, "target") == 0);
+    TEST(resolver_readlink_s("/x/fake-link", buf, 3) == NULL && errno == ENOMEM);
+    puts("");
+
+    puts("test relative paths");
+    if (chdir(dir) != 0) return 1;
+    path = resolverGetCanonicalPathA("sub/name");
+    snprintf(buf, sizeof(buf), "/real%s/sub/name", dir);
+    TEST(path && strcmp(path, buf) == 0);
+    free(path);
+    TEST(resolver_realpath_s("/a", buf, sizeof(buf)) == buf && strcmp(buf, "/real/a") == 0);
+    puts("");
+
+    puts("test cached results");
+    before = call_count();
+    TEST(resolverIsSymlinkA("/x/fake-link", NULL) == 1);
+    TEST(resolverIsSymlinkA("/x/missing", NULL) == -1 && errno == ENOENT);
+    TEST(call_count() == before);
+    puts("");
+
+    puts("test resolverQuery");
+    for (i = 0; i < 300; i++) {
+        memset(&queries[i], 0, sizeof(queries[i]));
+        queries[i].op = RESOLVER_ISSYMLINK + i % 4;
+        queries[i].path = (i % 2) ? "/batch/fake-link" : "/batch/other";
+    }
+    queries[299].path = "";
+    TEST(resolverQuery(queries, 299) == TRUE);
+    ok = 1;
+    for (i = 0; i < 299; i++) {
+        switch (queries[i].op)
+        {
+        case RESOLVER_ISSYMLINK:
+            ok = ok && queries[i].result == 0 && queries[i].tag == 0;
+            break;
+        case RESOLVER_READLINK:
+            ok = ok && queries[i].result == 0 && strcmp(queries[i].value, "target") == 0;
+            break;
+        case RESOLVER_REALPATH:
+            ok = ok && queries[i].result == 0 && strcmp(queries[i].value, "/real/batch/other") == 0;
+            break;
+        case RESOLVER_LSTAT:
+            ok = ok && queries[i].result == 0 && queries[i].st.size == 16;
+            break;
+        }
+        free(queries[i].value);
+    }
+    TEST(ok);
+    TEST(strcmp(queries[1].path, "/batch/fake-link") == 0);
+    TEST(resolverQuery(queries + 299, 1) == FALSE && errno == EINVAL);
+    puts("");
+
+    puts("test concurrent queries on one connection");
+    ok = 1;
+    for (i = 0; i < 4; i++) {
+        ok = ok && pthread_create(&threads[i], NULL, thread_queries, (void *)(long)(i + 1)) == 0;
+    }
+    for (i = 0; i < 4; i++) {
+        ok = ok && pthread_join(threads[i], &res) == 0 && res == (void *)(long)(i + 1);
+    }
+    TEST(ok);
+    puts("");
+
+    puts("test the cache is shared between clients");
+    before = call_count();
+    TEST(child_query(sock, 0, "/x/fake-link") == 0);
+    TEST(child_query(sock, RESOLVER_BULK, "/x/fake-link") == 0);
+    TEST(call_count() == before);
+    resolverFlush(server);
+    TEST(child_query(sock, RESOLVER_BULK, "/x/fake-link") == 0);
+    TEST(call_count() == before + 1);
+    puts("");
+
+    puts("test fallback after the service stopped");
+    resolverStop(server);
+    TEST(resolverIsSymlinkA(lnk, &tag) == 1 && tag == IO_REPARSE_TAG_SYMLINK);
+    TEST(resolverIsSymlinkA("/x/fake-link", NULL) == -1);
+    TEST(resolverConnect(sock, 0) == FALSE);
+    resolverDisconnect();
+    puts("");
+
+    unlink(lnk);
+    unlink(file);
+    rmdir(dir);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ntname.h"
+
+/* This test doesn't need Windows: NT names built from path slices. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+
+static size_t to_utf16(const char *s, uint16_t *buf)
+{
+    size_t i;
+
+    for (i = 0; s[i]; i++) {
+        buf[i] = (uint16_t)s[i];
+    }
+
+    return i;
+}
+
+/* nt_name() of the first 'len' characters of 'path' is 'expected'
+ * (NULL = no NT name) */
+static int name_is(const char *path, size_t len, const char *expected)
+{
+    uint16_t p[256], buf[256 + NT_NAME_EXTRA], e[256];
+    const uint16_t *name;
+    size_t n;
+
+    to_utf16(path, p);
+    n = nt_name(p, len, buf, &name);
+
+    if (!expected) {
+        return n == 0;
+    }
+
+    return n == to_utf16(expected, e) && memcmp(name, e, n * sizeof(uint16_t)) == 0;
+}
+
+#define NAME_IS(path, expected)  name_is(path, strlen(path), expected)
+
+
+int main()
+{
+    uint16_t p[64], buf[64 + NT_NAME_EXTRA];
+    const uint16_t *name = NULL;
+    size_t len;
+
+    puts("test nt_name (drive letters)");
+    TEST(NAME_IS("C:\\", "\\??\\C:\\"));
+    TEST(NAME_IS("C:\\Windows\\System32", "\\??\\C:\\Windows\\System32"));
+    TEST(NAME_IS("z:/dir/file.txt", "\\??\\z:\\dir\\file.txt"));
+    TEST(NAME_IS("C:\\dir\\file:stream", "\\??\\C:\\dir\\file:stream"));
+    puts("");
+
+    puts("test nt_name (UNC)");
+    TEST(NAME_IS("\\\\server\\share", "\\??\\UNC\\server\\share"));
+    TEST(NAME_IS("//server/share/dir", "\\??\\UNC\\server\\share\\dir"));
+    TEST(NAME_IS("\\\\server", NULL));
+    puts("");
+
+    puts("test nt_name (NT and verbatim paths)");
+    len = to_utf16("\\??\\C:\\dir", p);
+    TEST(nt_name(p, len, buf, &name) == len && name == p);
+    TEST(NAME_IS("\\\\?\\C:\\a\\..\\b.", "\\??\\C:\\a\\..\\b."));
+    TEST(NAME_IS("\\\\?\\UNC\\server\\share", "\\??\\UNC\\server\\share"));
+    TEST(NAME_IS("\\\\.\\C:\\dir", NULL));
+    puts("");
+
+    puts("test nt_name (Win32 rules)");
+    TEST(NAME_IS("relative\\path", NULL));
+    TEST(NAME_IS("\\rooted", NULL));
+    TEST(NAME_IS("C:drive-relative", NULL));
+    TEST(NAME_IS("C:\\a\\.\\b", NULL));
+    TEST(NAME_IS("C:\\a\\..\\b", NULL));
+    TEST(NAME_IS("C:\\a\\\\b", NULL));
+    TEST(NAME_IS("C:\\dir\\", NULL));
+    TEST(NAME_IS("C:\\file.", NULL));
+    TEST(NAME_IS("C:\\file ", NULL));
+    TEST(NAME_IS("C:\\dir\\nul", NULL));
+    TEST(NAME_IS("C:\\dir\\Com1.txt", NULL));
+    TEST(NAME_IS("C:\\dir\\CON .log", NULL));
+    TEST(NAME_IS("C:\\nul\\file", "\\??\\C:\\nul\\file"));
+    TEST(NAME_IS("C:\\dir\\COM10", "\\??\\C:\\dir\\COM10"));
+    TEST(NAME_IS("C:\\dir\\console", "\\??\\C:\\dir\\console"));
+    TEST(NAME_IS("", NULL));
+    puts("");
+
+    puts("test nt_name (slices)");
+    TEST(name_is("C:\\dir\\file;C:\\other", 11, "\\??\\C:\\dir\\file"));
+    TEST(name_is("\\??\\C:\\a|b", 8, "\\??\\C:\\a"));
+    len = to_utf16("C:\\a", p);
+    p[3] = 0;
+    TEST(nt_name(p, len, buf, &name) == 0);
+    puts("");
+
+    return failed ? 1 : 0;
+}
@@ -7,6 +7,7 @@
 #include <sys/types.h>
 #include <limits.h>
 #include <time.h>
+#include <errno.h>
 
 #include "w32-symlink.h"
 
@@ -57,6 +58,17 @@ int main()
     }
     puts("");
 
+    puts("test getLinkTargetViewA()");
+    static uint8_t rbuf[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    LINK_TARGET_VIEW view = {0};
+    TEST(getLinkTargetViewA(lnk, rbuf, sizeof(rbuf), &view) &&
+         view.tag == IO_REPARSE_TAG_SYMLINK && !view.utf8 && view.norm_len > 0);
+
+    if (view.norm_len > 0) {
+        wprintf(L"%.*s\n", (int)view.norm_len, (const wchar_t *)LINK_VIEW_STRING(rbuf, view.norm_off));
+    }
+    puts("");
+
     wprintf(L"test _wreadlink_s [%s]\n", wlnk);
     wchar_t *wpath = _wreadlink_s(wlnk, NULL, 0);
 
@@ -78,6 +90,51 @@ int main()
     }
     puts("");
 
+    puts("test lstatx()");
+    struct lstatx stx;
+    TEST((rv = lstatx(lnk, LSTATX_TYPE | LSTATX_MTIME | LSTATX_INO, &stx)) == 0 &&
+         (stx.stx_mode & _S_IFMT) == _S_IFLNK &&
+         stx.stx_reparse_tag == IO_REPARSE_TAG_SYMLINK);
+
+    if (rv == 0) {
+        printf("stx_mtime = %jd.%07u\n", (intmax_t)stx.stx_mtime.tv_sec,
+               stx.stx_mtime.tv_nsec / 100);
+    }
+    puts("");
+
+    puts("test readlinkat() and fstatat64()");
+    char linkbuf[PATH_MAX];
+    struct _stat64 st64;
+    HANDLE dir = CreateFileA(".", FILE_TRAVERSE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                             OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    TEST(dir != INVALID_HANDLE_VALUE &&
+         readlinkat(dir, lnk, linkbuf, sizeof(linkbuf)) > 0 &&
+         fstatat64(dir, lnk, &st64, AT_SYMLINK_NOFOLLOW) == 0 &&
+         fstatat64(AT_FDCWD, ntdll, &st64, 0) == 0);
+    puts("");
+
+    puts("test linkat()");
+    FILE *fp;
+    struct _stat64 st64b;
+    DeleteFileA("linkat_a.txt");
+    DeleteFileA("linkat_b.txt");
+    if ((fp = fopen("linkat_a.txt", "w")) != NULL) fclose(fp);
+    TEST(linkat(dir, "linkat_a.txt", AT_FDCWD, "linkat_b.txt", 0) == 0 &&
+         _lstat64("linkat_a.txt", &st64) == 0 && _lstat64("linkat_b.txt", &st64b) == 0 &&
+         st64.st_ino == st64b.st_ino);
+    TEST(linkat(AT_FDCWD, "linkat_a.txt", dir, "linkat_b.txt", 0) == -1 && errno == EEXIST);
+    CloseHandle(dir);
+    DeleteFileA("linkat_a.txt");
+    DeleteFileA("linkat_b.txt");
+    puts("");
+
+    puts("test linkFilterIsSymlinkA()");
+    LINK_FILTER *filter = linkFilterBuildA(".");
+    TEST(filter && linkFilterIsSymlinkA(filter, lnk, NULL) == TRUE &&
+         linkFilterRefresh(filter) && linkFilterIsSymlinkA(filter, lnk2, NULL) == TRUE);
+    linkFilterFree(filter);
+    puts("");
+
     puts("test _stat()");
     TEST((rv = _stat(lnk, &st)) == 0);
 
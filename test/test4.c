@@ -0,0 +1,274 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "usn_feed.h"
+
+/* This test doesn't need Windows: the journal is replayed from recorded data. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+#define TAG_SYMLINK      0xA000000CU
+#define TAG_MOUNT_POINT  0xA0000003U
+#define TAG_CLOUD        0x9000001AU
+
+
+typedef struct {
+    uint8_t data[4096];
+    size_t len;
+} BUFFER;
+
+typedef struct {
+    int count;
+    int types[8];
+    uint32_t tags[8];
+    char targets[8][64];
+} RESULT;
+
+
+static void put(BUFFER *b, uint64_t v, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        b->data[b->len++] = (uint8_t)(v >> (8*i));
+    }
+}
+
+static void put_utf16(BUFFER *b, const char *s)
+{
+    while (*s) put(b, (uint8_t)*s++, 2);
+}
+
+/* USN_RECORD_V2 */
+static void put_record(BUFFER *b, uint64_t id, uint64_t usn, uint32_t reason,
+                       uint32_t attr, const char *name)
+{
+    size_t namelen = strlen(name) * 2;
+    size_t reclen = (60 + namelen + 7) & ~(size_t)7;
+    size_t start = b->len;
+
+    put(b, reclen, 4);
+    put(b, 2, 2);       /* major */
+    put(b, 0, 2);       /* minor */
+    put(b, id, 8);
+    put(b, 5, 8);       /* parent */
+    put(b, usn, 8);
+    put(b, 0, 8);       /* timestamp */
+    put(b, reason, 4);
+    put(b, 0, 4);       /* source info */
+    put(b, 0, 4);       /* security ID */
+    put(b, attr, 4);
+    put(b, namelen, 2);
+    put(b, 60, 2);
+    put_utf16(b, name);
+
+    while (b->len < start + reclen) put(b, 0, 1);
+}
+
+/* chunk with 16 byte file ID + symlink or junction reparse data */
+static void put_reparse(BUFFER *b, uint64_t id, uint32_t tag, const char *target)
+{
+    size_t tlen = strlen(target) * 2;
+    size_t hdr = (tag == TAG_SYMLINK) ? 12 : 8;
+    size_t datalen = (tag == TAG_CLOUD) ? 4 : hdr + tlen;
+
+    put(b, USN_CHUNK_REPARSE, 4);
+    put(b, 16 + 8 + datalen, 4);
+    put(b, id, 8);
+    put(b, 0, 8);
+
+    put(b, tag, 4);
+    put(b, datalen, 2);
+    put(b, 0, 2);
+
+    if (tag == TAG_CLOUD) {
+        put(b, 0, 4);
+        return;
+    }
+
+    put(b, 0, 2);       /* substitute name offset */
+    put(b, tlen, 2);    /* substitute name length */
+    put(b, 0, 2);       /* print name offset */
+    put(b, 0, 2);       /* print name length */
+    if (tag == TAG_SYMLINK) put(b, 0, 4);
+    put_utf16(b, target);
+}
+
+static int collect(void *ctx, const USN_LINK_EVENT *ev)
+{
+    RESULT *r = (RESULT *)ctx;
+    size_t i;
+
+    if (r->count >= 8) return 1;
+
+    r->types[r->count] = ev->type;
+    r->tags[r->count] = ev->tag;
+
+    for (i = 0; ev->target && i < ev->target_len && i < 63; i++) {
+        r->targets[r->count][i] = (char)ev->target[i*2];
+    }
+    r->targets[r->count][i] = 0;
+    r->count++;
+
+    return 0;
+}
+
+static void make_journal(BUFFER *b)
+{
+    BUFFER records;
+    const uint32_t close = USN_FEED_CLOSE;
+    const uint32_t rp = USN_ATTRIBUTE_REPARSE_POINT;
+
+    memset(&records, 0, sizeof(records));
+    put_record(&records, 1, 100, USN_FEED_FILE_CREATE, rp, "link");          /* not closed yet */
+    put_record(&records, 1, 108, USN_FEED_FILE_CREATE | close, rp, "link");  /* added */
+    put_record(&records, 2, 116, USN_FEED_REPARSE_POINT_CHANGE | close, rp | 0x10, "junction");
+    put_record(&records, 3, 124, USN_FEED_FILE_DELETE | close, rp, "old");   /* removed */
+    put_record(&records, 4, 132, USN_FEED_FILE_CREATE | close, 0x20, "file"); /* no link */
+    put_record(&records, 6, 140, USN_FEED_FILE_CREATE | close, rp, "cloud");  /* no link */
+
+    b->len = 0;
+    put(b, USN_CHUNK_RECORDS, 4);
+    put(b, records.len, 4);
+    memcpy(b->data + b->len, records.data, records.len);
+    b->len += records.len;
+
+    put_reparse(b, 1, TAG_SYMLINK, "..\\target");
+    put_reparse(b, 2, TAG_MOUNT_POINT, "\\??\\C:\\dir");
+    put_reparse(b, 6, TAG_CLOUD, "");
+}
+
+/* a link renamed into another directory, then an unknown record version */
+static void make_rename_journal(BUFFER *b)
+{
+    BUFFER records;
+    const uint32_t close = USN_FEED_CLOSE;
+    const uint32_t rp = USN_ATTRIBUTE_REPARSE_POINT;
+    const uint32_t old_name = USN_FEED_RENAME_OLD_NAME;
+    const uint32_t new_name = USN_FEED_RENAME_NEW_NAME;
+    size_t start;
+
+    memset(&records, 0, sizeof(records));
+    put_record(&records, 7, 200, old_name, rp, "a");                     /* removed */
+    put_record(&records, 7, 208, old_name | new_name, rp, "b");          /* not closed yet */
+    put_record(&records, 7, 216, old_name | new_name | close, rp, "b");  /* added */
+    put_record(&records, 8, 224, USN_FEED_FILE_CREATE | old_name, rp, "tmp"); /* never added */
+    start = records.len;
+    put_record(&records, 9, 0, USN_FEED_FILE_CREATE | close, rp, "v4");
+    records.data[start + 4] = 4;                                         /* major */
+
+    b->len = 0;
+    put(b, USN_CHUNK_RECORDS, 4);
+    put(b, records.len, 4);
+    memcpy(b->data + b->len, records.data, records.len);
+    b->len += records.len;
+
+    put_reparse(b, 7, TAG_SYMLINK, "target");
+}
+
+/* removals of reparse points that are not links */
+static void make_removal_journal(BUFFER *b)
+{
+    BUFFER records;
+    const uint32_t close = USN_FEED_CLOSE;
+    const uint32_t rp = USN_ATTRIBUTE_REPARSE_POINT;
+    const uint32_t recall = 0x00400000U;  /* FILE_ATTRIBUTE_RECALL_ON_DATA_ACCESS */
+
+    memset(&records, 0, sizeof(records));
+    put_record(&records, 10, 300, USN_FEED_REPARSE_POINT_CHANGE | close, rp, "cloud"); /* no link */
+    put_record(&records, 10, 308, USN_FEED_FILE_DELETE | close, rp, "cloud");          /* no link */
+    put_record(&records, 11, 316, USN_FEED_FILE_CREATE | close, rp, "link");           /* added */
+    put_record(&records, 11, 324, USN_FEED_REPARSE_POINT_CHANGE | close, 0, "link");   /* removed */
+    put_record(&records, 12, 332, USN_FEED_FILE_DELETE | close, rp | recall, "placeholder");
+    put_record(&records, 13, 340, USN_FEED_RENAME_OLD_NAME, rp, "wof");                /* no link */
+    put_record(&records, 14, 348, USN_FEED_FILE_DELETE | close, rp, "unknown");        /* removed */
+
+    b->len = 0;
+    put(b, USN_CHUNK_RECORDS, 4);
+    put(b, records.len, 4);
+    memcpy(b->data + b->len, records.data, records.len);
+    b->len += records.len;
+
+    put_reparse(b, 10, TAG_CLOUD, "");
+    put_reparse(b, 11, TAG_SYMLINK, "target");
+    put_reparse(b, 13, TAG_CLOUD, "");
+}
+
+static int check_result(const RESULT *r)
+{
+    return r->count == 3 &&
+        r->types[0] == USN_LINK_ADDED && r->tags[0] == TAG_SYMLINK &&
+        strcmp(r->targets[0], "..\\target") == 0 &&
+        r->types[1] == USN_LINK_CHANGED && r->tags[1] == TAG_MOUNT_POINT &&
+        strcmp(r->targets[1], "\\??\\C:\\dir") == 0 &&
+        r->types[2] == USN_LINK_REMOVED && r->tags[2] == 0;
+}
+
+
+int main()
+{
+    static BUFFER journal, recorded;
+    USN_REPLAY replay;
+    USN_SOURCE src;
+    RESULT result;
+    uint64_t last = 0;
+    FILE *fp;
+
+    make_journal(&journal);
+
+    puts("test usn_feed_run (replay)");
+    memset(&result, 0, sizeof(result));
+    usn_replay_source(&replay, journal.data, journal.len, &src);
+    fp = tmpfile();
+    TEST(usn_feed_run(&src, collect, &result, fp, &last) == 0 && last == 140);
+    TEST(check_result(&result));
+    puts("");
+
+    puts("test usn_feed_run (replay of a recorded run)");
+    memset(&result, 0, sizeof(result));
+    recorded.len = 0;
+
+    if (fp) {
+        rewind(fp);
+        recorded.len = fread(recorded.data, 1, sizeof(recorded.data), fp);
+        fclose(fp);
+    }
+
+    usn_replay_source(&replay, recorded.data, recorded.len, &src);
+    TEST(usn_feed_run(&src, collect, &result, NULL, NULL) == 0);
+    TEST(check_result(&result));
+    puts("");
+
+    puts("test usn_feed_run (rename)");
+    memset(&result, 0, sizeof(result));
+    make_rename_journal(&recorded);
+    usn_replay_source(&replay, recorded.data, recorded.len, &src);
+    TEST(usn_feed_run(&src, collect, &result, NULL, &last) == 0 && last == 224);
+    TEST(result.count == 2 &&
+         result.types[0] == USN_LINK_REMOVED && result.tags[0] == 0 &&
+         result.types[1] == USN_LINK_ADDED && result.tags[1] == TAG_SYMLINK &&
+         strcmp(result.targets[1], "target") == 0);
+    puts("");
+
+    puts("test usn_feed_run (removed reparse points that are not links)");
+    memset(&result, 0, sizeof(result));
+    make_removal_journal(&recorded);
+    usn_replay_source(&replay, recorded.data, recorded.len, &src);
+    TEST(usn_feed_run(&src, collect, &result, NULL, &last) == 0 && last == 348);
+    TEST(result.count == 3 &&
+         result.types[0] == USN_LINK_ADDED && result.tags[0] == TAG_SYMLINK &&
+         result.types[1] == USN_LINK_REMOVED && result.types[2] == USN_LINK_REMOVED);
+    puts("");
+
+    puts("test usn_feed_run (truncated data)");
+    memset(&result, 0, sizeof(result));
+    journal.data[7] = 0x7f;  /* chunk length */
+    usn_replay_source(&replay, journal.data, journal.len, &src);
+    TEST(usn_feed_run(&src, collect, &result, NULL, NULL) == -1 && result.count == 0);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lx_path.h"
+
+/* This test doesn't need Windows: LX link targets are translated lexically. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+
+static int check(const LX_PATH_TABLE *table, const char *link,
+                 const char *target, const char *expected)
+{
+    char *result = NULL;
+    int rv, ok;
+
+    rv = lx_path_translate(table, link, target, &result);
+
+    if (expected == NULL) {
+        ok = (rv == LX_PATH_UNRESOLVED && result == NULL);
+    } else {
+        ok = (rv == LX_PATH_OK && strcmp(result, expected) == 0);
+    }
+
+    if (!ok) {
+        printf("  %s -> %s: %s\n", link, target, result ? result : "(null)");
+    }
+
+    free(result);
+
+    return ok;
+}
+
+
+int main()
+{
+    static const LX_MOUNT mounts[] = {
+        { "/data", "D:\\shared" },
+        { "/data/big/", "\\\\server\\big" }
+    };
+    LX_PATH_TABLE table = { NULL, mounts, 2, "Ubuntu", NULL, 0 };
+    LX_PATH_TABLE bare = { "/win", NULL, 0, NULL, NULL, 0 };
+    LX_PATH_TABLE multi = { NULL, NULL, 0, "Ubuntu", NULL, 0 };
+    LX_DISTRO distros[2];
+    LX_CONFIG config;
+
+    puts("test lx_path_translate (drive mounts)");
+    TEST(check(&table, "C:\\x\\lnk", "/mnt/c/Users/me", "C:\\Users\\me"));
+    TEST(check(&table, "C:\\x\\lnk", "/mnt/d", "D:\\"));
+    TEST(check(&table, "C:\\x\\lnk", "//mnt/./e/../e/f/", "E:\\f"));
+    TEST(check(&bare, "C:\\x\\lnk", "/win/c/y", "C:\\y"));
+    puts("");
+
+    puts("test lx_path_translate (relative targets)");
+    TEST(check(&table, "C:\\x\\lnk", "y/z", "C:\\x\\y\\z"));
+    TEST(check(&table, "C:\\x\\lnk", "../../d/y", "D:\\y"));
+    TEST(check(&table, "\\\\?\\C:\\x\\lnk", "../y", "C:\\y"));
+    TEST(check(&table, "C:\\x\\lnk", "../../..", "\\\\wsl$\\Ubuntu\\"));
+    TEST(check(&table, "\\\\nas\\share\\lnk", "a/b", "\\\\nas\\share\\a\\b"));
+    puts("");
+
+    puts("test lx_path_translate (distributions)");
+    TEST(check(&table, "C:\\x\\lnk", "/usr/bin", "\\\\wsl$\\Ubuntu\\usr\\bin"));
+    TEST(check(&table, "\\\\wsl.localhost\\Debian\\home\\lnk", "/etc",
+               "\\\\wsl.localhost\\Debian\\etc"));
+    TEST(check(&table, "\\\\wsl$\\Debian\\home\\lnk", "../tmp", "\\\\wsl$\\Debian\\tmp"));
+    TEST(check(&table, "\\\\wsl$\\Debian\\lnk", "/mnt/c", "C:\\"));
+    TEST(check(&bare, "C:\\x\\lnk", "/usr/bin", NULL));
+    puts("");
+
+    puts("test lx_path_translate (additional mounts)");
+    TEST(check(&table, "C:\\x\\lnk", "/data/a", "D:\\shared\\a"));
+    TEST(check(&table, "C:\\x\\lnk", "/data/big/a", "\\\\server\\big\\a"));
+    TEST(check(&table, "C:\\x\\lnk", "/database", "\\\\wsl$\\Ubuntu\\database"));
+    TEST(check(&table, "d:\\Shared\\sub\\lnk", "../../x", "\\\\wsl$\\Ubuntu\\x"));
+    puts("");
+
+    puts("test lx_path_translate (escaped characters)");
+    TEST(check(&table, "C:\\x\\lnk", "a:b", "C:\\x\\a\xEF\x80\xBA" "b"));
+    TEST(check(&table, "C:\\x\\a\xEF\x80\xBA" "b\\lnk", "../c", "C:\\x\\c"));
+    TEST(check(&table, "C:\\x\\a\xEF\x80\xBA" "b\\lnk", "/mnt/c/x/a:b/c",
+               "C:\\x\\a\xEF\x80\xBA" "b\\c"));
+    puts("");
+
+    puts("test lx_config_parse");
+    TEST(lx_config_parse("[network]\nroot = /wrong/\n"
+                         "[automount]\r\n  root = \"/windir/\"  # comment\r\n"
+                         "mountFsTab = true\n",
+                         "# <file system> <dir> <type>\n"
+                         "D:\\data /da\\040ta drvfs defaults 0 0\n"
+                         "//nas/x /srv cifs defaults 0 0\n"
+                         "  E: /e  DrvFs  rw", &config) == LX_PATH_OK &&
+         config.automount_root && strcmp(config.automount_root, "/windir/") == 0 &&
+         config.mount_count == 2 &&
+         strcmp(config.mounts[0].windows_prefix, "D:\\data") == 0 &&
+         strcmp(config.mounts[0].linux_prefix, "/da ta") == 0 &&
+         strcmp(config.mounts[1].windows_prefix, "E:") == 0 &&
+         strcmp(config.mounts[1].linux_prefix, "/e") == 0);
+    lx_config_free(&config);
+    TEST(lx_config_parse("[automount]\nmountFsTab=false\n", "D: /d drvfs", &config) == LX_PATH_OK &&
+         config.automount_root == NULL && config.mount_count == 0);
+    lx_config_free(&config);
+    puts("");
+
+    puts("test lx_path_translate (per distribution settings)");
+    lx_config_parse("[automount]\nroot=/windir\n", "D:\\data /data drvfs\n", &config);
+    distros[0].name = "Debian";
+    distros[0].automount_root = NULL;
+    distros[0].mounts = NULL;
+    distros[0].mount_count = 0;
+    distros[1].name = "ubuntu";
+    distros[1].automount_root = config.automount_root;
+    distros[1].mounts = config.mounts;
+    distros[1].mount_count = config.mount_count;
+    multi.distros = distros;
+    multi.distro_count = 2;
+    TEST(check(&multi, "C:\\x\\lnk", "/windir/c/y", "C:\\y"));
+    TEST(check(&multi, "C:\\x\\lnk", "/mnt/c/y", "\\\\wsl$\\Ubuntu\\mnt\\c\\y"));
+    TEST(check(&multi, "C:\\x\\lnk", "/data/f", "D:\\data\\f"));
+    TEST(check(&multi, "D:\\data\\sub\\lnk", "../../etc", "\\\\wsl$\\Ubuntu\\etc"));
+    TEST(check(&multi, "\\\\wsl$\\Debian\\home\\lnk", "/mnt/c", "C:\\"));
+    TEST(check(&multi, "\\\\?\\UNC\\wsl$\\Debian\\home\\lnk", "/windir/c",
+               "\\\\wsl$\\Debian\\windir\\c"));
+    TEST(check(&multi, "\\\\wsl.localhost\\Ubuntu\\lnk", "/data", "D:\\data\\"));
+    lx_config_free(&config);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* mkdtemp() */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "w32-symlink.h"
+
+/* This test runs against the native Linux backend. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+
+int main()
+{
+    char dir[] = "/tmp/w32-symlink-XXXXXX";
+    char file[64], lnk[64], hard[64], buf[256], out[256];
+    char *path, *real;
+    LINK_TARGET_VIEW view;
+    ULONG tag = 0;
+    FILE *fp;
+
+    if (!mkdtemp(dir)) return 1;
+
+    snprintf(file, sizeof(file), "%s/file", dir);
+    snprintf(lnk, sizeof(lnk), "%s/link", dir);
+    snprintf(hard, sizeof(hard), "%s/hard", dir);
+
+    if ((fp = fopen(file, "w")) != NULL) fclose(fp);
+
+    puts("test createLinkA");
+    TEST(createLinkA(lnk, "file", 's') == TRUE);
+    TEST(createLinkA(hard, file, 'h') == TRUE);
+    TEST(createLinkA(lnk, "file", 's') == FALSE);
+    puts("");
+
+    puts("test isSymlinkA");
+    TEST(isSymlinkA(lnk, &tag) == TRUE && tag == IO_REPARSE_TAG_SYMLINK);
+    TEST(isSymlinkA(file, NULL) == FALSE);
+    TEST(isSymlinkA(dir, NULL) == FALSE);
+    TEST(isSymlinkA("/nonexistent/path", NULL) == -1);
+    puts("");
+
+    puts("test getLinkTargetA");
+    tag = 0;
+    path = getLinkTargetA(lnk, &tag);
+    TEST(path && strcmp(path, "file") == 0 && tag == IO_REPARSE_TAG_SYMLINK);
+    free(path);
+    TEST(getLinkTargetA(file, NULL) == NULL);
+    puts("");
+
+    puts("test getLinkTargetViewA");
+    memset(&view, 0, sizeof(view));
+    TEST(getLinkTargetViewA(lnk, buf, sizeof(buf), &view) == TRUE &&
+         view.utf8 && view.flags == 0x1 && view.target_len == 4 &&
+         memcmp(LINK_VIEW_STRING(buf, view.target_off), "file", 4) == 0);
+    TEST(getLinkTargetViewA(lnk, buf, 4, &view) == FALSE);
+    puts("");
+
+    puts("test getCanonicalPathA");
+    path = getCanonicalPathA(lnk);
+    real = realpath(file, NULL);
+    TEST(path && real && strcmp(path, real) == 0);
+    puts("");
+
+    puts("test readlink_s and realpath_s");
+    TEST(readlink_s(lnk, buf, sizeof(buf)) == buf && strcmp(buf, "file") == 0);
+    TEST(readlink_s(lnk, buf, 4) == NULL);
+    TEST(realpath_s(lnk, buf, sizeof(buf)) == buf && real && strcmp(buf, real) == 0);
+    TEST(realpath_s(lnk, buf, 2) == NULL);
+    puts("");
+
+    puts("test length-delimited variants");
+    /* "<lnk>/x": the slice ends before the separator */
+    snprintf(buf, sizeof(buf), "%s/x", lnk);
+    tag = 0;
+    TEST(isSymlinkNA(buf, strlen(lnk), &tag) == TRUE && tag == IO_REPARSE_TAG_SYMLINK);
+    TEST(isSymlinkNA("/nonexistent\0", 13, NULL) == -1);
+    free(path);
+    path = getLinkTargetNA(buf, strlen(lnk), NULL);
+    TEST(path && strcmp(path, "file") == 0);
+    free(path);
+    path = getCanonicalPathNA(buf, strlen(lnk));
+    TEST(path && real && strcmp(path, real) == 0);
+    TEST(readlinkn_s(buf, strlen(lnk), out, sizeof(out)) == out && strcmp(out, "file") == 0);
+    TEST(realpathn_s(buf, strlen(lnk), out, sizeof(out)) == out && real && strcmp(out, real) == 0);
+    TEST(realpathn_s(lnk, 0, NULL, 0) == NULL);
+    free(path);
+    free(real);
+
+    unlink(lnk);
+    unlink(hard);
+    unlink(file);
+    rmdir(dir);
+
+    return failed ? 1 : 0;
+}
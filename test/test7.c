@@ -0,0 +1,234 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+/* This test doesn't need Windows: a call trace is written and replayed. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+#define TAG_SYMLINK  0xA000000CU
+#define TAG_CLOUD    0x9000001AU
+
+
+typedef struct {
+    uint8_t data[512];
+    size_t len;
+} BUFFER;
+
+
+static void put(BUFFER *b, uint64_t v, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        b->data[b->len++] = (uint8_t)(v >> (8*i));
+    }
+}
+
+static void put_utf16(BUFFER *b, const char *s)
+{
+    while (*s) put(b, (uint8_t)*s++, 2);
+}
+
+/* raw output of FSCTL_GET_REPARSE_POINT for a relative symlink */
+static void make_symlink(BUFFER *b, const char *target)
+{
+    size_t tlen = strlen(target) * 2;
+
+    put(b, TAG_SYMLINK, 4);
+    put(b, 12 + tlen, 2);
+    put(b, 0, 2);
+    put(b, 0, 2);       /* substitute name offset */
+    put(b, tlen, 2);    /* substitute name length */
+    put(b, 0, 2);       /* print name offset */
+    put(b, 0, 2);       /* print name length */
+    put(b, 1, 4);       /* SYMLINK_FLAG_RELATIVE */
+    put_utf16(b, target);
+}
+
+static void write_record(FILE *fp, uint32_t thread, uint32_t op, uint32_t error, uint32_t arg,
+                         uint64_t ns, uint64_t handle, uint64_t parent,
+                         const BUFFER *path, const BUFFER *data)
+{
+    TRACE_RECORD rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.op = op;
+    rec.error = error;
+    rec.arg = arg;
+    rec.thread = thread;
+    rec.elapsed_ns = ns;
+    rec.handle = handle;
+    rec.parent = parent;
+
+    if (path) {
+        rec.path = path->data;
+        rec.path_len = path->len;
+    }
+
+    if (data) {
+        rec.data = data->data;
+        rec.data_len = data->len;
+    }
+
+    trace_write(fp, &rec);
+}
+
+
+int main()
+{
+    static uint8_t trace[4096];
+    BUFFER path = {{0}, 0}, link = {{0}, 0}, cloud = {{0}, 0}, other = {{0}, 0}, upper = {{0}, 0};
+    BUFFER ntdir = {{0}, 0}, name = {{0}, 0}, ntlink = {{0}, 0}, v1 = {{0}, 0};
+    const TRACE_RECORD *found;
+    TRACE_INDEX index;
+    TRACE_STATS stats;
+    TRACE_RECORD rec;
+    size_t len = 0, pos = 0;
+    FILE *fp;
+
+    put_utf16(&path, "C:\\dir\\link");
+    put_utf16(&other, "C:\\other");
+    put_utf16(&upper, "c:\\DIR\\LINK");
+    put_utf16(&ntdir, "\\??\\C:\\dir");
+    put_utf16(&name, "link");
+    put_utf16(&ntlink, "\\??\\C:\\dir\\link");
+    make_symlink(&link, "..\\target");
+    put(&cloud, TAG_CLOUD, 4);
+    put(&cloud, 0, 4);
+
+    /* isSymlink() on a link, then on something that doesn't exist */
+    if ((fp = tmpfile()) != NULL) {
+        trace_write_header(fp);
+        write_record(fp, 1, TRACE_GET_ATTRIBUTES, 0, 0, 1000, 0, 0, &path, NULL);
+        write_record(fp, 1, TRACE_CREATE_FILE, 0, 0, 5000, 0, 0, &path, NULL);
+        write_record(fp, 1, TRACE_GET_REPARSE, 0, 0, 2000, 0, 0, NULL, &link);
+        write_record(fp, 1, TRACE_GET_REPARSE, 0, 0, 2000, 0, 0, NULL, &cloud);
+        write_record(fp, 1, TRACE_GET_ATTRIBUTES, 2, 0, 500, 0, 0, &path, NULL);
+        rewind(fp);
+        len = fread(trace, 1, sizeof(trace), fp);
+        fclose(fp);
+    }
+
+    puts("test trace_next");
+    TEST(trace_next(trace, len, &pos, &rec) == 1 && rec.op == TRACE_GET_ATTRIBUTES &&
+         rec.path_len == path.len && memcmp(rec.path, path.data, path.len) == 0);
+    TEST(trace_next(trace, len, &pos, &rec) == 1 && rec.op == TRACE_CREATE_FILE &&
+         rec.elapsed_ns == 5000 && rec.thread == 1);
+    TEST(trace_next(trace, len, &pos, &rec) == 1 && rec.op == TRACE_GET_REPARSE &&
+         rec.data_len == link.len && rec.path_len == 0);
+    puts("");
+
+    puts("test trace_replay");
+    TEST(trace_replay(trace, len, 100, &stats) == 0);
+    TEST(stats.calls[TRACE_GET_ATTRIBUTES] == 2 && stats.errors[TRACE_GET_ATTRIBUTES] == 1 &&
+         stats.recorded_ns[TRACE_GET_ATTRIBUTES] == 1500);
+    TEST(stats.calls[TRACE_CREATE_FILE] == 1 && stats.calls[TRACE_GET_REPARSE] == 2);
+    TEST(stats.links == 1 && stats.invalid == 0);
+    puts("");
+
+    puts("test trace_replay (corrupted data)");
+    TEST(trace_replay(trace, len - 1, 1, &stats) == -1);
+    trace[0] = 'X';
+    TEST(trace_replay(trace, len, 1, &stats) == -1);
+    puts("");
+
+    /* isSymlink(path, &tag) and _lstat64(other) on two threads */
+    len = 0;
+    if ((fp = tmpfile()) != NULL) {
+        trace_write_header(fp);
+        write_record(fp, 1, TRACE_CALL, 0, TRACE_CALL_ARG(TRACE_API_IS_SYMLINK, TRACE_FLAG_TAG),
+                     0, 0, 0, &path, NULL);
+        write_record(fp, 2, TRACE_CALL, 0, TRACE_CALL_ARG(TRACE_API_LSTAT, 0), 0, 0, 0, &other, NULL);
+        write_record(fp, 1, TRACE_GET_ATTRIBUTES, 0, 0x400, 1000, 0, 0, &path, NULL);
+        write_record(fp, 2, TRACE_GET_ATTRIBUTES, 2, 0, 500, 0, 0, &other, NULL);
+        write_record(fp, 1, TRACE_CREATE_FILE, 0, 0x02200000, 5000, 0x10, 0, &path, NULL);
+        write_record(fp, 2, TRACE_RETURN, 2, 0, 900, 0, 0, NULL, NULL);
+        write_record(fp, 1, TRACE_GET_REPARSE, 0, 0, 2000, 0x10, 0, NULL, &link);
+        write_record(fp, 1, TRACE_RETURN, 0, 0, 9000, 0, 0, NULL, NULL);
+        write_record(fp, 3, TRACE_FILE_INFO, 0, 18, 100, 0, 0, NULL, NULL);
+        rewind(fp);
+        len = fread(trace, 1, sizeof(trace), fp);
+        fclose(fp);
+    }
+
+    puts("test trace_index_build");
+    TEST(trace_index_build(trace, len, &index) == 0 && index.call_count == 2 &&
+         index.count == 5 && index.unowned == 1);
+    TEST(index.calls[0].api == TRACE_API_IS_SYMLINK && index.calls[0].flags == TRACE_FLAG_TAG &&
+         index.calls[0].returned && index.calls[0].error == 0 && index.calls[0].elapsed_ns == 9000 &&
+         index.calls[0].calls[TRACE_GET_ATTRIBUTES] == 1 &&
+         index.calls[0].calls[TRACE_CREATE_FILE] == 1 &&
+         index.calls[0].calls[TRACE_GET_REPARSE] == 1);
+    TEST(index.calls[1].api == TRACE_API_LSTAT && index.calls[1].error == 2 &&
+         index.calls[1].calls[TRACE_GET_ATTRIBUTES] == 1 &&
+         index.calls[1].calls[TRACE_CREATE_FILE] == 0);
+    puts("");
+
+    puts("test trace_lookup");
+    /* the reparse data was read through the handle opened on 'path' */
+    found = trace_lookup(&index, 0, TRACE_GET_REPARSE, 0, upper.data, upper.len);
+    TEST(found && found->data_len == link.len);
+    found = trace_lookup(&index, TRACE_NO_CALL, TRACE_GET_ATTRIBUTES, 0, other.data, other.len);
+    TEST(found && found->error == 2);
+    TEST(trace_lookup(&index, 0, TRACE_CREATE_FILE, 0x02000000, path.data, path.len) == NULL);
+    TEST(trace_lookup(&index, 1, TRACE_CREATE_FILE, 0x02200000, path.data, path.len) != NULL);
+    trace_index_free(&index);
+    TEST(trace_index_build(trace, len - 1, &index) == -1 && index.entries == NULL);
+    puts("");
+
+    /* a cached directory handle, another handle in between and a name
+     * opened relative to the directory */
+    len = 0;
+    if ((fp = tmpfile()) != NULL) {
+        trace_write_header(fp);
+        write_record(fp, 1, TRACE_NT_OPEN, 0, 0x4021, 100, 0x20, 0, &ntdir, NULL);
+        write_record(fp, 1, TRACE_CREATE_FILE, 0, 0x02000000, 100, 0x30, 0, &other, NULL);
+        write_record(fp, 1, TRACE_NT_OPEN, 0, 0x200000, 100, 0x40, 0x20, &name, NULL);
+        write_record(fp, 1, TRACE_GET_REPARSE, 0, 0, 100, 0x40, 0, NULL, &link);
+        write_record(fp, 1, TRACE_FILE_INFO, 0, 18, 100, 0x30, 0, NULL, &cloud);
+        rewind(fp);
+        len = fread(trace, 1, sizeof(trace), fp);
+        fclose(fp);
+    }
+
+    puts("test trace_index_build (handles)");
+    TEST(trace_index_build(trace, len, &index) == 0 && index.count == 5 && index.joined_count == 1);
+    found = trace_lookup(&index, TRACE_NO_CALL, TRACE_NT_OPEN, 0x200000, ntlink.data, ntlink.len);
+    TEST(found && found->handle == 0x40);
+    found = trace_lookup(&index, TRACE_NO_CALL, TRACE_GET_REPARSE, 0, ntlink.data, ntlink.len);
+    TEST(found && found->data_len == link.len);
+    found = trace_lookup(&index, TRACE_NO_CALL, TRACE_FILE_INFO, 18, other.data, other.len);
+    TEST(found && found->data_len == cloud.len);
+    TEST(trace_lookup(&index, TRACE_NO_CALL, TRACE_FILE_INFO, 18, ntlink.data, ntlink.len) == NULL);
+    trace_index_free(&index);
+    puts("");
+
+    /* version 1 traces have a shorter record header */
+    v1.len = 0;
+    memcpy(v1.data, TRACE_MAGIC_V1, TRACE_MAGIC_LEN);
+    v1.len = TRACE_MAGIC_LEN;
+    put(&v1, TRACE_GET_ATTRIBUTES, 4);
+    put(&v1, 0, 4);
+    put(&v1, 0x400, 4);
+    put(&v1, 700, 8);
+    put(&v1, path.len, 4);
+    put(&v1, 0, 4);
+    put(&v1, 7, 4);
+    memcpy(v1.data + v1.len, path.data, path.len);
+    v1.len += path.len;
+    pos = 0;
+
+    puts("test trace_next (version 1)");
+    TEST(trace_next(v1.data, v1.len, &pos, &rec) == 1 && rec.op == TRACE_GET_ATTRIBUTES &&
+         rec.thread == 7 && rec.handle == 0 && rec.path_len == path.len &&
+         memcmp(rec.path, path.data, path.len) == 0);
+    TEST(trace_next(v1.data, v1.len, &pos, &rec) == 0);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "reparse_decode.h"
+#include "retarget.h"
+
+/* This test doesn't need Windows: the reparse data is built in memory. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+#define TAG_SYMLINK      0xA000000CU
+#define TAG_MOUNT_POINT  0xA0000003U
+
+
+typedef struct {
+    uint8_t data[512];
+    size_t len;
+} BUFFER;
+
+
+static void put(BUFFER *b, uint64_t v, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        b->data[b->len++] = (uint8_t)(v >> (8*i));
+    }
+}
+
+static void put_utf16(BUFFER *b, const char *s)
+{
+    while (*s) put(b, (uint8_t)*s++, 2);
+}
+
+/* raw output of FSCTL_GET_REPARSE_POINT; like CreateSymbolicLinkW()
+ * the print name is stored first */
+static void make_link(BUFFER *b, uint32_t tag, uint32_t flags, const char *subst, const char *print)
+{
+    size_t slen = strlen(subst) * 2;
+    size_t plen = strlen(print) * 2;
+    size_t hdr = (tag == TAG_SYMLINK) ? 12 : 8;
+
+    b->len = 0;
+    put(b, tag, 4);
+    put(b, hdr + slen + plen, 2);
+    put(b, 0, 2);
+    put(b, plen, 2);    /* SubstituteNameOffset */
+    put(b, slen, 2);
+    put(b, 0, 2);       /* PrintNameOffset */
+    put(b, plen, 2);
+    if (tag == TAG_SYMLINK) put(b, flags, 4);
+    put_utf16(b, print);
+    put_utf16(b, subst);
+}
+
+/* compare a UTF-16 string of the buffer with an ASCII string */
+static int equals(const uint8_t *buf, size_t off, size_t len, const char *s)
+{
+    size_t i;
+
+    if (len != strlen(s)) return 0;
+
+    for (i = 0; i < len; i++) {
+        if (get_le16(buf + off + i*2) != (uint16_t)s[i]) return 0;
+    }
+
+    return 1;
+}
+
+/* retarget and check the names of the result */
+static int retarget(const BUFFER *in, const char *oldp, const char *newp,
+                    const char *subst, const char *print)
+{
+    uint16_t o[64], n[64];
+    uint8_t out[512];
+    size_t i, written = 0;
+    REPARSE_VIEW view;
+
+    for (i = 0; oldp[i]; i++) o[i] = (uint16_t)oldp[i];
+    for (i = 0; newp[i]; i++) n[i] = (uint16_t)newp[i];
+
+    if (reparse_retarget(in->data, in->len, o, strlen(oldp), n, strlen(newp),
+                         out, sizeof(out), &written) != RETARGET_OK ||
+        reparse_decode(out, written, &view) != REPARSE_DECODE_OK)
+    {
+        return 0;
+    }
+
+    return view.tag == get_le32(in->data) &&
+           equals(out, view.subst_off, view.subst_len, subst) &&
+           equals(out, view.print_off, view.print_len, print);
+}
+
+
+int main()
+{
+    BUFFER b;
+    uint16_t o[] = { 'T', ':', '\\', 't', 'o', 'o', 'l', 's' };
+    uint16_t n[] = { 'U', ':' };
+    uint16_t unc[] = { '\\', '\\', 's', 'r', 'v', '\\', 's', 'h', 'a', 'r', 'e' };
+    uint8_t out[512];
+    size_t written;
+
+    puts("test reparse_retarget (symlink, drive to drive)");
+    make_link(&b, TAG_SYMLINK, 0, "\\??\\T:\\tools\\bin\\cc.exe", "T:\\tools\\bin\\cc.exe");
+    TEST(retarget(&b, "T:\\tools", "U:\\new", "\\??\\U:\\new\\bin\\cc.exe", "U:\\new\\bin\\cc.exe"));
+    puts("");
+
+    puts("test reparse_retarget (ignores ASCII case)");
+    TEST(retarget(&b, "t:\\TOOLS", "U:", "\\??\\U:\\bin\\cc.exe", "U:\\bin\\cc.exe"));
+    puts("");
+
+    puts("test reparse_retarget (junction, drive to drive)");
+    make_link(&b, TAG_MOUNT_POINT, 0, "\\??\\T:\\tools\\lib", "T:\\tools\\lib");
+    TEST(retarget(&b, "T:\\tools", "U:\\tools", "\\??\\U:\\tools\\lib", "U:\\tools\\lib"));
+    puts("");
+
+    puts("test reparse_retarget (junction, drive to UNC)");
+    TEST(reparse_retarget(b.data, b.len, o, 8, unc, 11, out, sizeof(out), &written) == RETARGET_REMOTE);
+    puts("");
+
+    puts("test reparse_retarget (UNC to drive)");
+    make_link(&b, TAG_SYMLINK, 0, "\\??\\UNC\\srv\\share\\x", "\\\\srv\\share\\x");
+    TEST(retarget(&b, "\\\\SRV\\share", "D:\\mirror", "\\??\\D:\\mirror\\x", "D:\\mirror\\x"));
+    puts("");
+
+    puts("test reparse_retarget (the whole target)");
+    make_link(&b, TAG_SYMLINK, 0, "\\??\\T:\\tools", "");
+    TEST(retarget(&b, "T:\\tools", "U:\\tools", "\\??\\U:\\tools", ""));
+    puts("");
+
+    puts("test reparse_retarget (no match)");
+    make_link(&b, TAG_SYMLINK, 0, "\\??\\T:\\toolsX\\bin", "T:\\toolsX\\bin");
+    TEST(reparse_retarget(b.data, b.len, o, 8, n, 2, out, sizeof(out), &written) == RETARGET_NOMATCH);
+    make_link(&b, TAG_SYMLINK, 1, "T:\\tools\\bin", "T:\\tools\\bin");
+    TEST(reparse_retarget(b.data, b.len, o, 8, n, 2, out, sizeof(out), &written) == RETARGET_NOMATCH);
+    puts("");
+
+    puts("test reparse_retarget (errors)");
+    make_link(&b, TAG_SYMLINK, 0, "\\??\\T:\\tools\\bin", "T:\\tools\\bin");
+    TEST(reparse_retarget(b.data, b.len, o, 8, n, 2, out, 40, &written) == RETARGET_TOOLONG);
+    TEST(reparse_retarget(b.data, b.len - 2, o, 8, n, 2, out, sizeof(out), &written) == RETARGET_INVALID);
+
+    return failed ? 1 : 0;
+}
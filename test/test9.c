@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "volhealth.h"
+
+/* This test doesn't need Windows: the clock is passed in. */
+
+static int failed = 0;
+
+#define TEST(x)  puts((x) ? "success" : (failed++, "failure"))
+
+
+static size_t to_utf16(const char *s, uint16_t *buf)
+{
+    size_t i;
+
+    for (i = 0; s[i]; i++) {
+        buf[i] = (uint16_t)s[i];
+    }
+
+    return i;
+}
+
+/* volume_key() of 'path' equals 'expected' ("" = no key) */
+static int key_is(const char *path, const char *expected)
+{
+    uint16_t p[256], key[VOLHEALTH_KEY_MAX], e[VOLHEALTH_KEY_MAX];
+    size_t len, elen;
+
+    len = volume_key(p, to_utf16(path, p), key, VOLHEALTH_KEY_MAX);
+    elen = to_utf16(expected, e);
+
+    return len == elen && memcmp(key, e, len * sizeof(uint16_t)) == 0;
+}
+
+
+int main()
+{
+    static VOLHEALTH h;
+    uint16_t a[VOLHEALTH_KEY_MAX], b[VOLHEALTH_KEY_MAX];
+    size_t alen, blen, i;
+    uint16_t p[64];
+
+    puts("test volume_key");
+    TEST(key_is("C:\\Windows", "c:"));
+    TEST(key_is("\\\\?\\C:\\Windows", "c:"));
+    TEST(key_is("\\??\\c:\\", "c:"));
+    TEST(key_is("\\\\Server\\Share\\dir\\file", "\\\\server\\share"));
+    TEST(key_is("//server/share", "\\\\server\\share"));
+    TEST(key_is("\\\\?\\UNC\\SERVER\\share\\dir", "\\\\server\\share"));
+    TEST(key_is("\\\\server", "\\\\server"));
+    TEST(key_is("\\\\?\\Volume{1234}\\dir", "\\\\?\\volume{1234}"));
+    TEST(key_is("relative\\path", ""));
+    TEST(key_is("\\rooted", ""));
+    TEST(key_is("\\\\", ""));
+    puts("");
+
+    puts("test volhealth (backoff)");
+    volhealth_clear(&h);
+    alen = volume_key(p, to_utf16("\\\\nas\\data\\x", p), a, VOLHEALTH_KEY_MAX);
+    blen = volume_key(p, to_utf16("D:\\x", p), b, VOLHEALTH_KEY_MAX);
+    TEST(volhealth_admit(&h, a, alen, 1000) == 0);
+    volhealth_report(&h, a, alen, 1000, 1);
+    TEST(volhealth_admit(&h, a, alen, 1500) == VOLHEALTH_BACKOFF_MIN - 500);
+    TEST(volhealth_admit(&h, b, blen, 1500) == 0);
+    puts("");
+
+    puts("test volhealth (a single probe)");
+    TEST(volhealth_admit(&h, a, alen, 1000 + VOLHEALTH_BACKOFF_MIN) == 0);
+    TEST(volhealth_admit(&h, a, alen, 1001 + VOLHEALTH_BACKOFF_MIN) != 0);
+    volhealth_report(&h, a, alen, 5000, 1);
+    TEST(volhealth_admit(&h, a, alen, 5000) == 2 * VOLHEALTH_BACKOFF_MIN);
+    volhealth_report(&h, a, alen, 10000, 0);
+    TEST(volhealth_admit(&h, a, alen, 10000) == 0);
+    puts("");
+
+    puts("test volhealth (limits)");
+    for (i = 0; i < 40; i++) {
+        volhealth_report(&h, a, alen, 20000, 1);
+    }
+    TEST(volhealth_admit(&h, a, alen, 20000) == VOLHEALTH_BACKOFF_MAX);
+
+    /* the least recently used volume makes room */
+    for (i = 0; i < VOLHEALTH_SLOTS; i++) {
+        b[0] = (uint16_t)('a' + i % 26);
+        b[1] = (uint16_t)('a' + i / 26);
+        volhealth_report(&h, b, 2, 30000 + i, 1);
+    }
+    TEST(volhealth_admit(&h, a, alen, 30000) == 0);
+
+    volhealth_clear(&h);
+    TEST(volhealth_admit(&h, b, 2, 30000) == 0);
+
+    return failed ? 1 : 0;
+}
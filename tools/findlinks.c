@@ -0,0 +1,82 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <stdlib.h>
+#include "tool.h"
+#include "walk.h"
+#include "w32-symlink.h"
+
+
+static int emit_link(void *ctx, const WALK_ENTRY *entry)
+{
+    TOOL_RESULT res = { entry->path, 0, 0, NULL, NULL };
+    wchar_t *target;
+
+    switch (entry->reparse_tag)
+    {
+    case IO_REPARSE_TAG_SYMLINK:
+    case IO_REPARSE_TAG_MOUNT_POINT:
+    case IO_REPARSE_TAG_APPEXECLINK:
+    case IO_REPARSE_TAG_LX_SYMLINK:
+    case IO_REPARSE_TAG_NFS:
+        break;
+    default:
+        return WALK_CONTINUE;
+    }
+
+    if ((target = getLinkTargetW(entry->path, &res.tag)) == NULL) {
+        /* i.e. NFS entries that are not links */
+        if (entry->reparse_tag == IO_REPARSE_TAG_NFS) return WALK_CONTINUE;
+        res.error = GetLastError();
+        res.tag = entry->reparse_tag;
+    }
+
+    res.value = target;
+    tool_emit((TOOL_OUTPUT *)ctx, &res);
+    free(target);
+
+    return WALK_CONTINUE;
+}
+
+/* the roots are processed in parallel, the links below each root
+ * on a single thread; tool_emit() writes them out while the walk
+ * goes on instead of collecting a whole tree in memory */
+static void run(TOOL_OUTPUT *out, const wchar_t * const *fields)
+{
+    TOOL_RESULT res = { fields[0], 0, 0, NULL, NULL };
+
+    if (!walk_tree(fields[0], emit_link, out)) {
+        res.error = GetLastError();
+        tool_emit(out, &res);
+    }
+}
+
+static const TOOL tool = {
+    "findlinks", "DIRECTORY...", "", "target", TOOL_TEXT_LINK, 1, run
+};
+
+int main(void)
+{
+    return tool_main(&tool);
+}
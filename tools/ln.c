@@ -0,0 +1,55 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include "tool.h"
+#include "w32-symlink.h"
+
+
+static void run(TOOL_OUTPUT *out, const wchar_t * const *fields)
+{
+    TOOL_RESULT res = { fields[1], 0, 0, fields[0], NULL };
+    char mode = 'h';
+
+    if (tool_flag('d')) {
+        mode = 'd';
+    } else if (tool_flag('s')) {
+        mode = 's';
+    }
+
+    if (!createLinkW(fields[1], fields[0], mode)) {
+        res.error = GetLastError();
+    }
+
+    tool_emit(out, &res);
+}
+
+/* in batch mode a record is "TARGET<TAB>LINK" */
+static const TOOL tool = {
+    "ln", "[-s|-d] TARGET LINK...", "sd", "target", TOOL_TEXT_NONE, 2, run
+};
+
+int main(void)
+{
+    return tool_main(&tool);
+}
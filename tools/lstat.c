@@ -0,0 +1,77 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <errno.h>
+#include "tool.h"
+#include "w32-symlink.h"
+
+#define FIELDS  (LSTATX_TYPE | LSTATX_SIZE | LSTATX_MTIME | LSTATX_INO | \
+                 LSTATX_NLINK | LSTATX_TAG)
+
+
+/* Windows error for the errno of a path that didn't set one */
+static DWORD errno_to_winerr(int err)
+{
+    switch (err)
+    {
+    case ENOENT:       return ERROR_FILE_NOT_FOUND;
+    case ENOTDIR:      return ERROR_PATH_NOT_FOUND;
+    case EACCES:
+    case EPERM:        return ERROR_ACCESS_DENIED;
+    case ENOMEM:       return ERROR_NOT_ENOUGH_MEMORY;
+    case EINVAL:       return ERROR_INVALID_PARAMETER;
+    case ENAMETOOLONG: return ERROR_FILENAME_EXCED_RANGE;
+    default:           return ERROR_INVALID_FUNCTION;
+    }
+}
+
+static void run(TOOL_OUTPUT *out, const wchar_t * const *fields)
+{
+    TOOL_RESULT res = { fields[0], 0, 0, NULL, NULL };
+    struct lstatx stx;
+
+    SetLastError(0);
+
+    if (lwstatx(fields[0], FIELDS, &stx) == 0) {
+        res.tag = stx.stx_reparse_tag;
+        res.stx = &stx;
+    } else {
+        /* some paths only set errno */
+        res.error = GetLastError();
+        if (res.error == 0) {
+            res.error = errno_to_winerr(errno);
+        }
+    }
+
+    tool_emit(out, &res);
+}
+
+static const TOOL tool = {
+    "lstat", "PATH...", "", NULL, TOOL_TEXT_STAT, 1, run
+};
+
+int main(void)
+{
+    return tool_main(&tool);
+}
@@ -0,0 +1,52 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <stdlib.h>
+#include "tool.h"
+#include "w32-symlink.h"
+
+
+static void run(TOOL_OUTPUT *out, const wchar_t * const *fields)
+{
+    TOOL_RESULT res = { fields[0], 0, 0, NULL, NULL };
+    wchar_t *path;
+
+    if ((path = getCanonicalPathW(fields[0])) == NULL) {
+        res.error = GetLastError();
+        if (res.error == 0) res.error = ERROR_GEN_FAILURE;
+    }
+
+    res.value = path;
+    tool_emit(out, &res);
+    free(path);
+}
+
+static const TOOL tool = {
+    "realpath", "PATH...", "", "realpath", TOOL_TEXT_VALUE, 1, run
+};
+
+int main(void)
+{
+    return tool_main(&tool);
+}
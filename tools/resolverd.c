@@ -0,0 +1,105 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "w32-symlink.h"
+
+/* resolverd: runs the resolver service until it is interrupted. */
+
+static volatile sig_atomic_t stop = 0;
+
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+static int usage(void)
+{
+    fprintf(stderr,
+            "usage: resolverd [-t THREADS] [-c TTL_MS] [NAME]\n"
+            "Answers link queries of other processes over the pipe or socket NAME.\n"
+            "  -t  worker threads (default: number of processors)\n"
+            "  -c  cache results for TTL_MS milliseconds (default: 2000, 0 = no cache)\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    RESOLVER_SERVER *server;
+    const char *name = NULL;
+    unsigned long threads = 0, ttl = 2000;
+    char *end;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "-c") == 0) && i + 1 < argc) {
+            unsigned long n = strtoul(argv[i + 1], &end, 10);
+
+            if (*argv[i + 1] == 0 || *end != 0) {
+                return usage();
+            }
+
+            if (argv[i][1] == 't') threads = n; else ttl = n;
+            i++;
+        } else if (argv[i][0] == '-' || name) {
+            return usage();
+        } else {
+            name = argv[i];
+        }
+    }
+
+    if ((server = resolverStart(name, NULL, (unsigned int)threads, (unsigned int)ttl)) == NULL) {
+#ifdef _WIN32
+        fprintf(stderr, "resolverd: cannot start the service (error %lu)\n", GetLastError());
+#else
+        fprintf(stderr, "resolverd: cannot start the service: %s\n", strerror(errno));
+#endif
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    while (!stop) {
+#ifdef _WIN32
+        Sleep(200);
+#else
+        usleep(200 * 1000);
+#endif
+    }
+
+    resolverStop(server);
+
+    return 0;
+}
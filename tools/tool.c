@@ -0,0 +1,714 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <shellapi.h>
+#include <fcntl.h>
+#include <io.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include "tool.h"
+#include "toolio.h"
+#include "workers.h"
+
+/* records processed at once */
+#define BLOCK_SIZE  4096
+
+/* initial size of the stdin buffer */
+#define READ_SIZE  (1 << 20)
+
+/* output of a record that is written before the record is done */
+#define STREAM_SIZE  (1 << 20)
+
+#define FORMAT_TEXT    0
+#define FORMAT_JSON    1
+#define FORMAT_BINARY  2
+
+#define MAX_FIELDS  2
+
+
+struct TOOL_OUTPUT {
+    const TOOL   *tool;
+    struct BATCH *batch;
+    int           format;
+    uint64_t      index;
+    size_t        slot;    /* index in BATCH.outs */
+    BOOL          done;
+    BOOL          failed;
+    OUTBUF        out;
+    OUTBUF        err;
+};
+
+typedef struct BATCH {
+    const TOOL  *tool;
+    int          format;
+    unsigned int threads;
+    uint64_t     next_index;
+    TOOL_INPUT   recs[BLOCK_SIZE];
+    TOOL_OUTPUT  outs[BLOCK_SIZE];
+    SRWLOCK      lock;     /* protects the fields below and stdout */
+    size_t       head;     /* first slot of the block not written completely */
+    size_t       count;    /* slots in the block */
+    BOOL         failed;
+    BOOL         io_error;
+} BATCH;
+
+
+static char flags[128];
+
+
+int tool_flag(char c)
+{
+    return ((unsigned char)c < sizeof(flags)) ? flags[(unsigned char)c] : 0;
+}
+
+
+/* UTF-8 copy of 'wcs', must be deallocated with free() */
+static char *to_utf8(const wchar_t *wcs, size_t *len)
+{
+    char *str;
+    int n;
+
+    *len = 0;
+    n = WideCharToMultiByte(CP_UTF8, 0, wcs, -1, NULL, 0, NULL, NULL);
+    if (n <= 0 || (str = malloc(n)) == NULL) return NULL;
+
+    WideCharToMultiByte(CP_UTF8, 0, wcs, -1, str, n, NULL, NULL);
+    *len = (size_t)n - 1;
+
+    return str;
+}
+
+static wchar_t *from_utf8(const char *str)
+{
+    wchar_t *wcs;
+    int n;
+
+    n = MultiByteToWideChar(CP_UTF8, 0, str, -1, NULL, 0);
+    if (n <= 0 || (wcs = malloc(n * sizeof(wchar_t))) == NULL) return NULL;
+
+    MultiByteToWideChar(CP_UTF8, 0, str, -1, wcs, n);
+
+    return wcs;
+}
+
+static void put_message(OUTBUF *b, DWORD error)
+{
+    wchar_t *msg = NULL;
+    char *str;
+    size_t len;
+
+    FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS |
+                   FORMAT_MESSAGE_ALLOCATE_BUFFER,
+                   NULL, error, 0, (LPWSTR)&msg, 0, NULL);
+
+    if (msg && (str = to_utf8(msg, &len)) != NULL) {
+        while (len > 0 && (str[len-1] == '\n' || str[len-1] == '\r' ||
+                           str[len-1] == ' ' || str[len-1] == '.')) {
+            len--;
+        }
+        outbuf_put(b, str, len);
+        free(str);
+    } else {
+        outbuf_puts(b, "error ");
+        outbuf_u64(b, error);
+    }
+
+    LocalFree(msg);
+}
+
+/* NTFS file IDs fit into 64 bits */
+static uint64_t file_id_low(const FILE_ID_128 *id)
+{
+    uint64_t v = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--) {
+        v = (v << 8) | id->Identifier[i];
+    }
+
+    return v;
+}
+
+static void put_octal(OUTBUF *b, unsigned int value)
+{
+    char buf[16];
+
+    snprintf(buf, sizeof(buf), "%06o", value);
+    outbuf_puts(b, buf);
+}
+
+static void emit_text(TOOL_OUTPUT *o, const TOOL_RESULT *res,
+                      const char *path, size_t plen, const char *value, size_t vlen)
+{
+    if (res->error) {
+        outbuf_puts(&o->err, o->tool->name);
+        outbuf_puts(&o->err, ": ");
+        outbuf_put(&o->err, path, plen);
+        outbuf_puts(&o->err, ": ");
+        put_message(&o->err, res->error);
+        outbuf_puts(&o->err, "\n");
+        return;
+    }
+
+    switch (o->tool->text_style)
+    {
+    case TOOL_TEXT_VALUE:
+        outbuf_put(&o->out, value, vlen);
+        break;
+
+    case TOOL_TEXT_LINK:
+        outbuf_put(&o->out, path, plen);
+        outbuf_puts(&o->out, " -> ");
+        outbuf_put(&o->out, value, vlen);
+        break;
+
+    case TOOL_TEXT_STAT:
+        if (!res->stx) return;
+        put_octal(&o->out, res->stx->stx_mode);
+        outbuf_puts(&o->out, " ");
+        outbuf_u64(&o->out, res->stx->stx_nlink);
+        outbuf_puts(&o->out, " ");
+        outbuf_u64(&o->out, res->stx->stx_size);
+        outbuf_puts(&o->out, " ");
+        outbuf_i64(&o->out, res->stx->stx_mtime.tv_sec);
+        outbuf_puts(&o->out, " ");
+        outbuf_put(&o->out, path, plen);
+        break;
+
+    default:
+        return;
+    }
+
+    outbuf_puts(&o->out, "\n");
+}
+
+static void emit_json(TOOL_OUTPUT *o, const TOOL_RESULT *res,
+                      const char *path, size_t plen, const char *value, size_t vlen)
+{
+    OUTBUF *b = &o->out;
+    OUTBUF msg = { NULL, 0, 0, 0 };
+
+    outbuf_puts(b, "{\"index\":");
+    outbuf_u64(b, o->index);
+    outbuf_puts(b, ",\"path\":");
+    outbuf_json(b, path, plen);
+
+    if (res->error) {
+        outbuf_puts(b, ",\"error\":");
+        outbuf_u64(b, res->error);
+        outbuf_puts(b, ",\"message\":");
+        put_message(&msg, res->error);
+        outbuf_json(b, msg.data ? msg.data : "", msg.len);
+        outbuf_free(&msg);
+        outbuf_puts(b, "}\n");
+        return;
+    }
+
+    if (value) {
+        outbuf_puts(b, ",\"");
+        outbuf_puts(b, o->tool->value_key);
+        outbuf_puts(b, "\":");
+        outbuf_json(b, value, vlen);
+    }
+
+    if (res->tag) {
+        outbuf_puts(b, ",\"tag\":");
+        outbuf_u64(b, res->tag);
+    }
+
+    if (res->stx) {
+        outbuf_puts(b, ",\"mode\":");
+        outbuf_u64(b, res->stx->stx_mode);
+        outbuf_puts(b, ",\"nlink\":");
+        outbuf_u64(b, res->stx->stx_nlink);
+        outbuf_puts(b, ",\"size\":");
+        outbuf_u64(b, res->stx->stx_size);
+        outbuf_puts(b, ",\"mtime\":");
+        outbuf_i64(b, res->stx->stx_mtime.tv_sec);
+        outbuf_puts(b, ",\"ino\":");
+        outbuf_u64(b, file_id_low(&res->stx->stx_ino));
+        outbuf_puts(b, ",\"dev\":");
+        outbuf_u64(b, res->stx->stx_dev);
+    }
+
+    outbuf_puts(b, "}\n");
+}
+
+static void emit_binary(TOOL_OUTPUT *o, const TOOL_RESULT *res,
+                        const char *path, size_t plen, const char *value, size_t vlen)
+{
+    TOOL_STAT st;
+
+    if (res->error) {
+        outbuf_record(&o->out, o->index, (int32_t)res->error, res->tag, 0);
+        return;
+    }
+
+    switch (o->tool->text_style)
+    {
+    case TOOL_TEXT_VALUE:
+        outbuf_record(&o->out, o->index, 0, res->tag, (uint32_t)vlen);
+        outbuf_put(&o->out, value, vlen);
+        break;
+
+    case TOOL_TEXT_LINK:
+        outbuf_record(&o->out, o->index, 0, res->tag, (uint32_t)(plen + 1 + vlen));
+        outbuf_put(&o->out, path, plen);
+        outbuf_put(&o->out, "", 1);
+        outbuf_put(&o->out, value, vlen);
+        break;
+
+    case TOOL_TEXT_STAT:
+        if (!res->stx) return;
+        st.size = res->stx->stx_size;
+        st.mtime = res->stx->stx_mtime.tv_sec;
+        st.ino = file_id_low(&res->stx->stx_ino);
+        st.dev = res->stx->stx_dev;
+        st.mode = res->stx->stx_mode;
+        st.nlink = res->stx->stx_nlink;
+        outbuf_record(&o->out, o->index, 0, res->tag, TOOL_STAT_SIZE);
+        outbuf_stat(&o->out, &st);
+        break;
+
+    default:
+        outbuf_record(&o->out, o->index, 0, res->tag, 0);
+        break;
+    }
+}
+
+/* write what 'o' has so far; called with the batch lock held */
+static void write_output(BATCH *b, TOOL_OUTPUT *o)
+{
+    if (o->out.nomem || o->err.nomem) {
+        fprintf(stderr, "%s: out of memory\n", b->tool->name);
+        b->io_error = TRUE;
+        o->out.nomem = o->err.nomem = 0;
+    }
+
+    if (o->out.len > 0 && fwrite(o->out.data, 1, o->out.len, stdout) != o->out.len) {
+        b->io_error = TRUE;
+    }
+
+    if (o->err.len > 0) {
+        fwrite(o->err.data, 1, o->err.len, stderr);
+    }
+
+    o->out.len = 0;
+    o->err.len = 0;
+}
+
+void tool_emit(TOOL_OUTPUT *o, const TOOL_RESULT *res)
+{
+    char *path = NULL, *value = NULL;
+    size_t plen = 0, vlen = 0;
+
+    if (res->path) path = to_utf8(res->path, &plen);
+    if (res->value) value = to_utf8(res->value, &vlen);
+
+    if (res->error) {
+        o->failed = TRUE;
+    }
+
+    switch (o->format)
+    {
+    case FORMAT_JSON:
+        emit_json(o, res, path ? path : "", plen, value, vlen);
+        break;
+
+    case FORMAT_BINARY:
+        emit_binary(o, res, path ? path : "", plen, value ? value : "", vlen);
+        break;
+
+    default:
+        emit_text(o, res, path ? path : "", plen, value ? value : "", vlen);
+        break;
+    }
+
+    free(path);
+    free(value);
+
+    /* a record with many results (a findlinks root) doesn't keep them all
+     * in memory: once every record before it is written its output can go
+     * out right away */
+    if (o->out.len + o->err.len >= STREAM_SIZE) {
+        AcquireSRWLockExclusive(&o->batch->lock);
+
+        if (o->slot == o->batch->head) {
+            write_output(o->batch, o);
+        }
+
+        ReleaseSRWLockExclusive(&o->batch->lock);
+    }
+}
+
+
+static void run_record(void *ctx, size_t i)
+{
+    BATCH *b = (BATCH *)ctx;
+    TOOL_OUTPUT *o = &b->outs[i];
+    wchar_t *fields[MAX_FIELDS];
+    TOOL_RESULT res;
+    char *str, *tab;
+    DWORD error;
+    int n, k;
+
+    o->tool = b->tool;
+    o->batch = b;
+    o->format = b->format;
+    o->index = b->next_index + i;
+    o->slot = i;
+    o->failed = FALSE;
+    o->out.len = 0;
+    o->err.len = 0;
+
+    /* split "target<TAB>link" */
+    str = b->recs[i].str;
+    error = 0;
+
+    for (n = 0; n < b->tool->fields; n++) {
+        if (!str) {
+            error = ERROR_INVALID_PARAMETER;
+            break;
+        }
+
+        tab = (n < b->tool->fields - 1) ? strchr(str, '\t') : NULL;
+        if (tab) *tab = 0;
+
+        if ((fields[n] = from_utf8(str)) == NULL) {
+            error = ERROR_NOT_ENOUGH_MEMORY;
+            break;
+        }
+
+        str = tab ? tab + 1 : NULL;
+    }
+
+    if (error == 0) {
+        b->tool->run(o, (const wchar_t * const *)fields);
+    } else {
+        memset(&res, 0, sizeof(res));
+        res.path = (n > 0) ? fields[0] : L"";
+        res.error = error;
+        tool_emit(o, &res);
+    }
+
+    for (k = 0; k < n; k++) {
+        free(fields[k]);
+    }
+
+    /* write the output of this and the following finished records if
+     * all before them are written, keeping the input order */
+    AcquireSRWLockExclusive(&b->lock);
+    o->done = TRUE;
+
+    while (b->head < b->count && b->outs[b->head].done) {
+        o = &b->outs[b->head++];
+        write_output(b, o);
+        if (o->failed) b->failed = TRUE;
+    }
+
+    ReleaseSRWLockExclusive(&b->lock);
+}
+
+static void flush_block(BATCH *b, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        b->outs[i].done = FALSE;
+    }
+
+    b->head = 0;
+    b->count = count;
+
+    parallel_for(count, b->threads, run_record, b);
+
+    fflush(stdout);
+    b->next_index += count;
+}
+
+/* split 'buf' into blocks and process them; returns the bytes consumed */
+static size_t process_buffer(BATCH *b, char *buf, size_t len, char sep, int final)
+{
+    size_t count, used, off = 0;
+
+    do {
+        count = split_records(buf + off, len - off, sep, final, b->recs, BLOCK_SIZE, &used);
+        off += used;
+        if (count > 0) flush_block(b, count);
+    } while (count == BLOCK_SIZE && !b->io_error);
+
+    return off;
+}
+
+static BOOL read_stdin(BATCH *b, char sep)
+{
+    HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+    size_t size = READ_SIZE, have = 0, used;
+    DWORD n;
+    char *buf, *p;
+    int final = 0;
+
+    if ((buf = malloc(size)) == NULL) {
+        return FALSE;
+    }
+
+    while (!final && !b->io_error) {
+        /* keep a byte for the NUL of an unterminated last record */
+        if (have == size - 1) {
+            if ((p = realloc(buf, size * 2)) == NULL) {
+                free(buf);
+                return FALSE;
+            }
+            buf = p;
+            size *= 2;
+        }
+
+        /* a pipe returns whatever is available, so records are
+         * processed while the writer is still producing them */
+        if (!ReadFile(input, buf + have, (DWORD)(size - 1 - have), &n, NULL)) {
+            /* the writer closed its end of the pipe */
+            if (GetLastError() != ERROR_BROKEN_PIPE) b->io_error = TRUE;
+            final = 1;
+        } else if (n == 0) {
+            final = 1;
+        }
+
+        have += n;
+        used = process_buffer(b, buf, have, sep, final);
+        memmove(buf, buf + used, have - used);
+        have -= used;
+    }
+
+    free(buf);
+
+    return TRUE;
+}
+
+static BOOL read_list_file(BATCH *b, const wchar_t *file, char sep)
+{
+    LARGE_INTEGER size;
+    HANDLE handle, mapping;
+    size_t used, rest;
+    char *view, *tail;
+
+    handle = CreateFileW(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                         FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return FALSE;
+    }
+
+    /* nothing to do, and an empty file can't be mapped */
+    if (size.QuadPart == 0) {
+        CloseHandle(handle);
+        return TRUE;
+    }
+
+    /* copy-on-write, the separators are replaced with NUL in place */
+    mapping = CreateFileMappingW(handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(handle);
+
+    if (!mapping) {
+        return FALSE;
+    }
+
+    view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (!view) {
+        return FALSE;
+    }
+
+    used = process_buffer(b, view, (size_t)size.QuadPart, sep, 0);
+    rest = (size_t)size.QuadPart - used;
+
+    /* the last record isn't terminated, so there's no room for a NUL */
+    if (rest > 0 && !b->io_error) {
+        if ((tail = malloc(rest + 1)) == NULL) {
+            UnmapViewOfFile(view);
+            return FALSE;
+        }
+
+        memcpy(tail, view + used, rest);
+        process_buffer(b, tail, rest, sep, 1);
+        free(tail);
+    }
+
+    UnmapViewOfFile(view);
+
+    return TRUE;
+}
+
+/* the remaining arguments as records; for two fields they are paired
+ * up as "target<TAB>link" */
+static BOOL read_args(BATCH *b, wchar_t **argv, int argc)
+{
+    OUTBUF buf = { NULL, 0, 0, 0 };
+    char *str;
+    size_t len;
+    int i;
+
+    for (i = 0; i < argc; i++) {
+        if ((str = to_utf8(argv[i], &len)) == NULL) {
+            outbuf_free(&buf);
+            return FALSE;
+        }
+
+        outbuf_put(&buf, str, len);
+        outbuf_put(&buf, ((i + 1) % b->tool->fields) ? "\t" : "", 1);
+        free(str);
+    }
+
+    if (buf.nomem) {
+        outbuf_free(&buf);
+        return FALSE;
+    }
+
+    process_buffer(b, buf.data, buf.len, 0, 0);
+    outbuf_free(&buf);
+
+    return TRUE;
+}
+
+static int usage(const TOOL *tool)
+{
+    fprintf(stderr,
+            "usage: %s [-0] [-j|-r] [-t THREADS] %s\n"
+            "       %s -b|-f LISTFILE [-0] [-j|-r] [-t THREADS]\n"
+            "\n"
+            "  -b  read the paths from stdin\n"
+            "  -f  read the paths from LISTFILE\n"
+            "  -0  paths are separated by NUL instead of newlines\n"
+            "  -j  write NDJSON\n"
+            "  -r  write binary records\n"
+            "  -t  number of worker threads\n",
+            tool->name, tool->usage, tool->name);
+
+    return 2;
+}
+
+int tool_main(const TOOL *tool)
+{
+    static BATCH batch;
+    wchar_t **argv, *list = NULL;
+    BOOL from_stdin = FALSE, ok;
+    char sep = '\n';
+    int argc, i, k, rv;
+    wchar_t c;
+
+    if ((argv = CommandLineToArgvW(GetCommandLineW(), &argc)) == NULL) {
+        return 2;
+    }
+
+    memset(&batch, 0, sizeof(batch));
+    InitializeSRWLock(&batch.lock);
+    batch.tool = tool;
+    batch.format = FORMAT_TEXT;
+
+    for (i = 1; i < argc && argv[i][0] == L'-' && argv[i][1]; i++) {
+        if (wcscmp(argv[i], L"--") == 0) {
+            i++;
+            break;
+        }
+
+        for (k = 1; (c = argv[i][k]) != 0; k++) {
+            switch (c)
+            {
+            case L'0': sep = 0; break;
+            case L'b': from_stdin = TRUE; break;
+            case L'j': batch.format = FORMAT_JSON; break;
+            case L'r': batch.format = FORMAT_BINARY; break;
+
+            case L'f':
+            case L't':
+                if (argv[i][k+1] || i + 1 >= argc) {
+                    LocalFree(argv);
+                    return usage(tool);
+                }
+                if (c == L'f') {
+                    list = argv[++i];
+                } else {
+                    batch.threads = (unsigned int)wcstoul(argv[++i], NULL, 10);
+                }
+                goto next_arg;
+
+            default:
+                if (c < 128 && tool->options && strchr(tool->options, (char)c)) {
+                    flags[c] = 1;
+                    break;
+                }
+                LocalFree(argv);
+                return usage(tool);
+            }
+        }
+next_arg:
+        ;
+    }
+
+    /* either a batch source or arguments */
+    if ((from_stdin || list) ? (i < argc || (from_stdin && list))
+                             : (i >= argc || (argc - i) % tool->fields != 0))
+    {
+        LocalFree(argv);
+        return usage(tool);
+    }
+
+    _setmode(_fileno(stdout), _O_BINARY);
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+
+    if (from_stdin) {
+        ok = read_stdin(&batch, sep);
+    } else if (list) {
+        ok = read_list_file(&batch, list, sep);
+    } else {
+        ok = read_args(&batch, argv + i, argc - i);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "%s: cannot read the input (error %lu)\n",
+                tool->name, (unsigned long)GetLastError());
+    }
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        outbuf_free(&batch.outs[i].out);
+        outbuf_free(&batch.outs[i].err);
+    }
+
+    LocalFree(argv);
+
+    if (!ok || batch.io_error) {
+        rv = 2;
+    } else {
+        rv = batch.failed ? 1 : 0;
+    }
+
+    return rv;
+}
@@ -0,0 +1,93 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_TOOL_H_INCLUDED
+#define W32_SYMLINK_TOOL_H_INCLUDED
+
+#include <windows.h>
+#include <wchar.h>
+#include "toolio.h"
+#include "w32-symlink.h"
+
+
+/* the output of one input path, see tool_emit() */
+typedef struct TOOL_OUTPUT TOOL_OUTPUT;
+
+/* one result line */
+typedef struct {
+    const wchar_t        *path;   /* the file this is about */
+    DWORD                 error;  /* 0 or a Windows error code */
+    ULONG                 tag;    /* reparse tag, or 0 */
+    const wchar_t        *value;  /* link target or path, or NULL */
+    const struct lstatx  *stx;    /* lstat data, or NULL */
+} TOOL_RESULT;
+
+/* how a result looks like in text mode */
+#define TOOL_TEXT_VALUE  0  /* value */
+#define TOOL_TEXT_LINK   1  /* path -> value */
+#define TOOL_TEXT_STAT   2  /* mode links size mtime path */
+#define TOOL_TEXT_NONE   3  /* only errors */
+
+typedef struct {
+    const char *name;
+    const char *usage;       /* arguments after the common options */
+    const char *options;     /* tool specific option letters, see tool_flag() */
+    const char *value_key;   /* JSON name of TOOL_RESULT.value */
+    int         text_style;  /* TOOL_TEXT_* */
+    int         fields;      /* paths per input record (TAB separated), 1 or 2 */
+
+    /* called on a worker thread for every input record; must call
+     * tool_emit() for each result */
+    void (*run)(TOOL_OUTPUT *out, const wchar_t * const *fields);
+} TOOL;
+
+
+/**
+ * Common main() of the tools:
+ *
+ *   name [-0] [-j|-r] [-t THREADS] [OPTIONS] PATH...
+ *   name -b [-0] [-j|-r] [-t THREADS] [OPTIONS]
+ *   name -f LISTFILE [-0] [-j|-r] [-t THREADS] [OPTIONS]
+ *
+ * -b reads the paths from stdin, -f from a list file, which is mapped
+ * into memory. They are separated by newlines, or by NUL with -0.
+ * Records are processed in blocks on a pool of worker threads and the
+ * output of a record is written, in input order, as soon as it and all
+ * records before it are done. A record with a lot of output writes it
+ * while it still runs once the records before it are written.
+ *
+ * Output is text, NDJSON with -j or binary records with -r (see
+ * toolio.h). Paths are read and written UTF-8 encoded.
+ *
+ * Returns 0 if every record succeeded, 1 if any failed and 2 on usage
+ * or I/O errors.
+ */
+int tool_main(const TOOL *tool);
+
+/* whether the tool specific option 'c' was given */
+int tool_flag(char c);
+
+/* append a result to the output of the current record */
+void tool_emit(TOOL_OUTPUT *out, const TOOL_RESULT *res);
+
+#endif /* W32_SYMLINK_TOOL_H_INCLUDED */
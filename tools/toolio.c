@@ -0,0 +1,206 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "toolio.h"
+
+
+static int reserve(OUTBUF *b, size_t len)
+{
+    size_t size;
+    char *p;
+
+    if (b->nomem) return 0;
+    if (b->len + len <= b->size) return 1;
+
+    size = b->size ? b->size : 256;
+    while (size < b->len + len) size *= 2;
+
+    if ((p = realloc(b->data, size)) == NULL) {
+        b->nomem = 1;
+        return 0;
+    }
+
+    b->data = p;
+    b->size = size;
+
+    return 1;
+}
+
+void outbuf_put(OUTBUF *b, const void *data, size_t len)
+{
+    if (len > 0 && reserve(b, len)) {
+        memcpy(b->data + b->len, data, len);
+        b->len += len;
+    }
+}
+
+void outbuf_puts(OUTBUF *b, const char *str)
+{
+    outbuf_put(b, str, strlen(str));
+}
+
+void outbuf_u64(OUTBUF *b, uint64_t value)
+{
+    char buf[20];
+    size_t i = sizeof(buf);
+
+    do {
+        buf[--i] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    outbuf_put(b, buf + i, sizeof(buf) - i);
+}
+
+void outbuf_i64(OUTBUF *b, int64_t value)
+{
+    if (value < 0) {
+        outbuf_put(b, "-", 1);
+        outbuf_u64(b, 0 - (uint64_t)value);
+    } else {
+        outbuf_u64(b, (uint64_t)value);
+    }
+}
+
+void outbuf_free(OUTBUF *b)
+{
+    free(b->data);
+    memset(b, 0, sizeof(*b));
+}
+
+void outbuf_json(OUTBUF *b, const char *str, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    char esc[6] = { '\\', 'u', '0', '0', 0, 0 };
+    size_t i, start;
+    unsigned char c;
+
+    outbuf_put(b, "\"", 1);
+
+    for (i = start = 0; i < len; i++) {
+        c = (unsigned char)str[i];
+
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        outbuf_put(b, str + start, i - start);
+        start = i + 1;
+
+        switch (c) {
+            case '"':  outbuf_put(b, "\\\"", 2); break;
+            case '\\': outbuf_put(b, "\\\\", 2); break;
+            case '\n': outbuf_put(b, "\\n", 2); break;
+            case '\r': outbuf_put(b, "\\r", 2); break;
+            case '\t': outbuf_put(b, "\\t", 2); break;
+            default:
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 15];
+                outbuf_put(b, esc, 6);
+                break;
+        }
+    }
+
+    outbuf_put(b, str + start, len - start);
+    outbuf_put(b, "\"", 1);
+}
+
+static void put_le(uint8_t *p, uint64_t v, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8*i));
+    }
+}
+
+void outbuf_record(OUTBUF *b, uint64_t index, int32_t error, uint32_t tag, uint32_t length)
+{
+    uint8_t hdr[TOOL_RECORD_SIZE];
+
+    put_le(hdr, index, 8);
+    put_le(hdr + 8, (uint32_t)error, 4);
+    put_le(hdr + 12, tag, 4);
+    put_le(hdr + 16, length, 4);
+    put_le(hdr + 20, 0, 4);
+
+    outbuf_put(b, hdr, sizeof(hdr));
+}
+
+void outbuf_stat(OUTBUF *b, const TOOL_STAT *st)
+{
+    uint8_t data[TOOL_STAT_SIZE];
+
+    put_le(data, st->size, 8);
+    put_le(data + 8, (uint64_t)st->mtime, 8);
+    put_le(data + 16, st->ino, 8);
+    put_le(data + 24, st->dev, 8);
+    put_le(data + 32, st->mode, 4);
+    put_le(data + 36, st->nlink, 4);
+
+    outbuf_put(b, data, sizeof(data));
+}
+
+
+size_t split_records(char *buf, size_t len, char sep, int final,
+                     TOOL_INPUT *recs, size_t max, size_t *consumed)
+{
+    size_t n = 0, pos = 0, end, rlen;
+    char *p;
+
+    while (n < max && pos < len) {
+        p = memchr(buf + pos, sep, len - pos);
+
+        if (p) {
+            end = (size_t)(p - buf);
+        } else if (final) {
+            end = len;
+        } else {
+            break;
+        }
+
+        rlen = end - pos;
+
+        if (sep == '\n' && rlen > 0 && buf[pos + rlen - 1] == '\r') {
+            rlen--;
+        }
+
+        buf[pos + rlen] = 0;
+
+        if (rlen > 0) {
+            recs[n].str = buf + pos;
+            recs[n].len = rlen;
+            n++;
+        }
+
+        pos = (end < len) ? end + 1 : end;
+    }
+
+    *consumed = pos;
+
+    return n;
+}
@@ -0,0 +1,107 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#ifndef W32_SYMLINK_TOOLIO_H_INCLUDED
+#define W32_SYMLINK_TOOLIO_H_INCLUDED
+
+/* This file must not depend on windows.h so it can be built and tested
+ * on other platforms. All strings are UTF-8. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Binary output ("-r"): every result is a fixed 24 byte header followed
+ * by 'length' bytes of data. All numbers are little endian.
+ *
+ *  0  uint64  index of the input path (0, 1, ...)
+ *  8  int32   0 or a Windows error code
+ * 12  uint32  reparse tag, or 0
+ * 16  uint32  length of the data
+ * 20  uint32  reserved (0)
+ *
+ * The data is the UTF-8 result string (readlink, realpath), the link
+ * path, a NUL and the target (findlinks), or a TOOL_STAT (lstat).
+ */
+#define TOOL_RECORD_SIZE  24
+
+/* lstat data in binary output, little endian */
+typedef struct {
+    uint64_t size;
+    int64_t  mtime;   /* seconds since 1970 */
+    uint64_t ino;     /* low 64 bits of the file ID */
+    uint64_t dev;     /* volume serial number */
+    uint32_t mode;
+    uint32_t nlink;
+} TOOL_STAT;
+
+#define TOOL_STAT_SIZE  40
+
+
+/* a growing output buffer; a failed allocation sets 'nomem' */
+typedef struct {
+    char  *data;
+    size_t len;
+    size_t size;
+    int    nomem;
+} OUTBUF;
+
+void outbuf_put(OUTBUF *b, const void *data, size_t len);
+void outbuf_puts(OUTBUF *b, const char *str);
+void outbuf_u64(OUTBUF *b, uint64_t value);
+void outbuf_i64(OUTBUF *b, int64_t value);
+void outbuf_free(OUTBUF *b);
+
+/* 'str' as a quoted JSON string */
+void outbuf_json(OUTBUF *b, const char *str, size_t len);
+
+/* a binary record header (see above) */
+void outbuf_record(OUTBUF *b, uint64_t index, int32_t error, uint32_t tag, uint32_t length);
+
+/* a TOOL_STAT in its binary form */
+void outbuf_stat(OUTBUF *b, const TOOL_STAT *st);
+
+
+/* one input path inside of the input buffer */
+typedef struct {
+    char  *str;   /* NUL-terminated */
+    size_t len;
+} TOOL_INPUT;
+
+/**
+ * Split 'buf' into records separated by 'sep' ('\n' or '\0') and store
+ * up to 'max' of them in 'recs'. The separators are overwritten with NUL
+ * in place. With '\n' a trailing '\r' is removed as well. Empty records
+ * are skipped.
+ *
+ * The last record is only taken if it is terminated or if 'final' is
+ * set; in this case buf[len] must be writable. '*consumed' receives the
+ * number of bytes that were processed.
+ *
+ * Returns the number of records stored.
+ */
+size_t split_records(char *buf, size_t len, char sep, int final,
+                     TOOL_INPUT *recs, size_t max, size_t *consumed);
+
+#endif /* W32_SYMLINK_TOOLIO_H_INCLUDED */
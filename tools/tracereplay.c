@@ -0,0 +1,251 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026 Carsten Janssen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE
+ */
+#include <windows.h>
+#include <wchar.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "calltrace.h"
+#include "reparse_data_buffer.h"
+#include "trace.h"
+#include "w32-symlink.h"
+
+/* tracereplay: feeds the calls of a trace back into the library and
+ * compares the backend calls they make with the recorded ones. */
+
+static const char *api_names[TRACE_API_COUNT] = {
+    NULL, "isSymlink", "getLinkTarget", "getLinkTargetView", "getCanonicalPathEx",
+    "ntIsSymlink", "ntGetLinkTarget", "ntGetCanonicalPath", "_lstat64"
+};
+
+static const char *op_names[TRACE_CALL] = {
+    NULL, "CreateFile", "GetFileAttributes", "FSCTL_GET_REPARSE_POINT",
+    "GetFinalPathNameByHandle", "NtCreateFile", "NtQueryAttributesFile",
+    "GetFileInformationByHandleEx"
+};
+
+
+static int usage(void)
+{
+    fprintf(stderr,
+            "usage: tracereplay [-q] FILE\n"
+            "Replays the calls recorded with startCallTrace() in FILE against the\n"
+            "library and reports calls whose backend calls or results differ.\n"
+            "  -q  only print the summary\n");
+    return 2;
+}
+
+static uint8_t *load(const char *file, size_t *size)
+{
+    uint8_t *buf = NULL;
+    FILE *fp;
+    long len;
+
+    if ((fp = fopen(file, "rb")) == NULL) {
+        return NULL;
+    }
+
+    if (fseek(fp, 0, SEEK_END) == 0 && (len = ftell(fp)) > 0 &&
+        fseek(fp, 0, SEEK_SET) == 0 && (buf = malloc((size_t)len)) != NULL &&
+        fread(buf, 1, (size_t)len, fp) != (size_t)len)
+    {
+        free(buf);
+        buf = NULL;
+    }
+
+    if (buf) *size = (size_t)len;
+    fclose(fp);
+
+    return buf;
+}
+
+/* run one recorded call; returns its error code, 0 on success */
+static DWORD run(const TRACE_CALL_INFO *info, const wchar_t *path)
+{
+    static uint8_t view_buf[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
+    LINK_TARGET_VIEW view;
+    struct _stat64 st;
+    ULONG tag = 0;
+    wchar_t *wcs = NULL;
+    BOOL failed = FALSE;
+
+    SetLastError(0);
+
+    switch (info->api)
+    {
+    case TRACE_API_IS_SYMLINK:
+        failed = isSymlinkW(path, (info->flags & TRACE_FLAG_TAG) ? &tag : NULL) == -1;
+        break;
+
+    case TRACE_API_NT_IS_SYMLINK:
+        failed = ntIsSymlinkW(path, (info->flags & TRACE_FLAG_TAG) ? &tag : NULL) == -1;
+        break;
+
+    case TRACE_API_LINK_TARGET:
+        failed = (wcs = getLinkTargetW(path, NULL)) == NULL;
+        break;
+
+    case TRACE_API_NT_LINK_TARGET:
+        failed = (wcs = ntGetLinkTargetW(path, NULL)) == NULL;
+        break;
+
+    case TRACE_API_LINK_TARGET_VIEW:
+        failed = !getLinkTargetViewW(path, view_buf, sizeof(view_buf), &view);
+        break;
+
+    case TRACE_API_CANONICAL_PATH:
+        failed = (wcs = getCanonicalPathExW(path, info->flags)) == NULL;
+        break;
+
+    case TRACE_API_NT_CANONICAL_PATH:
+        failed = (wcs = ntGetCanonicalPathW(path, info->flags)) == NULL;
+        break;
+
+    case TRACE_API_LSTAT:
+        failed = _lwstat64(path, &st) != 0;
+        break;
+
+    default:
+        break;
+    }
+
+    free(wcs);
+
+    return failed ? GetLastError() : 0;
+}
+
+int main(int argc, char **argv)
+{
+    const TRACE_CALL_INFO *info;
+    TRACE_INDEX index;
+    uint64_t calls[TRACE_OP_COUNT], recorded[TRACE_OP_COUNT], replayed[TRACE_OP_COUNT];
+    uint64_t missing, differ = 0, skipped = 0;
+    const char *file = NULL;
+    uint8_t *buf;
+    wchar_t *path;
+    size_t size = 0, i, k;
+    DWORD error;
+    int quiet = 0, same, op;
+
+    for (k = 1; k < (size_t)argc; k++) {
+        if (strcmp(argv[k], "-q") == 0) {
+            quiet = 1;
+        } else if (argv[k][0] == '-' || file) {
+            return usage();
+        } else {
+            file = argv[k];
+        }
+    }
+
+    if (!file) {
+        return usage();
+    }
+
+    if ((buf = load(file, &size)) == NULL) {
+        fprintf(stderr, "tracereplay: cannot read %s\n", file);
+        return 2;
+    }
+
+    if (trace_index_build(buf, size, &index) != 0) {
+        fprintf(stderr, "tracereplay: %s is not a valid trace\n", file);
+        free(buf);
+        return 2;
+    }
+
+    memset(recorded, 0, sizeof(recorded));
+    memset(replayed, 0, sizeof(replayed));
+
+    for (i = 0; i < index.call_count; i++) {
+        info = &index.calls[i];
+
+        if (!info->returned || info->api == 0 || info->api >= TRACE_API_COUNT ||
+            (path = calloc(info->path_len / sizeof(wchar_t) + 1, sizeof(wchar_t))) == NULL)
+        {
+            skipped++;
+            continue;
+        }
+
+        memcpy(path, info->path, info->path_len);
+
+        if (!traced_replay_begin(&index, i)) {
+            fprintf(stderr, "tracereplay: a trace is being recorded\n");
+            free(path);
+            break;
+        }
+
+        error = run(info, path);
+        traced_replay_end(calls, &missing);
+
+        same = (error == info->error && missing == 0);
+
+        for (op = 1; op < TRACE_CALL; op++) {
+            recorded[op] += info->calls[op];
+            replayed[op] += calls[op];
+            if (calls[op] != info->calls[op]) same = 0;
+        }
+
+        if (!same) {
+            differ++;
+
+            if (!quiet) {
+                printf("%s(%ls):", api_names[info->api], path);
+
+                for (op = 1; op < TRACE_CALL; op++) {
+                    if (calls[op] != info->calls[op]) {
+                        printf(" %s %llu -> %llu", op_names[op],
+                               (unsigned long long)info->calls[op], (unsigned long long)calls[op]);
+                    }
+                }
+
+                if (missing > 0) {
+                    printf(" unrecorded %llu", (unsigned long long)missing);
+                }
+
+                if (error != info->error) {
+                    printf(" error %lu -> %lu", (unsigned long)info->error, (unsigned long)error);
+                }
+
+                printf("\n");
+            }
+        }
+
+        free(path);
+    }
+
+    printf("%llu calls, %llu differ, %llu skipped, %llu backend calls outside of a call\n",
+           (unsigned long long)index.call_count, (unsigned long long)differ,
+           (unsigned long long)skipped, (unsigned long long)index.unowned);
+
+    for (op = 1; op < TRACE_CALL; op++) {
+        printf("  %-30s %10llu recorded %10llu replayed\n", op_names[op],
+               (unsigned long long)recorded[op], (unsigned long long)replayed[op]);
+    }
+
+    trace_index_free(&index);
+    free(buf);
+
+    return differ ? 1 : 0;
+}